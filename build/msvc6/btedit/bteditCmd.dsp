@@ -143,6 +143,10 @@ SOURCE=..\..\..\src\stdlib\llstrcmp.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\lltrace.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\stdlib\memalloc.c
 # End Source File
 # Begin Source File
@@ -159,6 +163,10 @@ SOURCE=..\..\..\src\stdlib\mystring.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\omap.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\btree\opnbtree.c
 # End Source File
 # Begin Source File
@@ -112,6 +112,10 @@ SOURCE=..\..\..\src\btree\btrec.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\btree\compact.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\charmaps.c
 # End Source File
 # Begin Source File
@@ -208,6 +212,10 @@ SOURCE=..\..\..\src\btree\index.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\indifacts.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\indiseq.c
 # End Source File
 # Begin Source File
@@ -260,6 +268,10 @@ SOURCE=..\..\..\src\stdlib\llstrcmp.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\lltrace.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\locales.c
 # End Source File
 # Begin Source File
@@ -320,6 +332,10 @@ SOURCE=..\..\..\src\stdlib\object.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\omap.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\btree\opnbtree.c
 # End Source File
 # Begin Source File
@@ -328,6 +344,10 @@ SOURCE=..\..\..\src\stdlib\path.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\pedgraph.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\place.c
 # End Source File
 # Begin Source File
@@ -352,6 +372,10 @@ SOURCE=..\..\..\src\gedlib\refns.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\relcache.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\remove.c
 # End Source File
 # Begin Source File
@@ -420,6 +444,10 @@ SOURCE=..\..\..\src\stdlib\table.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\textindex.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\translat.c
 # End Source File
 # Begin Source File
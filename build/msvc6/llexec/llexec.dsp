@@ -124,6 +124,10 @@ SOURCE=..\..\..\src\btree\btrec.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\btree\compact.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\interp\builtin.c
 # End Source File
 # Begin Source File
@@ -132,6 +136,10 @@ SOURCE=..\..\..\src\interp\builtin_list.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\interp\builtin_map.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\charmaps.c
 # End Source File
 # Begin Source File
@@ -252,6 +260,10 @@ SOURCE=..\..\..\src\btree\index.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\indifacts.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\indiseq.c
 # End Source File
 # Begin Source File
@@ -316,6 +328,10 @@ SOURCE=.\llexec.rc
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\liflines\llserve.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\llgettext.c
 # End Source File
 # Begin Source File
@@ -328,6 +344,10 @@ SOURCE=..\..\..\src\stdlib\llstrcmp.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\lltrace.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\locales.c
 # End Source File
 # Begin Source File
@@ -392,14 +412,26 @@ SOURCE=..\..\..\src\stdlib\object.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\omap.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\btree\opnbtree.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\interp\parloop.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\stdlib\path.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\pedgraph.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\place.c
 # End Source File
 # Begin Source File
@@ -408,6 +440,10 @@ SOURCE=..\..\..\src\arch\platform.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\interp\profile.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\interp\progerr.c
 # End Source File
 # Begin Source File
@@ -444,6 +480,10 @@ SOURCE=..\..\..\src\gedlib\refns.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\relcache.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\remove.c
 # End Source File
 # Begin Source File
@@ -536,6 +576,10 @@ SOURCE=..\..\..\src\stdlib\table.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\textindex.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\translat.c
 # End Source File
 # Begin Source File
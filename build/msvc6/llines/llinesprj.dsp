@@ -149,6 +149,10 @@ SOURCE=..\..\..\src\btree\btrec.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\btree\compact.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\interp\builtin.c
 # End Source File
 # Begin Source File
@@ -157,6 +161,10 @@ SOURCE=..\..\..\src\interp\builtin_list.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\interp\builtin_map.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\charmaps.c
 # End Source File
 # Begin Source File
@@ -309,6 +317,10 @@ SOURCE=..\..\..\src\btree\index.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\indifacts.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\indiseq.c
 # End Source File
 # Begin Source File
@@ -393,6 +405,10 @@ SOURCE=..\..\..\src\stdlib\llstrcmp.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\lltrace.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\liflines\loadsave.c
 # End Source File
 # Begin Source File
@@ -489,14 +505,26 @@ SOURCE=..\..\..\src\stdlib\object.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\stdlib\omap.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\btree\opnbtree.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\interp\parloop.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\stdlib\path.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\pedgraph.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\liflines\pedigree.c
 # End Source File
 # Begin Source File
@@ -509,6 +537,10 @@ SOURCE=..\..\..\src\arch\platform.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\interp\profile.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\interp\progerr.c
 # End Source File
 # Begin Source File
@@ -549,6 +581,10 @@ SOURCE=..\..\..\src\gedlib\refns.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\relcache.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\remove.c
 # End Source File
 # Begin Source File
@@ -661,6 +697,10 @@ SOURCE=..\..\..\src\liflines\tandem.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\gedlib\textindex.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\gedlib\translat.c
 # End Source File
 # Begin Source File
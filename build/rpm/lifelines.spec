@@ -92,6 +92,7 @@ install -m 644 reports/ps-fan/ps-fan* $RPM_BUILD_ROOT%{reports_dir}/ps-fan
 install -d -m 755 $RPM_BUILD_ROOT%{tt_dir}
 install -m 644 tt/*.tt $RPM_BUILD_ROOT%{tt_dir}
 install -d -m 755 $RPM_BUILD_ROOT/usr/local/man/man1
+install -m 644 docs/man/btcompact.1 $RPM_BUILD_ROOT/usr/local/man/man1/btcompact.1
 install -m 644 docs/man/btedit.1 $RPM_BUILD_ROOT/usr/local/man/man1/btedit.1
 install -m 644 docs/man/dbverify.1 $RPM_BUILD_ROOT/usr/local/man/man1/dbverify.1
 install -m 644 docs/man/llines.1 $RPM_BUILD_ROOT/usr/local/man/man1/llines.1
@@ -118,6 +119,7 @@ install -m 644 docs/man/llexec.1 $RPM_BUILD_ROOT/usr/local/man/man1/llexec.1
 /usr/local/share/locale/rw/LC_MESSAGES/lifelines.mo
 %{reports_dir}
 %{tt_dir}
+/usr/local/man/man1/btcompact.1
 /usr/local/man/man1/btedit.1
 /usr/local/man/man1/dbverify.1
 /usr/local/man/man1/llines.1
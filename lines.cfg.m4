@@ -144,6 +144,21 @@ ifdef(`WINDOWS',
 # Print more detailed call stack for each report error
 #FullReportCallStack=1
 
+# Worker processes for parforindi & parforfam loops in reports
+# (default one per processor; 1 runs them as ordinary loops)
+#ReportWorkers=4
+
+# Trace btree, cache, parsing, translation & report output calls,
+# writing the most recent TraceEvents (default 131072) of them to
+# TraceFile (Chrome trace JSON, for chrome://tracing or Perfetto)
+# at exit, or when sent SIGUSR1 (default no tracing)
+ifdef(`WINDOWS',
+#TraceFile:=%llroot%\trace.json
+,
+#TraceFile=%llroot%/trace.json
+)dnl
+#TraceEvents=1000000
+
 # dayfmt,monthfmt,yearfmt,datefmt,erafmt,complexfmt
 # see programmers reference for stddate for these
 # 2,3,0,0,1,1 is GEDCOM style (1 AUG 1945) with complex dates
@@ -305,6 +320,12 @@ ifdef(`WINDOWS',
 # Default is 0 (feature off)
 #DisplayKeyTags=1
 
+# Keep a word index of names, titles, authors, places, notes
+# and refns in the database, to speed up scans and textsearch
+# (built when first needed, then kept up to date)
+#TextIndex=1
+# Default is 0
+
 # Where to find an iconv dll (only for MS-Windows)
 #iconv.path:=C:\Program Files\Common Files\gnu\iconv.dll
 # Not needed if it is named iconv.dll & is on the path.
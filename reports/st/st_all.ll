@@ -35,6 +35,7 @@ include("st_trig.li")
 include("st_convert.li")
 include("st_list.li")
 include("st_table.li")
+include("st_map.li")
 include("st_db.li")
 
 global(true)
@@ -60,6 +61,9 @@ proc main()
 	if (dostep(alltests, "Test tables ? (0=no)")) {
 		call testTables()
 	}
+	if (dostep(alltests, "Test maps ? (0=no)")) {
+		call testMaps()
+	}
 	if (dostep(alltests, "Test UTF-8strings ? (0=no)")) {
 		call testStrings_UTF_8()
 	}
@@ -0,0 +1,32 @@
+/*
+ * @progname       test_parforindi
+ * @version        1
+ * @category       self-test
+ * @output         text
+ * @description
+ *
+ * test parallel iterators: parforindi, parforfam
+ * Accumulate some data in reduction variables, printing results,
+ * so we can compare the output with the plain iterators'.
+ */
+proc main() {
+    set(n, 0)
+    set(keys, "")
+    list(l)
+    table(t)
+    indiset(s)
+    parforindi(i, c, n, keys, l, t, s) {
+        incr(n)
+        set(keys, concat(keys, " ", key(i)))
+        enqueue(l, c)
+        insert(t, sex(i), add(lookup(t, sex(i)), 1))
+        if (eq(mod(c, 3), 0)) { addtoset(s, i, c) }
+    }
+    print(nl(), d(n), ":", keys, nl())
+    forlist(l, e, c) { print(d(e), " ") }
+    print(nl(), "M ", d(lookup(t, "M")), " F ", d(lookup(t, "F")), nl())
+    forindiset(s, i, v, c) { print(key(i), "=", d(v), " ") }
+    set(n, 0)
+    parforfam(f, c, n) { incr(n) }
+    print(nl(), d(n), " families", nl())
+}
@@ -0,0 +1,64 @@
+/*
+ * @progname       test_relcache
+ * @version        1
+ * @category       self-test
+ * @output         text
+ * @description
+ *
+ * test relationship functions: ancestorset, descendantset (with and
+ * without generation limit), isancestor, lca
+ * A set of one person is answered from the relationship cache, and a
+ * set holding the same person twice walks the pedigree, so the two
+ * are compared as well as printed.
+ */
+proc main() {
+    forindi(i, c) {
+        indiset(one)
+        addtoset(one, i, 0)
+        indiset(two)
+        addtoset(two, i, 0)
+        addtoset(two, i, 0)
+        print(key(i), " anc:")
+        call showset(ancestorset(one))
+        call compare(ancestorset(one), ancestorset(two), "ancestorset", i)
+        call compare(ancestorset(one, 1), ancestorset(two, 1), "ancestorset 1", i)
+        print(" des:")
+        call showset(descendantset(one))
+        call compare(descendantset(one), descendantset(two), "descendantset", i)
+        call compare(descendantset(one, 1), descendantset(two, 1), "descendantset 1", i)
+        print(" par:")
+        call showset(ancestorset(one, 1))
+        print(nl())
+    }
+    forindi(i, c) {
+        forindi(j, d) {
+            if (lt(c, d)) {
+                set(s, lca(i, j))
+                if (or(length(s), isancestor(i, j), isancestor(j, i))) {
+                    print(key(i), " ", key(j), " isanc ", d(isancestor(i, j))
+                        , " ", d(isancestor(j, i)), " lca:")
+                    call showset(s)
+                    print(nl())
+                }
+            }
+        }
+    }
+}
+proc showset(s) {
+    forindiset(s, p, v, n) { print(" ", key(p), "=", d(v)) }
+}
+proc compare(s1, s2, what, i) {
+    set(ok, eq(length(s1), length(s2)))
+    list(k2)
+    list(v2)
+    forindiset(s2, p, v, n) {
+        enqueue(k2, key(p))
+        enqueue(v2, v)
+    }
+    forindiset(s1, p, v, n) {
+        if (or(nestr(key(p), getel(k2, n)), ne(v, getel(v2, n)))) {
+            set(ok, 0)
+        }
+    }
+    if (not(ok)) { print(nl(), what, " MISMATCH for ", key(i), nl()) }
+}
@@ -36,14 +36,47 @@
 #include "llstdlib.h"
 /* llstdlib.h pulls in standard.h, config.h, sys_inc.h */
 #include "btreei.h"
+#include "lltrace.h"
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* one record waiting to be written by a batch */
+typedef struct tag_btpend {
+	RKEY rkey;
+	RAWRECORD rec;
+	INT len;
+} *BTPEND;
+
+/* records added while batching, in an open hash table on rkey */
+struct tag_btbatch {
+	BTPEND *slots;
+	INT nslots; /* power of 2 */
+	INT count;
+	INT bytes;
+};
+
+/* flush pending records once the batch holds this much */
+#define BATCH_MAXRECS 100000
+#define BATCH_MAXBYTES (32*1024*1024)
 
 /*********************************************
  * local function prototypes
  *********************************************/
 
 /* alphabetical */
+static BOOLEAN add_one_record(BTREE btree, RKEY rkey, RAWRECORD rec, INT len);
+static BOOLEAN batch_record(BTREE btree, RKEY rkey, RAWRECORD rec, INT len);
+static BTPEND * batch_slot(struct tag_btbatch * batch, const RKEY * rkey);
 static void check_offset(BLOCK block, RKEY rkey, INT i);
+static int cmp_pend(const void * el1, const void * el2);
 static void filecopy(FILE*fpsrc, INT len, FILE*fpdest);
+static BLOCK find_write_block(BTREE btree, const RKEY * rkey, RKEY * pupper, BOOLEAN * phasupper);
+static void clear_batch(struct tag_btbatch * batch);
+static void free_pend(BTPEND pend);
+static BTPEND get_pending(BTREE btree, const RKEY * rkey);
+static INT merge_into_block(BTREE btree, BLOCK old, BTPEND * ents, INT cnt);
 static void movefiles(STRING, STRING);
 
 /*********************************************
@@ -90,22 +123,38 @@ check_offset (BLOCK block, RKEY rkey, INT i)
  *  rkey:   [in] key of record (eg, "     I67")
  *  record: [in] record data to add
  *  len:    [in] record length
+ * While a batch is open the record is only queued (see bt_begin_batch)
  *===============================*/
 BOOLEAN
 bt_addrecord (BTREE btree, RKEY rkey, RAWRECORD rec, INT len)
+{
+	BOOLEAN rtn;
+	TRACE_TIME tt;
+	ASSERT(bwrite(btree));
+	TRACE_BEGIN(tt);
+	if (bbatch(btree))
+		rtn = batch_record(btree, rkey, rec, len);
+	else
+		rtn = add_one_record(btree, rkey, rec, len);
+	TRACE_END(tt, "btree", "bt_addrecord", rkey2str(rkey));
+	return rtn;
+}
+/*=================================
+ * find_write_block -- Find data block that does/should hold record
+ *  btree:     [in]  btree to search
+ *  rkey:      [in]  key of record
+ *  pupper:    [out] first key beyond this block (if *phasupper)
+ *  phasupper: [out] does the block have an upper bound ?
+ * Maintains the lazy parent chaining, so only for writers
+ *===============================*/
+static BLOCK
+find_write_block (BTREE btree, const RKEY * rkey, RKEY * pupper, BOOLEAN * phasupper)
 {
 	INDEX index;
-	BLOCK old, newb, xtra;
-	FKEY nfkey, last = 0, parent;
-	INT i, j, k, l, n, lo, hi;
-	BOOLEAN found = FALSE;
-	INT off = 0;
-	FILE *fo=NULL, *ft1=NULL, *ft2=NULL;
-	char scratch0[MAXPATHLEN], scratch1[MAXPATHLEN], scratch2[MAXPATHLEN];
-	char *p = rec;
+	FKEY nfkey, last = 0;
+	INT i, n;
 
-/* search for data block that does/should hold record */
-	ASSERT(bwrite(btree));
+	*phasupper = FALSE;
 	ASSERT(index = bmaster(btree));
 	while (ixtype(index) == BTINDEXTYPE) {
 
@@ -119,15 +168,40 @@ bt_addrecord (BTREE btree, RKEY rkey, RAWRECORD rec, INT len)
 		n = nkeys(index);
 		nfkey = fkeys(index, 0);
 		for (i = 1; i <= n; i++) {
-			if (cmpkeys(&rkey, &rkeys(index, i)) < 0)
+			if (cmpkeys(rkey, &rkeys(index, i)) < 0) {
+				*pupper = rkeys(index, i);
+				*phasupper = TRUE;
 				break;
+			}
 			nfkey = fkeys(index, i);
 		}
 		index = getindex(btree, nfkey);
 	}
-/* have block that may hold older version of record */
 	ixparent(index) = last;
-	old = (BLOCK) index;
+	return (BLOCK) index;
+}
+/*=================================
+ * add_one_record -- Add record to BTREE, rewriting its data block
+ *  btree:  [in] btree to add record to
+ *  rkey:   [in] key of record (eg, "     I67")
+ *  record: [in] record data to add
+ *  len:    [in] record length
+ *===============================*/
+static BOOLEAN
+add_one_record (BTREE btree, RKEY rkey, RAWRECORD rec, INT len)
+{
+	BLOCK old, newb, xtra;
+	FKEY nfkey, parent;
+	INT i, j, k, l, n, lo, hi;
+	BOOLEAN found = FALSE, hasupper;
+	INT off = 0;
+	FILE *fo=NULL, *ft1=NULL, *ft2=NULL;
+	char scratch0[MAXPATHLEN], scratch1[MAXPATHLEN], scratch2[MAXPATHLEN];
+	char *p = rec;
+	RKEY upper;
+
+/* have block that may hold older version of record */
+	old = find_write_block(btree, &rkey, &upper, &hasupper);
 	if (!(nkeys(old) < NORECS)) {
 		char msg[256];
 		sprintf(msg, "Corrupt block (rkey=%s): nkeys (%d) exceeds maximum (%d)"
@@ -326,6 +400,290 @@ splitting:
 	addkey(btree, parent, rkeys(xtra, 0), ixself(xtra));
 	return TRUE;
 }
+/*=================================
+ * bt_begin_batch -- Start queueing records added to BTREE
+ *  btree:  [in] btree about to receive many records
+ * Every bt_addrecord rewrites a whole data block, which dominates
+ * bulk loads such as import. Inside a batch, records are held in
+ * memory and written in key order by bt_flush_batch, so each data
+ * block is rewritten once for all the records landing in it.
+ * Lookups (bt_getrecord, isrecord) see the queued records, and
+ * traversals flush first. Caller must bt_end_batch before closing.
+ *===============================*/
+void
+bt_begin_batch (BTREE btree)
+{
+	struct tag_btbatch * batch;
+	ASSERT(bwrite(btree));
+	if (bbatch(btree)) return;
+	batch = (struct tag_btbatch *)stdalloc(sizeof(*batch));
+	batch->nslots = 1024;
+	batch->slots = (BTPEND *)stdalloc(batch->nslots * sizeof(BTPEND));
+	batch->count = 0;
+	batch->bytes = 0;
+	bbatch(btree) = batch;
+}
+/*=================================
+ * bt_end_batch -- Write queued records and stop batching
+ *  btree:  [in] btree
+ *===============================*/
+void
+bt_end_batch (BTREE btree)
+{
+	struct tag_btbatch * batch = bbatch(btree);
+	if (!batch) return;
+	bt_flush_batch(btree);
+	stdfree(batch->slots);
+	stdfree(batch);
+	bbatch(btree) = NULL;
+}
+/*=================================
+ * bt_flush_batch -- Write all queued records
+ *  btree:  [in] btree
+ * Records are sorted by key, and each run of records falling into
+ * one data block is merged into it with a single rewrite. A record
+ * that does not fit goes through the normal path, which splits the
+ * block, and the merge resumes at the new block.
+ *===============================*/
+void
+bt_flush_batch (BTREE btree)
+{
+	struct tag_btbatch * batch = bbatch(btree);
+	BTPEND * ents;
+	INT i=0, k, r, used;
+
+	if (!batch || !batch->count) return;
+	ents = (BTPEND *)stdalloc(batch->count * sizeof(ents[0]));
+	for (k = 0; k < batch->nslots; k++) {
+		if (batch->slots[k])
+			ents[i++] = batch->slots[k];
+	}
+	ASSERT(i == batch->count);
+	qsort(ents, batch->count, sizeof(ents[0]), cmp_pend);
+
+	for (k = 0; k < batch->count; k += used) {
+		RKEY upper;
+		BOOLEAN hasupper;
+		BLOCK old = find_write_block(btree, &ents[k]->rkey, &upper, &hasupper);
+		for (r = k; r < batch->count; r++) {
+			if (hasupper && cmpkeys(&ents[r]->rkey, &upper) >= 0)
+				break;
+		}
+		used = merge_into_block(btree, old, ents+k, r-k);
+		if (!used) {
+			add_one_record(btree, ents[k]->rkey, ents[k]->rec, ents[k]->len);
+			used = 1;
+		}
+	}
+
+	stdfree(ents);
+	clear_batch(batch);
+}
+/*=================================
+ * batch_record -- Queue record in open batch
+ *  btree:  [in] btree
+ *  rkey:   [in] key of record
+ *  rec:    [in] record data (copied)
+ *  len:    [in] record length
+ *===============================*/
+static BOOLEAN
+batch_record (BTREE btree, RKEY rkey, RAWRECORD rec, INT len)
+{
+	struct tag_btbatch * batch = bbatch(btree);
+	BTPEND pend, *slot;
+
+	pend = (BTPEND)stdalloc(sizeof(*pend));
+	pend->rkey = rkey;
+	pend->len = len;
+	if (len) {
+		pend->rec = (RAWRECORD)stdalloc(len+1);
+		memcpy(pend->rec, rec, len);
+		pend->rec[len] = 0;
+	}
+	slot = batch_slot(batch, &rkey);
+	if (*slot) {
+		/* replaces earlier version */
+		batch->bytes -= (*slot)->len;
+		free_pend(*slot);
+	} else {
+		++batch->count;
+	}
+	*slot = pend;
+	batch->bytes += len;
+	if (2 * batch->count > batch->nslots) {
+		/* rehash into table twice the size */
+		BTPEND *oldslots = batch->slots;
+		INT i, oldn = batch->nslots;
+		batch->nslots *= 2;
+		batch->slots = (BTPEND *)stdalloc(batch->nslots * sizeof(BTPEND));
+		for (i = 0; i < oldn; i++) {
+			if (oldslots[i])
+				*batch_slot(batch, &oldslots[i]->rkey) = oldslots[i];
+		}
+		stdfree(oldslots);
+	}
+	if (batch->count >= BATCH_MAXRECS || batch->bytes >= BATCH_MAXBYTES)
+		bt_flush_batch(btree);
+	return TRUE;
+}
+/*=================================
+ * get_pending -- Find queued record, if batching
+ *===============================*/
+static BTPEND
+get_pending (BTREE btree, const RKEY * rkey)
+{
+	if (!bbatch(btree) || !bbatch(btree)->count)
+		return NULL;
+	return *batch_slot(bbatch(btree), rkey);
+}
+/*=================================
+ * batch_slot -- Find slot that holds (or would hold) rkey
+ *===============================*/
+static BTPEND *
+batch_slot (struct tag_btbatch * batch, const RKEY * rkey)
+{
+	unsigned int hval = 2166136261u;
+	INT i;
+	BTPEND *slot;
+	for (i = 0; i < RKEYLEN; i++)
+		hval = (hval ^ (uchar)rkey->r_rkey[i]) * 16777619u;
+	i = hval & (batch->nslots - 1);
+	while ((slot = &batch->slots[i]) && *slot
+		&& memcmp((*slot)->rkey.r_rkey, rkey->r_rkey, RKEYLEN))
+		i = (i + 1) & (batch->nslots - 1);
+	return slot;
+}
+/*=================================
+ * clear_batch -- Free all queued records
+ *===============================*/
+static void
+clear_batch (struct tag_btbatch * batch)
+{
+	INT i;
+	for (i = 0; i < batch->nslots; i++) {
+		if (batch->slots[i]) {
+			free_pend(batch->slots[i]);
+			batch->slots[i] = NULL;
+		}
+	}
+	batch->count = 0;
+	batch->bytes = 0;
+}
+/*=================================
+ * free_pend -- Destructor for queued records
+ *===============================*/
+static void
+free_pend (BTPEND pend)
+{
+	if (pend->rec)
+		stdfree(pend->rec);
+	stdfree(pend);
+}
+/*=================================
+ * cmp_pend -- qsort comparator for queued records
+ *===============================*/
+static int
+cmp_pend (const void * el1, const void * el2)
+{
+	BTPEND pend1 = *(BTPEND *)el1, pend2 = *(BTPEND *)el2;
+	return cmpkeys(&pend1->rkey, &pend2->rkey);
+}
+/*=================================
+ * merge_into_block -- Merge sorted records into one data block
+ *  btree:  [in] btree
+ *  old:    [in] data block the records belong in
+ *  ents:   [in] records, in key order
+ *  cnt:    [in] number of records
+ * Returns number of records merged, as many as fit without a split
+ * (0 if the first is new and the block is full). Old records are
+ * copied in contiguous runs rather than one at a time.
+ *===============================*/
+static INT
+merge_into_block (BTREE btree, BLOCK old, BTPEND * ents, INT cnt)
+{
+	BLOCK newb;
+	INT n = nkeys(old), used = 0, added = 0;
+	INT i, j, s, off = 0;
+	INT src[NORECS]; /* >= 0 is old index, < 0 is -(ents index)-1 */
+	FILE *fo=NULL, *ft1=NULL;
+	char scratch0[MAXPATHLEN], scratch1[MAXPATHLEN];
+
+/* see how many records fit without a split */
+	for (i = j = 0; j < cnt; j++) {
+		while (i < n && cmpkeys(&rkeys(old, i), &ents[j]->rkey) < 0)
+			i++;
+		if (!(i < n && cmpkeys(&rkeys(old, i), &ents[j]->rkey) == 0)) {
+			if (n + added == NORECS - 1) break;
+			added++;
+		}
+		used = j + 1;
+	}
+	if (!used) return 0;
+
+/* construct header for updated data block */
+	newb = allocblock();
+	ixtype(newb) = ixtype(old);
+	ixparent(newb) = ixparent(old);
+	ixself(newb) = ixself(old);
+	for (i = j = s = 0; i < n || j < used; s++) {
+		INT rel = (j == used) ? -1 : (i == n) ? 1
+			: cmpkeys(&rkeys(old, i), &ents[j]->rkey);
+		if (rel < 0) {
+			rkeys(newb, s) = rkeys(old, i);
+			lens(newb, s) = lens(old, i);
+			src[s] = i++;
+		} else {
+			if (rel == 0) i++; /* replaced */
+			rkeys(newb, s) = ents[j]->rkey;
+			lens(newb, s) = ents[j]->len;
+			src[s] = -(j++) - 1;
+		}
+		offs(newb, s) = off;
+		off += lens(newb, s);
+	}
+	nkeys(newb) = s;
+
+/* open original and new */
+	sprintf(scratch0, "%s/%s", bbasedir(btree), fkey2path(ixself(old)));
+	if (!(fo = fopen(scratch0, LLREADBINARY LLFILERANDOM))) {
+		char msg[sizeof(scratch0)+64];
+		sprintf(msg, "Corrupt db -- failed to open blockfile: %s", scratch0);
+		FATAL2(msg);
+	}
+	sprintf(scratch1, "%s/tmp1", bbasedir(btree));
+	if (!(ft1 = fopen(scratch1, LLWRITEBINARY LLFILETEMP LLFILERANDOM))) {
+		char msg[sizeof(scratch1)+64];
+		sprintf(msg, "Corrupt db -- failed to open temp blockfile: %s", scratch1);
+		FATAL2(msg);
+	}
+	ASSERT(fwrite(newb, BUFLEN, 1, ft1) == 1);
+	putheader(btree, newb);
+
+/* write records in order, copying adjacent old ones together */
+	for (s = 0; s < nkeys(newb); ) {
+		if (src[s] < 0) {
+			BTPEND pend = ents[-src[s]-1];
+			if (pend->len)
+				CHECKED_fwrite(pend->rec, pend->len, 1, ft1, scratch1);
+			s++;
+		} else {
+			INT first = src[s], len = lens(old, first);
+			for (s++; s < nkeys(newb) && src[s] == src[s-1] + 1
+				&& offs(old, src[s]) == offs(old, src[s-1]) + lens(old, src[s-1]); s++)
+				len += lens(old, src[s]);
+			if (fseek(fo, (long)(offs(old, first) + BUFLEN), 0))
+				FATAL();
+			filecopy(fo, len, ft1);
+		}
+	}
+
+/* make changes permanent in database */
+	CHECKED_fclose(ft1, scratch1);
+	fclose(fo); /* was opened read-only */
+	stdfree(old);
+	movefiles(scratch1, scratch0);
+	return used;
+}
 /*======================================================
  * filecopy -- Copy record from one data file to another
  * Copy from source file (already opened) to destination
@@ -360,7 +718,9 @@ readrec (BTREE btree, BLOCK block, INT i, INT *plen)
 	FILE *fd=NULL;
 	RAWRECORD rawrec;
 	INT len;
+	TRACE_TIME tt;
 
+	TRACE_BEGIN(tt);
 	snprintf(scratch, sizeof(scratch)
 		, "%s%c%s"
 		, bbasedir(btree), LLCHRDIRSEPARATOR, fkey2path(ixself(block)));
@@ -379,6 +739,7 @@ readrec (BTREE btree, BLOCK block, INT i, INT *plen)
 	if ((len = lens(block, i)) == 0) {
 		*plen = 0;
 		fclose(fd); /* readonly */
+		TRACE_END(tt, "btree", "readrec", rkey2str(rkeys(block, i)));
 		return NULL;
 	}
 	if (len < 0) {
@@ -397,6 +758,7 @@ readrec (BTREE btree, BLOCK block, INT i, INT *plen)
 	fclose(fd); /* readonly */
 	rawrec[len] = 0;
 	*plen = len;
+	TRACE_END(tt, "btree", "readrec", rkey2str(rkeys(block, i)));
 	return rawrec;
 }
 /*===================================
@@ -415,11 +777,20 @@ bt_getrecord (BTREE btree, const RKEY * rkey, INT *plen)
 	BLOCK block;
 	BOOLEAN found = FALSE;
 	RAWRECORD rawrec;
+	BTPEND pend;
 
 #ifdef DEBUG
 	llwprintf("GETRECORD: rkey: %s\n", rkey2str(*rkey));
 #endif
 	*plen = 0;
+	if ((pend = get_pending(btree, rkey)) != NULL) {
+		if (!pend->len || !strcmp(pend->rec, "DELE\n"))
+			return NULL;
+		rawrec = (RAWRECORD) stdalloc(pend->len + 1);
+		memcpy(rawrec, pend->rec, pend->len + 1);
+		*plen = pend->len;
+		return rawrec;
+	}
 	ASSERT(index = bmaster(btree));
 
 /* search for data block that does/should hold record */
@@ -497,6 +868,9 @@ isrecord (BTREE btree,
 	FKEY nfkey;
 	BLOCK block;
 
+	if (get_pending(btree, &rkey))
+		return TRUE;
+
 /* search for data block that does/should hold record */
 	ASSERT(index = bmaster(btree));
 	while (ixtype(index) == BTINDEXTYPE) {
@@ -25,6 +25,9 @@ void putheader(BTREE, BLOCK);
 void putindex(BTREE, INDEX);
 void writeindex(BTREE, INDEX);
 
+/* traverse.c */
+BOOLEAN traverse_block_records(BTREE, BLOCK, TRAV_RECORD_FUNC_BYKEY func, void *param);
+
 /* utils.c */
 void newmaster(BTREE, INDEX);
 FKEY path2fkey(STRING);
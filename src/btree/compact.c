@@ -0,0 +1,284 @@
+/*===========================================================
+ * compact.c -- write a compacted copy of a btree
+ *  Records are streamed in key order out of the old btree
+ *  (DELE records are dropped) and packed into fresh data
+ *  blocks to a target fill factor; the index levels are then
+ *  rebuilt bottom up, so the copy has as few files and as
+ *  shallow an index as the fill factor allows.
+ *=========================================================*/
+
+#include <errno.h>
+#include "llstdlib.h"
+#include "btreei.h"
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* one child of an index level being built */
+typedef struct {
+	FKEY fkey;   /* child file */
+	RKEY rkey;   /* first key under child */
+} LEVELENT;
+
+typedef struct {
+	BTREE newbt;       /* btree being written */
+	BTCOMPACT *stats;
+	INT maxrecs;       /* records per data block */
+	INT maxkids;       /* children per index */
+	BLOCK block;       /* data block being filled */
+	STRING data;       /* data of records in block */
+	INT datalen;
+	INT datasize;
+	char kclass;       /* key class of block (see key_class) */
+	LEVELENT *level;   /* blocks written so far */
+	INT nlevel;
+	INT levelsize;
+} COMPACT_STATE;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static void add_level_entry(LEVELENT **plevel, INT *pn, INT *psize, FKEY fkey, RKEY rkey);
+static BOOLEAN compact_block(BTREE btree, BLOCK block, void * param);
+static BOOLEAN compact_record(RKEY rkey, STRING data, INT len, void * param);
+static BOOLEAN count_index(BTREE btree, INDEX index, void * param);
+static void fill_index(INDEX index, LEVELENT *ents, INT n);
+static void flush_block(COMPACT_STATE *cstate);
+static char key_class(RKEY rkey);
+
+/*********************************************
+ * local function definitions
+ * body of module
+ *********************************************/
+
+/*==============================================
+ * bt_compact -- Write compacted copy of btree
+ *  btree:   [IN]  btree to copy (may be opened read-only)
+ *  newdir:  [IN]  directory for the copy (must not hold a btree)
+ *  fill:    [IN]  target fill percentage of blocks & indexes
+ *  stats:   [OUT] counts of records & files (may be NULL)
+ *  lldberr: [OUT] error code if the copy cannot be created
+ * Data blocks never mix key classes (record types, names, refns,
+ * text index), so each class is stored contiguously.
+ * Only the btree itself is copied, not other files in its directory.
+ *============================================*/
+BOOLEAN
+bt_compact (BTREE btree, STRING newdir, INT fill, BTCOMPACT * stats, INT *lldberr)
+{
+	COMPACT_STATE cstate;
+	BTCOMPACT localstats;
+	INDEX master, index;
+	INT i, n, groups, depth=1;
+
+	if (!stats)
+		stats = &localstats;
+	memset(stats, 0, sizeof(*stats));
+	if (fill < 1) fill = 1;
+	if (fill > 100) fill = 100;
+
+	memset(&cstate, 0, sizeof(cstate));
+	if (!(cstate.newbt = bt_openbtree(newdir, TRUE, 2, FALSE, lldberr)))
+		return FALSE;
+	cstate.stats = stats;
+	cstate.maxrecs = (NORECS - 1) * fill / 100;
+	if (cstate.maxrecs < 1) cstate.maxrecs = 1;
+	cstate.maxkids = (NOENTS - 1) * fill / 100;
+	if (cstate.maxkids < 2) cstate.maxkids = 2;
+	cstate.block = allocblock();
+	/* first block reuses the empty block the new btree came with */
+	master = bmaster(cstate.newbt);
+	ixself(cstate.block) = fkeys(master, 0);
+
+	traverse_index_blocks(btree, bmaster(btree), &cstate, count_index, compact_block);
+	flush_block(&cstate);
+	if (!cstate.nlevel) {
+		/* empty btree: keep the block we were given */
+		add_level_entry(&cstate.level, &cstate.nlevel, &cstate.levelsize
+			, ixself(cstate.block), rkeys(cstate.block, 0));
+	}
+
+	/* build index levels until one fits in the master index */
+	while (cstate.nlevel > cstate.maxkids) {
+		LEVELENT *upper=NULL;
+		INT nupper=0, uppersize=0, start=0;
+		groups = (cstate.nlevel + cstate.maxkids - 1) / cstate.maxkids;
+		for (i = 0; i < groups; i++) {
+			/* spread children evenly over the indexes of this level */
+			n = (cstate.nlevel - start) / (groups - i);
+			index = crtindex(cstate.newbt);
+			fill_index(index, cstate.level + start, n);
+			writeindex(cstate.newbt, index);
+			add_level_entry(&upper, &nupper, &uppersize
+				, ixself(index), cstate.level[start].rkey);
+			stdfree(index);
+			++stats->c_newindexes;
+			start += n;
+		}
+		stdfree(cstate.level);
+		cstate.level = upper;
+		cstate.nlevel = nupper;
+		cstate.levelsize = uppersize;
+		++depth;
+	}
+	fill_index(master, cstate.level, cstate.nlevel);
+	writeindex(cstate.newbt, master);
+	++stats->c_newindexes;
+	stats->c_newdepth = depth;
+
+	stdfree(cstate.level);
+	stdfree(cstate.block);
+	stdfree(cstate.data);
+	closebtree(cstate.newbt);
+	return TRUE;
+}
+/*==============================================
+ * count_index -- Index callback counting old indexes
+ *============================================*/
+static BOOLEAN
+count_index (BTREE btree, INDEX index, void * param)
+{
+	COMPACT_STATE *cstate = (COMPACT_STATE *)param;
+	btree=btree; /* unused */
+	index=index; /* unused */
+	++cstate->stats->c_oldindexes;
+	return TRUE;
+}
+/*==============================================
+ * compact_block -- Block callback copying records of one old block
+ *============================================*/
+static BOOLEAN
+compact_block (BTREE btree, BLOCK block, void * param)
+{
+	COMPACT_STATE *cstate = (COMPACT_STATE *)param;
+	++cstate->stats->c_oldblocks;
+	return traverse_block_records(btree, block, compact_record, param);
+}
+/*==============================================
+ * compact_record -- Append one record to the block being filled
+ *============================================*/
+static BOOLEAN
+compact_record (RKEY rkey, STRING data, INT len, void * param)
+{
+	COMPACT_STATE *cstate = (COMPACT_STATE *)param;
+	BLOCK block = cstate->block;
+	char kclass = key_class(rkey);
+	INT n;
+
+	if (len == 5 && eqstrn(data, "DELE\n", 5)) {
+		++cstate->stats->c_deleted;
+		return TRUE;
+	}
+	if (nkeys(block) >= cstate->maxrecs
+		|| (nkeys(block) && kclass != cstate->kclass)) {
+		BLOCK next;
+		flush_block(cstate);
+		next = crtblock(cstate->newbt);
+		ixself(block) = ixself(next);
+		stdfree(next);
+	}
+	if (cstate->datalen + len > cstate->datasize) {
+		INT newsize = 2*cstate->datasize + len;
+		if (cstate->data)
+			cstate->data = (STRING)stdrealloc(cstate->data, newsize);
+		else
+			cstate->data = (STRING)stdalloc(newsize);
+		cstate->datasize = newsize;
+	}
+	n = nkeys(block);
+	rkeys(block, n) = rkey;
+	offs(block, n) = cstate->datalen;
+	lens(block, n) = len;
+	if (len)
+		memcpy(cstate->data + cstate->datalen, data, len);
+	cstate->datalen += len;
+	nkeys(block) = n + 1;
+	cstate->kclass = kclass;
+	++cstate->stats->c_records;
+	return TRUE;
+}
+/*==============================================
+ * flush_block -- Write out block being filled (if any)
+ *  and empty it for the next records
+ *============================================*/
+static void
+flush_block (COMPACT_STATE *cstate)
+{
+	BLOCK block = cstate->block;
+	char scratch[MAXPATHLEN];
+	FILE *fp=NULL;
+
+	if (!nkeys(block))
+		return;
+	snprintf(scratch, sizeof(scratch), "%s%c%s"
+		, bbasedir(cstate->newbt), LLCHRDIRSEPARATOR, fkey2path(ixself(block)));
+	if (!(fp = fopen(scratch, LLWRITEBINARY))) {
+		char msg[sizeof(scratch)+64];
+		sprintf(msg, "Failed (errno=%d) to create blockfile: %s", errno, scratch);
+		FATAL2(msg);
+	}
+	if (fwrite(block, BUFLEN, 1, fp) != 1
+		|| (cstate->datalen && fwrite(cstate->data, cstate->datalen, 1, fp) != 1)
+		|| fclose(fp) != 0) {
+		char msg[sizeof(scratch)+64];
+		sprintf(msg, "Write for %ld bytes failed for blockfile: %s"
+			, (long)(BUFLEN + cstate->datalen), scratch);
+		FATAL2(msg);
+	}
+	add_level_entry(&cstate->level, &cstate->nlevel, &cstate->levelsize
+		, ixself(block), rkeys(block, 0));
+	++cstate->stats->c_newblocks;
+	nkeys(block) = 0;
+	cstate->datalen = 0;
+}
+/*==============================================
+ * fill_index -- Point index at n children
+ *============================================*/
+static void
+fill_index (INDEX index, LEVELENT *ents, INT n)
+{
+	INT i;
+	ASSERT(n >= 1 && n < NOENTS);
+	nkeys(index) = n - 1;
+	fkeys(index, 0) = ents[0].fkey;
+	for (i = 1; i < n; i++) {
+		rkeys(index, i) = ents[i].rkey;
+		fkeys(index, i) = ents[i].fkey;
+	}
+}
+/*==============================================
+ * add_level_entry -- Append child to a level under construction
+ *============================================*/
+static void
+add_level_entry (LEVELENT **plevel, INT *pn, INT *psize, FKEY fkey, RKEY rkey)
+{
+	if (*pn == *psize) {
+		INT newsize = 2 * (*psize) + 64;
+		if (*plevel)
+			*plevel = (LEVELENT *)stdrealloc(*plevel, newsize * sizeof(LEVELENT));
+		else
+			*plevel = (LEVELENT *)stdalloc(newsize * sizeof(LEVELENT));
+		*psize = newsize;
+	}
+	(*plevel)[*pn].fkey = fkey;
+	(*plevel)[*pn].rkey = rkey;
+	++(*pn);
+}
+/*==============================================
+ * key_class -- Kind of key, for keeping blocks homogeneous
+ *  This is the first nonblank character, which is the
+ *  record type for records (eg, I for "     I12"), and
+ *  the index type for names, refns, and text index
+ *============================================*/
+static char
+key_class (RKEY rkey)
+{
+	INT i;
+	for (i = 0; i < 8; i++) {
+		if (rkey.r_rkey[i] != ' ')
+			return rkey.r_rkey[i];
+	}
+	return ' ';
+}
@@ -31,6 +31,7 @@
 
 #include "llstdlib.h"
 #include "btreei.h"
+#include "lltrace.h"
 
 static INT incache (BTREE, FKEY);
 static BOOLEAN cacheindex (BTREE, INDEX);
@@ -190,8 +191,11 @@ getindex (BTREE btree, FKEY fkey)
 	if (fkey == ixself(bmaster(btree))) return bmaster(btree);
 	if ((j = incache(btree, fkey)) == -1) {	/* not in cache */
 		BOOLEAN robust = FALSE; /* abort on error */
+		TRACE_TIME tt;
+		TRACE_BEGIN(tt); /* only reads from disk are traced */
 		index = readindex(btree, fkey, robust);
 		cacheindex(btree, index);
+		TRACE_END(tt, "btree", "getindex", fkey2path(fkey));
 		return index;
 	}
 	return (bcache(btree))[j];
@@ -29,6 +29,7 @@
  *=========================================================*/
 
 
+#include <errno.h>
 #include "llstdlib.h"
 #include "btreei.h"
 
@@ -37,6 +38,7 @@
  *********************************************/
 
 /* alphabetical */
+static BOOLEAN read_block_records(BTREE btree, BLOCK block, void * param);
 static BOOLEAN traverse_block(BTREE btree, BLOCK block, RKEY lo, RKEY hi, TRAV_RECORD_FUNC_BYKEY, void * param);
 static BOOLEAN traverse_index(BTREE btree, INDEX index, RKEY lo, RKEY hi, TRAV_RECORD_FUNC_BYKEY, void * param);
 
@@ -62,6 +64,11 @@ traverse_index_blocks (BTREE btree, INDEX index, void *param
 
 	if (index == NULL)
 		return FALSE;
+	if (index == bmaster(btree)) {
+		/* write queued records first (may replace master) */
+		bt_flush_batch(btree);
+		index = bmaster(btree);
+	}
 	if (ixtype(index) == BTINDEXTYPE) {
 		INT i, n;
 		if (ifunc != NULL && !(*ifunc)(btree, index, param))
@@ -177,7 +184,93 @@ void
 traverse_db_rec_rkeys (BTREE btree, RKEY lo, RKEY hi, TRAV_RECORD_FUNC_BYKEY func, void * param)
 {
 	INDEX index;
+	bt_flush_batch(btree);
 	ASSERT(index = bmaster(btree));
 	traverse_index(btree, index, lo, hi, func, param);
 }
+/*==============================================
+ * traverse_db_blocks -- traverse all records, a block at a time
+ *  Each data block file is read with one read (skipping the
+ *  index cache), and each record of the block is passed to
+ *  func in key order, zero terminated (NULL if empty).
+ * NB: This covers all records, including DELE records.
+ * callback may modify the data, but it won't be updated into db
+ *============================================*/
+typedef struct
+{
+	TRAV_RECORD_FUNC_BYKEY func;
+	void * param;
+} TRAV_BLOCKS_PARAM;
+void
+traverse_db_blocks (BTREE btree, TRAV_RECORD_FUNC_BYKEY func, void * param)
+{
+	TRAV_BLOCKS_PARAM tparam;
+	tparam.func = func;
+	tparam.param = param;
+	traverse_index_blocks(btree, bmaster(btree), &tparam, NULL, read_block_records);
+}
+/*==============================================
+ * read_block_records -- Block callback for traverse_db_blocks
+ *============================================*/
+static BOOLEAN
+read_block_records (BTREE btree, BLOCK block, void * param)
+{
+	TRAV_BLOCKS_PARAM *tparam = (TRAV_BLOCKS_PARAM *)param;
+	return traverse_block_records(btree, block, tparam->func, tparam->param);
+}
+/*==============================================
+ * traverse_block_records -- Read one data block file
+ *  and pass its records to func (see traverse_db_blocks)
+ *============================================*/
+BOOLEAN
+traverse_block_records (BTREE btree, BLOCK block, TRAV_RECORD_FUNC_BYKEY func, void * param)
+{
+	char scratch[MAXPATHLEN];
+	FILE *fd=NULL;
+	STRING buf, p;
+	INT i, len, end=0;
+	INT n = nkeys(block);
+	BOOLEAN keepgoing = TRUE;
+	char save;
 
+	for (i = 0; i < n; i++) {
+		if (lens(block, i) < 0 || offs(block, i) < 0) {
+			char msg[64];
+			sprintf(msg, "Bad len (%ld) for blockfile (rkey=%s)"
+				, (long)lens(block, i), rkey2str(rkeys(block, i)));
+			FATAL2(msg);
+		}
+		if (offs(block, i) + lens(block, i) > end)
+			end = offs(block, i) + lens(block, i);
+	}
+	buf = (STRING)stdalloc(end + 1);
+	if (end) {
+		snprintf(scratch, sizeof(scratch)
+			, "%s%c%s"
+			, bbasedir(btree), LLCHRDIRSEPARATOR, fkey2path(ixself(block)));
+		if (!(fd = fopen(scratch, LLREADBINARY))) {
+			char msg[sizeof(scratch)+64];
+			sprintf(msg, _("Failed (errno=%d) to open blockfile (rkey=%s): %s")
+				, errno, rkey2str(rkeys(block, 0)), scratch);
+			FATAL2(msg);
+		}
+		if (fseek(fd, (long)BUFLEN, 0) || fread(buf, end, 1, fd) != 1) {
+			char msg[sizeof(scratch)+64];
+			sprintf(msg, "Read for %ld bytes failed for blockfile: %s"
+				, (long)end, scratch);
+			FATAL2(msg);
+		}
+		fclose(fd); /* readonly */
+	}
+	for (i = 0; i < n && keepgoing; i++) {
+		len = lens(block, i);
+		p = buf + offs(block, i);
+		/* terminate record in place, borrowing next byte */
+		save = p[len];
+		p[len] = 0;
+		keepgoing = (*func)(rkeys(block, i), len ? p : NULL, len, param);
+		p[len] = save;
+	}
+	stdfree(buf);
+	return keepgoing;
+}
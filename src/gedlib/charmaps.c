@@ -45,34 +45,29 @@ extern STRING qSbaddec,qSbadhex,qSnorplc,qSbadesc,qSnoorig,qSmaperr;
  * local types
  *********************************************/
 
-/* nodes that make up the tree that is a custom character translation table */
-/* MTE: Notes 12/24/2015
- * achar is defined as an INT16 here.
- * However, it is assigned from an INT parameter in create_xnode and step_xnode;
- * Compared with INT and uchar in translate_match;
- * Displayed as a uchar in show_xnode.
- * This needs to be cleaned up to be more consistent, possibly with different APIs
- * for translations between ASCII (8-bit) and  UTF-8, UTF-16 or Unicode encodings.
- */
-typedef struct tag_xnode *XNODE;
-struct tag_xnode {
-	XNODE parent;	/* parent node */
-	XNODE sibling;	/* next sib node */
-	XNODE child;	/* first child node */
-	INT16 achar;	/* my character */
-	INT16 count;	/* translation length */
-	STRING replace;	/* translation string */
-};
-
-/* root of a custom character translation table */
+/*
+ A custom character translation table is compiled into a byte-indexed
+ DFA: each state is a prefix of one or more patterns. State 0 is the
+ empty prefix; a state that has been extended by some pattern owns a
+ row of 256 transitions (0 meaning no pattern continues with that
+ byte). A state that completes a pattern has the offset of its
+ replacement in the string pool.
+*/
 struct tag_trantable {
-	XNODE start[256];
+	INT *trans;     /* 256 transitions per row */
+	INT *rowof;     /* row of each state, or -1 if none */
+	INT *repl;      /* pool offset of state's replacement, or -1 */
+	STRING pool;    /* replacement strings, each zero-terminated */
+	INT nstates;
+	INT nrows;
+	INT maxstates;
+	INT maxrows;
+	INT poollen;
+	INT poolmax;
 	char name[20];
 	INT total;
 };
 
-
-
 /*********************************************
  * local enums & defines
  *********************************************/
@@ -83,15 +78,14 @@ struct tag_trantable {
  *********************************************/
 
 /* alphabetical */
-static XNODE create_xnode(XNODE, INT, STRING);
+static INT add_pool_string(TRANTABLE tt, CNSTRING str);
+static INT add_state(TRANTABLE tt);
 static BOOLEAN init_map_from_str(STRING str, CNSTRING mapname, TRANTABLE * ptt, ZSTR zerr);
 static void maperror(CNSTRING errmsg);
-static void remove_xnodes(XNODE);
 #ifdef DEBUG
-static void show_xnode(XNODE node);
-static void show_xnodes(INT indent, XNODE node);
+static void show_states(INT indent, TRANTABLE tt, INT state);
 #endif
-static XNODE step_xnode(XNODE, INT);
+static INT step_state(TRANTABLE tt, INT state, INT achar);
 static INT translate_match(TRANTABLE tt, CNSTRING in, CNSTRING * out);
 
 /*********************************************
@@ -117,13 +111,12 @@ create_trantable (STRING *lefts, STRING *rights, INT n, STRING name)
 {
 	TRANTABLE tt = (TRANTABLE) stdalloc(sizeof(*tt));
 	STRING left, right;
-	INT i, c;
-	XNODE node;
+	INT i, state;
+	memset(tt, 0, sizeof(*tt));
 	tt->name[0] = 0;
 	tt->total = n;
 	llstrncpy(tt->name, name, sizeof(tt->name), uu8);
-	for (i = 0; i < 256; i++)
-		tt->start[i] = NULL;
+	add_state(tt); /* state 0, the empty prefix */
 	/* if empty, n==0, this is valid */
 	for (i = 0; i < n; i++) {
 		left = lefts[i];
@@ -131,53 +124,68 @@ create_trantable (STRING *lefts, STRING *rights, INT n, STRING name)
 		ASSERT(left);
 		ASSERT(right);
 		ASSERT(*left);
-		c = (uchar) *left++;
-		if (tt->start[c] == NULL)
-			tt->start[c] = create_xnode(NULL, c, NULL);
-		node = tt->start[c];
-		while ((c = (uchar) *left++)) {
-			node = step_xnode(node, c);
-		}
-		node->count = strlen(right);
-		node->replace = right;
+		state = 0;
+		while (*left)
+			state = step_state(tt, state, (uchar) *left++);
+		tt->repl[state] = add_pool_string(tt, right);
+		stdfree(right);
 	}
 	return tt;
 }
 /*=============================
- * create_xnode -- Create XNODE
- *  parent:  [in] parent of node to be created
- *  achar:   [in] start substring represented by this node
- *  string:  [in] replacement string for matches
+ * add_state -- Add state (with no row and no replacement)
+ *  returns number of new state
  *===========================*/
-static XNODE
-create_xnode (XNODE parent, INT achar, STRING string)
+static INT
+add_state (TRANTABLE tt)
 {
-	XNODE node = (XNODE) stdalloc(sizeof(*node));
-	node->parent = parent;
-	node->sibling = NULL;
-	node->child = NULL;
-	node->achar = achar;
-	node->replace = string;
-	node->count = string ? strlen(string) : 0;
-	return node;
+	if (tt->nstates == tt->maxstates) {
+		tt->maxstates = tt->maxstates ? 2*tt->maxstates : 64;
+		tt->rowof = (INT *)stdrealloc(tt->rowof, tt->maxstates*sizeof(INT));
+		tt->repl = (INT *)stdrealloc(tt->repl, tt->maxstates*sizeof(INT));
+	}
+	tt->rowof[tt->nstates] = -1;
+	tt->repl[tt->nstates] = -1;
+	return tt->nstates++;
 }
 /*==========================================
- * step_xnode -- Step to node from character
+ * step_state -- Step to state from character, adding it if new
  *========================================*/
-static XNODE
-step_xnode (XNODE node, INT achar)
+static INT
+step_state (TRANTABLE tt, INT state, INT achar)
 {
-	XNODE prev, node0 = node;
-	if (node->child == NULL)
-		return node->child = create_xnode(node0, achar, NULL);
-	prev = NULL;
-	node = node->child;
-	while (node) {
-		if (node->achar == achar) return node;
-		prev = node;
-		node = node->sibling;
+	INT next, row = tt->rowof[state];
+	if (row < 0) {
+		if (tt->nrows == tt->maxrows) {
+			tt->maxrows = tt->maxrows ? 2*tt->maxrows : 16;
+			tt->trans = (INT *)stdrealloc(tt->trans, tt->maxrows*256*sizeof(INT));
+		}
+		row = tt->rowof[state] = tt->nrows++;
+		memset(tt->trans + row*256, 0, 256*sizeof(INT));
 	}
-	return prev->sibling = create_xnode(node0, achar, NULL);
+	if ((next = tt->trans[row*256 + achar]))
+		return next;
+	next = add_state(tt);
+	tt->trans[tt->rowof[state]*256 + achar] = next;
+	return next;
+}
+/*==========================================
+ * add_pool_string -- Copy replacement string into pool
+ *  returns its offset
+ *========================================*/
+static INT
+add_pool_string (TRANTABLE tt, CNSTRING str)
+{
+	INT len = strlen(str), off = tt->poollen;
+	if (tt->poollen + len + 1 > tt->poolmax) {
+		tt->poolmax = tt->poolmax ? 2*tt->poolmax : 1024;
+		while (tt->poollen + len + 1 > tt->poolmax)
+			tt->poolmax *= 2;
+		tt->pool = (STRING)stdrealloc(tt->pool, tt->poolmax);
+	}
+	memcpy(tt->pool + off, str, len+1);
+	tt->poollen += len+1;
+	return off;
 }
 /*=============================================
  * remove_trantable -- Remove translation table
@@ -185,30 +193,20 @@ step_xnode (XNODE node, INT achar)
 void
 remove_trantable (TRANTABLE tt)
 {
-	INT i;
 	if (!tt) return;
-	for (i = 0; i < 256; i++)
-		remove_xnodes(tt->start[i]);
+	if (tt->trans) stdfree(tt->trans);
+	if (tt->rowof) stdfree(tt->rowof);
+	if (tt->repl) stdfree(tt->repl);
+	if (tt->pool) stdfree(tt->pool);
 	stdfree(tt);
 }
-/*====================================
- * remove_xnodes -- Remove xnodes tree
- *==================================*/
-static void
-remove_xnodes (XNODE node)
-{
-	if (!node) return;
-	remove_xnodes(node->child);
-	remove_xnodes(node->sibling);
-	if (node->replace) stdfree(node->replace);
-	stdfree(node);
-}
 /*===================================================
  * translate_match -- Find match for current point in string
  *  tt:    [in] tran table
  *  in:    [in] in string
  *  match: [out] match string
  * returns length of input matched
+ * The longest pattern that matches wins
  * match string output points directly into trans table
  * memory, so it is longer-lived than a static buffer
  * Created: 2001/07/21 (Perry Rapp)
@@ -216,48 +214,23 @@ remove_xnodes (XNODE node)
 static INT
 translate_match (TRANTABLE tt, CNSTRING in, CNSTRING * out)
 {
-	XNODE node, chnode;
-	INT nxtch;
-	CNSTRING q = in;
-	node = tt->start[(uchar)*in];
-	if (!node) {
-		*out = "";
-		return 0;
-	}
-	q = in+1;
-/* Match as far as possible */
-	while (*q && node->child) {
-		nxtch = (uchar)*q;
-		chnode = node->child;
-		while (chnode && chnode->achar != nxtch)
-			chnode = chnode->sibling;
-		if (!chnode) break;
-		node = chnode;
-		q++;
-	}
-	while (TRUE) {
-		if (node->replace) {
-			/* replacing match */
-			*out = node->replace;
-			return q - in;
+	const uchar * q = (const uchar *)in;
+	INT state = 0, row, matchlen = 0, matchrepl = -1;
+	/* walk as far as possible, remembering the last full match */
+	while (*q && (row = tt->rowof[state]) >= 0
+		&& (state = tt->trans[row*256 + *q])) {
+		++q;
+		if (tt->repl[state] >= 0) {
+			matchrepl = tt->repl[state];
+			matchlen = q - (const uchar *)in;
 		}
-		/* no replacement, only partial match,
-		climb back & keep looking - we might have gone past
-		a shorter but full (replacing) match */
-		if (node->parent) {
-			node = node->parent;
-			--q;
-			continue;
-		}
-		/*
-		no replacement matches
-		(climbed all the way back to start
-		*/
-		ASSERT(q == in+1);
+	}
+	if (matchrepl < 0) {
 		*out = "";
 		return 0;
 	}
-	return 0;
+	*out = tt->pool + matchrepl;
+	return matchlen;
 }
 /*===================================================
  * init_map_from_rec -- Init single translation table
@@ -596,48 +569,32 @@ maperror (CNSTRING errmsg)
 void
 show_trantable (TRANTABLE tt)
 {
-	INT i;
-	XNODE node;
 	if (tt == NULL) {
 		llwprintf("EMPTY TABLE\n");
 		return;
 	}
-	for (i = 0; i < 256; i++) {
-		node = tt->start[i];
-		if (node) {
-			show_xnodes(0, node);
-		}
-	}
+	show_states(0, tt, 0);
 }
-
 /*===============================================
- * show_xnodes -- DEBUG routine that shows XNODEs
+ * show_states -- DEBUG routine that shows the states
+ *  reached from one state
  *=============================================*/
 static void
-show_xnodes (INT indent, XNODE node)
+show_states (INT indent, TRANTABLE tt, INT state)
 {
-	INT i;
-	if (!node) return;
-	for (i = 0; i < indent; i++)
-		llwprintf("  ");
-	show_xnode(node);
-	show_xnodes(indent+1, node->child);
-	show_xnodes(indent,   node->sibling);
-}
-/*================================================
- * show_xnode -- DEBUG routine that shows 1 XNODE
- *==============================================*/
-static void
-show_xnode (XNODE node)
-{
-	llwprintf("%d(%c)", node->achar, node->achar);
-	if (node->replace) {
-		if (node->count)
-			llwprintf(" \"%s\"\n", node->replace);
+	INT i, c, next, row = tt->rowof[state];
+	if (row < 0) return;
+	for (c = 0; c < 256; c++) {
+		if (!(next = tt->trans[row*256 + c])) continue;
+		for (i = 0; i < indent; i++)
+			llwprintf("  ");
+		llwprintf("%d(%c)", c, c);
+		if (tt->repl[next] >= 0)
+			llwprintf(" \"%s\"\n", tt->pool + tt->repl[next]);
 		else
-			llwprintf(" \"\"\n");
-	} else
-		llwprintf("\n");
+			llwprintf("\n");
+		show_states(indent+1, tt, next);
+	}
 }
 #endif /* DEBUG */
 
@@ -649,7 +606,15 @@ show_xnode (XNODE node)
 void
 custom_translatez (ZSTR zstr, TRANTABLE tt)
 {
-	ZSTR zout = custom_translate(zs_str(zstr), tt);
+	ZSTR zout;
+	CNSTRING p = zs_str(zstr);
+	INT row = tt->rowof[0];
+	/* nothing to do unless some pattern starts in the string */
+	if (row < 0) return;
+	while (*p && !tt->trans[row*256 + (uchar)*p])
+		++p;
+	if (!*p) return;
+	zout = custom_translate(zs_str(zstr), tt);
 	zs_setz(zstr, zout);
 	zs_free(&zout);
 }
@@ -658,15 +623,28 @@ custom_translatez (ZSTR zstr, TRANTABLE tt)
  *  str:  [IN]  string to be translated
  *  tt:   [IN]  custom translation table
  * returns translated string
+ * Runs of bytes that begin no pattern are copied in one step
  *=================================================*/
 ZSTR
 custom_translate (CNSTRING str, TRANTABLE tt)
 {
 	ZSTR zout = zs_newn((unsigned int)(strlen(str)*1.3+2));
+	const INT * first = tt->rowof[0] >= 0 ? tt->trans + tt->rowof[0]*256 : NULL;
 	CNSTRING p = str;
 	while (*p) {
-		CNSTRING tmp;
-		INT len = translate_match(tt, p, &tmp);
+		CNSTRING tmp, run = p;
+		INT len;
+		if (first) {
+			while (*p && !first[(uchar)*p])
+				++p;
+		} else {
+			p += strlen(p);
+		}
+		if (p > run)
+			zs_appsn(zout, run, p - run);
+		if (!*p)
+			break;
+		len = translate_match(tt, p, &tmp);
 		if (len) {
 			p += len;
 			zs_apps(zout, tmp);
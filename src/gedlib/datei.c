@@ -63,6 +63,7 @@ extern STRING qSmon_fr12A,qSmon_fr12B,qSmon_fr13A,qSmon_fr13B;
 
 /* alphabetical */
 static void init_keywordtbl(void);
+static INT keyword_hash(CNSTRING word, INT len);
 static void load_lang(void);
 static STRING lower_dup(STRING s);
 static STRING title_dup(STRING s);
@@ -181,7 +182,12 @@ struct gedcom_keywords_s gedkeys[] = {
 };
 
 
-TABLE keywordtbl = NULL;
+/* gedkeys by keyword_hash, for date_keyword (open addressing) */
+#define KEYHASH_SIZE 256
+#define KEYWORD_MAXLEN 15
+static struct gedcom_keywords_s * keyhash[KEYHASH_SIZE];
+static BOOLEAN keyhash_built = FALSE;
+
 BOOLEAN lang_changed=FALSE;
 
 
@@ -191,7 +197,7 @@ BOOLEAN lang_changed=FALSE;
 void
 initialize_if_needed (void)
 {
-	if (!keywordtbl) {
+	if (!keyhash_built) {
 		init_keywordtbl();
 		load_lang();
 	} else if (lang_changed) {
@@ -202,17 +208,73 @@ initialize_if_needed (void)
 /*=========================================
  * init_keywordtbl -- Set up table of known
  *  keywords which we recognize in parsing dates
+ * The keywords are fixed, so this is only done once.
  *=======================================*/
 static void
 init_keywordtbl (void)
 {
-	INT i, j;
-	keywordtbl = create_table_int();
+	INT i, h, len;
 	/* Load GEDCOM keywords & values into keyword table */
 	for (i=0; i<ARRSIZE(gedkeys); ++i) {
-		j = gedkeys[i].value;
-		insert_table_int(keywordtbl, gedkeys[i].keyword, j);
+		len = strlen(gedkeys[i].keyword);
+		ASSERT(len <= KEYWORD_MAXLEN);
+		h = keyword_hash(gedkeys[i].keyword, len);
+		while (keyhash[h]) {
+			/* first entry wins (eg, MAY) */
+			if (eqstr(keyhash[h]->keyword, gedkeys[i].keyword))
+				break;
+			h = (h+1) & (KEYHASH_SIZE-1);
+		}
+		if (!keyhash[h])
+			keyhash[h] = &gedkeys[i];
+	}
+	keyhash_built = TRUE;
+}
+/*=========================================
+ * keyword_hash -- Hash of keyword, ignoring
+ *  case of ASCII letters
+ *=======================================*/
+static INT
+keyword_hash (CNSTRING word, INT len)
+{
+	unsigned int h = 0;
+	INT i, c;
+	for (i=0; i<len; ++i) {
+		c = (uchar)word[i];
+		if (c>='a' && c<='z')
+			c += 'A' - 'a';
+		h = h*31 + c;
 	}
+	return (INT)(h & (KEYHASH_SIZE-1));
+}
+/*=========================================
+ * date_keyword -- Look up word in date
+ *  word: [IN]  start of word (need not be terminated)
+ *  len:  [IN]  length of word
+ * ASCII letters match either case, as GEDCOM keywords.
+ * returns value of keyword (see gedkeys), or 0 if unknown
+ *=======================================*/
+INT
+date_keyword (CNSTRING word, INT len)
+{
+	INT h, i;
+	struct gedcom_keywords_s * key;
+	if (len > KEYWORD_MAXLEN)
+		return 0;
+	for (h = keyword_hash(word, len); (key = keyhash[h]) != NULL
+		; h = (h+1) & (KEYHASH_SIZE-1)) {
+		CNSTRING kw = key->keyword;
+		for (i=0; i<len; ++i) {
+			INT c = (uchar)word[i];
+			if (c>='a' && c<='z')
+				c += 'A' - 'a';
+			if (c != (uchar)kw[i])
+				break;
+		}
+		if (i == len && !kw[len])
+			return key->value;
+	}
+	return 0;
 }
 /*=============================
  * load_one_cmplx_pic -- Generate case variations
@@ -416,10 +478,7 @@ void
 term_date (void)
 {
 	clear_lang();
-	if (keywordtbl) {
-		destroy_table(keywordtbl);
-		keywordtbl = 0;
-	}
+	clear_date_memo();
 }
 /*=============================
  * upper_dup -- Get uppercase & strdup it
@@ -18,6 +18,7 @@ struct tag_gdateval {
 	INT subtype;
 	INT valid; /* -1=bad syntax, 0=freeform, 1=perfect GEDCOM date */
 	STRING text; /* copy of original */
+	INT refs; /* holders (see extract_date & free_gdateval) */
 };
 /* typedef struct tag_gdateval *GDATEVAL; */ /* in date.h */
 
@@ -77,10 +78,11 @@ struct gedcom_keywords_s {
 extern struct gedcom_keywords_s gedkeys[];
 
 
-extern TABLE keywordtbl;
 extern BOOLEAN lang_changed;
 
 
+void clear_date_memo(void);
+INT date_keyword(CNSTRING word, INT len);
 void initialize_if_needed(void);
 
 
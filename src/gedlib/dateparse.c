@@ -50,6 +50,16 @@ enum { MONTH_TOK=1, CHAR_TOK, WORD_TOK, ICONS_TOK, CALENDAR_TOK, YEAR_TOK };
 /* used in parsing dates -- 1st, 2nd, & 3rd numbers found */
 struct tag_nums { struct tag_dnum num1; struct tag_dnum num2; struct tag_dnum num3; };
 
+/* position of get_date_tok in string being parsed */
+struct tag_datelex {
+	CNSTRING start;    /* string being parsed */
+	CNSTRING pos;      /* next char to scan (NULL at end) */
+	char scratch[90];  /* copy of current token */
+};
+
+/* memo of dates parsed, by hash of text (see extract_date) */
+#define DATE_MEMO_SIZE 16384
+
 /*********************************************
  * local function prototypes
  *********************************************/
@@ -62,19 +72,20 @@ static void assign_dnum(struct tag_dnum * dest, struct tag_dnum * src);
 static void clear_dnum(struct tag_dnum * dnum);
 static void clear_numbers(struct tag_nums * nums);
 static void free_gdate(struct tag_gdate *);
-static INT get_date_tok(struct tag_dnum*);
+static INT get_date_tok(struct tag_datelex * lex, struct tag_dnum*);
 static BOOLEAN is_date_delim(char c);
 static BOOLEAN is_valid_day(struct tag_gdate * pdate, struct tag_dnum day);
 static BOOLEAN is_valid_month(struct tag_gdate * pdate, struct tag_dnum month);
 static void mark_freeform(GDATEVAL gdv);
 static void mark_invalid(GDATEVAL gdv);
-static void set_date_string(STRING);
+static INT memo_hash(CNSTRING str);
+static GDATEVAL parse_date(STRING str);
 
 /*********************************************
  * local types & variables
  *********************************************/
 
-static STRING sstr, sstr_start;
+static GDATEVAL date_memo[DATE_MEMO_SIZE];
 
 /*********************************************
  * local & exported function definitions
@@ -104,10 +115,63 @@ mark_freeform (GDATEVAL gdv)
 /*=====================================================
  * extract_date -- Extract date from free format string
  *  str:  [IN]  date to parse
- * returns new date_val
+ * The same few date strings are parsed again and again (by
+ * year, date2jd, date formatting, etc), so recent results are
+ * kept in a memo, and a date found there is shared rather than
+ * parsed again. As parsing depends on nothing but the string,
+ * the memo never goes stale.
+ * returns date_val, which caller must free_gdateval (and must
+ *  not change, as it may be shared)
  *===================================================*/
 GDATEVAL
 extract_date (STRING str)
+{
+	GDATEVAL gdv;
+	INT h;
+	if (!str || !str[0])
+		return parse_date(str);
+	h = memo_hash(str);
+	gdv = date_memo[h];
+	if (!gdv || !eqstr(gdv->text, str)) {
+		free_gdateval(gdv);
+		gdv = date_memo[h] = parse_date(str);
+	}
+	++gdv->refs;
+	return gdv;
+}
+/*=====================================================
+ * memo_hash -- Slot of date string in date_memo
+ *  (FNV-1a hash)
+ *===================================================*/
+static INT
+memo_hash (CNSTRING str)
+{
+	unsigned int h = 2166136261u;
+	for ( ; *str; ++str) {
+		h ^= (uchar)*str;
+		h *= 16777619u;
+	}
+	return (INT)(h & (DATE_MEMO_SIZE-1));
+}
+/*=====================================================
+ * clear_date_memo -- Free all dates kept in memo
+ *  (dates still held by callers are freed when they let go)
+ *===================================================*/
+void
+clear_date_memo (void)
+{
+	INT i;
+	for (i=0; i<DATE_MEMO_SIZE; ++i) {
+		free_gdateval(date_memo[i]);
+		date_memo[i] = 0;
+	}
+}
+/*=====================================================
+ * parse_date -- Parse free format string into new date_val
+ *  str:  [IN]  date to parse
+ *===================================================*/
+static GDATEVAL
+parse_date (STRING str)
 {
 	/* we accumulate numbers to figure when we finish a
 	date (with a full period or range, we may finish the
@@ -115,6 +179,7 @@ extract_date (STRING str)
 	INT tok;
 	struct tag_dnum dnum = {BAD_YEAR, 0, 0};
 	struct tag_nums nums = { {BAD_YEAR, 0, 0}, {BAD_YEAR, 0, 0}, {BAD_YEAR, 0, 0} };
+	struct tag_datelex lex;
 	GDATEVAL gdv = create_gdateval();
 	struct tag_gdate * pdate = &gdv->date1;
 	if (!str || !str[0])
@@ -123,8 +188,12 @@ extract_date (STRING str)
 	if (str[0] == '(' && str[strlen(str)-1] == ')') {
 		gdv->valid = GDV_V_PHRASE;
 	}
-	set_date_string(str);
-	while ((tok = get_date_tok(&dnum))) {
+	initialize_if_needed();
+	lex.start = lex.pos = str;
+	/* longer strings are not parsed (as they cannot be dates) */
+	if (strlen(str) > sizeof(lex.scratch)-1)
+		lex.pos = NULL;
+	while ((tok = get_date_tok(&lex, &dnum))) {
 		switch (tok) {
 		case MONTH_TOK:
 			if (!pdate->month.val) {
@@ -496,6 +565,7 @@ create_gdateval (void)
 	gdv->date1.year.val = BAD_YEAR;
 	gdv->date2.year.val = BAD_YEAR;
 	gdv->valid = GDV_V_GOOD;
+	gdv->refs = 1;
 	return gdv;
 
 }
@@ -511,99 +581,94 @@ free_gdate (struct tag_gdate * gdate)
 	clear_dnum(&gdate->day);
 }
 /*===============================================
- * free_gdateval -- Delete existing GEDCOM date_val
+ * free_gdateval -- Release GEDCOM date_val
+ *  (deleted once no one holds it)
  * Created: 2001/12/28 (Perry Rapp)
  *=============================================*/
 void
 free_gdateval (GDATEVAL gdv)
 {
 	if (!gdv) return;
+	if (--gdv->refs > 0) return;
 	free_gdate(&gdv->date1);
 	free_gdate(&gdv->date2);
 	if (gdv->text)
 		stdfree(gdv->text);
 	stdfree(gdv);
 }
-/*===============================================
- * set_date_string -- Store date extraction string
- *  in static buffer for use during subsequent parsing
- *=============================================*/
-static void
-set_date_string (STRING str)
-{
-	sstr = str;
-	sstr_start = str;
-	initialize_if_needed();
-}
 /*==================================================
  * get_date_tok -- Return next date extraction token
+ *  lex:     [I/O]  position in string being parsed
  *  pdnum:   [OUT]  numeric value of token, if day/year number
  *                  or numeric value of month or calendar or keyword
- *  psval:   [OUT]  pointer to (static) copy of original text
- *                   (only used for slash years)
+ *                  (with new copy of text for compound years)
  *================================================*/
 static INT
-get_date_tok (struct tag_dnum *pdnum)
+get_date_tok (struct tag_datelex * lex, struct tag_dnum *pdnum)
 {
-	static char scratch[90];
-	STRING p = scratch;
-	INT c;
+	STRING p = lex->scratch;
+	CNSTRING sstr = lex->pos;
+	INT c, tok;
 	/* flag if token preceded by whitespace (or at start of buffer) */
 	BOOLEAN white_before = FALSE;
 	if (!sstr) return 0;
-	if (strlen(sstr) > sizeof(scratch)-1) return 0;
-	while (iswhite((uchar)*sstr++))
-		;
-	sstr--;
-	white_before = (sstr==sstr_start || iswhite((uchar)sstr[-1]));
+	while (iswhite((uchar)*sstr))
+		++sstr;
+	white_before = (sstr==lex->start || iswhite((uchar)sstr[-1]));
 	if (sstr[0]=='@' && sstr[1]=='#' && sstr[2]=='D') {
+		CNSTRING word = sstr;
 		INT i;
-		/* collect calendar escape to closing @ (or end of string) */
+		/* find calendar escape to closing @ (or end of string) */
 		do {
-			*p++ = *sstr++;
+			++sstr;
 		} while (sstr[0] && sstr[0]!='@');
 		if (*sstr != '@') {
-			return CHAR_TOK;
-		} else {
-			*p++ = *sstr++; /* consume the '@' */
-			*p = 0;
+			tok = CHAR_TOK;
+			goto done;
 		}
-		/* look it up in our big table of GEDCOM keywords */
-		i = valueof_int(keywordtbl, upperascii_s(scratch));
+		++sstr; /* consume the '@' */
+		/* look it up in our table of GEDCOM keywords */
+		i = date_keyword(word, sstr - word);
 		if (i >= 2001 && i < 2000 + GDV_CALENDARS_IX) {
 			pdnum->val = i - 2000;
-			return CALENDAR_TOK;
+			tok = CALENDAR_TOK;
+		} else {
+			/* unrecognized word */
+			tok = CHAR_TOK;
 		}
-		/* unrecognized word */
-		return CHAR_TOK;
+		goto done;
 	}
 	if (isletter((uchar)*sstr)) {
+		CNSTRING word = sstr;
 		INT i;
-		/* collect all letters (to end or whitespace or closeparen) */
+		/* find end of letters (end or whitespace or closeparen) */
 		do {
-			*p++ = *sstr++;
+			++sstr;
 		} while (sstr[0] && sstr[0]!=')' && !iswhite((uchar)sstr[0]));
-		*p = 0;
-		/* look it up in our big table of GEDCOM keywords */
-		i = valueof_int(keywordtbl, upperascii_s(scratch));
+		/* look it up in our table of GEDCOM keywords */
+		i = date_keyword(word, sstr - word);
 		if (!i) {
 			/* unrecognized word */
-			return CHAR_TOK;
+			tok = CHAR_TOK;
+			goto done;
 		}
 		if (i > 0 && i <= 999) {
 			pdnum->val = i % 100;
 			/* TODO: we need to use the fact that calendar is i/100 */
 			/* That is, now we know what calendar this is in */
 			/* Except Gregorian & Julian are not distinguished by month names */
-			return MONTH_TOK;
+			tok = MONTH_TOK;
+			goto done;
 		}
 		pdnum->val = 0;
 		if (i >= 1001 && i < 1000 + GD_END2) {
 			pdnum->val = i - 1000;
-			return WORD_TOK;
+			tok = WORD_TOK;
+			goto done;
 		}
-		FATAL(); /* something unexpected is in the keywordtbl ? Find out what! */
-		return WORD_TOK;
+		FATAL(); /* something unexpected is in the keyword table ? Find out what! */
+		tok = WORD_TOK;
+		goto done;
 	}
 	if (chartype((uchar)*sstr) == DIGIT) {
 		INT i=0; /* primary numeric value */
@@ -612,7 +677,8 @@ get_date_tok (struct tag_dnum *pdnum)
 			i = i*10 + c - '0';
 		if (i > 9999) {
 			/* 5+ digit numbers are not recognized */
-			return CHAR_TOK;
+			tok = CHAR_TOK;
+			goto done;
 		}
 		/* c is the char after the last digit,
 		and sstr is the next char after that */
@@ -620,7 +686,8 @@ get_date_tok (struct tag_dnum *pdnum)
 		if ((c=='/' || c=='-') && white_before) {
 			INT modnum=1;
 			signed int delta;
-			STRING saves = sstr, savep = p;
+			CNSTRING saves = sstr;
+			STRING savep = p;
 			char csave = c;
 			j=0;
 			while (chartype(c = (uchar)(*p++ = *sstr++)) == DIGIT) {
@@ -635,13 +702,12 @@ get_date_tok (struct tag_dnum *pdnum)
 				&& (csave == '-' || delta == 1)) {
 
 				*--p = 0;
+				sstr--; /* leave whitespace (or end) for next token */
 				pdnum->val = i;
 				pdnum->val2 = i + delta;
-				pdnum->str = strsave(scratch);
-				if (is_valid_day(NULL, *pdnum))
-					return ICONS_TOK;
-				else
-					return YEAR_TOK;
+				pdnum->str = strsave(lex->scratch);
+				tok = is_valid_day(NULL, *pdnum) ? ICONS_TOK : YEAR_TOK;
+				goto done;
 			}
 			/* pop back to before slash/hyphen, so it can be handled as
 			a number before a date delimiter */
@@ -651,32 +717,35 @@ get_date_tok (struct tag_dnum *pdnum)
 			&& (i % 10 == 0)
 			&& (!sstr[0] || iswhite((uchar)sstr[0]))) {
 			/* eg, 1850s -- this is English-specific */
-			p[1] = 0;
+			*p = 0;
 			pdnum->val = i;
 			pdnum->val2 = i+9;
-			pdnum->str = strsave(scratch);
-			if (is_valid_day(NULL, *pdnum))
-				return ICONS_TOK;
-			else
-				return YEAR_TOK;
+			pdnum->str = strsave(lex->scratch);
+			tok = is_valid_day(NULL, *pdnum) ? ICONS_TOK : YEAR_TOK;
+			goto done;
 		}
 		*--p = 0;
 		sstr--;
 		if (*sstr && !is_date_delim(*sstr)) {
 			/* number only valid if followed by date delimiter */
-			return CHAR_TOK;
+			tok = CHAR_TOK;
+			goto done;
 		}
 		pdnum->val = i;
 		pdnum->val2 = i;
 		pdnum->str = 0;
-		return ICONS_TOK;
+		tok = ICONS_TOK;
+		goto done;
 	}
 	if (*sstr == 0)  {
-		sstr = NULL;
+		lex->pos = NULL;
 		return 0;
 	}
 	++sstr;
-	return CHAR_TOK;
+	tok = CHAR_TOK;
+done:
+	lex->pos = sstr;
+	return tok;
 }
 /*=============================
  * get_todays_date -- Get today's date
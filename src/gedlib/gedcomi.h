@@ -10,7 +10,11 @@ void custom_translatez(ZSTR zstr, TRANTABLE tt);
 BOOLEAN init_map_from_file(CNSTRING file, CNSTRING mapname, TRANTABLE*, ZSTR zerr);
 
 
+/* indifacts.c */
+void free_indifacts(INDIFACTS facts);
+
 /* keytonod.c */
+INDIFACTS * cacheel_facts(CACHEEL cel);
 void cel_remove_record(CACHEEL cel, RECORD rec);
 NODE is_cel_loaded(CACHEEL cel);
 
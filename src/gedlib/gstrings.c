@@ -110,10 +110,14 @@ indi_to_list_string (NODE indi, NODE fam, INT len, RFMT rfmt, BOOLEAN appkey)
 {
 	char scratch[MAXLINELEN];
 	STRING name, evt = NULL, p = scratch;
+	CNSTRING kept;
 	int hasparents;
 	int hasfamily;
 	if (len>(INT)sizeof(scratch))
 		len = sizeof(scratch);
+	/* lists show the same people again & again */
+	if (!fam && (kept = indifacts_list_string(indi, len, rfmt, appkey)))
+		return strsave(kept);
 	if (indi) {
 		ASSERT(name = indi_to_name(indi, len));
 	} else
@@ -161,6 +165,8 @@ indi_to_list_string (NODE indi, NODE fam, INT len, RFMT rfmt, BOOLEAN appkey)
 	    }
 	}
 	limit_width(scratch, len, uu8);
+	if (!fam)
+		indifacts_save_list_string(indi, len, rfmt, appkey, scratch);
 	return strsave(scratch);
 }
 /*================================================
@@ -401,4 +407,5 @@ void
 set_displaykeys (BOOLEAN keyflag)
 {
 	displaykeys = keyflag;
+	drop_indifacts();
 }
@@ -0,0 +1,279 @@
+/*=============================================================
+ * indifacts.c -- Facts derived from cached person records
+ *  Reports and list displays ask for the same few things about
+ *  a person over and over: name parts, a formatted name, the
+ *  dates of birth and death, the one-line list description.
+ *  Each cache element of a person may hold an INDIFACTS, which
+ *  keeps these once worked out. Each part is filled only when
+ *  first asked for, and all are freed with the cache element.
+ *  Any change that might alter them (a record written, a node
+ *  added to or detached from a cached record, options, date
+ *  pictures or locale changed) simply bumps a generation count,
+ *  which makes every INDIFACTS start again when next used.
+ *  Only the first NAME, BIRT and DEAT lines of a record are
+ *  covered; asking about any other node works it out afresh.
+ *==============================================================*/
+
+#include "llstdlib.h"
+#include "table.h"
+#include "translat.h"
+#include "gedcom.h"
+#include "gedcomi.h"
+#include "date.h"
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* which parts of an INDIFACTS are filled */
+#define IF_NODES     0x01  /* name & evnt */
+#define IF_SURNAME   0x02
+#define IF_GIVENS    0x04
+#define IF_NAMEDO    0x08  /* fullname[DOSURCAP] */
+#define IF_NAMENO    0x10  /* fullname[NOSURCAP] */
+#define IF_BIRTDATE  0x20  /* gdv[0] */
+#define IF_DEATDATE  0x40  /* gdv[1] */
+#define IF_LIST      0x80
+
+struct tag_indifacts {
+	INT gen;             /* factsgen when filled */
+	INT have;            /* IF_ flags of parts filled */
+	NODE name;           /* first NAME line */
+	NODE evnt[2];        /* first BIRT & DEAT lines */
+	STRING surname;
+	STRING givens;
+	STRING fullname[2];  /* by SURCAPTYPE, in REGORDER */
+	INT fulllen[2];      /* length fullname was made for */
+	GDATEVAL gdv[2];     /* dates of evnt */
+	STRING liststr;      /* indi_to_list_string without family */
+	INT listlen;         /* arguments liststr was made for */
+	RFMT listrfmt;
+	BOOLEAN listkey;
+};
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static void clear_facts(INDIFACTS facts);
+static INDIFACTS get_facts(NODE node);
+static void on_record_change(VPTR uparm);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+static INT factsgen = 1;
+static BOOLEAN registered = FALSE;
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*=============================================
+ * drop_indifacts -- Forget all derived facts
+ *  (eg, options changed)
+ *===========================================*/
+void
+drop_indifacts (void)
+{
+	++factsgen;
+}
+/*=============================================
+ * on_record_change -- Database record written
+ *===========================================*/
+static void
+on_record_change (VPTR uparm)
+{
+	uparm = uparm; /* unused */
+	drop_indifacts();
+}
+/*=============================================
+ * free_indifacts -- Free facts of cache element
+ *  (called as cache element is emptied)
+ *===========================================*/
+void
+free_indifacts (INDIFACTS facts)
+{
+	if (!facts) return;
+	clear_facts(facts);
+	stdfree(facts);
+}
+/*=============================================
+ * clear_facts -- Free all parts & mark them unfilled
+ *===========================================*/
+static void
+clear_facts (INDIFACTS facts)
+{
+	INT i;
+	strfree(&facts->surname);
+	strfree(&facts->givens);
+	strfree(&facts->liststr);
+	for (i=0; i<2; ++i) {
+		strfree(&facts->fullname[i]);
+		if (facts->gdv[i]) {
+			free_gdateval(facts->gdv[i]);
+			facts->gdv[i] = 0;
+		}
+	}
+	facts->name = facts->evnt[0] = facts->evnt[1] = 0;
+	facts->have = 0;
+}
+/*=============================================
+ * get_facts -- Find facts of person node belongs to
+ *  node: [IN]  any node of a person record
+ * returns NULL if node is not in the cache (eg, a
+ *  temporary node), or not in a person record
+ *===========================================*/
+static INDIFACTS
+get_facts (NODE node)
+{
+	INDIFACTS * pfacts;
+	INDIFACTS facts;
+	NODE root;
+	if (!node || !node->n_cel)
+		return NULL;
+	pfacts = cacheel_facts(node->n_cel);
+	if (!(facts = *pfacts)) {
+		if (!(root = is_cel_loaded(node->n_cel)) || nestr(ntag(root), "INDI"))
+			return NULL;
+		if (!registered) {
+			register_record_change_callback(on_record_change, 0);
+			registered = TRUE;
+		}
+		facts = *pfacts = (INDIFACTS)stdalloc(sizeof(*facts));
+		facts->gen = factsgen;
+	}
+	if (facts->gen != factsgen) {
+		clear_facts(facts);
+		facts->gen = factsgen;
+	}
+	if (!(facts->have & IF_NODES)) {
+		root = is_cel_loaded(node->n_cel);
+		facts->name = find_tag(nchild(root), "NAME");
+		facts->evnt[0] = find_tag(nchild(root), "BIRT");
+		facts->evnt[1] = find_tag(nchild(root), "DEAT");
+		facts->have |= IF_NODES;
+	}
+	return facts;
+}
+/*=============================================
+ * indifacts_surname -- Surname of person (getasurname)
+ *  name: [IN]  NAME line (with a value)
+ *===========================================*/
+CNSTRING
+indifacts_surname (NODE name)
+{
+	INDIFACTS facts = get_facts(name);
+	if (!facts || facts->name != name)
+		return getasurname(nval(name));
+	if (!(facts->have & IF_SURNAME)) {
+		strupdate(&facts->surname, getasurname(nval(name)));
+		facts->have |= IF_SURNAME;
+	}
+	return facts->surname;
+}
+/*=============================================
+ * indifacts_givens -- Given names of person (givens)
+ *  name: [IN]  NAME line (with a value)
+ *===========================================*/
+CNSTRING
+indifacts_givens (NODE name)
+{
+	INDIFACTS facts = get_facts(name);
+	if (!facts || facts->name != name)
+		return givens(nval(name));
+	if (!(facts->have & IF_GIVENS)) {
+		strupdate(&facts->givens, givens(nval(name)));
+		facts->have |= IF_GIVENS;
+	}
+	return facts->givens;
+}
+/*=============================================
+ * indifacts_name -- Name of person in regular order
+ *  name:  [IN]  NAME line
+ *  caps:  [IN]  whether to capitalize surname
+ *  len:   [IN]  max length (as manip_name)
+ * Only the length last asked for is kept.
+ * returns NULL if name has no value
+ *===========================================*/
+CNSTRING
+indifacts_name (NODE name, SURCAPTYPE caps, INT len)
+{
+	INDIFACTS facts = get_facts(name);
+	INT flag = (caps == DOSURCAP) ? IF_NAMEDO : IF_NAMENO;
+	STRING str;
+	if (!facts || facts->name != name)
+		return manip_name(nval(name), caps, REGORDER, len);
+	if (!(facts->have & flag) || facts->fulllen[caps] != len) {
+		str = manip_name(nval(name), caps, REGORDER, len);
+		strupdate(&facts->fullname[caps], str);
+		facts->fulllen[caps] = len;
+		facts->have |= flag;
+	}
+	return facts->fullname[caps];
+}
+/*=============================================
+ * indifacts_date -- Parsed date of birth or death
+ *  evnt: [IN]  event line
+ * returns the date (which caller must not free) if evnt
+ *  is the first BIRT or DEAT of a cached person, else NULL
+ *===========================================*/
+GDATEVAL
+indifacts_date (NODE evnt)
+{
+	INDIFACTS facts = get_facts(evnt);
+	INT i, flag;
+	if (!facts)
+		return NULL;
+	if (evnt == facts->evnt[0])
+		i = 0;
+	else if (evnt == facts->evnt[1])
+		i = 1;
+	else
+		return NULL;
+	flag = i ? IF_DEATDATE : IF_BIRTDATE;
+	if (!(facts->have & flag)) {
+		facts->gdv[i] = extract_date(event_to_date(evnt, FALSE));
+		facts->have |= flag;
+	}
+	return facts->gdv[i];
+}
+/*=============================================
+ * indifacts_list_string -- Kept list string of person
+ *  indi:   [IN]  person
+ *  len, rfmt, appkey: [IN]  as given to indi_to_list_string
+ * returns NULL if none kept for these arguments
+ *===========================================*/
+CNSTRING
+indifacts_list_string (NODE indi, INT len, RFMT rfmt, BOOLEAN appkey)
+{
+	INDIFACTS facts = get_facts(indi);
+	if (!facts || !(facts->have & IF_LIST))
+		return NULL;
+	if (facts->listlen != len || facts->listrfmt != rfmt
+		|| facts->listkey != appkey)
+		return NULL;
+	return facts->liststr;
+}
+/*=============================================
+ * indifacts_save_list_string -- Keep list string of person
+ *  indi:   [IN]  person
+ *  len, rfmt, appkey: [IN]  as given to indi_to_list_string
+ *  str:    [IN]  string it made
+ *===========================================*/
+void
+indifacts_save_list_string (NODE indi, INT len, RFMT rfmt, BOOLEAN appkey
+	, CNSTRING str)
+{
+	INDIFACTS facts = get_facts(indi);
+	if (!facts)
+		return;
+	strupdate(&facts->liststr, str);
+	facts->listlen = len;
+	facts->listrfmt = rfmt;
+	facts->listkey = appkey;
+	facts->have |= IF_LIST;
+}
@@ -74,6 +74,26 @@
 #define ISPRN_FAMSEQ 1
 #define ISPRN_SPOUSESEQ 2
 
+/*====================
+ * sorting
+ *==================*/
+/* intervals this short are finished by insertion sort */
+#define SHORTSORT_MAX 16
+/* keysort switches to radix sort for sequences this long */
+#define RADIXSORT_MIN 64
+
+/*====================
+ * membership index
+ *==================*/
+/* shorter sequences are searched by linear scan */
+#define SEQINDEX_MIN 16
+/* initial number of slots (power of 2) */
+#define SEQINDEX_MINSLOTS 64
+/* set operations */
+#define SEQOP_UNION 1
+#define SEQOP_INTERSECT 2
+#define SEQOP_DIFFERENCE 3
+
 /*********************************************
  * local types
  *********************************************/
@@ -89,6 +109,8 @@ struct tag_sortel {
 	UNION s_val;	/* any value */
 	STRING s_prn;	/* menu print string */
 	INT s_pri;	/* key as integer (exc valuesort_indiseq puts values here) */
+	STRING s_ckey;	/* name collation key, built by namesort */
+	INT s_cklen;	/* length of s_ckey */
 };
 /* typedef struct tag_sortel *SORTEL; */ /* in indiseq.h */
 #define skey(s) ((s)->s_key)
@@ -96,6 +118,31 @@ struct tag_sortel {
 #define sval(s) ((s)->s_val)
 #define sprn(s) ((s)->s_prn)
 #define spri(s) ((s)->s_pri)
+#define sckey(s) ((s)->s_ckey)
+#define scklen(s) ((s)->s_cklen)
+/*==================================================================
+ * SEQINDEX -- Membership index over the keys of an indiseq: a hash,
+ *   by key letter and key number, of how many elements have each key
+ *   Built on first lookup of a long sequence, then kept current by
+ *   append & delete; a sequence holding any key that is not a letter
+ *   followed by a plain number is marked unindexable
+ *================================================================*/
+struct tag_seqslot {
+	INT q_num;      /* key number */
+	INT q_count;    /* elements with this key (may drop to 0) */
+	char q_type;    /* key letter, 0 if slot never used */
+};
+struct tag_seqindex {
+	struct tag_seqslot *q_slots; /* open addressing, linear probing */
+	INT q_max;      /* number of slots, a power of 2 */
+	INT q_used;     /* slots in use (including those with count 0) */
+	BOOLEAN q_bad;  /* sequence has a key that cannot be indexed */
+};
+/* typedef struct tag_seqindex *SEQINDEX; */ /* in indiseq.h */
+
+/* byte of key integer for radix sort, sign flipped so negatives sort first */
+#define PRIDIGIT(s, shift) \
+	(((((unsigned long)spri(s)) ^ 0x80000000UL) >> (shift)) & 0xFF)
 
 /*********************************************
  * local function prototypes
@@ -109,18 +156,35 @@ static void calc_indiseq_name_el(INDISEQ seq, INT index);
 static INT canonkey_compare(SORTEL el1, SORTEL el2, VPTR param);
 static INT canonkey_order(char c);
 static void check_indiseq_valtype(INDISEQ seq, INT valtype);
+static INDISEQ closure_to_indiseq(INDISEQ seq, BOOLEAN up, INT maxgen);
 static UNION copyval(INDISEQ seq, UNION uval);
 static INDISEQ create_indiseq_impl(INT valtype, INDISEQ_VALUE_FNCTABLE fnctable);
+static SEQINDEX create_seqindex(INT size);
+static void clear_el_collkey(SORTEL el);
 static void delete_el(INDISEQ seq, SORTEL el);
 static void deleteval(INDISEQ seq, UNION uval);
 static INDISEQ dupseq(INDISEQ seq);
+static struct tag_seqslot * find_seqslot(SEQINDEX idx, char type, INT num);
+static void free_seqindex(SEQINDEX *pidx);
 static STRING get_print_el(INDISEQ, INT i, INT len, RFMT rfmt);
+static SEQINDEX get_seqindex(INDISEQ seq);
+static void heap_sort(SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b);
+static void insertion_sort(SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b);
 static BOOLEAN is_locale_current(INDISEQ seq);
 static INT key_compare(SORTEL el1, SORTEL el2, VPTR param);
+static BOOLEAN make_name_collkeys(INDISEQ seq);
 static INT name_compare(SORTEL el1, SORTEL el2, VPTR param);
-static void llqsort2(SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b);
+static INT namekey_compare(SORTEL el1, SORTEL el2, VPTR param);
+static void llqsort2(SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b, INT maxdepth);
 static void partition2(SORTEL *arr, ELCMPFNC cmp, VPTR param, INT a, INT b, INT *pi, INT *pj);
+static BOOLEAN parse_seqkey(CNSTRING key, char *ptype, INT *pnum);
 static STRING qkey_to_name(STRING key);
+static void radix_sort_pri(SORTEL *data, INT len);
+static INDISEQ seqindex_setop(INDISEQ one, INDISEQ two, INT op);
+static BOOLEAN seqindex_add(SEQINDEX idx, CNSTRING key, INT delta);
+static INT seqindex_count(INDISEQ seq, CNSTRING key);
+static void seqindex_grow(SEQINDEX idx);
+static void sift_down(SORTEL *heap, ELCMPFNC cmp, VPTR param, INT i, INT n);
 static void update_locale(INDISEQ seq);
 static INT value_compare(SORTEL el1, SORTEL el2, VPTR param);
 
@@ -210,11 +274,14 @@ remove_indiseq (INDISEQ seq)
 		if (snam(*d)) stdfree(snam(*d));
 		deleteval(seq, sval(*d));
 		if (sprn(*d)) stdfree(sprn(*d));
+		clear_el_collkey(*d);
 		stdfree(*d);
 	}
 	stdfree(IData(seq));
 	if (ILocale(seq))
 		stdfree(ILocale(seq));
+	strfree(&IKeylocale(seq));
+	free_seqindex(&IKeyindex(seq));
 	stdfree(seq);
 }
 /*==============================
@@ -374,7 +441,8 @@ append_indiseq_null (INDISEQ seq,    /* sequence */
                      BOOLEAN alloc)  /* key alloced? */
 {
 	UNION u;
-	u.i=0;
+	/* clear whole union, as INT is narrower than pointers */
+	u.w=0;
 	/* no type check - valid for any seq */
 	append_indiseq_impl(seq, key, name, u, sure, alloc);
 }
@@ -403,17 +471,12 @@ append_indiseq_impl (INDISEQ seq, STRING key, CNSTRING name, UNION val
 			why FAM seqs didn't do dupcheck */
 		BOOLEAN dupcheck = (*key != 'F' && *key != 'I')
 			|| (*key == 'I' && !name);
-		if (dupcheck)
-		{
-			for (i = 0; i < n; i++) {
-				if (eqstr(key, skey(old[i]))) {
-						/* failed dupe check - bail */
-					if (alloc)
-						stdfree(key);
-					deleteval(seq, val);
-					return;
-				}
-			}
+		if (dupcheck && in_indiseq(seq, key)) {
+				/* failed dupe check - bail */
+			if (alloc)
+				stdfree(key);
+			deleteval(seq, val);
+			return;
 		}
 	}
 	el = (SORTEL) stdalloc(sizeof(*el));
@@ -430,6 +493,8 @@ append_indiseq_impl (INDISEQ seq, STRING key, CNSTRING name, UNION val
 	sval(el) = val;
 	spri(el) = 0;
 	sprn(el) = NULL;
+	sckey(el) = NULL;
+	scklen(el) = 0;
 	if ((n = ISize(seq)) >= IMax(seq))  {
 		m = 3*n;
 		new = (SORTEL *) stdalloc(m*sizeof(SORTEL));
@@ -441,6 +506,8 @@ append_indiseq_impl (INDISEQ seq, STRING key, CNSTRING name, UNION val
 	}
 	old[ISize(seq)++] = el;
 	IFlags(seq) = 0;
+	if (IKeyindex(seq))
+		seqindex_add(IKeyindex(seq), skey(el), 1);
 }
 /*=========================================================
  * rename_indiseq -- Update element name with standard name
@@ -460,6 +527,7 @@ rename_indiseq (INDISEQ seq, STRING key)
 		if (eqstr(key, skey(data[i]))) {
 			STRING name = qkey_to_name(key);
 			if (snam(data[i])) stdfree(snam(data[i]));
+			clear_el_collkey(data[i]);
 			if (name)
 				snam(data[i]) = strsave(name);
 			else
@@ -473,10 +541,12 @@ rename_indiseq (INDISEQ seq, STRING key)
 BOOLEAN
 in_indiseq (INDISEQ seq, STRING key)
 {
-	INT i, len;
+	INT i, len, count;
 	SORTEL *data;
 
 	if (!seq || !key) return FALSE;
+	if ((count = seqindex_count(seq, key)) >= 0)
+		return count > 0;
 	len = ISize(seq);
 	data = IData(seq);
 	for (i = 0; i < len; i++) {
@@ -484,6 +554,161 @@ in_indiseq (INDISEQ seq, STRING key)
 	}
 	return FALSE;
 }
+/*==============================================
+ * get_seqindex -- Return membership index of sequence,
+ *  building it if needed
+ *  returns NULL if sequence cannot be indexed
+ *=============================================*/
+static SEQINDEX
+get_seqindex (INDISEQ seq)
+{
+	SEQINDEX idx = IKeyindex(seq);
+	if (!idx) {
+		idx = IKeyindex(seq) = create_seqindex(ISize(seq));
+		FORINDISEQ(seq, el, num)
+			if (!seqindex_add(idx, skey(el), 1))
+				break;
+		ENDINDISEQ
+	}
+	return idx->q_bad ? NULL : idx;
+}
+/*==============================================
+ * seqindex_count -- How many elements of sequence have key ?
+ *  (short sequences get no index until something else builds one)
+ *  returns -1 if sequence has no usable index
+ *=============================================*/
+static INT
+seqindex_count (INDISEQ seq, CNSTRING key)
+{
+	SEQINDEX idx;
+	struct tag_seqslot *slot;
+	char type;
+	INT num;
+	if (!IKeyindex(seq) && ISize(seq) < SEQINDEX_MIN) return -1;
+	if (!(idx = get_seqindex(seq))) return -1;
+	/* every key in seq is canonical, so a key that is not is absent */
+	if (!parse_seqkey(key, &type, &num)) return 0;
+	slot = find_seqslot(idx, type, num);
+	return slot->q_type ? slot->q_count : 0;
+}
+/*==============================================
+ * create_seqindex -- Create empty membership index
+ *  size: [IN]  expected number of keys
+ *=============================================*/
+static SEQINDEX
+create_seqindex (INT size)
+{
+	SEQINDEX idx = (SEQINDEX)stdalloc(sizeof(*idx));
+	INT max = SEQINDEX_MINSLOTS;
+	while (max < 2*size)
+		max *= 2;
+	idx->q_slots = (struct tag_seqslot *)stdalloc(max*sizeof(idx->q_slots[0]));
+	memset(idx->q_slots, 0, max*sizeof(idx->q_slots[0]));
+	idx->q_max = max;
+	idx->q_used = 0;
+	idx->q_bad = FALSE;
+	return idx;
+}
+/*==============================================
+ * free_seqindex -- Free membership index (if any)
+ *=============================================*/
+static void
+free_seqindex (SEQINDEX *pidx)
+{
+	SEQINDEX idx = *pidx;
+	if (!idx) return;
+	stdfree(idx->q_slots);
+	stdfree(idx);
+	*pidx = NULL;
+}
+/*==============================================
+ * parse_seqkey -- Split key into letter & number
+ *  accepts only a letter followed by a number without leading zeros,
+ *  so that no two keys map to the same letter & number
+ *=============================================*/
+static BOOLEAN
+parse_seqkey (CNSTRING key, char *ptype, INT *pnum)
+{
+	CNSTRING p = key + 1;
+	INT num = 0, ndigits = 0;
+	if (!key[0] || *p < '1' || *p > '9') return FALSE;
+	for ( ; *p; ++p, ++ndigits) {
+		if (*p < '0' || *p > '9' || ndigits >= 9) return FALSE;
+		num = num*10 + (*p - '0');
+	}
+	*ptype = key[0];
+	*pnum = num;
+	return TRUE;
+}
+/*==============================================
+ * find_seqslot -- Find slot of key letter & number,
+ *  or the empty slot where it would go
+ *=============================================*/
+static struct tag_seqslot *
+find_seqslot (SEQINDEX idx, char type, INT num)
+{
+	unsigned int h = (unsigned int)num * 2654435761U + (unsigned char)type;
+	unsigned int mask = idx->q_max - 1;
+	struct tag_seqslot *slot;
+	h ^= h >> 16;
+	while (1) {
+		slot = &idx->q_slots[h & mask];
+		if (!slot->q_type || (slot->q_num == num && slot->q_type == type))
+			return slot;
+		++h;
+	}
+}
+/*==============================================
+ * seqindex_add -- Adjust count of key in index by delta
+ *  returns FALSE (and marks index unusable) if key cannot be indexed
+ *=============================================*/
+static BOOLEAN
+seqindex_add (SEQINDEX idx, CNSTRING key, INT delta)
+{
+	struct tag_seqslot *slot;
+	char type;
+	INT num;
+	if (idx->q_bad) return FALSE;
+	if (!parse_seqkey(key, &type, &num)) {
+		idx->q_bad = TRUE;
+		return FALSE;
+	}
+	slot = find_seqslot(idx, type, num);
+	if (!slot->q_type) {
+		if (delta <= 0) return TRUE;
+		if (2*(idx->q_used+1) > idx->q_max) {
+			seqindex_grow(idx);
+			slot = find_seqslot(idx, type, num);
+		}
+		slot->q_type = type;
+		slot->q_num = num;
+		++idx->q_used;
+	}
+	slot->q_count += delta;
+	return TRUE;
+}
+/*==============================================
+ * seqindex_grow -- Double slots of index, dropping keys
+ *  no longer present
+ *=============================================*/
+static void
+seqindex_grow (SEQINDEX idx)
+{
+	struct tag_seqslot *old = idx->q_slots, *slot;
+	INT i, oldmax = idx->q_max;
+	idx->q_max *= 2;
+	idx->q_slots = (struct tag_seqslot *)stdalloc(idx->q_max*sizeof(old[0]));
+	memset(idx->q_slots, 0, idx->q_max*sizeof(old[0]));
+	idx->q_used = 0;
+	for (i = 0; i < oldmax; ++i) {
+		if (old[i].q_type && old[i].q_count > 0) {
+			slot = find_seqslot(idx, old[i].q_type, old[i].q_num);
+			*slot = old[i];
+			++idx->q_used;
+		}
+	}
+	stdfree(old);
+}
 /*===============================================================
  * delete_indiseq -- Remove el from sequence
  *  if key & name given, look for element matching both
@@ -504,6 +729,7 @@ delete_indiseq (INDISEQ seq, STRING key, STRING name, INT index)
 	data = IData(seq);
 	if (key) {
 		if (*key != 'I') return FALSE;
+		if (!seqindex_count(seq, key)) return FALSE;
 		for (i = 0; i < len; i++) {
 			if (eqstr(key, skey(data[i])) && (!name ||
 			    eqstr(name, snam(data[i])))) break;
@@ -517,6 +743,8 @@ delete_indiseq (INDISEQ seq, STRING key, STRING name, INT index)
 	for (i = index; i < len; i++)
 		data[i] = data[i+1];
 	ISize(seq)--;
+	if (IKeyindex(seq))
+		seqindex_add(IKeyindex(seq), skey(el), -1);
 	delete_el(seq, el);
 	stdfree(el);
 	return TRUE;
@@ -536,6 +764,7 @@ delete_el (INDISEQ seq, SORTEL el)
 		stdfree(sprn(el));
 		sprn(el)=NULL;
 	}
+	clear_el_collkey(el);
 	deleteval(seq, sval(el));
 	if (IValtype(seq) == ISVAL_INT)
 		sval(el).i = 0;
@@ -670,6 +899,19 @@ name_compare (SORTEL el1, SORTEL el2, VPTR param)
 	}
 	return canonkey_compare(el1, el2, param);
 }
+/*==================================
+ * namekey_compare -- Compare two elements by name collation key
+ *  (same order as name_compare, see make_name_collkeys)
+ *================================*/
+static INT
+namekey_compare (SORTEL el1, SORTEL el2, VPTR param)
+{
+	INT len1 = scklen(el1), len2 = scklen(el2);
+	INT rel = memcmp(sckey(el1), sckey(el2), len1 < len2 ? len1 : len2);
+	param = param; /* unused */
+	if (rel) return rel;
+	return len1 - len2;
+}
 /*================================
  * key_compare -- Compare two keys
  * also used for integer value sort
@@ -754,11 +996,77 @@ namesort_indiseq (INDISEQ seq)
 	FORINDISEQ(seq, el, num)
 		spri(el) = atoi(skey(el) + 1);
 	ENDINDISEQ
-	partition_sort(IData(seq), ISize(seq), name_compare, seq);
+	if (make_name_collkeys(seq))
+		partition_sort(IData(seq), ISize(seq), namekey_compare, seq);
+	else
+		partition_sort(IData(seq), ISize(seq), name_compare, seq);
 	IFlags(seq) &= ~ALLSORTS;
 	IFlags(seq) |= NAMESORT;
 	update_locale(seq);
 }
+/*==========================================
+ * make_name_collkeys -- Give each element a binary key that
+ *  sorts by memcmp as name_compare orders the elements:
+ *  named elements first, by namecollkey, then canonical key order
+ * Keys are kept with the elements, and only rebuilt for elements
+ * whose name changed, or all of them when the locale changes
+ * returns FALSE if collation in use has no keys
+ *========================================*/
+static BOOLEAN
+make_name_collkeys (INDISEQ seq)
+{
+	const char *locstr = llsetlocale(LC_COLLATE, NULL);
+	ZSTR zkey = zs_new();
+	BOOLEAN ok = ll_strxfrmloc("", zkey);
+
+	if (!locstr) locstr = "";
+	if (!ok || !IKeylocale(seq) || !eqstr(IKeylocale(seq), locstr)) {
+		FORINDISEQ(seq, el, num)
+			clear_el_collkey(el);
+		ENDINDISEQ
+		strupdate(&IKeylocale(seq), locstr);
+	}
+	FORINDISEQ(seq, el, num)
+		if (ok && !sckey(el)) {
+			unsigned long pri = (unsigned long)spri(el) + 0x80000000UL;
+			char tail[5];
+			zs_clear(zkey);
+			if (snam(el)) {
+				zs_appc(zkey, 0);
+				ok = namecollkey(snam(el), zkey);
+			} else {
+				/* unnamed elements sort after named ones */
+				zs_appc(zkey, 1);
+			}
+			/* ties are broken by canonkey_compare */
+			tail[0] = (char)canonkey_order(skey(el)[0]);
+			tail[1] = (char)((pri >> 24) & 0xFF);
+			tail[2] = (char)((pri >> 16) & 0xFF);
+			tail[3] = (char)((pri >> 8) & 0xFF);
+			tail[4] = (char)(pri & 0xFF);
+			zs_appsn(zkey, tail, sizeof(tail));
+			if (ok) {
+				scklen(el) = zs_len(zkey);
+				sckey(el) = stdalloc(scklen(el));
+				memcpy(sckey(el), zs_str(zkey), scklen(el));
+			}
+		}
+	ENDINDISEQ
+	zs_free(&zkey);
+	return ok;
+}
+/*==========================================
+ * clear_el_collkey -- Discard element's name collation key
+ *========================================*/
+static void
+clear_el_collkey (SORTEL el)
+{
+	if (sckey(el)) {
+		stdfree(sckey(el));
+		sckey(el) = NULL;
+	}
+	scklen(el) = 0;
+}
 /*========================================
  * keysort_indiseq -- Sort sequence by key
  *======================================*/
@@ -769,7 +1077,10 @@ keysort_indiseq (INDISEQ seq)
 	FORINDISEQ(seq, el, num)
 		spri(el) = atoi(skey(el) + 1);
 	ENDINDISEQ
-	partition_sort(IData(seq), ISize(seq), key_compare, seq);
+	if (ISize(seq) >= RADIXSORT_MIN)
+		radix_sort_pri(IData(seq), ISize(seq));
+	else
+		partition_sort(IData(seq), ISize(seq), key_compare, seq);
 	IFlags(seq) &= ~ALLSORTS;
 	IFlags(seq) |= KEYSORT;
 }
@@ -832,6 +1143,9 @@ valuesort_indiseq (INDISEQ seq, BOOLEAN *eflg)
 }
 /*=========================================
  * partition_sort -- Partition (quick) sort
+ *  introsort: quicksort with median of three pivot, insertion sort
+ *  for short intervals, and heapsort for any interval whose
+ *  partitioning goes too deep (so bad pivots cannot make it quadratic)
  *=======================================*/
 /*
  *  data:  [I/O] array of els to sort
@@ -842,11 +1156,17 @@ valuesort_indiseq (INDISEQ seq, BOOLEAN *eflg)
 void
 partition_sort (SORTEL *data, INT len, ELCMPFNC cmp, VPTR param)
 {
-	llqsort2(data, cmp, param, 0, len-1);
+	INT maxdepth = 0, n;
+	/* allow 2*log2(len) levels of partitioning */
+	for (n = len; n > 1; n >>= 1)
+		maxdepth += 2;
+	llqsort2(data, cmp, param, 0, len-1, maxdepth);
 }
 /*======================================
  * llqsort2 -- Nonrecursive quicksort
  *  median of three pivot
+ *  intervals of more than maxdepth levels of partitioning
+ *  are handed to heapsort
  *====================================*/
 /*======================================
  * partition2 -- Median of three pivot
@@ -898,43 +1218,134 @@ partition2 (SORTEL *arr, ELCMPFNC cmp, VPTR param, INT a, INT b, INT *pi, INT *p
 	*pi = i; *pj = j;
 }
 static void
-llqsort2 (SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b)
+llqsort2 (SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b, INT maxdepth)
 {
-	INT stack[64];
-	INT i, j, top;
+	INT stack[96];
+	INT i, j, top, depth;
 
 	top = 0;
+	depth = maxdepth;
 
 	while (1) {
-		while (b > a+1) {
+		while (b - a >= SHORTSORT_MAX) {
+			if (depth <= 0) {
+				heap_sort(data, cmp, param, a, b);
+				b = a;
+				break;
+			}
+			--depth;
 			partition2(data, cmp, param, a, b, &i, &j);
 			/* loop to simulate tail recursion on smaller interval */
 			if (j-a > b-i) {
 				/* (i+1,b) is shorter interval than (a,j) */
 				/* do (i+1, b) now, and push (a,j) */
-				stack[top++] = a; stack[top++] = j;
+				stack[top++] = a; stack[top++] = j; stack[top++] = depth;
 				a=i+1;
 			} else {
 				/* (a,j) is shorter interval than (i+1,b) */
 				/* do (a,j) now, and push (i+1,b) */
-				stack[top++] = i+1; stack[top++] = b;
+				stack[top++] = i+1; stack[top++] = b; stack[top++] = depth;
 				b = j;
 			}
 		}
-		if (b > a) {
-			/* swap data[a] and data[b] if needed */
-			if (CMP(data[a], data[b])>0) {
-				SORTEL t = data[a]; data[a] = data[b]; data[b] = t;
-			}
-		}
+		if (b > a)
+			insertion_sort(data, cmp, param, a, b);
 		if (top == 0) break;
 		/* pop & do whatever is on top of our stack */
-		b = stack[--top]; a = stack[--top];
+		depth = stack[--top]; b = stack[--top]; a = stack[--top];
+	}
+}
+/*======================================
+ * insertion_sort -- Sort short interval [a,b] in place
+ *====================================*/
+static void
+insertion_sort (SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b)
+{
+	INT i, j;
+	for (i = a+1; i <= b; ++i) {
+		SORTEL t = data[i];
+		for (j = i; j > a && CMP(data[j-1], t) > 0; --j)
+			data[j] = data[j-1];
+		data[j] = t;
+	}
+}
+/*======================================
+ * heap_sort -- Sort interval [a,b] in place, in O(n log n)
+ *  whatever the input (used when quicksort degenerates)
+ *====================================*/
+static void
+heap_sort (SORTEL *data, ELCMPFNC cmp, VPTR param, INT a, INT b)
+{
+	SORTEL *heap = data + a;
+	INT n = b - a + 1, i;
+	SORTEL t;
+	for (i = n/2 - 1; i >= 0; --i)
+		sift_down(heap, cmp, param, i, n);
+	for (i = n - 1; i > 0; --i) {
+		t = heap[0]; heap[0] = heap[i]; heap[i] = t;
+		sift_down(heap, cmp, param, 0, i);
+	}
+}
+/*======================================
+ * sift_down -- Restore max heap property below node i
+ *  heap:  [I/O] heap of n elements
+ *====================================*/
+static void
+sift_down (SORTEL *heap, ELCMPFNC cmp, VPTR param, INT i, INT n)
+{
+	SORTEL t = heap[i];
+	INT child;
+	while ((child = 2*i + 1) < n) {
+		if (child + 1 < n && CMP(heap[child], heap[child+1]) < 0)
+			++child;
+		if (CMP(t, heap[child]) >= 0)
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = t;
+}
+/*======================================
+ * radix_sort_pri -- Sort elements by their integer keys (spri)
+ *  LSD radix sort, one byte per pass; stable, no comparisons
+ *  passes in which all elements share the same byte are skipped
+ *====================================*/
+static void
+radix_sort_pri (SORTEL *data, INT len)
+{
+	SORTEL *tmp, *src, *dst, *t;
+	INT count[256];
+	INT i, shift, pos;
+
+	if (len < 2) return;
+	tmp = (SORTEL *)stdalloc(len*sizeof(SORTEL));
+	src = data;
+	dst = tmp;
+	for (shift = 0; shift < 32; shift += 8) {
+		memset(count, 0, sizeof(count));
+		for (i = 0; i < len; ++i)
+			++count[PRIDIGIT(src[i], shift)];
+		if (count[PRIDIGIT(src[0], shift)] == len)
+			continue;
+		for (i = 0, pos = 0; i < 256; ++i) {
+			INT c = count[i];
+			count[i] = pos;
+			pos += c;
+		}
+		for (i = 0; i < len; ++i)
+			dst[count[PRIDIGIT(src[i], shift)]++] = src[i];
+		t = src; src = dst; dst = t;
 	}
+	if (src != data)
+		memcpy(data, src, len*sizeof(SORTEL));
+	stdfree(tmp);
 }
 /*==================================================================
  * unique_indiseq -- Remove identical (key, name) els from sequence
- * NOTE: this routine has MEMORY LEAK -- it doesn't free storage for
+ *  & leave it in key order
+ *  duplicates are found with the membership index, if there is one,
+ *  keeping the first element with each key; otherwise by key sorting
+ * NOTE: that fallback has MEMORY LEAK -- it doesn't free storage for
  *   els removed from sequence
  *================================================================*/
 void
@@ -942,10 +1353,28 @@ unique_indiseq (INDISEQ seq)
 {
 	INT i, j, n;
 	SORTEL *d;
+	SEQINDEX idx;
 	if (!seq) return;
 	n = ISize(seq);
 	d = IData(seq);
 	if (n == 0 || (IFlags(seq) & UNIQUED)) return;
+	if ((idx = get_seqindex(seq))) {
+		/* from the end, drop each element whose key occurs earlier */
+		for (i = n-1; i >= 0; --i) {
+			if (seqindex_count(seq, skey(d[i])) > 1) {
+				seqindex_add(idx, skey(d[i]), -1);
+				delete_el(seq, d[i]);
+				stdfree(d[i]);
+				d[i] = NULL;
+			}
+		}
+		for (j = 0, i = 0; i < n; i++)
+			if (d[i]) d[j++] = d[i];
+		ISize(seq) = j;
+		keysort_indiseq(seq);
+		IFlags(seq) |= UNIQUED;
+		return;
+	}
 	if (!(IFlags(seq) & KEYSORT)) keysort_indiseq(seq);
 	for (j = 0, i = 1; i < n; i++)
 		if (spri(d[i]) != spri(d[j])) {
@@ -1027,6 +1456,8 @@ union_indiseq (INDISEQ one, INDISEQ two)
 		return dupseq(two);
 	if (!two)
 		return dupseq(one);
+	if ((three = seqindex_setop(one, two, SEQOP_UNION)))
+		return three;
 	if (!(IFlags(one) & KEYSORT)) keysort_indiseq(one);
 	if (!(IFlags(one) & UNIQUED)) unique_indiseq(one);
 	if (!(IFlags(two) & KEYSORT)) keysort_indiseq(two);
@@ -1096,6 +1527,8 @@ intersect_indiseq (INDISEQ one, INDISEQ two)
 	INT valtype;
 	UNION uval;
 	if (!one || !two) return NULL;
+	if ((three = seqindex_setop(one, two, SEQOP_INTERSECT)))
+		return three;
 	if (!(IFlags(one) & KEYSORT)) keysort_indiseq(one);
 	if (!(IFlags(one) & UNIQUED)) unique_indiseq(one);
 	if (!(IFlags(two) & KEYSORT)) keysort_indiseq(two);
@@ -1143,6 +1576,8 @@ difference_indiseq (INDISEQ one, INDISEQ two)
 		return NULL;
 	if (!two)
 		return dupseq(one);
+	if ((three = seqindex_setop(one, two, SEQOP_DIFFERENCE)))
+		return three;
 	if (!(IFlags(one) & KEYSORT)) keysort_indiseq(one);
 	if (!(IFlags(one) & UNIQUED)) unique_indiseq(one);
 	if (!(IFlags(two) & KEYSORT)) keysort_indiseq(two);
@@ -1180,6 +1615,49 @@ difference_indiseq (INDISEQ one, INDISEQ two)
 	IFlags(three) = KEYSORT|UNIQUED;
 	return three;
 }
+/*=========================================================
+ * seqindex_setop -- Create union, intersection or difference
+ *  of two sequences by membership index, without sorting or
+ *  uniquing the inputs; result is unique, in key order
+ * copies values from "one", or from "two" for keys only it has
+ *  returns NULL if either input cannot be indexed
+ *=======================================================*/
+static INDISEQ
+seqindex_setop (INDISEQ one, INDISEQ two, INT op)
+{
+	INDISEQ three;
+	INT size = length_indiseq(one);
+	BOOLEAN keep;
+	if (!get_seqindex(one) || !get_seqindex(two))
+		return NULL;
+	if (op == SEQOP_UNION)
+		size += length_indiseq(two);
+	three = create_indiseq_impl(get_combined_valtype(one, two), IValfnctbl(one));
+	IKeyindex(three) = create_seqindex(size);
+	FORINDISEQ(one, el, num)
+		keep = TRUE;
+		if (op == SEQOP_INTERSECT)
+			keep = seqindex_count(two, skey(el)) > 0;
+		else if (op == SEQOP_DIFFERENCE)
+			keep = seqindex_count(two, skey(el)) == 0;
+		if (keep && !seqindex_count(three, skey(el))) {
+			/* indiseq values must be copied with copyval */
+			append_indiseq_impl(three, strsave(skey(el)), NULL
+				, copyval(one, sval(el)), TRUE, TRUE);
+		}
+	ENDINDISEQ
+	if (op == SEQOP_UNION) {
+		FORINDISEQ(two, el, num)
+			if (!seqindex_count(three, skey(el))) {
+				append_indiseq_impl(three, strsave(skey(el)), NULL
+					, copyval(two, sval(el)), TRUE, TRUE);
+			}
+		ENDINDISEQ
+	}
+	keysort_indiseq(three);
+	IFlags(three) = KEYSORT|UNIQUED;
+	return three;
+}
 /*=====================================================
  * parent_indiseq -- Create parent sequence of sequence
  * copies values from original seq using copyval
@@ -1189,26 +1667,23 @@ parent_indiseq (INDISEQ seq)
 {
 	TABLE tab=0; /* table of people inserted (values not used) */
 	INDISEQ par=0;
-	NODE indi=0;
-	INT fnum=0, snum=0;
-	STRING key=0;
+	char key[MAXKEYWIDTH+1];
 	UNION uval;
 	if (!seq) return NULL;
 	tab = create_table_vptr();
 	par = create_indiseq_impl(IValtype(seq), IValfnctbl(seq));
 	FORINDISEQ(seq, el, num)
-		indi = key_to_indi(skey(el));
-		FORFAMCS(indi, fam, fath, moth, fnum)
-			FORFAMSPOUSES(fam, spouse, snum)
-				if (spouse && !in_table(tab, key = indi_to_key(spouse))) {
+		FORPEDLINKS(PG_FAMC, atoi(skey(el)+1), fnum)
+			FORPEDLINKS(PG_SPOUSE, fnum, pnum)
+				snprintf(key, sizeof(key), "I%d", pnum);
+				if (!in_table(tab, key)) {
 					/* indiseq values must be copied with copyval */
 					uval = copyval(seq, sval(el));
-					key = strsave(key);
-					append_indiseq_impl(par, key, NULL, uval, TRUE, TRUE);
+					append_indiseq_impl(par, strsave(key), NULL, uval, TRUE, TRUE);
 					insert_table_ptr(tab, key, 0);
 				}
-			ENDFAMSPOUSES
-		ENDFAMCS
+			ENDPEDLINKS
+		ENDPEDLINKS
 	ENDINDISEQ
 	destroy_table(tab);
 	return par;
@@ -1220,29 +1695,25 @@ parent_indiseq (INDISEQ seq)
 INDISEQ
 child_indiseq (INDISEQ seq)
 {
-	INT num1, num2;
 	TABLE tab=0; /* table of people already inserted (values not used) */
 	INDISEQ cseq=0;
-	NODE indi=0;
-	STRING key=0;
+	char key[MAXKEYWIDTH+1];
 	UNION uval;
 	if (!seq) return NULL;
 	tab = create_table_vptr();
 	cseq = create_indiseq_impl(IValtype(seq), IValfnctbl(seq));
 	FORINDISEQ(seq, el, num)
-		indi = key_to_indi(skey(el));
-		FORFAMS(indi, fam, num1)
-			FORCHILDRENx(fam, chil, num2)
-				key = indi_to_key(chil);
+		FORPEDLINKS(PG_FAMS, atoi(skey(el)+1), fnum)
+			FORPEDLINKS(PG_CHIL, fnum, cnum)
+				snprintf(key, sizeof(key), "I%d", cnum);
 				if (!in_table(tab, key)) {
-					key = strsave(key);
 					/* indiseq values must be copied with copyval */
 					uval = copyval(seq, sval(el));
-					append_indiseq_impl(cseq, key, NULL, uval, TRUE, TRUE);
+					append_indiseq_impl(cseq, strsave(key), NULL, uval, TRUE, TRUE);
 					insert_table_ptr(tab, key, 0);
 				}
-			ENDCHILDRENx
-		ENDFAMS
+			ENDPEDLINKS
+		ENDPEDLINKS
 	ENDINDISEQ
 	destroy_table(tab);
 	return cseq;
@@ -1331,17 +1802,17 @@ INDISEQ
 indi_to_fathers (NODE indi)
 {
 	INDISEQ seq;
-	INT num1, num2, len = 0;
-	STRING key;
+	INT len = 0;
+	char key[MAXKEYWIDTH+1];
 	if (!indi) return NULL;
 	seq = create_indiseq_null();
-	FORFAMCS(indi, fam, fath, moth, num1)
-		FORHUSBS(fam, husb, num2)
+	FORPEDLINKS(PG_FAMC, node_to_keynum('I', indi), fnum)
+		FORPEDLINKS(PG_HUSB, fnum, pnum)
 			len++;
-			key = indi_to_key(husb);
+			snprintf(key, sizeof(key), "I%d", pnum);
 			append_indiseq_null(seq, key, NULL, TRUE, FALSE);
-		ENDHUSBS
-	ENDFAMCS
+		ENDPEDLINKS
+	ENDPEDLINKS
 	if (len) return seq;
 	remove_indiseq(seq);
 	return NULL;
@@ -1353,17 +1824,17 @@ INDISEQ
 indi_to_mothers (NODE indi)
 {
 	INDISEQ seq;
-	INT num1, num2, len = 0;
-	STRING key;
+	INT len = 0;
+	char key[MAXKEYWIDTH+1];
 	if (!indi) return NULL;
 	seq = create_indiseq_null();
-	FORFAMCS(indi, fam, fath, moth, num1)
-		FORWIFES(fam, wife, num2)
+	FORPEDLINKS(PG_FAMC, node_to_keynum('I', indi), fnum)
+		FORPEDLINKS(PG_WIFE, fnum, pnum)
 			len++;
-			key = indi_to_key(wife);
+			snprintf(key, sizeof(key), "I%d", pnum);
 			append_indiseq_null(seq, key, NULL, TRUE, FALSE);
-		ENDWIFES
-	ENDFAMCS
+		ENDPEDLINKS
+	ENDPEDLINKS
 	if (len) return seq;
 	remove_indiseq(seq);
 	return NULL;
@@ -1421,15 +1892,14 @@ INDISEQ
 fam_to_children (NODE fam)
 {
 	INDISEQ seq;
-	INT num;
-	STRING key;
+	char key[MAXKEYWIDTH+1];
 	if (!fam) return NULL;
 	seq = create_indiseq_null();
-	FORCHILDRENx(fam, chil, num)
-		key = indi_to_key(chil);
+	FORPEDLINKS(PG_CHIL, node_to_keynum('F', fam), cnum)
+		snprintf(key, sizeof(key), "I%d", cnum);
 		append_indiseq_null(seq, key, NULL, TRUE, FALSE);
-	ENDCHILDRENx
-	if (num && ISize(seq)) return seq;
+	ENDPEDLINKS
+	if (ISize(seq)) return seq;
 	remove_indiseq(seq);
 	return NULL;
 }
@@ -1440,15 +1910,14 @@ INDISEQ
 fam_to_fathers (NODE fam)
 {
 	INDISEQ seq;
-	INT num;
-	STRING key;
+	char key[MAXKEYWIDTH+1];
 	if (!fam) return NULL;
 	seq = create_indiseq_null();
-	FORHUSBS(fam, husb, num)
-		key = indi_to_key(husb);
+	FORPEDLINKS(PG_HUSB, node_to_keynum('F', fam), pnum)
+		snprintf(key, sizeof(key), "I%d", pnum);
 		append_indiseq_null(seq, key, NULL, TRUE, FALSE);
-	ENDHUSBS
-	if (num && ISize(seq)) return seq;
+	ENDPEDLINKS
+	if (ISize(seq)) return seq;
 	remove_indiseq(seq);
 	return NULL;
 }
@@ -1459,15 +1928,14 @@ INDISEQ
 fam_to_mothers (NODE fam)
 {
 	INDISEQ seq;
-	INT num;
-	STRING key;
+	char key[MAXKEYWIDTH+1];
 	if (!fam) return NULL;
 	seq = create_indiseq_null();
-	FORWIFES(fam, wife, num)
-		key = indi_to_key(wife);
+	FORPEDLINKS(PG_WIFE, node_to_keynum('F', fam), pnum)
+		snprintf(key, sizeof(key), "I%d", pnum);
 		append_indiseq_null(seq, key, NULL, TRUE, FALSE);
-	ENDWIFES
-	if (num && ISize(seq)) return seq;
+	ENDPEDLINKS
+	if (ISize(seq)) return seq;
 	remove_indiseq(seq);
 	return NULL;
 }
@@ -1513,20 +1981,22 @@ sibling_indiseq (INDISEQ seq, BOOLEAN close)
  * ancestor_indiseq -- Create ancestor sequence of sequence
  *  values are created with the generation number
  *  (via value function table)
+ *  maxgen: [IN]  generations to go back (0 for all)
  *=======================================================*/
 INDISEQ
-ancestor_indiseq (INDISEQ seq)
+ancestor_indiseq (INDISEQ seq, INT maxgen)
 {
 	/* table lists people already listed (values unused) */
 	TABLE tab;
 	LIST anclist, genlist;
 	INDISEQ anc=0;
-	NODE indi=0;
-	STRING key, pkey;
+	STRING key;
+	char pkey[MAXKEYWIDTH+1];
 	INT gen=0;
-	INT fnum=0, snum=0;
 	UNION uval;
 	if (!seq) return NULL;
+	if (length_indiseq(seq) == 1)
+		return closure_to_indiseq(seq, TRUE, maxgen);
 		/* table of people already added */
 	tab = create_table_vptr();
 		/* paired processing list - see comments in descendant_indiseq code */
@@ -1540,11 +2010,13 @@ ancestor_indiseq (INDISEQ seq)
 	while (!is_empty_list(anclist)) {
 		key = (STRING) dequeue_list(anclist);
 		gen = (INT) dequeue_list(genlist) + 1;
-		indi = key_to_indi(key);
+		if (maxgen && gen > maxgen)
+			continue;
 
-		FORFAMCS(indi, fam, fath, moth, fnum)
-			FORFAMSPOUSES(fam, spouse, snum)
-				if (spouse && !in_table(tab, pkey = indi_to_key(spouse))) {
+		FORPEDLINKS(PG_FAMC, atoi(key+1), fnum)
+			FORPEDLINKS(PG_SPOUSE, fnum, snum)
+				snprintf(pkey, sizeof(pkey), "I%d", snum);
+				if (!in_table(tab, pkey)) {
 						/* copy key for list, others make their own copies */
 					uval = creategenval(seq, gen);
 					append_indiseq_pval(anc, pkey, NULL, uval.w, TRUE);
@@ -1552,8 +2024,8 @@ ancestor_indiseq (INDISEQ seq)
 					enqueue_list(genlist, (VPTR)gen);
 					insert_table_ptr(tab, pkey, 0);
 				}
-			ENDFAMSPOUSES
-		ENDFAMCS
+			ENDPEDLINKS
+		ENDPEDLINKS
 	}
 	destroy_table(tab);
 	destroy_empty_list(anclist);
@@ -1564,9 +2036,10 @@ ancestor_indiseq (INDISEQ seq)
  * descendant_indiseq -- Create descendant sequence of sequence
  *  values are created with the generation number
  *  (passed to create_value callback)
+ *  maxgen: [IN]  generations to go down (0 for all)
  *===========================================================*/
 INDISEQ
-descendent_indiseq (INDISEQ seq)
+descendent_indiseq (INDISEQ seq, INT maxgen)
 {
 	INT gen;
 	/* itab lists people already entered, ftab families
@@ -1574,10 +2047,12 @@ descendent_indiseq (INDISEQ seq)
 	TABLE itab, ftab;
 	LIST deslist, genlist;
 	INDISEQ des;
-	NODE indi;
-	STRING key, dkey, fkey;
+	STRING key;
+	char dkey[MAXKEYWIDTH+1], fkey[MAXKEYWIDTH+1];
 	UNION uval;
 	if (!seq) return NULL;
+	if (length_indiseq(seq) == 1)
+		return closure_to_indiseq(seq, FALSE, maxgen);
 		/* itab = people already added, value irrelevant */
 	itab = create_table_vptr();
 		/* ftab = families already added (processed), value irrelevant */
@@ -1600,36 +2075,64 @@ descendent_indiseq (INDISEQ seq)
 	ENDINDISEQ
 		/* loop until processing list is empty */
 	while (!is_empty_list(deslist)) {
-		INT num1, num2;
 		key = (STRING) dequeue_list(deslist);
 		gen = (INT) dequeue_list(genlist) + 1;
-		indi = key_to_indi(key);
-		FORFAMS(indi, fam, num1)
+		if (maxgen && gen > maxgen)
+			continue;
+		FORPEDLINKS(PG_FAMS, atoi(key+1), fnum)
 				/* skip families already processed */
-			if (in_table(ftab, fkey = fam_to_key(fam)))
-				goto a;
+			snprintf(fkey, sizeof(fkey), "F%d", fnum);
+			if (in_table(ftab, fkey))
+				continue;
 			insert_table_ptr(ftab, fkey, 0);
-			FORCHILDRENx(fam, child, num2)
+			FORPEDLINKS(PG_CHIL, fnum, cnum)
 					/* only do people not processed */
-				if (!in_table(itab,
-				    dkey = indi_to_key(child))) {
+				snprintf(dkey, sizeof(dkey), "I%d", cnum);
+				if (!in_table(itab, dkey)) {
 						/* copy key for list, others make their own copies */
 					uval = creategenval(seq, gen);
 						/* add person to output */
-					append_indiseq_pval(des, strsave(dkey), NULL, uval.w, TRUE);
+					append_indiseq_pval(des, dkey, NULL, uval.w, TRUE);
 						/* also want descendants, so add person to processing list */
 					enqueue_list(deslist, (VPTR)strsave(dkey));
 					enqueue_list(genlist, (VPTR)gen);
 					insert_table_ptr(itab, dkey, 0);
 				}
-			ENDCHILDRENx
-		a:;
-		ENDFAMS
+			ENDPEDLINKS
+		ENDPEDLINKS
 	}
 	destroy_table(itab);
 	destroy_table(ftab);
 	return des;
 }
+/*=============================================================
+ * closure_to_indiseq -- Ancestors or descendants of one person
+ *  from the relationship cache (same order & values as walking
+ *  the pedigree in ancestor_indiseq or descendent_indiseq)
+ *  seq:    [IN]  sequence holding just the one person
+ *  up:     [IN]  ancestors (TRUE) or descendants (FALSE)
+ *  maxgen: [IN]  generation limit (0 for none)
+ *===========================================================*/
+static INDISEQ
+closure_to_indiseq (INDISEQ seq, BOOLEAN up, INT maxgen)
+{
+	INDISEQ rel=0;
+	RELCLOSURE clos=0;
+	INT i, gen=0;
+	char key[MAXKEYWIDTH+1];
+	UNION uval;
+	STRING ikey = skey(IData(seq)[0]);
+	rel = create_indiseq_impl(IValtype(seq), IValfnctbl(seq));
+	clos = up ? ancestor_closure(ikey, maxgen) : descendant_closure(ikey, maxgen);
+	for (i = 0; i < closure_length(clos); ++i) {
+		INT keynum = closure_entry(clos, i, &gen);
+		snprintf(key, sizeof(key), "I%d", keynum);
+		uval = creategenval(seq, gen);
+		append_indiseq_pval(rel, key, NULL, uval.w, TRUE);
+	}
+	release_closure(clos);
+	return rel;
+}
 /*========================================================
  * spouse_indiseq -- Create spouses sequence of a sequence
  *======================================================*/
@@ -2206,8 +2709,10 @@ calc_indiseq_names (INDISEQ seq)
 	FORINDISEQ(seq, el, num)
 		if (*skey(el)=='I' && !snam(el)) {
 			STRING name = qkey_to_name(skey(el));
-			if (name)
+			if (name) {
 				snam(el) = strsave(name);
+				clear_el_collkey(el);
+			}
 		}
 	ENDINDISEQ
 	IFlags(seq) |= WITHNAMES;
@@ -2236,8 +2741,10 @@ calc_indiseq_name_el (INDISEQ seq, INT index)
 		return;
 
 	name = qkey_to_name(key);
-	if (name)
+	if (name) {
 		snam(IData(seq)[index]) = strsave(name);
+		clear_el_collkey(IData(seq)[index]);
+	}
 }
 /*=======================================================
  * qkey_to_name -- find the name for person with given key
@@ -47,6 +47,7 @@
 #include "charprops.h"
 #include "xlat.h"
 #include "dbcontext.h"
+#include "lltrace.h"
 
 /*********************************************
  * global/exported variables
@@ -260,6 +261,11 @@ update_useropts (VPTR uparm)
 	strupdate(&illegal_char, getlloptstr("IllegalChar", 0));
 
 	nodechk_enable(!!getlloptint("nodecheck", 0));
+
+	/* list strings depend on display options */
+	drop_indifacts();
+
+	lltrace_configure(getlloptstr("TraceFile", 0), getlloptint("TraceEvents", 0));
 }
 /*==================================================
  * update_db_options -- 
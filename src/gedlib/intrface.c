@@ -34,6 +34,8 @@
 
 extern BTREE BTR;
 
+static LIST f_record_change_callbacks = NULL; /* listeners for INDI & FAM writes */
+
 /*=================================================
  * retrieve_raw_record -- Retrieve record string from database
  *  key:  [IN] key of desired record (eg, "    I543")
@@ -54,7 +56,33 @@ retrieve_raw_record (CNSTRING key, INT *plen)
 BOOLEAN
 store_record (CNSTRING key, STRING rec, INT len)
 {
-	return bt_addrecord (BTR, str2rkey(key), rec, len);
+	BOOLEAN rtn;
+	/* before writing, so it can read the old record */
+	textindex_note_record(key, rec, len);
+	rtn = bt_addrecord (BTR, str2rkey(key), rec, len);
+	if (key[0] == 'I' || key[0] == 'F') {
+		pedgraph_note_record(key, rec, len);
+		notify_listeners(&f_record_change_callbacks);
+	}
+	return rtn;
+}
+/*=========================================
+ * register_record_change_callback -- Ask to be told
+ *  whenever a person or family record is written
+ *  (including deletion)
+ *=======================================*/
+void
+register_record_change_callback (CALLBACK_FNC fncptr, VPTR uparm)
+{
+	add_listener(&f_record_change_callbacks, fncptr, uparm);
+}
+/*=========================================
+ * unregister_record_change_callback -- 
+ *=======================================*/
+void
+unregister_record_change_callback (CALLBACK_FNC fncptr, VPTR uparm)
+{
+	delete_listener(&f_record_change_callbacks, fncptr, uparm);
 }
 /*=========================================
  * retrieve_to_file -- Retrieve record to file
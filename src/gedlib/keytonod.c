@@ -38,6 +38,7 @@
 #include "liflines.h"
 #include "feedback.h"
 #include "zstr.h"
+#include "lltrace.h"
 
 /*********************************************
  * global variables (no header)
@@ -61,6 +62,7 @@ struct tag_cacheel {
 	INT c_lock;       /* lock count (includes report locks) */
 	INT c_rptlock;    /* report lock count */
 	RECORD c_record;
+	INDIFACTS c_facts; /* derived facts (see indifacts.c) */
 };
 #define cnode(e)      ((e)->c_node)
 #define cprev(e)      ((e)->c_prev)
@@ -69,6 +71,7 @@ struct tag_cacheel {
 #define cclock(e)     ((e)->c_lock)
 #define ccrptlock(e)  ((e)->c_rptlock)
 #define crecord(e)    ((e)->c_record)
+#define cfacts(e)     ((e)->c_facts)
 
 /*==============================
  * CACHE -- Internal cache type.
@@ -135,6 +138,8 @@ static CACHE indicache, famcache, evencache, sourcache, othrcache;
 
 static CNSTRING cel_magic = "CEL_MAGIC"; /* fixed pointer to identify cel */
 
+static INT cache_misses = 0; /* records loaded from database into any cache */
+
 /* keybuf circular list of last 10 keys we looked up in cache 
  * kept for printing debug messages in crash log
  */
@@ -665,10 +670,13 @@ add_to_direct (CACHE cache, CNSTRING key, INT reportmode)
 	CACHEEL cel=0;
 	RECORD rec=0;
 	int i, j;
+	TRACE_TIME tt;
 
 	ASSERT(cache);
 	ASSERT(key);
+	TRACE_BEGIN(tt);
 	rec = NULL;
+	++cache_misses;
 	if ((rawrec = retrieve_raw_record(key, &len))) 
 		/* 2003-11-22, we should use string_to_node here */
 		rec = string_to_record(rawrec, key, len);
@@ -710,6 +718,7 @@ add_to_direct (CACHE cache, CNSTRING key, INT reportmode)
 	crecord(cel) = rec;
 	stdfree(rawrec);
 	ASSERT(cel->c_magic == cel_magic);
+	TRACE_END(tt, "cache", "add_to_direct", key);
 	return cel;
 }
 /*======================================================
@@ -963,6 +972,15 @@ get_cache_stats_fam (void)
 {
 	return get_cache_stats(famcache);
 }
+/*=========================================
+ * get_cache_miss_count -- Return number of records
+ *  loaded from database because they were not in cache
+ *=======================================*/
+INT
+get_cache_miss_count (void)
+{
+	return cache_misses;
+}
 /*============================================
  * ensure_cel_has_record -- Make sure cache element has record
  *  (node_to_cache, which creates cels, doesn't create records)
@@ -1073,6 +1091,7 @@ get_free_cacheel (CACHE cache)
 			crashlog(_("Cache [%s] overflowed its max size (%d)"), cacname(cache), cacmaxdir(cache));
 			ASSERT(0);
 		}
+		TRACE_INSTANT("cache", "evict", ckey(cel));
 		remove_from_cache(cache, ckey(cel));
 	}
 
@@ -1096,12 +1115,13 @@ static void
 set_all_nodetree_to_cel (NODE node, CACHEEL cel)
 {
 	BOOLEAN travdone = FALSE;
-	/* Now set all nodes in tree to point to cache record */
+	/* Now set all nodes in tree to point to cache record
+	(children not yet parsed get it from their parent when parsed) */
 	while (!travdone) {
 		node->n_cel = cel;
 		/* go to bottom of tree */
-		while (nchild(node)) {
-			node = nchild(node);
+		while (nchild_loaded(node)) {
+			node = nchild_loaded(node);
 			node->n_cel = cel;
 		}
 		/* find next node in traversal/ascent */
@@ -1131,12 +1151,13 @@ put_node_in_cache (CACHE cache, CACHEEL cel, NODE node, STRING key)
 	ckey(cel) = strsave(key);
 	cclock(cel) = FALSE;
 	first_direct(cache, cel);
-	/* Now set all nodes in tree to point to cache record */
+	/* Now set all nodes in tree to point to cache record
+	(children not yet parsed get it from their parent when parsed) */
 	while (!travdone) {
 		node->n_cel = cel;
 		/* go to bottom of tree */
-		while (nchild(node)) {
-			node = nchild(node);
+		while (nchild_loaded(node)) {
+			node = nchild_loaded(node);
 			node->n_cel = cel;
 		}
 		/* find next node in traversal/ascent */
@@ -1240,6 +1261,8 @@ remove_cel_from_cache (CACHE cache, CACHEEL cel, BOOLEAN delcache)
 		cnode(cel) = 0;
 		free_nodes(node);
 	}
+	free_indifacts(cfacts(cel));
+	cfacts(cel) = 0;
 
 	celnext = cacfree(cache);
 	cnext(cel) = celnext;
@@ -1498,6 +1521,15 @@ is_cel_loaded (CACHEEL cel)
 	if (!cel) return NULL;
 	return cnode(cel);
 }
+/*==============================================
+ * cacheel_facts -- Where derived facts of record are kept
+ *  (for indifacts.c, which fills it)
+ *============================================*/
+INDIFACTS *
+cacheel_facts (CACHEEL cel)
+{
+	return &cfacts(cel);
+}
 /*==============================================
  * cel_remove_record -- Our record informing us it is destructing
  *  Requires non-null inputs
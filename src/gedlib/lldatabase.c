@@ -92,6 +92,9 @@ void lldb_close (LLDATABASE *plldb)
 		destroy_table(placabbvs);
 		placabbvs = NULL;
 	}
+	free_closure_cache();
+	free_pedgraph();
+	free_textindex();
 	free_caches();
 	check_node_leaks();
 	check_record_leaks();
@@ -305,6 +305,7 @@ setmsgs (STRING localename)
 		notify_gettext_language_changed();
 		send_uilang_callbacks();
 		date_update_lang();
+		drop_indifacts();
 	}
 	return str;
 }
@@ -759,6 +759,40 @@ namecmp (STRING name1, STRING name2)
 	if (*p2) return -1;
 	return 0;
 }
+/*====================================
+ * namecollkey -- Append collation key of GEDCOM name
+ *  name: [IN]  GEDCOM name
+ *  zkey: [I/O] binary key to append to
+ * Keys of two names compare by memcmp as namecmp compares the
+ * names (surname, first initial, then each given name), so a
+ * sort can build them once instead of reparsing each name at
+ * every comparison
+ * returns FALSE if collation in use has no keys (see ll_strxfrmloc)
+ *==================================*/
+BOOLEAN
+namecollkey (CNSTRING name, ZSTR zkey)
+{
+	char sqz[MAXGEDNAMELEN];
+	STRING p = sqz;
+	INT finitial;
+	char fbuf[4];
+
+	if (!ll_strxfrmloc(getsxsurname(name), zkey))
+		return FALSE;
+	finitial = getfinitial(name);
+	fbuf[0] = (char)((finitial >> 24) & 0xFF);
+	fbuf[1] = (char)((finitial >> 16) & 0xFF);
+	fbuf[2] = (char)((finitial >> 8) & 0xFF);
+	fbuf[3] = (char)(finitial & 0xFF);
+	zs_appsn(zkey, fbuf, sizeof(fbuf));
+	cmpsqueeze(name, p);
+	for ( ; *p; p += strlen(p) + 1) {
+		if (!ll_strxfrmloc(p, zkey))
+			return FALSE;
+	}
+	/* empty last piece, so that a name with fewer givens sorts first */
+	return ll_strxfrmloc("", zkey);
+}
 /*===========================================================
  * cmpsqueeze -- Squeeze GEDCOM name to superstring of givens
  *  in:  [in] input string
@@ -1160,6 +1194,28 @@ traverse_names (TRAV_NAMES_FUNC func, void *param)
 	tparam.func = func;
 	traverse_db_rec_rkeys(BTR, name_lo(), name_hi(), &traverse_name_callback, &tparam);
 }
+/*====================================================
+ * traverse_name_rec -- traverse names of one raw btree
+ *  record, if it is a name record (for callers reading
+ *  the btree themselves, eg by traverse_db_blocks)
+ *  rawkey: [IN]  chars of record's RKEY
+ *  data:   [IN]  contents of record
+ * returns FALSE if not a name record
+ *==================================================*/
+BOOLEAN
+traverse_name_rec (CNSTRING rawkey, STRING data, TRAV_NAMES_FUNC func, void *param)
+{
+	TRAV_NAME_PARAM tparam;
+	RKEY rkey, lo = name_lo(), hi = name_hi();
+	memcpy(rkey.r_rkey, rawkey, sizeof(rkey.r_rkey));
+	if (!data || ll_strncmp(lo.r_rkey, rkey.r_rkey, 8) >= 0
+		|| ll_strncmp(hi.r_rkey, rkey.r_rkey, 8) < 0)
+		return FALSE;
+	tparam.param = param;
+	tparam.func = func;
+	traverse_name_callback(rkey, data, 0, &tparam);
+	return TRUE;
+}
 /*====================================================
  * flush_name_cache -- Clear any cached name records
  *==================================================*/
@@ -162,6 +162,7 @@ free_node (NODE node)
 {
 	if (nxref(node)) stdfree(nxref(node));
 	if (nval(node)) stdfree(nval(node));
+	if (nflag(node) & ND_LAZY) stdfree(node->n_lazy);
 
 	/*
 	tag is pointer into shared tagtable
@@ -217,9 +218,9 @@ void
 free_temp_node_tree (NODE node)
 {
 	NODE n2;
-	if ((n2 = nchild(node))) {
+	if ((n2 = nchild_loaded(node))) {
 		free_temp_node_tree(n2);
-		nchild(node) = 0;
+		nchild_loaded(node) = 0;
 	}
 	if ((n2 = nsibling(node))) {
 		free_temp_node_tree(n2);
@@ -254,7 +255,8 @@ free_nodes (NODE node)
 {
 	NODE sib;
 	while (node) {
-		if (nchild(node)) free_nodes(nchild(node));
+		/* children still unparsed are freed as text by free_node */
+		if (nchild_loaded(node)) free_nodes(nchild_loaded(node));
 		sib = nsibling(node);
 		free_node(node);
 		node = sib;
@@ -71,7 +71,8 @@ check_node_recursively (NODE node, NODE parent, INT level, CNSTRING key, CNSTRIN
 
 	check_node(node, parent, level, key, scope);
 
-	for (child = nchild(node); child; child = nsibling(child)) {
+	/* children not yet parsed are not checked (or parsed) */
+	for (child = nchild_loaded(node); child; child = nsibling(child)) {
 		check_node_recursively(child, node, level+1, key, scope);
 	}
 }
@@ -11,6 +11,9 @@
  *===========================================================*/
 
 #include "llstdlib.h"
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#endif
 #include "table.h"
 #include "translat.h"
 #include "gedcom.h"
@@ -20,6 +23,7 @@
 #include "date.h"
 #include "xlat.h"
 #include "cache.h"
+#include "lltrace.h"
 
 /*********************************************
  * global/exported variables
@@ -34,6 +38,24 @@ INT flineno = 0;
 extern STRING qSfileof, qSreremp, qSrerlng, qSrernlv, qSrerinc;
 extern STRING qSrerbln, qSrernwt, qSrerilv, qSrerwlv, qSunsupunix, qSunsupuniv;
 
+/*********************************************
+ * local types
+ *********************************************/
+
+/* whole GEDCOM file in memory (mapped if possible) */
+struct tag_gedbuf {
+	FILE *fp;
+	char *base;
+	size_t len;
+	size_t pos;      /* offset of next line */
+	BOOLEAN mapped;
+	char line[MAXLINELEN+2]; /* current line, tokenized in place */
+};
+
+/* subtrees (below level 1) at least this long are left as text
+when a record is read, until first used (see defer_subtree) */
+#define LAZY_MINLEN 256
+
 /*********************************************
  * local function prototypes, alphabetical
  *********************************************/
@@ -41,11 +63,16 @@ extern STRING qSrerbln, qSrernwt, qSrerilv, qSrerwlv, qSunsupunix, qSunsupuniv;
 /* alphabetical */
 static BOOLEAN buffer_to_line(STRING p, INT *plev, STRING *pxref
 	, STRING *ptag, STRING *pval, STRING *pmsg);
-static NODE do_first_fp_to_node(FILE *fp, BOOLEAN list, XLAT tt
+static void defer_subtree(STRING *pstr, NODE node, INT lev);
+static NODE do_first_to_node(FILE *fp, GEDBUF gb, BOOLEAN list, XLAT tt
+	, STRING *pmsg, BOOLEAN *peof);
+static NODE next_to_node(FILE *fp, GEDBUF gb, BOOLEAN list, XLAT ttm
 	, STRING *pmsg, BOOLEAN *peof);
+static INT read_line(FILE *fp, GEDBUF gb, XLAT ttm, STRING *pmsg);
 static void prefix_file(FILE *fp, XLAT tt);
 static BOOLEAN string_to_line(STRING *ps, INT *plev, STRING *pxref, 
 	STRING *ptag, STRING *pval, STRING *pmsg);
+static BOOLEAN string_to_nodes(STRING *pstr, NODE prnt, BOOLEAN lazy, NODE *proot);
 static STRING swrite_node(INT levl, NODE node, STRING p);
 static STRING swrite_nodes(INT levl, NODE node, STRING p);
 static BOOLEAN should_write_bom(void);
@@ -87,6 +114,165 @@ file_to_line (FILE *fp,
 	}
 	return buffer_to_line(p, plev, pxref, ptag, pval, pmsg);
 }
+/*==========================================
+ * open_gedbuf -- Load GEDCOM file for reading by lines
+ *  fp:   [IN]  open file, positioned where reading is to start
+ * The file is mapped into memory when the platform allows (else
+ * read in whole), so lines are found with a memchr scan instead of
+ * stdio, and seeking back is free. fp must stay open until
+ * close_gedbuf. Returns NULL if the file cannot be loaded.
+ *========================================*/
+GEDBUF
+open_gedbuf (FILE *fp)
+{
+	GEDBUF gb;
+	long start = ftell(fp);
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	struct stat sbuf;
+#endif
+
+	if (start < 0) {
+		/* no position is only expected of a pipe; a file whose
+		position cannot be told (eg, too big for long) is an error */
+		if (fseek(fp, 0, SEEK_CUR) == 0)
+			return NULL;
+		start = 0;
+	}
+	gb = (GEDBUF)stdalloc(sizeof(*gb));
+	gb->fp = fp;
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	if (fstat(fileno(fp), &sbuf) == 0 && S_ISREG(sbuf.st_mode)
+		&& sbuf.st_size > 0 && (off_t)(size_t)sbuf.st_size == sbuf.st_size) {
+		void * addr = mmap(NULL, (size_t)sbuf.st_size, PROT_READ
+			, MAP_PRIVATE, fileno(fp), 0);
+		if (addr != MAP_FAILED) {
+			gb->base = (char *)addr;
+			gb->len = (size_t)sbuf.st_size;
+			gb->mapped = TRUE;
+		}
+	}
+#endif
+	if (!gb->mapped) {
+		/* read it all (fine for pipes too) */
+		size_t size = 65536, n;
+		char * base;
+		rewind(fp);
+		gb->base = (char *)stdalloc(size);
+		while ((n = fread(gb->base + gb->len, 1, size - gb->len, fp)) > 0) {
+			gb->len += n;
+			if (gb->len == size) {
+				if (size > ((size_t)-1) / 2) {
+					/* cannot hold any more */
+					close_gedbuf(gb);
+					return NULL;
+				}
+				size *= 2;
+				/* not stdrealloc, which takes an INT size */
+				if (!(base = (char *)realloc(gb->base, size))) {
+					close_gedbuf(gb);
+					return NULL;
+				}
+				gb->base = base;
+			}
+		}
+		if (ferror(fp)) {
+			close_gedbuf(gb);
+			return NULL;
+		}
+	}
+	gb->pos = ((size_t)start < gb->len) ? (size_t)start : gb->len;
+	return gb;
+}
+/*==========================================
+ * close_gedbuf -- Release GEDCOM file buffer
+ *  the file itself is left open, positioned after what was read
+ *========================================*/
+void
+close_gedbuf (GEDBUF gb)
+{
+	if (!gb) return;
+	fseek(gb->fp, gb->pos, SEEK_SET);
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	if (gb->mapped) {
+		munmap(gb->base, (size_t)gb->len);
+		gb->base = 0;
+	}
+#endif
+	if (gb->base)
+		stdfree(gb->base);
+	stdfree(gb);
+}
+/*==========================================
+ * gedbuf_tell -- Offset of next line to be read
+ *========================================*/
+size_t
+gedbuf_tell (GEDBUF gb)
+{
+	return gb->pos;
+}
+/*==========================================
+ * gedbuf_seek -- Set offset of next line to be read
+ *========================================*/
+void
+gedbuf_seek (GEDBUF gb, size_t pos)
+{
+	gb->pos = (pos > gb->len) ? gb->len : pos;
+}
+/*==========================================
+ * gedbuf_check_unicode -- Check for BOM at current position
+ *  return descriptive string if found, or 0 if not
+ *  (see check_file_for_unicode); skips UTF-8 BOM
+ *========================================*/
+STRING
+gedbuf_check_unicode (GEDBUF gb)
+{
+	INT bomlen = 0;
+	size_t avail = gb->len - gb->pos;
+	/* a BOM is at most 4 bytes */
+	STRING unitype = check_buffer_for_unicode(gb->base + gb->pos
+		, (INT)(avail < 4 ? avail : 4), &bomlen);
+	gb->pos += bomlen;
+	return unitype;
+}
+/*==========================================
+ * gedbuf_to_line -- Get GEDCOM line from file buffer
+ *  as file_to_line, but the line is found with memchr and only
+ *  that line is copied (once, or into the translator if ttm)
+ *========================================*/
+INT
+gedbuf_to_line (GEDBUF gb,
+                XLAT ttm,
+                INT *plev,
+                STRING *pxref,
+                STRING *ptag,
+                STRING *pval,
+                STRING *pmsg)
+{
+	static char out[MAXLINELEN+2];
+	char *p, *nl;
+	size_t len;
+	*pmsg = NULL;
+	while (TRUE) {
+		if (gb->pos >= gb->len) return DONE;
+		p = gb->base + gb->pos;
+		nl = (char *)memchr(p, '\n', gb->len - gb->pos);
+		len = nl ? (size_t)(nl - p) : gb->len - gb->pos;
+		gb->pos += nl ? len + 1 : len;
+		/* longer lines are cut, & then rejected by buffer_to_line */
+		if (len > MAXLINELEN+1)
+			len = MAXLINELEN+1;
+		memcpy(gb->line, p, len);
+		gb->line[len] = 0;
+		p = gb->line;
+		flineno++;
+		if (ttm) {
+			translate_string(ttm, p, out, MAXLINELEN+2);
+			p = out;
+		}
+		if (!allwhite(p)) break;
+	}
+	return buffer_to_line(p, plev, pxref, ptag, pval, pmsg);
+}
 /*==============================================
  * string_to_line -- Get GEDCOM line from string
  *
@@ -170,9 +356,8 @@ buffer_to_line (STRING p, INT *plev, STRING *pxref
 		*pmsg = scratch;
 		return ERROR;
 	}
-	while (*p != '@') p++;
-	p++;
-	if (*p == 0) {
+	while (*p && *p != '@') p++;
+	if (*p == 0 || *++p == 0) {
 		sprintf(scratch, _(qSrerinc), flineno);
 		*pmsg = scratch;
 		return ERROR;
@@ -282,14 +467,15 @@ convert_first_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
 		*pmsg = _(qSunsupunix);
 		return NULL;
 	}
-	node = do_first_fp_to_node(fp, list, ttm, pmsg, peof);
+	node = do_first_to_node(fp, NULL, list, ttm, pmsg, peof);
 	nodechk(node, "convert_first_fp_to_node");
 	return node;
 }
 /*================================================================
- * do_first_fp_to_node -- Convert first GEDCOM record in file to tree
+ * do_first_to_node -- Convert first GEDCOM record in file to tree
  *
- *  fp:    [IN]  file that holds GEDCOM record/s
+ *  fp:    [IN]  file that holds GEDCOM record/s (if no gb)
+ *  gb:    [IN]  file buffer that holds GEDCOM record/s
  *  list:  [IN]  can be list at level 0?
  *  tt:    [IN]  character translation table
  *  *pmsg: [OUT] possible error message
@@ -298,7 +484,7 @@ convert_first_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
  * TODO: revise import (restore_record) so can delete this
  *==============================================================*/
 static NODE
-do_first_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
+do_first_to_node (FILE *fp, GEDBUF gb, BOOLEAN list, XLAT ttm,
 	STRING *pmsg,  BOOLEAN *peof)
 {
 	INT rc;
@@ -306,7 +492,7 @@ do_first_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
 	flineno = 0;
 	*pmsg = NULL;
 	*peof = FALSE;
-	rc = file_to_line(fp, ttm, &lev, &xref, &tag, &val, pmsg);
+	rc = read_line(fp, gb, ttm, pmsg);
 	if (rc == DONE) {
 		*peof = ateof = TRUE;
 		*pmsg = _(qSfileof);
@@ -315,7 +501,25 @@ do_first_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
 		return NULL;
 	lev0 = lev;
 	lahead = TRUE;
-	return next_fp_to_node(fp, list, ttm, pmsg, peof);
+	return next_to_node(fp, gb, list, ttm, pmsg, peof);
+}
+/*================================================================
+ * first_gedbuf_to_node -- Convert first GEDCOM record in buffer to tree
+ *  as convert_first_fp_to_node
+ *==============================================================*/
+NODE
+first_gedbuf_to_node (GEDBUF gb, BOOLEAN list, XLAT ttm,
+	STRING *pmsg,  BOOLEAN *peof)
+{
+	STRING unitype = gedbuf_check_unicode(gb);
+	NODE node=0;
+	if (unitype && !eqstr(unitype, "UTF-8")) {
+		*pmsg = _(qSunsupunix);
+		return NULL;
+	}
+	node = do_first_to_node(NULL, gb, list, ttm, pmsg, peof);
+	nodechk(node, "first_gedbuf_to_node");
+	return node;
 }
 /*==============================================================
  * next_fp_to_record -- Convert next GEDCOM record in file to tree
@@ -347,6 +551,39 @@ next_fp_to_record (FILE *fp, BOOLEAN list, XLAT ttm,
 NODE
 next_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
 	STRING *pmsg, BOOLEAN *peof)
+{
+	return next_to_node(fp, NULL, list, ttm, pmsg, peof);
+}
+/*==============================================================
+ * next_gedbuf_to_node -- Convert next GEDCOM record in buffer to tree
+ *  as next_fp_to_node
+ *============================================================*/
+NODE
+next_gedbuf_to_node (GEDBUF gb, BOOLEAN list, XLAT ttm,
+	STRING *pmsg, BOOLEAN *peof)
+{
+	return next_to_node(NULL, gb, list, ttm, pmsg, peof);
+}
+/*==============================================================
+ * read_line -- Read next line into the parser's line variables
+ *  from gb if given, else from fp
+ *============================================================*/
+static INT
+read_line (FILE *fp, GEDBUF gb, XLAT ttm, STRING *pmsg)
+{
+	if (gb)
+		return gedbuf_to_line(gb, ttm, &lev, &xref, &tag, &val, pmsg);
+	return file_to_line(fp, ttm, &lev, &xref, &tag, &val, pmsg);
+}
+/*==============================================================
+ * next_to_node -- Convert next GEDCOM record to tree
+ *  fp:   [IN]  file that holds GEDCOM record/s (if no gb)
+ *  gb:   [IN]  file buffer that holds GEDCOM record/s
+ *  (see next_fp_to_node)
+ *============================================================*/
+static NODE
+next_to_node (FILE *fp, GEDBUF gb, BOOLEAN list, XLAT ttm,
+	STRING *pmsg, BOOLEAN *peof)
 {
 	INT curlev, bcode, rc;
 	NODE root, node, curnode;
@@ -359,7 +596,7 @@ next_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
 		return NULL;
 	}
 	if (!lahead) {
-		rc = file_to_line(fp, ttm, &lev, &xref, &tag, &val, pmsg);
+		rc = read_line(fp, gb, ttm, pmsg);
 		if (rc == DONE) {
 			ateof = *peof = TRUE;
 			return NULL;
@@ -374,7 +611,7 @@ next_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
 	}
 	root = curnode = create_node(xref, tag, val, NULL);
 	bcode = OKAY;
-	rc = file_to_line(fp, ttm, &lev, &xref, &tag, &val, pmsg);
+	rc = read_line(fp, gb, ttm, pmsg);
 	while (rc == OKAY) {
 		if (lev == curlev) {
 			if (lev == lev0 && !list) {
@@ -413,7 +650,7 @@ next_fp_to_node (FILE *fp, BOOLEAN list, XLAT ttm,
 			bcode = ERROR;
 			break;
 		}
-		rc = file_to_line(fp, ttm, &lev, &xref, &tag, &val, pmsg);
+		rc = read_line(fp, gb, ttm, pmsg);
 	}
 	if (bcode == DONE) return root;
 	if (bcode == ERROR || rc == ERROR) {
@@ -442,7 +679,17 @@ string_to_record (STRING str, CNSTRING key, INT len)
 
 	if (*str == '0') { /* traditional node, no metadata */
 		/* actually no metadata was ever used in any version */
-		node = string_to_node(str);
+		TRACE_TIME tt;
+		TRACE_BEGIN(tt);
+		flineno = 0;
+		/* long subtrees (eg, notes) are only parsed when used */
+		if (!string_to_nodes(&str, NULL, TRUE, &node)) {
+			free_nodes(node);
+			node = NULL;
+		} else {
+			nodechk(node, "string_to_record");
+		}
+		TRACE_END(tt, "gedcom", "string_to_record", key);
 	} else {
 		if (!strcmp(str, "DELE\n")) {
 			/* should have been filtered out in getrecord */
@@ -462,6 +709,30 @@ string_to_record (STRING str, CNSTRING key, INT len)
  *======================================*/
 NODE
 string_to_node (STRING str)
+{
+	NODE root=NULL;
+	TRACE_TIME tt;
+	TRACE_BEGIN(tt);
+	flineno = 0;
+	if (!string_to_nodes(&str, NULL, FALSE, &root)) {
+		free_nodes(root);
+		root = NULL;
+	} else {
+		nodechk(root, "string_to_node");
+	}
+	TRACE_END(tt, "gedcom", "string_to_node", root ? nxref(root) : NULL);
+	return root;
+}
+/*========================================
+ * string_to_nodes -- Read lines from string into tree
+ *  pstr:  [I/O] string (advanced; 0s are put between lines)
+ *  prnt:  [IN]  parent of nodes read (NULL for a record)
+ *  lazy:  [IN]  leave long subtrees of level 1 nodes as text?
+ *  proot: [OUT] first node read (even if there was an error)
+ * returns FALSE if a line was bad
+ *======================================*/
+static BOOLEAN
+string_to_nodes (STRING *pstr, NODE prnt, BOOLEAN lazy, NODE *proot)
 {
 	INT lev;
 	INT lev0;
@@ -472,12 +743,12 @@ string_to_node (STRING str)
 	INT curlev;
 	NODE root=NULL, node, curnode;
 	STRING msg;
-	flineno = 0;
-	if (!string_to_line(&str, &lev, &xref, &tag, &val, &msg))
-		goto string_to_node_fail;
+	*proot = NULL;
+	if (!string_to_line(pstr, &lev, &xref, &tag, &val, &msg))
+		return FALSE;
 	lev0 = curlev = lev;
-	root = curnode = create_node(xref, tag, val, NULL);
-	while (string_to_line(&str, &lev, &xref, &tag, &val, &msg)) {
+	*proot = root = curnode = create_node(xref, tag, val, prnt);
+	while (string_to_line(pstr, &lev, &xref, &tag, &val, &msg)) {
 		if (lev == curlev) {
 			node = create_node(xref, tag, val, nparent(curnode));
 			nsibling(curnode) = node;
@@ -491,7 +762,7 @@ string_to_node (STRING str)
 			if (lev < lev0) {
 				llwprintf("Error: line %d: illegal level",
 				    flineno);
-				goto string_to_node_fail;
+				return FALSE;
 			}
 			while (lev < curlev) {
 				curnode = nparent(curnode);
@@ -502,16 +773,83 @@ string_to_node (STRING str)
 			curnode = node;
 		} else {
 			llwprintf("Error: line %d: illegal level", flineno);
-			goto string_to_node_fail;
+			return FALSE;
 		}
+		if (lazy && lev == lev0 + 1)
+			defer_subtree(pstr, node, lev);
 	}
-	if (!msg) {
-		nodechk(root, "string_to_node");
-		return root;
+	return !msg;
+}
+/*========================================
+ * defer_subtree -- Keep lines below node as text, if there
+ *  are many, to be parsed when first used (see nchild)
+ *  pstr: [I/O] string, just past node's line (advanced
+ *               past the lines, if they are kept)
+ *  node: [I/O] node just read
+ *  lev:  [IN]  level of node
+ * Lines are only kept if each passes buffer_to_line and their
+ * levels nest, so that a bad line is still found when the
+ * record is read.
+ *======================================*/
+static void
+defer_subtree (STRING *pstr, NODE node, INT lev)
+{
+	static char line[MAXLINELEN+2];
+	STRING p = *pstr;
+	STRING xref, tag, val, msg;
+	INT prevlev = lev, l, len;
+
+	while (*p) {
+		STRING q = p;
+		while (*q && *q != '\n')
+			++q;
+		len = q - p;
+		if (len > MAXLINELEN+1)
+			return;
+		memcpy(line, p, len);
+		line[len] = 0;
+		if (buffer_to_line(line, &l, &xref, &tag, &val, &msg) != OKAY)
+			return;
+		if (l <= lev)
+			break;
+		if (l > prevlev + 1)
+			return;
+		prevlev = l;
+		p = (*q ? q + 1 : q);
+	}
+	len = p - *pstr;
+	if (len < LAZY_MINLEN)
+		return;
+	node->n_lazy = (STRING)stdalloc(len + 1);
+	memcpy(node->n_lazy, *pstr, len);
+	node->n_lazy[len] = 0;
+	nflag(node) |= ND_LAZY;
+	*pstr = p;
+}
+/*========================================
+ * load_lazy_children -- Parse children left as text
+ *  node: [IN]  node with ND_LAZY set
+ * Called (through nchild) on first use of the children.
+ * returns address of node's child pointer
+ *======================================*/
+NODE *
+load_lazy_children (NODE node)
+{
+	STRING text = node->n_lazy, str = text;
+	NODE kids=NULL;
+	TRACE_TIME tt;
+
+	TRACE_BEGIN(tt);
+	node->n_lazy = NULL;
+	nflag(node) &= ~ND_LAZY;
+	if (!string_to_nodes(&str, node, FALSE, &kids)) {
+		/* record was bad; keep what could be read */
+		llwprintf("Error: bad line below %s", ntag(node));
 	}
-string_to_node_fail:
-	free_nodes(root);
-	return NULL;
+	node->n_child = kids;
+	stdfree(text);
+	TRACE_END(tt, "gedcom", "load_lazy_children", ntag(node));
+	return &node->n_child;
 }
 #if 0
 /*============================================
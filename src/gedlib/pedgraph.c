@@ -0,0 +1,427 @@
+/*=============================================================
+ * pedgraph.c -- Pedigree links of whole database as flat arrays
+ *  For each person, the families in which the person is a child
+ *  (FAMC) or spouse (FAMS); for each family, its husbands,
+ *  wives and children. Each kind of link is held in compressed
+ *  sparse row form: an offset array indexed by key number and
+ *  one array of linked key numbers, in record order. So walking
+ *  the pedigree needs no records loaded or parsed at all.
+ *  Built on first use with one pass over the raw database
+ *  records. Records written after that (every add, edit, merge
+ *  and delete goes through store_record) are parsed again and
+ *  kept in a small overlay, until there are so many that the
+ *  graph is simply dropped and built afresh when next needed.
+ *==============================================================*/
+
+#include "llstdlib.h"
+#include "table.h"
+#include "gedcom.h"
+#include "btree.h"
+
+extern BTREE BTR;
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* links of one record written since graph was built */
+typedef struct tag_pedrec {
+	INT count[PG_NKINDS];
+	INT *links[PG_NKINDS];
+} *PEDREC;
+
+/* links of one kind, collected while building or parsing */
+typedef struct tag_linkbuf {
+	INT count;
+	INT max;
+	INT *from;    /* key number of record holding link */
+	INT *to;      /* key number link points to */
+} LINKBUF;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static BOOLEAN build_callback(CNSTRING key, STRING data, INT len, void *param);
+static BOOLEAN build_pedgraph(void);
+static void destroy_pedrec(VPTR ptr);
+static unsigned char * get_flag(char ntype, INT keynum, BOOLEAN grow);
+static void linkbuf_add(LINKBUF * buf, INT from, INT to);
+static BOOLEAN parse_links(CNSTRING rec, INT len, char ntype, INT keynum, LINKBUF * bufs);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+/* flag bits, one byte per key number */
+#define PG_PRESENT  1   /* live record of this key exists */
+#define PG_OVERLAY  2   /* links come from overlay, not arrays */
+
+/* drop graph when overlay reaches this (plus 1/8 of records) */
+#define MAXOVERLAY 1024
+
+static BOOLEAN built = FALSE;
+static INT nkeys[PG_NKINDS];       /* size of each offset array - 1 */
+static INT *offsets[PG_NKINDS];    /* links of key k: offsets[k]..[k+1] */
+static INT *targets[PG_NKINDS];    /* all links of each kind */
+static unsigned char *iflags = 0;  /* PG_ flags by person key number */
+static unsigned char *fflags = 0;  /* PG_ flags by family key number */
+static INT niflags = 0, nfflags = 0;
+static INT nrecords = 0;           /* records seen when built */
+static TABLE overlay = 0;          /* PEDREC by key */
+static INT noverlay = 0;
+
+/* tag, type of record holding it, type of record it points to */
+static struct {
+	CNSTRING tag;
+	char fromtype;
+	char totype;
+} linkinfo[PG_NKINDS] = {
+	{ "FAMC", 'I', 'F' },
+	{ "FAMS", 'I', 'F' },
+	{ "HUSB", 'F', 'I' },
+	{ "WIFE", 'F', 'I' },
+	{ "HUSB/WIFE", 'F', 'I' },
+	{ "CHIL", 'F', 'I' },
+};
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*=============================================
+ * pedgraph_links -- Get links of one kind from one record
+ *  kind:   [IN]  PG_FAMC etc
+ *  keynum: [IN]  key number of person (PG_FAMC, PG_FAMS)
+ *                or of family (other kinds)
+ *  plinks: [OUT] key numbers linked to, in record order
+ *                (valid until next record is written)
+ * Only the first run of each tag counts (as in FORFAMCS etc),
+ * except PG_SPOUSE has every HUSB & WIFE (as in FORFAMSPOUSES).
+ * Links may point to missing records: see pedgraph_has_record.
+ * Returns number of links
+ *===========================================*/
+INT
+pedgraph_links (INT kind, INT keynum, const INT ** plinks)
+{
+	unsigned char * flag;
+	*plinks = 0;
+	ASSERT(kind >= 0 && kind < PG_NKINDS);
+	if (!built && !build_pedgraph())
+		return 0;
+	flag = get_flag(linkinfo[kind].fromtype, keynum, FALSE);
+	if (!flag || !(*flag & PG_PRESENT))
+		return 0;
+	if (*flag & PG_OVERLAY) {
+		char key[20];
+		PEDREC prec;
+		snprintf(key, sizeof(key), "%c%d", linkinfo[kind].fromtype, keynum);
+		prec = (PEDREC)valueof_ptr(overlay, key);
+		if (!prec) return 0;
+		*plinks = prec->links[kind];
+		return prec->count[kind];
+	}
+	if (keynum >= nkeys[kind])
+		return 0;
+	*plinks = targets[kind] + offsets[kind][keynum];
+	return offsets[kind][keynum+1] - offsets[kind][keynum];
+}
+/*=============================================
+ * pedgraph_target_type -- Type of record links of kind point to
+ *  returns 'I' or 'F'
+ *===========================================*/
+char
+pedgraph_target_type (INT kind)
+{
+	ASSERT(kind >= 0 && kind < PG_NKINDS);
+	return linkinfo[kind].totype;
+}
+/*=============================================
+ * pedgraph_has_record -- Is there a live record with this key ?
+ *  ntype:  [IN]  'I' or 'F'
+ *  keynum: [IN]  key number
+ *===========================================*/
+BOOLEAN
+pedgraph_has_record (char ntype, INT keynum)
+{
+	unsigned char * flag;
+	if (!built && !build_pedgraph())
+		return FALSE;
+	flag = get_flag(ntype, keynum, FALSE);
+	return flag && (*flag & PG_PRESENT);
+}
+/*=============================================
+ * pedgraph_note_record -- Record written to database
+ *  key:  [IN]  key of record (eg, "I23")
+ *  rec:  [IN]  new contents of record ("DELE\n" if deleted)
+ *  len:  [IN]  length of rec
+ * Called by store_record, so covers adds, edits & deletes
+ *===========================================*/
+void
+pedgraph_note_record (CNSTRING key, CNSTRING rec, INT len)
+{
+	LINKBUF bufs[PG_NKINDS];
+	PEDREC prec;
+	unsigned char * flag;
+	INT keynum, kind, i;
+	char ntype = key[0];
+	if (!built) return;
+	if (ntype != 'I' && ntype != 'F') return;
+	keynum = atoi(key+1);
+	if (keynum <= 0) return;
+
+	if (noverlay >= MAXOVERLAY + nrecords/8) {
+		/* too much changed, start over when next needed */
+		free_pedgraph();
+		return;
+	}
+	memset(bufs, 0, sizeof(bufs));
+	prec = (PEDREC)stdalloc(sizeof(*prec));
+	flag = get_flag(ntype, keynum, TRUE);
+	if (parse_links(rec, len, ntype, keynum, bufs))
+		*flag |= PG_PRESENT;
+	else
+		*flag &= ~PG_PRESENT;
+	for (kind = 0; kind < PG_NKINDS; ++kind) {
+		LINKBUF * buf = &bufs[kind];
+		if (!buf->count) continue;
+		prec->count[kind] = buf->count;
+		prec->links[kind] = (INT *)stdalloc(buf->count * sizeof(INT));
+		for (i = 0; i < buf->count; ++i)
+			prec->links[kind][i] = buf->to[i];
+		stdfree(buf->from);
+		stdfree(buf->to);
+	}
+	if (!(*flag & PG_OVERLAY)) {
+		*flag |= PG_OVERLAY;
+		++noverlay;
+	}
+	/* table frees any earlier overlay of same record */
+	insert_table_ptr(overlay, key, prec);
+}
+/*=============================================
+ * free_pedgraph -- Release all memory of graph
+ *  (eg, database closing)
+ *===========================================*/
+void
+free_pedgraph (void)
+{
+	INT kind;
+	for (kind = 0; kind < PG_NKINDS; ++kind) {
+		stdfree(offsets[kind]);
+		stdfree(targets[kind]);
+		offsets[kind] = targets[kind] = 0;
+		nkeys[kind] = 0;
+	}
+	stdfree(iflags);
+	stdfree(fflags);
+	iflags = fflags = 0;
+	niflags = nfflags = 0;
+	if (overlay) {
+		destroy_table(overlay);
+		overlay = 0;
+	}
+	noverlay = 0;
+	nrecords = 0;
+	built = FALSE;
+}
+/*=============================================
+ * build_pedgraph -- Read links of every person & family
+ *  returns FALSE if no database open
+ *===========================================*/
+static BOOLEAN
+build_pedgraph (void)
+{
+	LINKBUF bufs[PG_NKINDS];
+	INT kind, i;
+	if (!BTR) return FALSE;
+	memset(bufs, 0, sizeof(bufs));
+	free_pedgraph();
+	built = TRUE;
+	overlay = create_table_custom_vptr(destroy_pedrec);
+	/* btree keys are right justified, so no span holds just I & F */
+	traverse_db_rec_keys(NULL, NULL, build_callback, bufs);
+
+	/* counting sort each kind by key number; stable, so record
+	order of links is kept */
+	for (kind = 0; kind < PG_NKINDS; ++kind) {
+		LINKBUF * buf = &bufs[kind];
+		INT n = (linkinfo[kind].fromtype == 'I') ? niflags : nfflags;
+		INT *off = (INT *)stdalloc((n+1) * sizeof(INT));
+		INT *tgt = (INT *)stdalloc((buf->count ? buf->count : 1) * sizeof(INT));
+		INT *fill = (INT *)stdalloc((n+1) * sizeof(INT));
+		for (i = 0; i < buf->count; ++i)
+			++off[buf->from[i]+1];
+		for (i = 0; i < n; ++i)
+			off[i+1] += off[i];
+		memcpy(fill, off, (n+1) * sizeof(INT));
+		for (i = 0; i < buf->count; ++i)
+			tgt[fill[buf->from[i]]++] = buf->to[i];
+		stdfree(fill);
+		stdfree(buf->from);
+		stdfree(buf->to);
+		offsets[kind] = off;
+		targets[kind] = tgt;
+		nkeys[kind] = n;
+	}
+	return TRUE;
+}
+/*=============================================
+ * build_callback -- Collect links of one raw record
+ *===========================================*/
+static BOOLEAN
+build_callback (CNSTRING key, STRING data, INT len, void *param)
+{
+	LINKBUF * bufs = (LINKBUF *)param;
+	char ntype = key[0];
+	INT keynum;
+	if ((ntype != 'I' && ntype != 'F') || !isdigit((uchar)key[1]))
+		return TRUE;
+	keynum = atoi(key+1);
+	if (keynum <= 0) return TRUE;
+	/* flag arrays must cover every key number used in links */
+	get_flag(ntype, keynum, TRUE);
+	if (parse_links(data, len, ntype, keynum, bufs)) {
+		*get_flag(ntype, keynum, TRUE) |= PG_PRESENT;
+		++nrecords;
+	}
+	return TRUE;
+}
+/*=============================================
+ * parse_links -- Find pedigree links in raw record text
+ *  Looks only at level 1 lines, with values of form @X123@
+ *  bufs: [I/O] links found are appended here
+ * Returns FALSE if record is deleted ("DELE")
+ *===========================================*/
+static BOOLEAN
+parse_links (CNSTRING rec, INT len, char ntype, INT keynum, LINKBUF * bufs)
+{
+	CNSTRING p = rec, end = rec + len;
+	BOOLEAN done[PG_NKINDS];
+	BOOLEAN inrun[PG_NKINDS];
+	INT kind;
+	if (len >= 4 && !strncmp(rec, "DELE", 4))
+		return FALSE;
+	memset(done, 0, sizeof(done));
+	memset(inrun, 0, sizeof(inrun));
+	while (p < end) {
+		CNSTRING eol = memchr(p, '\n', end - p);
+		CNSTRING tag, val;
+		INT taglen, target=0;
+		if (!eol) eol = end;
+		while (p < eol && (*p == ' ' || *p == '\t')) ++p;
+		if (p + 1 >= eol || p[0] != '1' || (p[1] != ' ' && p[1] != '\t')) {
+			/* deeper lines do not end a run of level 1 tags */
+			p = eol + 1;
+			continue;
+		}
+		tag = p + 2;
+		while (tag < eol && (*tag == ' ' || *tag == '\t')) ++tag;
+		for (val = tag; val < eol && *val != ' ' && *val != '\t'; ++val)
+			;
+		taglen = val - tag;
+		while (val < eol && (*val == ' ' || *val == '\t')) ++val;
+		for (kind = 0; kind < PG_NKINDS; ++kind) {
+			BOOLEAN match;
+			if (linkinfo[kind].fromtype != ntype) continue;
+			if (kind == PG_SPOUSE)
+				match = (taglen == 4 && (!strncmp(tag, "HUSB", 4) || !strncmp(tag, "WIFE", 4)));
+			else
+				match = (taglen == 4 && !strncmp(tag, linkinfo[kind].tag, 4));
+			if (!match) {
+				/* first run of this tag has ended */
+				if (inrun[kind] && kind != PG_SPOUSE)
+					done[kind] = TRUE;
+				inrun[kind] = FALSE;
+				continue;
+			}
+			inrun[kind] = TRUE;
+			if (done[kind]) continue;
+			if (!target) {
+				/* value must be @X123@ pointing to right type */
+				CNSTRING q = val;
+				if (q+3 < eol && q[0] == '@' && q[1] == linkinfo[kind].totype
+					&& isdigit((uchar)q[2])) {
+					target = atoi(q+2);
+					for (q += 2; q < eol && isdigit((uchar)*q); ++q)
+						;
+					if (q >= eol || *q != '@')
+						target = 0;
+				}
+				if (target <= 0)
+					target = -1;
+			}
+			if (target > 0) {
+				linkbuf_add(&bufs[kind], keynum, target);
+				/* flag arrays must cover link targets too */
+				get_flag(linkinfo[kind].totype, target, TRUE);
+			}
+		}
+		p = eol + 1;
+	}
+	return TRUE;
+}
+/*=============================================
+ * linkbuf_add -- Append one link to buffer
+ *===========================================*/
+static void
+linkbuf_add (LINKBUF * buf, INT from, INT to)
+{
+	if (buf->count == buf->max) {
+		INT newmax = buf->max ? 2 * buf->max : 1024;
+		INT *newfrom = (INT *)stdalloc(newmax * sizeof(INT));
+		INT *newto = (INT *)stdalloc(newmax * sizeof(INT));
+		if (buf->count) {
+			memcpy(newfrom, buf->from, buf->count * sizeof(INT));
+			memcpy(newto, buf->to, buf->count * sizeof(INT));
+		}
+		stdfree(buf->from);
+		stdfree(buf->to);
+		buf->from = newfrom;
+		buf->to = newto;
+		buf->max = newmax;
+	}
+	buf->from[buf->count] = from;
+	buf->to[buf->count] = to;
+	++buf->count;
+}
+/*=============================================
+ * get_flag -- Find flag byte of person or family
+ *  grow: [IN]  enlarge flag array if needed ?
+ * returns NULL if key number beyond array (and not grow)
+ *===========================================*/
+static unsigned char *
+get_flag (char ntype, INT keynum, BOOLEAN grow)
+{
+	unsigned char **pflags = (ntype == 'I') ? &iflags : &fflags;
+	INT *pnum = (ntype == 'I') ? &niflags : &nfflags;
+	if (keynum <= 0) return NULL;
+	if (keynum >= *pnum) {
+		INT newnum = *pnum ? *pnum : 1024;
+		unsigned char * newflags;
+		if (!grow) return NULL;
+		while (newnum <= keynum)
+			newnum *= 2;
+		newflags = (unsigned char *)stdalloc(newnum);
+		if (*pnum)
+			memcpy(newflags, *pflags, *pnum);
+		stdfree(*pflags);
+		*pflags = newflags;
+		*pnum = newnum;
+	}
+	return &(*pflags)[keynum];
+}
+/*=============================================
+ * destroy_pedrec -- Free overlay entry (table callback)
+ *===========================================*/
+static void
+destroy_pedrec (VPTR ptr)
+{
+	PEDREC prec = (PEDREC)ptr;
+	INT kind;
+	for (kind = 0; kind < PG_NKINDS; ++kind)
+		stdfree(prec->links[kind]);
+	stdfree(prec);
+}
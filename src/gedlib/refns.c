@@ -704,3 +704,25 @@ traverse_refns (TRAV_REFNS_FUNC func, void *param)
 	tparam.func = func;
 	traverse_db_rec_rkeys(BTR, refn_lo(), refn_hi(), &traverse_refn_callback, &tparam);
 }
+/*====================================================
+ * traverse_refn_rec -- traverse refns of one raw btree
+ *  record, if it is a refn record (for callers reading
+ *  the btree themselves, eg by traverse_db_blocks)
+ *  rawkey: [IN]  chars of record's RKEY
+ *  data:   [IN]  contents of record
+ * returns FALSE if not a refn record
+ *==================================================*/
+BOOLEAN
+traverse_refn_rec (CNSTRING rawkey, STRING data, TRAV_REFNS_FUNC func, void *param)
+{
+	TRAV_REFN_PARAM tparam;
+	RKEY rkey, lo = refn_lo(), hi = refn_hi();
+	memcpy(rkey.r_rkey, rawkey, sizeof(rkey.r_rkey));
+	if (!data || ll_strncmp(lo.r_rkey, rkey.r_rkey, 8) >= 0
+		|| ll_strncmp(hi.r_rkey, rkey.r_rkey, 8) < 0)
+		return FALSE;
+	tparam.param = param;
+	tparam.func = func;
+	traverse_refn_callback(rkey, data, 0, &tparam);
+	return TRUE;
+}
@@ -0,0 +1,427 @@
+/*=============================================================
+ * relcache.c -- Cached ancestor & descendant closures
+ *  A closure is every ancestor (or descendant) of one person,
+ *  optionally limited to a number of generations, held as arrays
+ *  of key numbers (in breadth-first order, and sorted for lookup).
+ *  Closures are kept in a cache keyed by person, direction and
+ *  generation limit, so repeated relationship queries from a
+ *  report do not walk the pedigree again. The whole cache is
+ *  dropped whenever any person or family record is written.
+ *==============================================================*/
+
+#include "llstdlib.h"
+#include "table.h"
+#include "gedcom.h"
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* key number & generation, for sorted lookup */
+typedef struct tag_relent {
+	INT keynum;
+	INT gen;
+} RELENT;
+
+struct tag_relclosure {
+	INT refcnt;
+	INT count;
+	INT *keynums;   /* in breadth-first order */
+	INT *gens;      /* generation of each entry in keynums */
+	RELENT *sorted; /* same entries, ordered by keynum */
+};
+
+/* growable bitmap of key numbers already visited */
+typedef struct tag_markset {
+	unsigned char *bits;
+	INT size;       /* bytes allocated */
+} MARKSET;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static void append_entry(RELCLOSURE clos, INT *pmax, INT keynum, INT gen);
+static RELCLOSURE build_closure(CNSTRING ikey, BOOLEAN up, INT maxgen);
+static void clear_mark(MARKSET * marks, INT keynum);
+static INT compare_relents(const void * p1, const void * p2);
+static void destroy_closure_el(VPTR ptr);
+static RELCLOSURE get_closure(CNSTRING ikey, BOOLEAN up, INT maxgen);
+static void on_record_change(VPTR uparm);
+static BOOLEAN test_and_mark(MARKSET * marks, INT keynum);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+/* Drop everything once the cache holds this many entries in all */
+#define MAXCACHED 4000000
+
+static TABLE closures = 0;     /* RELCLOSURE by "A<key>:<maxgen>" etc */
+static INT ncached = 0;        /* total entries in all cached closures */
+static BOOLEAN registered = FALSE;
+static MARKSET imarks;         /* people visited by build_closure */
+static MARKSET fmarks;         /* families visited by build_closure */
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*=============================================
+ * ancestor_closure -- Get all ancestors of a person
+ *  ikey:   [IN]  key of person (eg, "I23")
+ *  maxgen: [IN]  generations to go back (0 for all)
+ * Caller must release_closure the result
+ *===========================================*/
+RELCLOSURE
+ancestor_closure (CNSTRING ikey, INT maxgen)
+{
+	return get_closure(ikey, TRUE, maxgen);
+}
+/*=============================================
+ * descendant_closure -- Get all descendants of a person
+ *  ikey:   [IN]  key of person (eg, "I23")
+ *  maxgen: [IN]  generations to go down (0 for all)
+ * Caller must release_closure the result
+ *===========================================*/
+RELCLOSURE
+descendant_closure (CNSTRING ikey, INT maxgen)
+{
+	return get_closure(ikey, FALSE, maxgen);
+}
+/*=============================================
+ * release_closure -- Caller is done with closure
+ *===========================================*/
+void
+release_closure (RELCLOSURE clos)
+{
+	if (!clos) return;
+	if (--clos->refcnt) return;
+	stdfree(clos->keynums);
+	stdfree(clos->gens);
+	stdfree(clos->sorted);
+	stdfree(clos);
+}
+/*=============================================
+ * closure_length -- Number of people in closure
+ *===========================================*/
+INT
+closure_length (RELCLOSURE clos)
+{
+	return clos ? clos->count : 0;
+}
+/*=============================================
+ * closure_entry -- Get one person of closure
+ *  i:    [IN]  index (0..length-1, breadth-first order)
+ *  pgen: [OUT] generation of person (1 = parent or child)
+ * returns key number of person
+ *===========================================*/
+INT
+closure_entry (RELCLOSURE clos, INT i, INT * pgen)
+{
+	ASSERT(clos && i >= 0 && i < clos->count);
+	if (pgen)
+		*pgen = clos->gens[i];
+	return clos->keynums[i];
+}
+/*=============================================
+ * closure_find -- Look up person in closure
+ *  keynum: [IN]  key number of person (eg, 23 for I23)
+ * returns generation of person, or 0 if not in closure
+ *===========================================*/
+INT
+closure_find (RELCLOSURE clos, INT keynum)
+{
+	INT lo=0, hi;
+	if (!clos) return 0;
+	hi = clos->count - 1;
+	while (lo <= hi) {
+		INT mid = (lo + hi) / 2;
+		INT knum = clos->sorted[mid].keynum;
+		if (knum == keynum)
+			return clos->sorted[mid].gen;
+		if (knum < keynum)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+	return 0;
+}
+/*=============================================
+ * closest_common_ancestors -- Find nearest shared ancestors
+ *  key1:     [IN]  first person
+ *  key2:     [IN]  second person
+ *  pkeynums: [OUT] key numbers of common ancestors (caller frees)
+ *  pgens1:   [OUT] generations above first person (caller frees)
+ *  pgens2:   [OUT] generations above second person (caller frees)
+ * Each person counts as an ancestor of self at generation 0, so
+ * if one is an ancestor of the other, that one is the answer.
+ * Returns every common ancestor with least total generations,
+ * nearest to key1 first (0 if none, and nothing is allocated).
+ *===========================================*/
+INT
+closest_common_ancestors (CNSTRING key1, CNSTRING key2
+	, INT ** pkeynums, INT ** pgens1, INT ** pgens2)
+{
+	RELCLOSURE anc1, anc2;
+	INT knum1 = atoi(key1+1), knum2 = atoi(key2+1);
+	INT best = -1, count = 0, i;
+	INT *keynums=0, *gens1=0, *gens2=0;
+
+	*pkeynums = *pgens1 = *pgens2 = 0;
+	anc1 = ancestor_closure(key1, 0);
+	anc2 = ancestor_closure(key2, 0);
+	/* i == -1 is key1 itself */
+	for (i = -1; i < anc1->count; ++i) {
+		INT knum = (i < 0) ? knum1 : anc1->keynums[i];
+		INT g1 = (i < 0) ? 0 : anc1->gens[i];
+		INT g2 = (knum == knum2) ? 0 : closure_find(anc2, knum);
+		if (i >= 0 && knum == knum1)
+			continue; /* in own ancestry, already done at gen 0 */
+		if (!g2 && knum != knum2)
+			continue;
+		if (best >= 0 && g1 > best)
+			break; /* breadth-first, so nothing nearer follows */
+		if (best < 0 || g1 + g2 < best) {
+			best = g1 + g2;
+			count = 0;
+		} else if (g1 + g2 > best) {
+			continue;
+		}
+		if (!keynums) {
+			INT n = anc1->count + 1;
+			keynums = (INT *)stdalloc(n * sizeof(INT));
+			gens1 = (INT *)stdalloc(n * sizeof(INT));
+			gens2 = (INT *)stdalloc(n * sizeof(INT));
+		}
+		keynums[count] = knum;
+		gens1[count] = g1;
+		gens2[count] = g2;
+		++count;
+	}
+	release_closure(anc1);
+	release_closure(anc2);
+	if (count) {
+		*pkeynums = keynums;
+		*pgens1 = gens1;
+		*pgens2 = gens2;
+	} else if (keynums) {
+		stdfree(keynums);
+		stdfree(gens1);
+		stdfree(gens2);
+	}
+	return count;
+}
+/*=============================================
+ * free_closure_cache -- Drop all cached closures
+ *  (eg, database closing)
+ *===========================================*/
+void
+free_closure_cache (void)
+{
+	if (closures) {
+		destroy_table(closures);
+		closures = 0;
+	}
+	ncached = 0;
+	if (registered) {
+		unregister_record_change_callback(on_record_change, 0);
+		registered = FALSE;
+	}
+	stdfree(imarks.bits);
+	stdfree(fmarks.bits);
+	memset(&imarks, 0, sizeof(imarks));
+	memset(&fmarks, 0, sizeof(fmarks));
+}
+/*=============================================
+ * on_record_change -- Database record written
+ *  Pedigree may have changed, so nothing cached can be trusted
+ *===========================================*/
+static void
+on_record_change (VPTR uparm)
+{
+	uparm = uparm; /* unused */
+	if (closures && ncached) {
+		destroy_table(closures);
+		closures = create_table_custom_vptr(destroy_closure_el);
+		ncached = 0;
+	}
+}
+/*=============================================
+ * destroy_closure_el -- Release closure held by cache table
+ *===========================================*/
+static void
+destroy_closure_el (VPTR ptr)
+{
+	release_closure((RELCLOSURE)ptr);
+}
+/*=============================================
+ * get_closure -- Find closure in cache, or build & cache it
+ *  returns closure with reference added for caller
+ *===========================================*/
+static RELCLOSURE
+get_closure (CNSTRING ikey, BOOLEAN up, INT maxgen)
+{
+	char key[40];
+	RELCLOSURE clos;
+	if (maxgen < 0) maxgen = 0;
+	if (!registered) {
+		register_record_change_callback(on_record_change, 0);
+		registered = TRUE;
+	}
+	if (!closures)
+		closures = create_table_custom_vptr(destroy_closure_el);
+	snprintf(key, sizeof(key), "%c%s:%d", up ? 'A' : 'D', ikey, maxgen);
+	clos = (RELCLOSURE)valueof_ptr(closures, key);
+	if (!clos) {
+		clos = build_closure(ikey, up, maxgen);
+		if (ncached + clos->count > MAXCACHED)
+			on_record_change(0);
+		ncached += clos->count;
+		insert_table_ptr(closures, key, clos);
+	}
+	++clos->refcnt;
+	return clos;
+}
+/*=============================================
+ * build_closure -- Walk pedigree from one person
+ *  ikey:   [IN]  person to start from
+ *  up:     [IN]  ancestors (TRUE) or descendants (FALSE)
+ *  maxgen: [IN]  generation limit (0 for none)
+ * Visits people in the same order as ancestor_indiseq and
+ * descendent_indiseq. The closure itself serves as the queue:
+ * starting person first, then each person added, in turn.
+ * Returns closure with one reference (for the cache)
+ *===========================================*/
+static RELCLOSURE
+build_closure (CNSTRING ikey, BOOLEAN up, INT maxgen)
+{
+	RELCLOSURE clos = (RELCLOSURE)stdalloc(sizeof(*clos));
+	INT maxcount = 0, i, j;
+	INT knum = atoi(ikey+1), gen = 0;
+	clos->refcnt = 1;
+
+	for (i = -1; i < clos->count; ++i) {
+		if (i >= 0) {
+			knum = clos->keynums[i];
+			gen = clos->gens[i];
+		}
+		if (maxgen && gen >= maxgen)
+			break; /* breadth-first, so rest are at least as far */
+		if (up) {
+			FORPEDLINKS(PG_FAMC, knum, fnum)
+				FORPEDLINKS(PG_SPOUSE, fnum, pnum)
+					if (!test_and_mark(&imarks, pnum))
+						append_entry(clos, &maxcount, pnum, gen+1);
+				ENDPEDLINKS
+			ENDPEDLINKS
+		} else {
+			FORPEDLINKS(PG_FAMS, knum, fnum)
+				/* skip families already processed */
+				if (!test_and_mark(&fmarks, fnum)) {
+					FORPEDLINKS(PG_CHIL, fnum, cnum)
+						if (!test_and_mark(&imarks, cnum))
+							append_entry(clos, &maxcount, cnum, gen+1);
+					ENDPEDLINKS
+				}
+			ENDPEDLINKS
+		}
+	}
+
+	/* reset visited marks for next time */
+	for (i = 0; i < clos->count; ++i)
+		clear_mark(&imarks, clos->keynums[i]);
+	if (!up) {
+		for (i = -1; i < clos->count; ++i) {
+			knum = (i < 0) ? atoi(ikey+1) : clos->keynums[i];
+			FORPEDLINKS(PG_FAMS, knum, fnum)
+				clear_mark(&fmarks, fnum);
+			ENDPEDLINKS
+		}
+	}
+
+	/* sorted copy for closure_find */
+	if (clos->count) {
+		clos->sorted = (RELENT *)stdalloc(clos->count * sizeof(RELENT));
+		for (j = 0; j < clos->count; ++j) {
+			clos->sorted[j].keynum = clos->keynums[j];
+			clos->sorted[j].gen = clos->gens[j];
+		}
+		qsort(clos->sorted, clos->count, sizeof(RELENT), compare_relents);
+	}
+	return clos;
+}
+/*=============================================
+ * append_entry -- Add person to end of closure
+ *===========================================*/
+static void
+append_entry (RELCLOSURE clos, INT * pmax, INT keynum, INT gen)
+{
+	if (clos->count == *pmax) {
+		INT newmax = *pmax ? 2 * *pmax : 16;
+		INT *newkeys = (INT *)stdalloc(newmax * sizeof(INT));
+		INT *newgens = (INT *)stdalloc(newmax * sizeof(INT));
+		if (clos->count) {
+			memcpy(newkeys, clos->keynums, clos->count * sizeof(INT));
+			memcpy(newgens, clos->gens, clos->count * sizeof(INT));
+		}
+		stdfree(clos->keynums);
+		stdfree(clos->gens);
+		clos->keynums = newkeys;
+		clos->gens = newgens;
+		*pmax = newmax;
+	}
+	clos->keynums[clos->count] = keynum;
+	clos->gens[clos->count] = gen;
+	++clos->count;
+}
+/*=============================================
+ * compare_relents -- qsort comparator for RELENT by keynum
+ *===========================================*/
+static INT
+compare_relents (const void * p1, const void * p2)
+{
+	const RELENT * r1 = (const RELENT *)p1;
+	const RELENT * r2 = (const RELENT *)p2;
+	if (r1->keynum < r2->keynum) return -1;
+	return r1->keynum > r2->keynum;
+}
+/*=============================================
+ * test_and_mark -- Mark key number as visited
+ *  returns TRUE if it was already marked
+ *===========================================*/
+static BOOLEAN
+test_and_mark (MARKSET * marks, INT keynum)
+{
+	INT byte = keynum / 8;
+	unsigned char bit = (unsigned char)(1 << (keynum % 8));
+	if (keynum < 0) return TRUE;
+	if (byte >= marks->size) {
+		INT newsize = marks->size ? marks->size : 1024;
+		unsigned char * newbits;
+		while (newsize <= byte)
+			newsize *= 2;
+		newbits = (unsigned char *)stdalloc(newsize);
+		if (marks->size)
+			memcpy(newbits, marks->bits, marks->size);
+		stdfree(marks->bits);
+		marks->bits = newbits;
+		marks->size = newsize;
+	}
+	if (marks->bits[byte] & bit)
+		return TRUE;
+	marks->bits[byte] |= bit;
+	return FALSE;
+}
+/*=============================================
+ * clear_mark -- Unmark key number
+ *===========================================*/
+static void
+clear_mark (MARKSET * marks, INT keynum)
+{
+	INT byte = keynum / 8;
+	if (keynum < 0 || byte >= marks->size) return;
+	marks->bits[byte] &= (unsigned char)~(1 << (keynum % 8));
+}
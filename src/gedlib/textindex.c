@@ -0,0 +1,1015 @@
+/*=============================================================
+ * textindex.c -- Word index of record text, for scans
+ *  Every word in the values of NAME, TITL, AUTH, PLAC, NOTE &
+ *  REFN lines (and of the CONC & CONT lines under them) of
+ *  persons, families, sources, events & others, with the keys
+ *  of the records holding it. A search pattern with a run of
+ *  plain letters & digits need only look at records holding a
+ *  word which contains that run. Those candidates are still
+ *  matched against the pattern by the caller, so the index
+ *  narrows a scan but never decides it.
+ *  Kept in the database as bucket records (keyed "  T" plus the
+ *  first 5 characters of their words) and a header record
+ *  "  T     " saying whether the buckets are up to date. Read
+ *  whole on first use, kept current by store_record (so every
+ *  add, edit, merge & delete), and written back on close.
+ *  Only used with the TextIndex option set, and then built
+ *  with one pass over the raw records if missing or stale.
+ *==============================================================*/
+
+#include "llstdlib.h"
+#include "table.h"
+#include "gedcom.h"
+#include "btree.h"
+#include "indiseq.h"
+#include "lloptions.h"
+#include "fpattern.h"
+
+extern BTREE BTR;
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* one word, with keys of records holding it, in key order */
+typedef struct tag_txword {
+	STRING word;
+	INT count;
+	INT max;
+	RKEY *keys;
+} *TXWORD;
+
+/* all words sharing first TX_PREFIX chars; one database record */
+typedef struct tag_txbucket {
+	RKEY rkey;
+	INT count;
+	INT max;
+	TXWORD *words;   /* sorted */
+	BOOLEAN dirty;   /* changed since read or written */
+} *TXBUCKET;
+
+/* distinct words of one record, sorted */
+typedef struct tag_wordlist {
+	INT count;
+	INT max;
+	STRING *words;
+} WORDLIST;
+
+/* what to do with each text value of a raw record */
+typedef BOOLEAN (*TXLINE_FUNC)(CNSTRING val, INT vlen, void *param);
+
+/* textindex_search in progress */
+typedef struct tag_txsearch {
+	CNSTRING pattern;
+	fpattern_comp *compiled;
+	CNSTRING tag;        /* tag to search, or NULL for indexed tags */
+	BOOLEAN found;
+	INDISEQ seq;
+} TXSEARCH;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static void add_posting(CNSTRING word, RKEY rkey);
+static BOOLEAN build_callback(CNSTRING key, STRING data, INT len, void *param);
+static void build_textindex(void);
+static CNSTRING bucket_name(CNSTRING word, char * name);
+static int cmp_rkeys(const void * el1, const void * el2);
+static int cmp_words(const void * el1, const void * el2);
+static void destroy_bucket(VPTR ptr);
+static TXWORD find_word(TXBUCKET bucket, CNSTRING word, BOOLEAN create);
+static void for_text_lines(CNSTRING rec, INT len, CNSTRING onlytag, TXLINE_FUNC func, void *param);
+static void free_wordlist(WORDLIST * wl);
+static TXBUCKET get_bucket(CNSTRING word, BOOLEAN create);
+static RKEY header_rkey(void);
+static BOOLEAN is_text_key(CNSTRING key);
+static BOOLEAN load_callback(RKEY rkey, STRING data, INT len, void *param);
+static BOOLEAN load_textindex(void);
+static void mark_stale(void);
+static BOOLEAN match_line(CNSTRING val, INT vlen, void *param);
+static INT pattern_run(CNSTRING pattern, char * run, INT max, BOOLEAN * panchored);
+static void record_words(CNSTRING rec, INT len, WORDLIST * wl);
+static void remove_posting(CNSTRING word, RKEY rkey);
+static void save_textindex(void);
+static BOOLEAN search_callback(CNSTRING key, STRING data, INT len, void *param);
+static void search_record(TXSEARCH * search, CNSTRING key, CNSTRING rec, INT len);
+static BOOLEAN stale_callback(RKEY rkey, STRING data, INT len, void *param);
+static BOOLEAN textindex_ready(void);
+static BOOLEAN word_line(CNSTRING val, INT vlen, void *param);
+static void write_bucket(TXBUCKET bucket);
+static void write_header(CNSTRING hdr);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+#define TX_PREFIX   5     /* word chars in key of bucket record */
+#define TX_MINWORD  2     /* shorter words are not indexed */
+#define TX_MAXLEVEL 99    /* deeper lines are ignored */
+#define TX_MAXRUN   64    /* longest pattern run used */
+
+/* state of index */
+#define TX_UNKNOWN  0     /* not yet looked at */
+#define TX_NONE     1     /* not in use */
+#define TX_LOADED   2     /* in memory */
+
+static INT txstate = TX_UNKNOWN;
+static TABLE buckets = 0;        /* TXBUCKET by bucket name */
+static BOOLEAN stale = FALSE;    /* header in database says dirty */
+static BOOLEAN badbucket = FALSE;
+
+static CNSTRING hdrclean = "TEXTINDEX 1 clean\n";
+static CNSTRING hdrdirty = "TEXTINDEX 1 dirty\n";
+
+/* tags whose values are indexed */
+static CNSTRING txtags[] = { "NAME", "TITL", "AUTH", "PLAC", "NOTE", "REFN" };
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*=============================================
+ * textindex_candidates -- Records which may match pattern
+ *  pattern: [IN]  fpattern to be matched against a whole value
+ *                 (or name piece) of an indexed tag
+ *  ntype:   [IN]  type of record wanted ('I' etc), or 0 for all
+ * Candidates are all records holding a word which contains the
+ * longest run of plain letters & digits in the pattern (which
+ * starts with the run, if the pattern does).
+ * Returns NULL if index cannot serve the pattern (not in use,
+ * no run of 2 or more chars, or an exclusion outside a set),
+ * else sequence in canonical key order
+ *===========================================*/
+INDISEQ
+textindex_candidates (CNSTRING pattern, char ntype)
+{
+	char run[TX_MAXRUN+1];
+	char name[TX_PREFIX+1];
+	BOOLEAN anchored = FALSE;
+	RKEY *keys = 0;
+	INT nkeys = 0, maxkeys = 0, runlen, cmplen, i, j;
+	TABLE_ITER tabit;
+	CNSTRING bname;
+	VPTR ptr;
+	INDISEQ seq;
+
+	runlen = pattern_run(pattern, run, sizeof(run), &anchored);
+	if (runlen < TX_MINWORD)
+		return NULL;
+	if (!textindex_ready())
+		return NULL;
+	/* a word starting with run must be in bucket of run */
+	bucket_name(run, name);
+	cmplen = (runlen < TX_PREFIX) ? runlen : TX_PREFIX;
+
+	tabit = begin_table_iter(buckets);
+	while (next_table_ptr(tabit, &bname, &ptr)) {
+		TXBUCKET bucket = (TXBUCKET)ptr;
+		if (anchored && strncmp(bname, name, cmplen))
+			continue;
+		for (i = 0; i < bucket->count; ++i) {
+			TXWORD txw = bucket->words[i];
+			if (anchored ? strncmp(txw->word, run, runlen) : !strstr(txw->word, run))
+				continue;
+			for (j = 0; j < txw->count; ++j) {
+				RKEY *rk = &txw->keys[j];
+				if (ntype && rkey2str(*rk)[0] != ntype)
+					continue;
+				if (nkeys == maxkeys) {
+					INT newmax = maxkeys ? 2 * maxkeys : 256;
+					RKEY *newkeys = (RKEY *)stdalloc(newmax * sizeof(RKEY));
+					if (nkeys)
+						memcpy(newkeys, keys, nkeys * sizeof(RKEY));
+					stdfree(keys);
+					keys = newkeys;
+					maxkeys = newmax;
+				}
+				keys[nkeys++] = *rk;
+			}
+		}
+	}
+	end_table_iter(&tabit);
+
+	/* a record holding several matching words was added for each */
+	if (nkeys > 1)
+		qsort(keys, nkeys, sizeof(RKEY), cmp_rkeys);
+	seq = create_indiseq_null();
+	for (i = 0; i < nkeys; ++i) {
+		if (i && !cmpkeys(&keys[i-1], &keys[i]))
+			continue;
+		append_indiseq_null(seq, strsave(rkey2str(keys[i])), NULL, TRUE, TRUE);
+	}
+	stdfree(keys);
+	canonkeysort_indiseq(seq);
+	return seq;
+}
+/*=============================================
+ * textindex_search -- Records with text value matching pattern
+ *  pattern: [IN]  fpattern (must be valid), matched without case
+ *                 against each whole value, CONC & CONT lines
+ *                 each on their own
+ *  tag:     [IN]  tag whose values to search, or NULL for
+ *                 all indexed tags (NAME TITL AUTH PLAC NOTE REFN)
+ * Uses the index when it can, else reads every record.
+ * Returns sequence in canonical key order
+ *===========================================*/
+INDISEQ
+textindex_search (CNSTRING pattern, CNSTRING tag)
+{
+	TXSEARCH search;
+	INDISEQ cands = 0;
+	BOOLEAN indexed = TRUE;
+	INT i;
+
+	search.pattern = pattern;
+	search.compiled = fpattern_compile(pattern);
+	search.tag = tag;
+	search.seq = create_indiseq_null();
+	if (tag) {
+		indexed = FALSE;
+		for (i = 0; i < ARRSIZE(txtags); ++i) {
+			if (eqstr(tag, txtags[i]))
+				indexed = TRUE;
+		}
+	}
+	if (indexed)
+		cands = textindex_candidates(pattern, 0);
+	if (cands) {
+		FORINDISEQ(cands, el, num)
+			CNSTRING key = element_skey(el);
+			INT len = 0;
+			STRING rec = retrieve_raw_record(key, &len);
+			if (rec)
+				search_record(&search, key, rec, len);
+			stdfree(rec);
+		ENDINDISEQ
+		remove_indiseq(cands);
+	} else {
+		traverse_db_rec_keys(NULL, NULL, search_callback, &search);
+	}
+	fpattern_free(search.compiled);
+	canonkeysort_indiseq(search.seq);
+	return search.seq;
+}
+/*=============================================
+ * textindex_note_record -- Record written to database
+ *  key:  [IN]  key of record (eg, "I23")
+ *  rec:  [IN]  new contents of record ("DELE\n" if deleted)
+ *  len:  [IN]  length of rec
+ * Called by store_record before the record is written, so
+ * old contents can still be read
+ *===========================================*/
+void
+textindex_note_record (CNSTRING key, CNSTRING rec, INT len)
+{
+	WORDLIST old, new;
+	RKEY rkey;
+	STRING oldrec;
+	INT oldlen = 0, i = 0, j = 0;
+	BOOLEAN changed = FALSE;
+
+	if (!is_text_key(key)) return;
+	if (!textindex_ready()) {
+		/* an index left in the database is no longer current */
+		if (txstate == TX_NONE && !stale)
+			mark_stale();
+		return;
+	}
+	rkey = str2rkey(key);
+	oldrec = bt_getrecord(BTR, &rkey, &oldlen);
+	record_words(oldrec, oldlen, &old);
+	record_words(rec, len, &new);
+	stdfree(oldrec);
+	/* both lists sorted, so walk them together */
+	while (i < old.count || j < new.count) {
+		INT rel;
+		if (i == old.count)
+			rel = 1;
+		else if (j == new.count)
+			rel = -1;
+		else
+			rel = strcmp(old.words[i], new.words[j]);
+		if (rel < 0) {
+			remove_posting(old.words[i++], rkey);
+			changed = TRUE;
+		} else if (rel > 0) {
+			add_posting(new.words[j++], rkey);
+			changed = TRUE;
+		} else {
+			++i;
+			++j;
+		}
+	}
+	free_wordlist(&old);
+	free_wordlist(&new);
+	if (changed && !stale && bwrite(BTR)) {
+		/* until closed, buckets in database are behind */
+		write_header(hdrdirty);
+		stale = TRUE;
+	}
+}
+/*=============================================
+ * free_textindex -- Write back changes & release index
+ *  (eg, database closing)
+ *===========================================*/
+void
+free_textindex (void)
+{
+	if (txstate == TX_LOADED && BTR)
+		save_textindex();
+	if (buckets) {
+		destroy_table(buckets);
+		buckets = 0;
+	}
+	txstate = TX_UNKNOWN;
+	stale = FALSE;
+}
+/*=============================================
+ * textindex_ready -- Load or build index on first use
+ *  returns TRUE if index is in memory
+ *===========================================*/
+static BOOLEAN
+textindex_ready (void)
+{
+	if (txstate == TX_UNKNOWN && BTR) {
+		txstate = TX_NONE;
+		if (getlloptint("TextIndex", 0) && !load_textindex())
+			build_textindex();
+	}
+	return txstate == TX_LOADED;
+}
+/*=============================================
+ * load_textindex -- Read index from database
+ *  returns FALSE if no index there, or not up to date
+ *===========================================*/
+static BOOLEAN
+load_textindex (void)
+{
+	RKEY lo = header_rkey(), hi = header_rkey();
+	INT len = 0, i;
+	STRING hdr = bt_getrecord(BTR, &lo, &len);
+	BOOLEAN ok = hdr && len == (INT)strlen(hdrclean)
+		&& !strncmp(hdr, hdrclean, len);
+	stdfree(hdr);
+	if (!ok) return FALSE;
+
+	buckets = create_table_custom_vptr(destroy_bucket);
+	badbucket = FALSE;
+	/* lo (the header) is excluded, hi is beyond any bucket */
+	for (i = 3; i < RKEYLEN; ++i)
+		hi.r_rkey[i] = '~';
+	traverse_db_rec_rkeys(BTR, lo, hi, load_callback, NULL);
+	if (badbucket) {
+		destroy_table(buckets);
+		buckets = 0;
+		return FALSE;
+	}
+	txstate = TX_LOADED;
+	stale = FALSE;
+	return TRUE;
+}
+/*=============================================
+ * load_callback -- Read one bucket record
+ *  Record is INT count of words, then for each word: the word
+ *  (0 terminated), INT count of keys, and that many RKEYs
+ *===========================================*/
+static BOOLEAN
+load_callback (RKEY rkey, STRING data, INT len, void *param)
+{
+	STRING p = data, end = data + len;
+	char name[TX_PREFIX+1];
+	TXBUCKET bucket;
+	INT nwords, nkeys, i;
+	param = param; /* unused */
+
+	if (len < (INT)sizeof(INT)) {
+		badbucket = TRUE;
+		return FALSE;
+	}
+	memcpy(&nwords, p, sizeof(INT));
+	p += sizeof(INT);
+	if (!nwords) return TRUE;
+	memcpy(name, &rkey.r_rkey[3], TX_PREFIX);
+	name[TX_PREFIX] = 0;
+	bucket = (TXBUCKET)stdalloc(sizeof(*bucket));
+	bucket->rkey = rkey;
+	insert_table_ptr(buckets, name, bucket);
+	for (i = 0; i < nwords; ++i) {
+		STRING word = p;
+		TXWORD txw;
+		while (p < end && *p) ++p;
+		if (end - p < 1 + (INT)sizeof(INT)) {
+			badbucket = TRUE;
+			return FALSE;
+		}
+		++p;
+		memcpy(&nkeys, p, sizeof(INT));
+		p += sizeof(INT);
+		if (nkeys <= 0 || nkeys > (end - p) / (INT)sizeof(RKEY)) {
+			badbucket = TRUE;
+			return FALSE;
+		}
+		txw = find_word(bucket, word, TRUE);
+		txw->keys = (RKEY *)stdalloc(nkeys * sizeof(RKEY));
+		memcpy(txw->keys, p, nkeys * sizeof(RKEY));
+		txw->count = txw->max = nkeys;
+		p += nkeys * sizeof(RKEY);
+	}
+	return TRUE;
+}
+/*=============================================
+ * build_textindex -- Index text of every record
+ *  Written to database too, if it is writable
+ *===========================================*/
+static void
+build_textindex (void)
+{
+	RKEY lo = header_rkey(), hi = header_rkey();
+	INT i;
+	buckets = create_table_custom_vptr(destroy_bucket);
+	txstate = TX_LOADED;
+	/* every bucket of an older index gets rewritten, empty if need be */
+	for (i = 3; i < RKEYLEN; ++i)
+		hi.r_rkey[i] = '~';
+	traverse_db_rec_rkeys(BTR, lo, hi, stale_callback, NULL);
+	traverse_db_rec_keys(NULL, NULL, build_callback, NULL);
+	if (bwrite(BTR)) {
+		stale = TRUE;
+		save_textindex();
+	}
+}
+/*=============================================
+ * stale_callback -- Note bucket of an older index
+ *===========================================*/
+static BOOLEAN
+stale_callback (RKEY rkey, STRING data, INT len, void *param)
+{
+	char name[TX_PREFIX+1];
+	TXBUCKET bucket;
+	INT nwords = 0;
+	param = param; /* unused */
+	if (len >= (INT)sizeof(INT))
+		memcpy(&nwords, data, sizeof(INT));
+	if (!nwords) return TRUE;
+	memcpy(name, &rkey.r_rkey[3], TX_PREFIX);
+	name[TX_PREFIX] = 0;
+	bucket = (TXBUCKET)stdalloc(sizeof(*bucket));
+	bucket->rkey = rkey;
+	bucket->dirty = TRUE;
+	insert_table_ptr(buckets, name, bucket);
+	return TRUE;
+}
+/*=============================================
+ * build_callback -- Index words of one raw record
+ *===========================================*/
+static BOOLEAN
+build_callback (CNSTRING key, STRING data, INT len, void *param)
+{
+	WORDLIST wl;
+	RKEY rkey;
+	INT i;
+	param = param; /* unused */
+	if (!is_text_key(key)) return TRUE;
+	record_words(data, len, &wl);
+	rkey = str2rkey(key);
+	for (i = 0; i < wl.count; ++i)
+		add_posting(wl.words[i], rkey);
+	free_wordlist(&wl);
+	return TRUE;
+}
+/*=============================================
+ * save_textindex -- Write changed buckets & clean header
+ *===========================================*/
+static void
+save_textindex (void)
+{
+	TABLE_ITER tabit;
+	CNSTRING name;
+	VPTR ptr;
+	BOOLEAN batch;
+	if (!stale || !bwrite(BTR)) return;
+	/* caller (eg, import) may have its own batch open */
+	batch = !bbatch(BTR);
+	if (batch)
+		bt_begin_batch(BTR);
+	tabit = begin_table_iter(buckets);
+	while (next_table_ptr(tabit, &name, &ptr)) {
+		TXBUCKET bucket = (TXBUCKET)ptr;
+		if (bucket->dirty)
+			write_bucket(bucket);
+	}
+	end_table_iter(&tabit);
+	if (batch)
+		bt_end_batch(BTR);
+	write_header(hdrclean);
+	stale = FALSE;
+}
+/*=============================================
+ * write_bucket -- Write one bucket record (see load_callback)
+ *===========================================*/
+static void
+write_bucket (TXBUCKET bucket)
+{
+	INT len = sizeof(INT), i;
+	STRING rec, p;
+	for (i = 0; i < bucket->count; ++i) {
+		TXWORD txw = bucket->words[i];
+		len += strlen(txw->word) + 1 + sizeof(INT) + txw->count * sizeof(RKEY);
+	}
+	p = rec = (STRING)stdalloc(len);
+	memcpy(p, &bucket->count, sizeof(INT));
+	p += sizeof(INT);
+	for (i = 0; i < bucket->count; ++i) {
+		TXWORD txw = bucket->words[i];
+		INT wlen = strlen(txw->word) + 1;
+		memcpy(p, txw->word, wlen);
+		p += wlen;
+		memcpy(p, &txw->count, sizeof(INT));
+		p += sizeof(INT);
+		memcpy(p, txw->keys, txw->count * sizeof(RKEY));
+		p += txw->count * sizeof(RKEY);
+	}
+	bt_addrecord(BTR, bucket->rkey, rec, len);
+	stdfree(rec);
+	bucket->dirty = FALSE;
+}
+/*=============================================
+ * mark_stale -- Mark index in database as not up to date
+ *  (written to while index not in use)
+ *===========================================*/
+static void
+mark_stale (void)
+{
+	RKEY rkey = header_rkey();
+	INT len = 0;
+	STRING hdr = bt_getrecord(BTR, &rkey, &len);
+	if (hdr && len == (INT)strlen(hdrclean) && !strncmp(hdr, hdrclean, len))
+		write_header(hdrdirty);
+	stdfree(hdr);
+	stale = TRUE;
+}
+/*=============================================
+ * write_header -- Write header record of index
+ *===========================================*/
+static void
+write_header (CNSTRING hdr)
+{
+	bt_addrecord(BTR, header_rkey(), (RAWRECORD)hdr, strlen(hdr));
+}
+/*=============================================
+ * header_rkey -- Key of header record, "  T     "
+ *  Bucket keys follow it, and it sorts first
+ *===========================================*/
+static RKEY
+header_rkey (void)
+{
+	RKEY rkey;
+	INT i;
+	for (i = 0; i < RKEYLEN; ++i)
+		rkey.r_rkey[i] = ' ';
+	rkey.r_rkey[2] = 'T';
+	return rkey;
+}
+/*=============================================
+ * bucket_name -- Name of bucket holding word
+ *  First TX_PREFIX chars of word, with any non-ASCII char as
+ *  '_' & padded with spaces, as in key of bucket record
+ *  name: [OUT] buffer of TX_PREFIX+1 chars
+ *===========================================*/
+static CNSTRING
+bucket_name (CNSTRING word, char * name)
+{
+	INT i;
+	for (i = 0; i < TX_PREFIX && word[i]; ++i)
+		name[i] = ((uchar)word[i] < 0x80) ? word[i] : '_';
+	for ( ; i < TX_PREFIX; ++i)
+		name[i] = ' ';
+	name[TX_PREFIX] = 0;
+	return name;
+}
+/*=============================================
+ * get_bucket -- Find bucket which holds word
+ *  create: [IN]  make new (empty) bucket if none yet ?
+ *===========================================*/
+static TXBUCKET
+get_bucket (CNSTRING word, BOOLEAN create)
+{
+	char name[TX_PREFIX+1];
+	TXBUCKET bucket;
+	bucket_name(word, name);
+	bucket = (TXBUCKET)valueof_ptr(buckets, name);
+	if (!bucket && create) {
+		bucket = (TXBUCKET)stdalloc(sizeof(*bucket));
+		bucket->rkey = header_rkey();
+		memcpy(&bucket->rkey.r_rkey[3], name, TX_PREFIX);
+		insert_table_ptr(buckets, name, bucket);
+	}
+	return bucket;
+}
+/*=============================================
+ * find_word -- Find word in bucket
+ *  create: [IN]  add it (with no keys) if not there ?
+ *===========================================*/
+static TXWORD
+find_word (TXBUCKET bucket, CNSTRING word, BOOLEAN create)
+{
+	INT lo = 0, hi = bucket->count, i;
+	TXWORD txw;
+	while (lo < hi) {
+		INT mid = (lo + hi) / 2;
+		INT rel = strcmp(bucket->words[mid]->word, word);
+		if (!rel)
+			return bucket->words[mid];
+		if (rel < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (!create) return NULL;
+	if (bucket->count == bucket->max) {
+		INT newmax = bucket->max ? 2 * bucket->max : 4;
+		TXWORD *newwords = (TXWORD *)stdalloc(newmax * sizeof(TXWORD));
+		if (bucket->count)
+			memcpy(newwords, bucket->words, bucket->count * sizeof(TXWORD));
+		stdfree(bucket->words);
+		bucket->words = newwords;
+		bucket->max = newmax;
+	}
+	for (i = bucket->count; i > lo; --i)
+		bucket->words[i] = bucket->words[i-1];
+	txw = (TXWORD)stdalloc(sizeof(*txw));
+	txw->word = strsave(word);
+	bucket->words[lo] = txw;
+	++bucket->count;
+	return txw;
+}
+/*=============================================
+ * add_posting -- Note that record holds word
+ *===========================================*/
+static void
+add_posting (CNSTRING word, RKEY rkey)
+{
+	TXBUCKET bucket = get_bucket(word, TRUE);
+	TXWORD txw = find_word(bucket, word, TRUE);
+	INT lo = txw->count, hi = txw->count, i;
+	/* building visits records in key order, so try end first */
+	if (txw->count && cmpkeys(&txw->keys[txw->count-1], &rkey) >= 0) {
+		lo = 0;
+		while (lo < hi) {
+			INT mid = (lo + hi) / 2;
+			INT rel = cmpkeys(&txw->keys[mid], &rkey);
+			if (!rel) return;
+			if (rel < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+	}
+	if (txw->count == txw->max) {
+		INT newmax = txw->max ? 2 * txw->max : 4;
+		RKEY *newkeys = (RKEY *)stdalloc(newmax * sizeof(RKEY));
+		if (txw->count)
+			memcpy(newkeys, txw->keys, txw->count * sizeof(RKEY));
+		stdfree(txw->keys);
+		txw->keys = newkeys;
+		txw->max = newmax;
+	}
+	for (i = txw->count; i > lo; --i)
+		txw->keys[i] = txw->keys[i-1];
+	txw->keys[lo] = rkey;
+	++txw->count;
+	bucket->dirty = TRUE;
+}
+/*=============================================
+ * remove_posting -- Note that record no longer holds word
+ *  Word is dropped from bucket when no record holds it
+ *===========================================*/
+static void
+remove_posting (CNSTRING word, RKEY rkey)
+{
+	TXBUCKET bucket = get_bucket(word, FALSE);
+	TXWORD txw = bucket ? find_word(bucket, word, FALSE) : 0;
+	INT lo = 0, hi, i;
+	if (!txw) return;
+	hi = txw->count;
+	while (lo < hi) {
+		INT mid = (lo + hi) / 2;
+		INT rel = cmpkeys(&txw->keys[mid], &rkey);
+		if (!rel) break;
+		if (rel < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo >= hi) return;
+	lo = (lo + hi) / 2;
+	for (i = lo + 1; i < txw->count; ++i)
+		txw->keys[i-1] = txw->keys[i];
+	--txw->count;
+	bucket->dirty = TRUE;
+	if (txw->count) return;
+	for (i = 0; bucket->words[i] != txw; ++i)
+		;
+	for (++i; i < bucket->count; ++i)
+		bucket->words[i-1] = bucket->words[i];
+	--bucket->count;
+	strfree(&txw->word);
+	stdfree(txw->keys);
+	stdfree(txw);
+}
+/*=============================================
+ * destroy_bucket -- Free bucket (table callback)
+ *===========================================*/
+static void
+destroy_bucket (VPTR ptr)
+{
+	TXBUCKET bucket = (TXBUCKET)ptr;
+	INT i;
+	for (i = 0; i < bucket->count; ++i) {
+		TXWORD txw = bucket->words[i];
+		strfree(&txw->word);
+		stdfree(txw->keys);
+		stdfree(txw);
+	}
+	stdfree(bucket->words);
+	stdfree(bucket);
+}
+/*=============================================
+ * is_text_key -- Is this key of a record whose text is indexed ?
+ *  (persons, families, sources, events & others)
+ *===========================================*/
+static BOOLEAN
+is_text_key (CNSTRING key)
+{
+	if (!key || !key[0] || !strchr("IFSEX", key[0]))
+		return FALSE;
+	return isdigit((uchar)key[1]);
+}
+/*=============================================
+ * record_words -- Find distinct words in raw record
+ *  A word is a run of ASCII letters & digits (made lower case)
+ *  or of non-ASCII bytes, at least TX_MINWORD long
+ *  rec: [IN]  record text (may be NULL)
+ *  wl:  [OUT] sorted words, to be freed by free_wordlist
+ *===========================================*/
+static void
+record_words (CNSTRING rec, INT len, WORDLIST * wl)
+{
+	INT i, n = 0;
+	memset(wl, 0, sizeof(*wl));
+	if (!rec || (len >= 4 && !strncmp(rec, "DELE", 4)))
+		return;
+	for_text_lines(rec, len, NULL, word_line, wl);
+	if (wl->count < 2) return;
+	qsort(wl->words, wl->count, sizeof(STRING), cmp_words);
+	for (i = 0; i < wl->count; ++i) {
+		if (n && eqstr(wl->words[n-1], wl->words[i]))
+			strfree(&wl->words[i]);
+		else
+			wl->words[n++] = wl->words[i];
+	}
+	wl->count = n;
+}
+/*=============================================
+ * word_line -- Add words of one value to WORDLIST
+ *===========================================*/
+static BOOLEAN
+word_line (CNSTRING val, INT vlen, void *param)
+{
+	WORDLIST * wl = (WORDLIST *)param;
+	INT i = 0, j;
+	while (i < vlen) {
+		uchar c = (uchar)val[i];
+		STRING word;
+		if (c < 0x80 && !isalnum(c)) {
+			++i;
+			continue;
+		}
+		for (j = i; j < vlen; ++j) {
+			c = (uchar)val[j];
+			if (c < 0x80 && !isalnum(c))
+				break;
+		}
+		if (j - i >= TX_MINWORD) {
+			INT k;
+			if (wl->count == wl->max) {
+				INT newmax = wl->max ? 2 * wl->max : 16;
+				STRING *newwords = (STRING *)stdalloc(newmax * sizeof(STRING));
+				if (wl->count)
+					memcpy(newwords, wl->words, wl->count * sizeof(STRING));
+				stdfree(wl->words);
+				wl->words = newwords;
+				wl->max = newmax;
+			}
+			word = (STRING)stdalloc(j - i + 1);
+			for (k = 0; k < j - i; ++k) {
+				c = (uchar)val[i+k];
+				word[k] = (c < 0x80) ? tolower(c) : c;
+			}
+			word[k] = 0;
+			wl->words[wl->count++] = word;
+		}
+		i = j;
+	}
+	return TRUE;
+}
+/*=============================================
+ * cmp_words -- Compare words for qsort (bytewise, as merged
+ *  by textindex_note_record)
+ *===========================================*/
+static int
+cmp_words (const void * el1, const void * el2)
+{
+	return strcmp(*(const STRING *)el1, *(const STRING *)el2);
+}
+/*=============================================
+ * cmp_rkeys -- Compare RKEYs for qsort
+ *===========================================*/
+static int
+cmp_rkeys (const void * el1, const void * el2)
+{
+	return cmpkeys((const RKEY *)el1, (const RKEY *)el2);
+}
+/*=============================================
+ * free_wordlist -- Free words found by record_words
+ *===========================================*/
+static void
+free_wordlist (WORDLIST * wl)
+{
+	INT i;
+	for (i = 0; i < wl->count; ++i)
+		strfree(&wl->words[i]);
+	stdfree(wl->words);
+	memset(wl, 0, sizeof(*wl));
+}
+/*=============================================
+ * for_text_lines -- Visit text values in raw record
+ *  onlytag: [IN]  tag whose values to visit, or NULL for
+ *                 all indexed tags
+ *  func:    [IN]  called with each value (not 0 terminated),
+ *                 including CONC & CONT lines under those tags;
+ *                 returns FALSE to stop
+ * Values are as parsed into nodes: leading & trailing white
+ * space is dropped
+ *===========================================*/
+static void
+for_text_lines (CNSTRING rec, INT len, CNSTRING onlytag, TXLINE_FUNC func, void *param)
+{
+	BOOLEAN text[TX_MAXLEVEL+1]; /* is line at this level a wanted one ? */
+	CNSTRING p = rec, end = rec + len;
+	INT onlylen = onlytag ? strlen(onlytag) : 0;
+	memset(text, 0, sizeof(text));
+	while (p < end) {
+		CNSTRING eol = memchr(p, '\n', end - p);
+		CNSTRING tag, val, vend;
+		INT level = 0, taglen, i;
+		BOOLEAN want = FALSE;
+		if (!eol) eol = end;
+		while (p < eol && iswhite((uchar)*p)) ++p;
+		if (p >= eol || !isdigit((uchar)*p)) {
+			p = eol + 1;
+			continue;
+		}
+		while (p < eol && isdigit((uchar)*p) && level <= TX_MAXLEVEL)
+			level = level*10 + (*p++ - '0');
+		while (p < eol && iswhite((uchar)*p)) ++p;
+		if (p < eol && *p == '@') {
+			/* skip cross reference */
+			for (++p; p < eol && *p != '@'; ++p)
+				;
+			for (++p; p < eol && iswhite((uchar)*p); ++p)
+				;
+		}
+		if (level > TX_MAXLEVEL || p >= eol) {
+			p = eol + 1;
+			continue;
+		}
+		tag = p;
+		for (val = tag; val < eol && !iswhite((uchar)*val); ++val)
+			;
+		taglen = val - tag;
+		while (val < eol && iswhite((uchar)*val)) ++val;
+		for (vend = eol; vend > val && iswhite((uchar)vend[-1]); --vend)
+			;
+		if (level > 0 && text[level-1] && taglen == 4
+			&& (!strncmp(tag, "CONC", 4) || !strncmp(tag, "CONT", 4))) {
+			want = TRUE;
+			text[level] = FALSE;
+		} else {
+			if (onlytag)
+				text[level] = (taglen == onlylen && !strncmp(tag, onlytag, taglen));
+			else {
+				text[level] = FALSE;
+				for (i = 0; i < ARRSIZE(txtags); ++i) {
+					if (taglen == 4 && !strncmp(tag, txtags[i], 4))
+						text[level] = TRUE;
+				}
+			}
+			want = text[level];
+		}
+		if (want && !(*func)(val, vend - val, param))
+			return;
+		p = eol + 1;
+	}
+}
+/*=============================================
+ * search_callback -- Search one raw record (full scan)
+ *===========================================*/
+static BOOLEAN
+search_callback (CNSTRING key, STRING data, INT len, void *param)
+{
+	if (is_text_key(key))
+		search_record((TXSEARCH *)param, key, data, len);
+	return TRUE;
+}
+/*=============================================
+ * search_record -- Add record to search result if it matches
+ *===========================================*/
+static void
+search_record (TXSEARCH * search, CNSTRING key, CNSTRING rec, INT len)
+{
+	if (len >= 4 && !strncmp(rec, "DELE", 4))
+		return;
+	search->found = FALSE;
+	for_text_lines(rec, len, search->tag, match_line, search);
+	if (search->found)
+		append_indiseq_null(search->seq, strsave(key), NULL, TRUE, TRUE);
+}
+/*=============================================
+ * match_line -- Does one value match search pattern ?
+ *  returns FALSE (stop) once it does
+ *===========================================*/
+static BOOLEAN
+match_line (CNSTRING val, INT vlen, void *param)
+{
+	TXSEARCH * search = (TXSEARCH *)param;
+	char buffer[256];
+	STRING str = (vlen < (INT)sizeof(buffer)) ? buffer : (STRING)stdalloc(vlen + 1);
+	memcpy(str, val, vlen);
+	str[vlen] = 0;
+	search->found = fpattern_matchc(search->compiled, str);
+	if (str != buffer)
+		stdfree(str);
+	return !search->found;
+}
+/*=============================================
+ * pattern_run -- Find longest run of plain letters & digits
+ *  in fpattern, which any matching text must contain
+ *  run:       [OUT] the run, lower case
+ *  max:       [IN]  size of run buffer
+ *  panchored: [OUT] run starts the pattern (so matching text) ?
+ * Quoted chars, wildcards & sets all break runs.
+ * Returns length of run, or 0 if pattern has an exclusion
+ *===========================================*/
+static INT
+pattern_run (CNSTRING pattern, char * run, INT max, BOOLEAN * panchored)
+{
+	char cur[TX_MAXRUN+1];
+	CNSTRING p = pattern;
+	INT len = 0, best = 0;
+	BOOLEAN atstart = TRUE;
+	*panchored = FALSE;
+	run[0] = 0;
+	if (max > (INT)sizeof(cur))
+		max = sizeof(cur);
+	while (1) {
+		uchar c = (uchar)*p;
+		if (c && c < 0x80 && isalnum(c)) {
+			/* a cut short run is still in any match */
+			if (len < max - 1)
+				cur[len++] = tolower(c);
+			++p;
+			continue;
+		}
+		if (len > best || (len == best && atstart && !*panchored)) {
+			memcpy(run, cur, len);
+			run[len] = 0;
+			best = len;
+			*panchored = atstart;
+		}
+		len = 0;
+		atstart = FALSE;
+		if (!c)
+			break;
+		++p;
+		if (c == FPAT_NOT) {
+			run[0] = 0;
+			return 0;
+		}
+		if (c == FPAT_QUOTE || c == FPAT_QUOTE2) {
+			if (*p) ++p;
+		} else if (c == FPAT_SET_L) {
+			/* skipping too much is harmless, too little is not */
+			while (*p && *p != FPAT_SET_R) {
+				if ((*p == FPAT_QUOTE || *p == FPAT_QUOTE2) && p[1])
+					++p;
+				++p;
+			}
+			if (*p) ++p;
+		}
+	}
+	return best;
+}
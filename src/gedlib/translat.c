@@ -22,6 +22,7 @@
 #include "lloptions.h"
 #include "gedcomi.h"
 #include "arch.h" 
+#include "lltrace.h"
 
 
 /*********************************************
@@ -76,6 +77,7 @@ enum { ZON_X, ZON_INT, ZON_GUI, ZON_EDI, ZON_RPT, ZON_GED, NUM_ZONES };
 static void clear_legacy_tt(INT trnum);
 static void clear_predefined_list(void);
 static struct conversion_s * getconvert(INT trnum);
+static BOOLEAN has_legacy_tt(XLAT xlat);
 static BOOLEAN is_legacy_first(INT trnum);
 static void local_init(void);
 
@@ -180,7 +182,10 @@ ZSTR
 translate_string_to_zstring (XLAT xlat, CNSTRING in)
 {
 	ZSTR zstr = zs_news(in);
+	TRACE_TIME tt;
+	TRACE_BEGIN(tt);
 	transl_xlat(xlat, zstr);
+	TRACE_END(tt, "translate", "translate_string_to_zstring", NULL);
 	return zstr;
 }
 /*===================================================
@@ -196,13 +201,23 @@ void
 translate_string (XLAT ttm, CNSTRING in, STRING out, INT maxlen)
 {
 	ZSTR zstr=0;
+	TRACE_TIME tt;
 	if (!in || !in[0]) {
 		out[0] = 0;
 		return;
 	}
+	TRACE_BEGIN(tt);
+	if (!has_legacy_tt(ttm)
+		&& xl_translate_buffer(ttm, in, strlen(in), out, maxlen) >= 0) {
+		TRACE_END(tt, "translate", "translate_string", NULL);
+		return;
+	}
+	/* result too long for out (or legacy table), so translate in
+	a zstring and truncate at a character boundary */
 	zstr = translate_string_to_zstring(ttm, in);
 	llstrsets(out, maxlen, uu8, zs_str(zstr));
 	zs_free(&zstr);
+	TRACE_END(tt, "translate", "translate_string", NULL);
 }
 /*==========================================================
  * translate_write -- Translate and output lines in a buffer
@@ -215,7 +230,8 @@ translate_string (XLAT ttm, CNSTRING in, STRING out, INT maxlen)
  *  (or until last line if not terminated with \n)
  * *lenp will be set to zero unless there is a final line
  * not terminated by \n and caller didn't ask to write it anyway
- * NB: If no translation table, entire string is always written
+ * NB: If no translation table (or an identity translation),
+ *  entire string is always written
  *========================================================*/
 BOOLEAN
 translate_write(XLAT ttm, STRING in, INT *lenp, FILE *ofp, BOOLEAN last)
@@ -226,8 +242,9 @@ translate_write(XLAT ttm, STRING in, INT *lenp, FILE *ofp, BOOLEAN last)
 	STRING bp = in;
 	int i=0,j=0;
 
-	if(ttm == NULL) {
-	    ASSERT(fwrite(in, *lenp, 1, ofp) == 1);
+	if(transl_is_identity(ttm)) {
+	    if (*lenp)
+	        ASSERT(fwrite(in, *lenp, 1, ofp) == 1);
 	    *lenp = 0;
 	    return TRUE;
 	}
@@ -562,6 +579,24 @@ transl_free_predefined_xlats (void)
 {
 	clear_predefined_list();
 }
+/*==========================================================
+ * transl_is_identity -- Will transl_xlat leave text unchanged ?
+ *  (no conversion steps and no legacy translation table)
+ *========================================================*/
+BOOLEAN
+transl_is_identity (XLAT xlat)
+{
+	return !has_legacy_tt(xlat) && xl_is_identity(xlat);
+}
+/*==========================================================
+ * has_legacy_tt -- Does transl_xlat apply a legacy table with xlat ?
+ *========================================================*/
+static BOOLEAN
+has_legacy_tt (XLAT xlat)
+{
+	INT index = xlat ? xl_get_uparam(xlat)-1 : -1;
+	return index>=0 && legacytts[index].tt;
+}
 /*==========================================================
  * transl_is_xlat_valid -- Does it do the job ?
  * Created: 2002/12/15 (Perry Rapp)
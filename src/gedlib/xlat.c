@@ -53,6 +53,9 @@ typedef struct tag_dyntt *DYNTT;
 typedef struct xlat_step_s {
 	STRING iconv_src;
 	STRING iconv_dest;
+	ICVT icvt;          /* opened on first use, kept for later calls */
+	BOOLEAN icvtfailed; /* iconv could not open this conversion */
+	ZSTR zbuf;          /* scratch output of iconv step */
 	DYNTT dyntt;
 } *XLSTEP;
 
@@ -68,6 +71,8 @@ static XLSTEP create_iconv_step(CNSTRING src, CNSTRING dest);
 static XLSTEP create_dyntt_step(DYNTT dyntt);
 static XLAT create_null_xlat(BOOLEAN adhoc);
 static XLAT create_xlat(CNSTRING src, CNSTRING dest, BOOLEAN adhoc);
+static ICVT get_step_icvt(XLSTEP xstep);
+static BOOLEAN is_ascii_passthrough(XLAT xlat, CNSTRING in, INT inlen);
 static DYNTT create_dyntt(TRANTABLE tt, CNSTRING name, CNSTRING path);
 static void destroy_dyntt(DYNTT dyntt);
 static void dyntt_destructor(VTABLE *obj);
@@ -150,6 +155,8 @@ free_xlat (XLAT xlat)
 		xstep = (XLSTEP)el;
 		strfree(&xstep->iconv_src);
 		strfree(&xstep->iconv_dest);
+		icvt_close(&xstep->icvt);
+		zs_free(&xstep->zbuf);
 		xstep->dyntt = 0; /* f_dyntts owns dyntt memory */
 	ENDLIST
 	destroy_list(xlat->steps);
@@ -404,13 +411,26 @@ xl_do_xlat (XLAT xlat, ZSTR zstr)
 		xstep = (XLSTEP)el;
 		if (xstep->iconv_src) {
 			/* an iconv step */
-			ZSTR ztemp=zs_new();
-			if (iconv_trans(xstep->iconv_src, xstep->iconv_dest, zs_str(zstr), ztemp, '?')) {
+			ICVT icvt = get_step_icvt(xstep);
+			if (!icvt) {
+				/* iconv failed, anything to do ? */
+			} else if (icvt_is_ascii_transparent(icvt)
+				&& isasciibuf(zs_str(zstr), zs_len(zstr))) {
+				/* nothing for iconv to change */
 				cvtd=TRUE;
-				zs_move(zstr, &ztemp);
 			} else {
-				zs_free(&ztemp);
-				/* iconv failed, anything to do ? */
+				ZSTR zbuf;
+				if (!xstep->zbuf)
+					xstep->zbuf = zs_new();
+				zbuf = xstep->zbuf;
+				zs_clear(zbuf);
+				if (icvt_trans(icvt, zs_str(zstr), zbuf, '?')) {
+					/* copy back, including any wide terminator */
+					cvtd=TRUE;
+					zs_reserve(zstr, zs_len(zbuf)+1);
+					memcpy(zs_str(zstr), zs_str(zbuf), zs_len(zbuf)+1);
+					zs_set_len(zstr, zs_len(zbuf));
+				}
 			}
 		} else if (xstep->dyntt) {
 			/* a custom translation table step */
@@ -420,6 +440,79 @@ xl_do_xlat (XLAT xlat, ZSTR zstr)
 	ENDLIST
 	return cvtd;
 }
+/*==========================================================
+ * xl_translate_buffer -- Translate text into caller's buffer
+ *  xlat:   [IN]  translation to apply
+ *  in:     [IN]  text to translate
+ *  inlen:  [IN]  length of in
+ *  out:    [OUT] translated text (zero-terminated)
+ *  outcap: [IN]  size of out
+ *  returns length of result, or -1 if it does not fit in out
+ * Identity translations, ASCII text through ASCII-compatible
+ * codesets, and single iconv steps are done without allocating
+ *========================================================*/
+INT
+xl_translate_buffer (XLAT xlat, CNSTRING in, INT inlen, STRING out, INT outcap)
+{
+	ZSTR zstr=0;
+	INT len=-1;
+
+	if (xl_is_identity(xlat) || is_ascii_passthrough(xlat, in, inlen)) {
+		if (inlen >= outcap)
+			return -1;
+		memcpy(out, in, inlen);
+		out[inlen] = 0;
+		return inlen;
+	}
+	if (length_list(xlat->steps) == 1) {
+		XLSTEP xstep = (XLSTEP)get_list_element(xlat->steps, 1, NULL);
+		ICVT icvt = xstep->iconv_src ? get_step_icvt(xstep) : NULL;
+		if (icvt)
+			return icvt_trans_buffer(icvt, in, inlen, out, outcap, '?');
+	}
+	/* in need not be zero-terminated at inlen */
+	zstr = zs_newn(inlen+1);
+	memcpy(zs_str(zstr), in, inlen);
+	zs_str(zstr)[inlen] = 0;
+	zs_set_len(zstr, inlen);
+	xl_do_xlat(xlat, zstr);
+	if ((INT)zs_len(zstr) < outcap) {
+		len = zs_len(zstr);
+		memcpy(out, zs_str(zstr), len+1);
+	}
+	zs_free(&zstr);
+	return len;
+}
+/*==========================================================
+ * is_ascii_passthrough -- Is in ASCII text that every step of
+ *  xlat leaves unchanged ? (tt steps may remap anything)
+ *========================================================*/
+static BOOLEAN
+is_ascii_passthrough (XLAT xlat, CNSTRING in, INT inlen)
+{
+	BOOLEAN ok=TRUE;
+	FORLIST(xlat->steps, el)
+		XLSTEP xstep = (XLSTEP)el;
+		ICVT icvt = xstep->iconv_src ? get_step_icvt(xstep) : NULL;
+		if (ok && (!icvt || !icvt_is_ascii_transparent(icvt)))
+			ok = FALSE;
+	ENDLIST
+	return ok && isasciibuf(in, inlen);
+}
+/*==========================================================
+ * get_step_icvt -- Get iconv conversion of step, opening it
+ *  the first time it is needed
+ *========================================================*/
+static ICVT
+get_step_icvt (XLSTEP xstep)
+{
+	if (!xstep->icvt && !xstep->icvtfailed) {
+		xstep->icvt = icvt_open(xstep->iconv_src, xstep->iconv_dest);
+		if (!xstep->icvt)
+			xstep->icvtfailed = TRUE;
+	}
+	return xstep->icvt;
+}
 /*==========================================================
  * xl_load_all_dyntts -- Load internal list of available translation
  *  tables (based on *.tt files in TTPATH)
@@ -719,6 +812,15 @@ end_get_desc:
 	zs_free(&zstr);
 	return zrtn;
 }
+/*==========================================================
+ * xl_is_identity -- Does this translation leave all text unchanged ?
+ *  (true for an empty chain, and for an invalid one, which is skipped)
+ *========================================================*/
+BOOLEAN
+xl_is_identity (XLAT xlat)
+{
+	return !xlat || !xlat->valid || is_empty_list(xlat->steps);
+}
 /*==========================================================
  * xl_is_xlat_valid -- Does it do the job ?
  * Created: 2002/12/15 (Perry Rapp)
@@ -114,6 +114,7 @@ typedef struct {
 	INDEX  *b_cache;     /* index cache */
 	BOOLEAN b_write;     /* database writeable? */
 	BOOLEAN b_immut;     /* database immutable? */
+	struct tag_btbatch *b_batch; /* queued writes, if batching */
 } *BTREE, BTREESTRUCT;
 #define bbasedir(b) ((b)->b_basedir)
 #define bmaster(b)  ((b)->b_master)
@@ -124,6 +125,7 @@ typedef struct {
 #define bcache(b)   ((b)->b_cache)
 #define bwrite(b)   ((b)->b_write)
 #define bimmut(b)   ((b)->b_immut)
+#define bbatch(b)   ((b)->b_batch)
 
 /*======================================================
  * BLOCK -- Data structure for BTREE record file headers
@@ -169,6 +171,19 @@ typedef BOOLEAN(*TRAV_BLOCK_FUNC)(BTREE, BLOCK, void*);
 typedef BOOLEAN(*TRAV_RECORD_FUNC_BYKEY)(RKEY, STRING, INT, void*);
 #define TRAV_RECORD_FUNC_BYKEY_ARGS(a,b,c,d) RKEY a, STRING b, INT c, void* d
 
+/*============================================
+ * BTCOMPACT -- Counts reported by bt_compact
+ *==========================================*/
+typedef struct {
+	INT c_records;      /* records copied */
+	INT c_deleted;      /* DELE records dropped */
+	INT c_oldblocks;    /* data blocks in old btree */
+	INT c_oldindexes;   /* index files in old btree */
+	INT c_newblocks;    /* data blocks in copy */
+	INT c_newindexes;   /* index files in copy */
+	INT c_newdepth;     /* index levels in copy */
+} BTCOMPACT;
+
 /*====================================
  * BTREE library function declarations 
  *==================================*/
@@ -179,6 +194,9 @@ BOOLEAN addtextfile(BTREE, RKEY, CNSTRING file, TRANSLFNC);
 RECORD_STATUS write_record_to_file(BTREE btree, RKEY rkey, STRING file);
 RECORD_STATUS write_record_to_textfile(BTREE btree, RKEY rkey, STRING file, TRANSLFNC);
 
+/* compact.c */
+BOOLEAN bt_compact(BTREE btree, STRING newdir, INT fill, BTCOMPACT * stats, INT *lldberr);
+
 /* opnbtree.c */
 BOOLEAN closebtree(BTREE);
 void describe_dberror(INT dberr, STRING buffer, INT buflen);
@@ -193,12 +211,16 @@ INDEX readindex(BTREE btr, FKEY ikey, BOOLEAN robust);
 
 /* btrec.c */
 BOOLEAN bt_addrecord(BTREE, RKEY, RAWRECORD, INT);
+void bt_begin_batch(BTREE);
+void bt_end_batch(BTREE);
+void bt_flush_batch(BTREE);
 RAWRECORD bt_getrecord(BTREE, const RKEY *, INT*);
 BOOLEAN isrecord(BTREE, RKEY);
 INT cmpkeys(const RKEY * rk1, const RKEY * rk2);
 
 /* traverse.c */
 BOOLEAN traverse_index_blocks(BTREE, INDEX, void *, TRAV_INDEX_FUNC ifunc, TRAV_BLOCK_FUNC dfunc);
+void traverse_db_blocks(BTREE, TRAV_RECORD_FUNC_BYKEY func, void *param);
 void traverse_db_rec_rkeys(BTREE, RKEY lo, RKEY hi, TRAV_RECORD_FUNC_BYKEY func, void *param);
 
 /* utils.c */
@@ -171,11 +171,19 @@ static const char	fpattern_h_id[] =
 /* omitted */
 
 
+/* Public types */
+
+typedef struct fpattern_comp	fpattern_comp;	/* Compiled pattern	*/
+
+
 /* Public functions */
 
 extern int	fpattern_isvalid(const char *pat);
 extern int	fpattern_match(const char *pat, const char *fname);
 extern int	fpattern_matchn(const char *pat, const char *fname);
+extern fpattern_comp *	fpattern_compile(const char *pat);
+extern int	fpattern_matchc(const fpattern_comp *fp, const char *fname);
+extern void	fpattern_free(fpattern_comp *fp);
 
 
 #ifdef __cplusplus
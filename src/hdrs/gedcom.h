@@ -84,17 +84,22 @@ struct tag_node {
 	NODE   n_sibling;   /* sibling */
 	INT    n_flag;      /* eg, ND_TEMP */
 	CACHEEL n_cel;      /* pointer to cacheel, if node is inside cache */
+	STRING n_lazy;      /* children not yet parsed (if ND_LAZY) */
 };
 #define nxref(n)    ((n)->n_xref)
 #define ntag(n)     ((n)->n_tag)
 #define nval(n)     ((n)->n_val)
 #define nparent(n)  ((n)->n_parent)
-#define nchild(n)   ((n)->n_child)
+/* parses children first, if they were left as text (see ND_LAZY) */
+#define nchild(n)   (*(nflag(n) & ND_LAZY ? load_lazy_children(n) : &(n)->n_child))
+/* children parsed so far, for code that must not parse them */
+#define nchild_loaded(n) ((n)->n_child)
 #define nsibling(n) ((n)->n_sibling)
 #define nflag(n)    ((n)->n_flag)
 #define nrefcnt(n)  ((n)->n_refcnt)
 #define ncel(n)     ((n)->n_cel)
-enum { ND_TEMP=1 };
+/* ND_LAZY: children are still the text in n_lazy */
+enum { ND_TEMP=1, ND_LAZY=2 };
 
 struct tag_nkey { char ntype; INT keynum; char key[MAXKEYWIDTH+1]; };
 typedef struct tag_nkey NKEY;
@@ -153,6 +158,9 @@ struct tag_rfmt {
 };
 typedef struct tag_rfmt *RFMT;
 
+/* GEDCOM file loaded for line reading (see nodeio.c) */
+typedef struct tag_gedbuf *GEDBUF;
+
 
 /*==============================================
  * Option type enumerations (but we use defines)
@@ -280,6 +288,7 @@ void free_node(NODE);
 void free_nodes(NODE);
 void free_temp_node_tree(NODE);
 STRING full_value(NODE, STRING sep);
+INT get_cache_miss_count(void);
 ZSTR get_cache_stats_fam(void);
 ZSTR get_cache_stats_indi(void);
 STRING get_current_locale_collate(void);
@@ -473,6 +482,7 @@ RECORD string_to_record(STRING str, CNSTRING key, INT len);
 void termlocale(void);
 BOOLEAN traverse_nodes(NODE node, BOOLEAN (*func)(NODE, VPTR), VPTR param);
 void traverse_refns(TRAV_REFNS_FUNC func, void *param);
+BOOLEAN traverse_refn_rec(CNSTRING rawkey, STRING data, TRAV_REFNS_FUNC func, void *param);
 INT tree_strlen(INT, NODE);
 void uilocale(void);
 NODE union_nodes(NODE, NODE, BOOLEAN, BOOLEAN);
@@ -503,9 +513,11 @@ void del_in_dbase(CNSTRING key);
 void delete_record_missing_data_entry(CNSTRING key);
 BOOLEAN mark_deleted_record_as_deleted(CNSTRING key);
 BOOLEAN mark_live_record_as_live(CNSTRING key);
+void register_record_change_callback(CALLBACK_FNC fncptr, VPTR uparm);
 BOOLEAN store_text_file_to_db(STRING key, CNSTRING file, TRANSLFNC);
 void traverse_db_key_recs(TRAV_RECORDS_FUNC, void *param);
 void traverse_db_rec_keys(CNSTRING lo, CNSTRING hi, TRAV_RAWRECORDS_FUNC func, void *param);
+void unregister_record_change_callback(CALLBACK_FNC fncptr, VPTR uparm);
 
 /* keytonod.c */
 void add_new_indi_to_cache(RECORD rec);
@@ -543,8 +555,10 @@ STRING manip_name(STRING name, SURCAPTYPE captype, SURORDER surorder, INT len);
 LIST name_to_list(CNSTRING name, INT *plen, INT *psind);
 STRING name_string(STRING);
 int namecmp(STRING, STRING);
+BOOLEAN namecollkey(CNSTRING name, ZSTR zkey);
 void remove_name(STRING name, CNSTRING key);
 void traverse_names(TRAV_NAMES_FUNC func, void *param);
+BOOLEAN traverse_name_rec(CNSTRING rawkey, STRING data, TRAV_NAMES_FUNC func, void *param);
 STRING trim_name(STRING, INT);
 
 /* node.c */
@@ -566,6 +580,15 @@ void nodechk(NODE node, CNSTRING scope);
 void nodechk_enable(BOOLEAN enable);
 
 /* nodeio.c */
+void close_gedbuf(GEDBUF gb);
+NODE first_gedbuf_to_node(GEDBUF gb, BOOLEAN list, XLAT ttm, STRING *pmsg, BOOLEAN *peof);
+STRING gedbuf_check_unicode(GEDBUF gb);
+void gedbuf_seek(GEDBUF gb, size_t pos);
+size_t gedbuf_tell(GEDBUF gb);
+INT gedbuf_to_line(GEDBUF gb, XLAT ttm, INT *plev, STRING *pxref, STRING *ptag, STRING *pval, STRING *pmsg);
+NODE * load_lazy_children(NODE node);
+NODE next_gedbuf_to_node(GEDBUF gb, BOOLEAN list, XLAT ttm, STRING *pmsg, BOOLEAN *peof);
+GEDBUF open_gedbuf(FILE *fp);
 void prefix_file_for_edit(FILE *fp);
 void prefix_file_for_gedcom(FILE *fp);
 void prefix_file_for_report(FILE *fp);
@@ -575,6 +598,32 @@ void write_indi_to_file_for_edit(NODE indi, CNSTRING file, RFMT rfmt);
 void write_fam_to_file_for_edit(NODE fam, CNSTRING file, RFMT rfmt);
 void write_nodes(INT, FILE*, XLAT, NODE, BOOLEAN, BOOLEAN, BOOLEAN);
 
+/* indifacts.c */
+/* facts derived from a cached person record */
+typedef struct tag_indifacts *INDIFACTS;
+void drop_indifacts(void);
+struct tag_gdateval * indifacts_date(NODE evnt); /* GDATEVAL (date.h) */
+CNSTRING indifacts_givens(NODE name);
+CNSTRING indifacts_list_string(NODE indi, INT len, RFMT rfmt, BOOLEAN appkey);
+CNSTRING indifacts_name(NODE name, SURCAPTYPE caps, INT len);
+void indifacts_save_list_string(NODE indi, INT len, RFMT rfmt, BOOLEAN appkey, CNSTRING str);
+CNSTRING indifacts_surname(NODE name);
+
+/* pedgraph.c */
+/* kinds of pedigree link, for pedgraph_links */
+#define PG_FAMC    0  /* person to families as child */
+#define PG_FAMS    1  /* person to families as spouse */
+#define PG_HUSB    2  /* family to husbands */
+#define PG_WIFE    3  /* family to wives */
+#define PG_SPOUSE  4  /* family to husbands & wives, in record order */
+#define PG_CHIL    5  /* family to children */
+#define PG_NKINDS  6
+void free_pedgraph(void);
+BOOLEAN pedgraph_has_record(char ntype, INT keynum);
+INT pedgraph_links(INT kind, INT keynum, const INT ** plinks);
+void pedgraph_note_record(CNSTRING key, CNSTRING rec, INT len);
+char pedgraph_target_type(INT kind);
+
 /* place.c */
 LIST place_to_list(STRING, INT*);
 LIST value_to_list (STRING str, INT *plen, STRING dlm);
@@ -582,11 +631,27 @@ LIST value_to_list (STRING str, INT *plen, STRING dlm);
 /* refns.c */
 void annotate_with_supplemental(NODE node, RFMT rfmt);
 
+/* relcache.c */
+/* cached ancestor or descendant closure of one person */
+typedef struct tag_relclosure *RELCLOSURE;
+RELCLOSURE ancestor_closure(CNSTRING ikey, INT maxgen);
+INT closest_common_ancestors(CNSTRING key1, CNSTRING key2, INT ** pkeynums, INT ** pgens1, INT ** pgens2);
+INT closure_entry(RELCLOSURE clos, INT i, INT * pgen);
+INT closure_find(RELCLOSURE clos, INT keynum);
+INT closure_length(RELCLOSURE clos);
+RELCLOSURE descendant_closure(CNSTRING ikey, INT maxgen);
+void free_closure_cache(void);
+void release_closure(RELCLOSURE clos);
+
 /* soundex.c */
 CNSTRING trad_soundex(CNSTRING);
 INT soundex_count(void);
 CNSTRING soundex_get(INT i, CNSTRING name);
 
+/* textindex.c */
+void free_textindex(void);
+void textindex_note_record(CNSTRING key, CNSTRING rec, INT len);
+
 /* xreffile.c */
 BOOLEAN addxref_if_missing (CNSTRING key);
 BOOLEAN delete_xref_if_present(CNSTRING key);
@@ -362,6 +362,25 @@
 		__node = nsibling(__node);\
 	}}
 
+/* FORPEDLINKS iterate over key numbers of records linked from one
+ * person or family, via the pedigree graph (no records are loaded)
+ * kind is PG_FAMC etc; links to missing records are skipped
+ */
+#define FORPEDLINKS(kind,keynum,lnum) \
+	{\
+	const INT * __links=0;\
+	INT __n = pedgraph_links(kind, keynum, &__links);\
+	char __ttype = pedgraph_target_type(kind);\
+	INT __i, lnum;\
+	for (__i = 0; __i < __n; ++__i) {\
+		lnum = __links[__i];\
+		if (!pedgraph_has_record(__ttype, lnum)) continue;\
+		{
+
+#define ENDPEDLINKS \
+		}\
+	}}
+
 #define FORTAGVALUES(root,tag,node,value)\
 	{\
 	NODE node, __node = nchild(root);\
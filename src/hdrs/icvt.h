@@ -13,8 +13,15 @@
 #ifndef ICVT_H_INCLUDED
 #define ICVT_H_INCLUDED 1
 
+typedef struct tag_icvt *ICVT;
+
 BOOLEAN iconv_trans(CNSTRING src, CNSTRING dest, CNSTRING sin, ZSTR zout, char illegal);
 BOOLEAN iconv_can_trans(CNSTRING src, CNSTRING dest);
+void icvt_close(ICVT * picvt);
+BOOLEAN icvt_is_ascii_transparent(ICVT icvt);
+ICVT icvt_open(CNSTRING src, CNSTRING dest);
+BOOLEAN icvt_trans(ICVT icvt, CNSTRING sin, ZSTR zout, char illegal);
+INT icvt_trans_buffer(ICVT icvt, CNSTRING in, INT inlen, STRING out, INT outcap, char illegal);
 void init_win32_iconv_shim(CNSTRING dllpath);
 
 #endif /* ICVT_H_INCLUDED */
@@ -36,6 +36,7 @@
 #include "gedcom.h"		/* for NODE */
 
 typedef struct tag_sortel *SORTEL;
+typedef struct tag_seqindex *SEQINDEX;
 
 
 typedef INT (*ELCMPFNC)(SORTEL el1, SORTEL el2, VPTR param);
@@ -95,6 +96,8 @@ struct tag_indiseq {
 	INT is_prntype;    /* for special cases (spouseseq & famseq) */
 	INT is_valtype;    /* int, string, pointer */
 	STRING is_locale;  /* used by namesort */
+	STRING is_keylocale; /* locale of elements' name collation keys */
+	SEQINDEX is_keyindex; /* membership index over keys, built on demand */
 	INDISEQ_VALUE_FNCTABLE is_valfnctbl;
 };
 #ifndef INDISEQ_type_defined
@@ -110,6 +113,8 @@ typedef struct tag_indiseq *INDISEQ;
 #define IPrntype(s)  ((s)->is_prntype)
 #define IValtype(s)  ((s)->is_valtype)
 #define ILocale(s)   ((s)->is_locale)
+#define IKeylocale(s) ((s)->is_keylocale)
+#define IKeyindex(s) ((s)->is_keyindex)
 #define IValfnctbl(s) ((s)->is_valfnctbl)
 
 #define KEYSORT       (1<<0)
@@ -128,7 +133,7 @@ typedef struct tag_indiseq *INDISEQ;
 
 void add_browse_list(STRING, INDISEQ);
 void addref_indiseq(INDISEQ seq);
-INDISEQ ancestor_indiseq(INDISEQ seq);
+INDISEQ ancestor_indiseq(INDISEQ seq, INT maxgen);
 void append_indiseq_null(INDISEQ, STRING key, CNSTRING name, BOOLEAN sure, BOOLEAN alloc);
 void append_indiseq_ival(INDISEQ, STRING key, STRING name, INT val, BOOLEAN sure, BOOLEAN alloc);
 void append_indiseq_pval(INDISEQ, STRING key, STRING name, VPTR val, BOOLEAN sure);
@@ -146,7 +151,7 @@ void default_delete_value(UNION uval, INT valtype);
 UNION default_create_gen_value(INT gen, INT * valtype);
 INT default_compare_values(VPTR ptr1, VPTR ptr2, INT valtype);
 BOOLEAN delete_indiseq(INDISEQ, STRING, STRING, INT);
-INDISEQ descendent_indiseq(INDISEQ seq);
+INDISEQ descendent_indiseq(INDISEQ seq, INT maxgen);
 INDISEQ difference_indiseq(INDISEQ, INDISEQ);
 INT element_ikey(SORTEL el);
 BOOLEAN element_indiseq(INDISEQ seq, INT index, STRING *pkey, STRING *pname);
@@ -196,6 +201,8 @@ void set_indiseq_value_funcs(INDISEQ seq, INDISEQ_VALUE_FNCTABLE valfnctbl);
 INDISEQ sibling_indiseq(INDISEQ, BOOLEAN);
 INDISEQ spouse_indiseq(INDISEQ);
 INDISEQ str_to_indiseq(STRING name, char ctype);
+INDISEQ textindex_candidates(CNSTRING pattern, char ntype);
+INDISEQ textindex_search(CNSTRING pattern, CNSTRING tag);
 void unique_indiseq(INDISEQ);
 INDISEQ union_indiseq(INDISEQ one, INDISEQ two);
 void update_browse_list(STRING, INDISEQ);
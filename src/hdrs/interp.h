@@ -35,10 +35,14 @@
 #define _INTERP_H
 
 void poutput(STRING, BOOLEAN *eflg);
+void interp_clear_cached(void);
+BOOLEAN interp_load_cached(LIST lifiles);
 void interp_main(LIST lifiles, STRING ofile, BOOLEAN picklist, BOOLEAN timing);
+INT interp_run_cached(STRING ofile);
 void init_interpreter(void);
 void shutdown_interpreter(void);
 ZSTR get_report_error_msg (STRING msg);
+void set_report_profile(CNSTRING fname);
 
 extern BOOLEAN prog_trace;
 
@@ -101,9 +101,11 @@ void remove_listeners(LIST * notifiees);
 
 /* lldate.c */
 void get_current_lldate(LLDATE * creation);
+INT64 get_usec_clock(void);
 
 /* llstrcmp.c */
 int ll_strcmploc(const char*, const char*);
+BOOLEAN ll_strxfrmloc(CNSTRING str, ZSTR zkey);
 CNSTRING ll_what_collation(void);
 int ll_strncmp(const char*, const char*, int);
 typedef BOOLEAN (*usersortfnc)(const char *str1, const char *str2, INT * rtn);
@@ -123,6 +125,7 @@ char * dcngettext_null(const char *, const char *, const char *, unsigned long i
 char *norm_charmap(char *name);
 
 /* path.c */
+STRING check_buffer_for_unicode(CNSTRING buf, INT len, INT * pbomlen);
 STRING check_file_for_unicode(FILE * fp);
 INT chop_path(CNSTRING path, STRING dirs);
 void closefp(FILE **pfp);
@@ -162,6 +165,7 @@ void init_stdlib(void);
 /* stdstrng.c */
 INT chartype(INT);
 BOOLEAN eqstr_ex(CNSTRING s1, CNSTRING s2);
+BOOLEAN isasciibuf(CNSTRING buf, INT len);
 BOOLEAN isasciiletter(INT c);
 BOOLEAN isletter(INT);
 BOOLEAN islinebreak(INT c);
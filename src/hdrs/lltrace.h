@@ -0,0 +1,50 @@
+/*=============================================================
+ * lltrace.h -- Tracepoints on hot paths (btree, cache, parsing,
+ *  translation, report output)
+ *  Traced calls are kept in a ring buffer of the most recent
+ *  events, written out in Chrome trace (JSON) format, which
+ *  chrome://tracing and Perfetto display as a timeline.
+ *  Tracing is started by setting the TraceFile option (eg,
+ *  llexec -I TraceFile=trace.json), and the buffer is written
+ *  to that file at exit, when TraceFile is cleared, and (where
+ *  there is SIGUSR1) whenever the process is sent SIGUSR1.
+ *  Configuring --without-trace compiles the tracepoints out.
+ *===========================================================*/
+
+#ifndef lltrace_h_included
+#define lltrace_h_included
+
+/* clock reading in nanoseconds (0 when not tracing) */
+typedef INT64 TRACE_TIME;
+
+extern BOOLEAN lltrace_on;
+
+void lltrace_complete(TRACE_TIME start, CNSTRING cat, CNSTRING name, CNSTRING arg);
+void lltrace_configure(CNSTRING file, INT nevents);
+BOOLEAN lltrace_dump(CNSTRING file);
+void lltrace_instant(CNSTRING cat, CNSTRING name, CNSTRING arg);
+TRACE_TIME lltrace_now(void);
+
+/*
+ * A traced call looks like
+ *   TRACE_TIME tt;
+ *   TRACE_BEGIN(tt);
+ *   ...
+ *   TRACE_END(tt, "btree", "readrec", rkey2str(rkey));
+ * cat & name must be string constants (only pointers are kept);
+ * arg (which may be NULL) is copied, and only evaluated when
+ * tracing, so it may be costly to compute.
+ */
+#ifdef LLTRACE
+#define TRACE_BEGIN(tt) ((tt) = (lltrace_on ? lltrace_now() : 0))
+#define TRACE_END(tt, cat, name, arg) \
+	((tt) ? lltrace_complete((tt), (cat), (name), (arg)) : (void)0)
+#define TRACE_INSTANT(cat, name, arg) \
+	(lltrace_on ? lltrace_instant((cat), (name), (arg)) : (void)0)
+#else
+#define TRACE_BEGIN(tt) ((tt) = 0)
+#define TRACE_END(tt, cat, name, arg) ((void)(tt))
+#define TRACE_INSTANT(cat, name, arg) ((void)0)
+#endif
+
+#endif /* lltrace_h_included */
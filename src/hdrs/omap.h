@@ -0,0 +1,36 @@
+/*=============================================================
+ * omap.h -- Header file for ordered map
+ *  Keys & values are opaque pointers, ordered by a client
+ *  supplied compare function (uses rbtree for storage)
+ *===========================================================*/
+
+#ifndef omap_h_included
+#define omap_h_included
+
+typedef struct tag_omap *OMAP;
+typedef struct tag_omap_iter *OMAP_ITER;
+
+/* return <0, 0, >0 as key1 is below, equal to, or above key2 */
+typedef int (*OMAPCMP)(const void * key1, const void * key2);
+/* free a key or a value */
+typedef void (*OMAPDEL)(void * ptr);
+
+/* creating and deleting map */
+OMAP create_omap(OMAPCMP cmp, OMAPDEL delkey, OMAPDEL delval);
+void addref_omap(OMAP omap);
+void release_omap(OMAP omap);
+
+/* working with entire map */
+INT get_omap_count(OMAP omap);
+
+/* working with elements of map */
+void * find_omap(OMAP omap, const void * key, BOOLEAN * present);
+void insert_omap(OMAP omap, void * key, void * val);
+BOOLEAN remove_omap(OMAP omap, const void * key);
+
+/* iteration in key order (low & high inclusive, NULL for open end) */
+OMAP_ITER begin_omap(OMAP omap, const void * low, const void * high);
+BOOLEAN next_omap(OMAP_ITER omit, const void ** pkey, void ** pval);
+void end_omap(OMAP_ITER * pomit);
+
+#endif /* omap_h_included */
@@ -38,6 +38,7 @@
 #endif
 
 #include "table.h"      /* for TABLE */
+#include "omap.h"       /* for OMAP */
 
 typedef union {
 	/* "basic" types, should be same as UNION */
@@ -54,6 +55,7 @@ typedef union {
 	RECORD	rxd;
 	INDISEQ	qxd;
 	TABLE	txd;
+	OMAP	mxd;
 } PVALUE_DATA;
 
 typedef struct tag_pvalue *PVALUE;
@@ -81,7 +83,9 @@ struct tag_pvalue {
 #define PTABLE    14  /* txd */ /* table */
 #define PSET      15  /* qxd */ /* set/indiseq */
 #define PARRAY    16  /* axd */ /* array */
-#define PMAXLIVE  PARRAY /* maximum live type */
+#define PMAP      17  /* mxd */ /* ordered map (keyed by scalar pvalues) */
+#define PHSET     18  /* txd */ /* hash set (of scalar pvalues) */
+#define PMAXLIVE  PHSET /* maximum live type */
 #define PFREED    99  /* returned to free list */
 
 /* Handy PVALUE macros */
@@ -110,7 +114,9 @@ void bad_type_error(CNSTRING op, ZSTR *zerr, PVALUE val1, PVALUE val2);
 void clear_pvalue(PVALUE val);
 void coerce_pvalue(INT, PVALUE, BOOLEAN*);
 PVALUE copy_pvalue(PVALUE);
+PVALUE create_new_pvalue_hashset(void);
 PVALUE create_new_pvalue_list(void);
+PVALUE create_new_pvalue_map(void);
 PVALUE create_new_pvalue_table(void);
 PVALUE create_pvalue(INT type, PVALUE_DATA pvd);
 PVALUE create_pvalue_any(void);
@@ -147,6 +153,7 @@ BOOLEAN is_numeric_pvalue(PVALUE);
 BOOLEAN is_pvalue(PVALUE);
 BOOLEAN is_record_pvalue(PVALUE);
 BOOLEAN is_numeric_zero(PVALUE);
+BOOLEAN is_scalar_key_pvalue(PVALUE);
 void pvalues_begin(void);
 void pvalues_end(void);
 
@@ -155,6 +162,7 @@ CACHEEL pvalue_to_cel(PVALUE val);
 float pvalue_to_float(PVALUE val);
 INT pvalue_to_int(PVALUE);
 LIST pvalue_to_list(PVALUE val);
+OMAP pvalue_to_map(PVALUE val);
 NODE pvalue_to_node(PVALUE val);
 RECORD pvalue_to_record(PVALUE val);
 INDISEQ pvalue_to_seq(PVALUE val);
@@ -176,6 +184,7 @@ PVALUE create_new_pvalue(void);
 void free_pvalue_memory(PVALUE val);
 void set_pvalue_node(PVALUE val, NODE node);
 INT pvalues_collate(PVALUE val1, PVALUE val2);
+int pvalue_keys_compare(const void * key1, const void * key2);
 void init_pvalue_vtable(PVALUE val);
 
 #endif /* _PVALUE_H */
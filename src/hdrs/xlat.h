@@ -24,11 +24,13 @@ TRANTABLE xl_get_legacy_tt(XLAT xlat);
 XLAT xl_get_null_xlat(void);
 INT xl_get_uparam(XLAT);
 XLAT xl_get_xlat(CNSTRING src, CNSTRING dest, BOOLEAN adhoc);
+BOOLEAN xl_is_identity(XLAT xlat);
 BOOLEAN xl_is_xlat_valid(XLAT xlat);
 void xl_load_all_dyntts(CNSTRING ttpath);
 void xl_parse_codeset(CNSTRING codeset, ZSTR zcsname, LIST * subcodes);
 void xl_release_xlat(XLAT xlat);
 void xl_set_uparam(XLAT, INT uparam);
+INT xl_translate_buffer(XLAT xlat, CNSTRING in, INT inlen, STRING out, INT outcap);
 void xlat_shutdown(void);
 
 #endif /* xlat_h_included */
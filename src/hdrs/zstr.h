@@ -33,6 +33,7 @@ char * zs_set_len(ZSTR zstr, unsigned int len);
 char * zs_sets(ZSTR zstr, const char *);
 char * zs_setz(ZSTR zstr, ZCSTR zsrc);
 char * zs_apps(ZSTR zstr, const char *);
+char * zs_appsn(ZSTR zstr, const char *, unsigned int len);
 char * zs_appz(ZSTR zstr, ZCSTR zrc);
 char * zs_appc(ZSTR zstr, char);
 char * zs_setf(ZSTR zstr, const char * fmt, ...);
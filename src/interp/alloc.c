@@ -75,6 +75,9 @@ STRING nonvarx     = 0;
 STRING nonlst1     = 0;
 STRING nonlstx     = 0;
 STRING nontabx     = 0;
+STRING nonmapx     = 0;
+STRING nonhsetx    = 0;
+STRING nonkeyx     = 0;
 STRING nonset1     = 0;
 STRING nonsetx     = 0;
 STRING nonlstarrx  = 0;
@@ -579,6 +582,46 @@ forindi_node (PACTX pactx, STRING ivar, STRING nvar, PNODE body)
 	set_parents(body, node);
 	return node;
 }
+/*=========================================
+ * parforindi_node -- Create parallel forindi loop node
+ *  pactx: [IN]  pointer to parseinfo structure (parse globals)
+ *  ivar,  [IN]  person
+ *  nvar:  [IN]  counter
+ *  reds:  [IN]  reduction variables (list of iden nodes)
+ *  body:  [IN]  loop body statements
+ *=======================================*/
+PNODE
+parforindi_node (PACTX pactx, STRING ivar, STRING nvar, PNODE reds, PNODE body)
+{
+	PNODE node = create_pnode(pactx, IPARINDI);
+	ireduce(node) = (VPTR) reds;
+	ielement(node) = (VPTR) ivar;
+	inum(node) = (VPTR) nvar;
+	ibody(node) = (VPTR) body;
+	node->i_flags = PN_IELEMENT_HPTR + PN_INUM_HPTR;
+	set_parents(body, node);
+	return node;
+}
+/*=========================================
+ * parforfam_node -- Create parallel forfam loop node
+ *  pactx: [IN]  pointer to parseinfo structure (parse globals)
+ *  fvar,  [IN]  family
+ *  nvar:  [IN]  counter
+ *  reds:  [IN]  reduction variables (list of iden nodes)
+ *  body:  [IN]  loop body statements
+ *=======================================*/
+PNODE
+parforfam_node (PACTX pactx, STRING fvar, STRING nvar, PNODE reds, PNODE body)
+{
+	PNODE node = create_pnode(pactx, IPARFAM);
+	ireduce(node) = (VPTR) reds;
+	ielement(node) = (VPTR) fvar;
+	inum(node) = (VPTR) nvar;
+	ibody(node) = (VPTR) body;
+	node->i_flags = PN_IELEMENT_HPTR + PN_INUM_HPTR;
+	set_parents(body, node);
+	return node;
+}
 /*=========================================
  * forsour_node -- Create forsour loop node
  *  pactx: [IN]  pointer to parseinfo structure (parse globals)
@@ -1017,6 +1060,9 @@ clear_error_strings (void)
 	strfree(&nonlst1);
 	strfree(&nonlstx);
 	strfree(&nontabx);
+	strfree(&nonmapx);
+	strfree(&nonhsetx);
+	strfree(&nonkeyx);
 	strfree(&nonset1);
 	strfree(&nonsetx);
 	strfree(&nonlstarrx);
@@ -1091,6 +1137,9 @@ interp_load_lang (void)
 	nonlst1     = strsave(_("%s: the arg must be a list."));
 	nonlstx     = strsave(_("%s: the arg #%s must be a list."));
 	nontabx     = strsave(_("%s: the arg #%s must be a table."));
+	nonmapx     = strsave(_("%s: the arg #%s must be a map."));
+	nonhsetx    = strsave(_("%s: the arg #%s must be a hash set."));
+	nonkeyx     = strsave(_("%s: the arg #%s must be a number, boolean, string or record."));
 	nonset1     = strsave(_("%s: the arg must be a set."));
 	nonsetx     = strsave(_("%s: the arg #%s must be a set."));
 	nonlstarrx  = strsave(_("%s: the arg #%s must be a list or array."));
@@ -1377,6 +1426,12 @@ describe_pnode (PNODE node, ZSTR zstr, INT max)
 	case IFAM:
 		zs_apps(zstr, "*FamilyLoop *");
 		break;
+	case IPARINDI:
+		zs_apps(zstr, "*ParallelPersonLoop *");
+		break;
+	case IPARFAM:
+		zs_apps(zstr, "*ParallelFamilyLoop *");
+		break;
 	case ISOUR:
 		zs_apps(zstr, "*SourceLoop *");
 		break;
@@ -57,6 +57,7 @@ extern STRING qSaskstr,qSchoostrttl;
  *********************************************/
 
 static ZSTR decode(STRING str, INT * offset);
+static GDATEVAL event_to_gdateval(NODE evnt, BOOLEAN * pfree);
 static FLOAT julianday(GDATEVAL gdv);
 static INT normalize_year(INT yr);
 
@@ -298,7 +299,6 @@ llrpt_name (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	NODE name, indi = eval_indi(argvar, stab, eflg, NULL);
 	SURCAPTYPE captype = DOSURCAP;
 	PVALUE val=0;
-	STRING outname = 0;
 	if (*eflg) {
 		prog_var_error(node, stab, argvar, NULL, nonindx, "name", "1");
 		return NULL;
@@ -323,8 +323,7 @@ llrpt_name (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		return create_pvalue_from_string(0);
 	}
 	/* NOTE: the 68 here is arbitrary */
-	outname = manip_name(nval(name), captype, REGORDER, 68);
-	return create_pvalue_from_string(outname);
+	return create_pvalue_from_string(indifacts_name(name, captype, 68));
 }
 /*==================================================+
  * llrpt_fullname -- Process person's name
@@ -388,6 +387,8 @@ llrpt_fullname (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	}
 
 	/* indi with a name record, or a permitted empty record (via RequireNames=0) */
+	if (regorder == REGORDER)
+		return create_pvalue_from_string(indifacts_name(name, caps, len));
 	outname = manip_name(nval(name), caps, regorder, len);
 	return create_pvalue_from_string(outname);
 }
@@ -415,7 +416,7 @@ llrpt_surname (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		}
 		return create_pvalue_from_string(0);
 	}
-	str = getasurname(nval(name));
+	str = indifacts_surname(name);
 	return create_pvalue_from_string(str);
 }
 /*========================================+
@@ -649,7 +650,7 @@ llrpt_givens (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		}
 		return create_pvalue_from_string(0);
 	}
-	str = givens(nval(name));
+	str = indifacts_givens(name);
 	return create_pvalue_from_string(str);
 }
 /*===============================+
@@ -1947,11 +1948,16 @@ llrpt_empty (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		set_pvalue_int(val, length_list(list));
 		bEmpty = !list || !length_list(list);
 	}
-	else if (val && (type == PTABLE))
+	else if (val && (type == PTABLE || type == PHSET))
 	{
 		TABLE table = pvalue_to_table(val);
 		bEmpty = !table || !get_table_count(table);
 	}
+	else if (val && (type == PMAP))
+	{
+		OMAP omap = pvalue_to_map(val);
+		bEmpty = !omap || !get_omap_count(omap);
+	}
 	else if (val && (type == PSET))
 	{
        	INDISEQ seq = pvalue_to_seq(val);
@@ -1983,9 +1989,12 @@ llrpt_length (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		if (type == PLIST) {
 			LIST list = pvalue_to_list(val);
 			len = (list ? length_list(list) : 0);
-		} else if (type == PTABLE) {
+		} else if (type == PTABLE || type == PHSET) {
 			TABLE table = pvalue_to_table(val);
 			len = (table ? get_table_count(table) : 0);
+		} else if (type == PMAP) {
+			OMAP omap = pvalue_to_map(val);
+			len = (omap ? get_omap_count(omap) : 0);
 		} else if (type == PSET) {
 			INDISEQ seq = pvalue_to_seq(val);
 			len = (seq ? length_indiseq(seq) : 0);
@@ -2630,15 +2639,16 @@ llrpt_date (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 PVALUE
 llrpt_date2jd (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 {
-	STRING str=0;
 	GDATEVAL gdv;
+	BOOLEAN freegdv = TRUE;
 	PNODE argvar = builtin_args(node);
 	
 	FLOAT jd = 0;
 	PVALUE val = eval_without_coerce(argvar, stab, eflg);
 	/* Handle string input */
 	if (val && which_pvalue_type(val) == PSTRING) {
-		str = pvalue_to_string(val);
+		/* Parse into lifelines date structure (GDATEVAL) */
+		gdv = extract_date(pvalue_to_string(val));
 	}
 	else /* handle NODE input */
 	{
@@ -2650,14 +2660,13 @@ llrpt_date2jd (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 			return NULL;
 		}
 		evnt = pvalue_to_node(val);
-		str = event_to_date(evnt, FALSE);
+		gdv = event_to_gdateval(evnt, &freegdv);
 	}
-	/* Parse into lifelines date structure (GDATEVAL) */
-	gdv = extract_date(str);
 	/* Compute julian date value as float */
 	jd = julianday(gdv);
 
-	free_gdateval(gdv);
+	if (freegdv)
+		free_gdateval(gdv);
 	*eflg = FALSE;
 	return create_pvalue_from_float(jd);
 }
@@ -2673,8 +2682,9 @@ static char *dofw[] = {  N_("Sunday"),  N_("Monday"), N_("Tuesday"),
 PVALUE
 llrpt_dayofweek (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 {
-	STRING str = 0, str2 = 0;
+	STRING str2 = 0;
 	GDATEVAL gdv;
+	BOOLEAN freegdv = TRUE;
 	INT weekdaynum = 0;
 	PNODE argvar = builtin_args(node);
 	
@@ -2682,7 +2692,8 @@ llrpt_dayofweek (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	PVALUE val = eval_without_coerce(argvar, stab, eflg);
 	/* Handle string input */
 	if (val && which_pvalue_type(val) == PSTRING) {
-		str = pvalue_to_string(val);
+		/* Parse into lifelines date structure (GDATEVAL) */
+		gdv = extract_date(pvalue_to_string(val));
 	}
 	else /* handle NODE input */
 	{
@@ -2693,10 +2704,8 @@ llrpt_dayofweek (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 			return NULL;
 		}
 		evnt = pvalue_to_node(val);
-		str = event_to_date(evnt, FALSE);
+		gdv = event_to_gdateval(evnt, &freegdv);
 	}
-	/* Parse into lifelines date structure (GDATEVAL) */
-	gdv = extract_date(str);
 	/* Compute julian date value as float */
 	jd = julianday(gdv);
 	/* Compute which day of week */
@@ -2704,7 +2713,8 @@ llrpt_dayofweek (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	/* Convert to localized name */
 	str2 = _(dofw[weekdaynum]);
 
-	free_gdateval(gdv);
+	if (freegdv)
+		free_gdateval(gdv);
 	*eflg = FALSE;
 	return create_pvalue_from_string(str2);
 }
@@ -2772,6 +2782,22 @@ llrpt_jd2date (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	return create_pvalue_from_node(prnt);
 }
 
+/*=============================================
+ * event_to_gdateval -- Parse date of event
+ *  evnt:  [IN]  event node
+ *  pfree: [OUT] whether caller must free_gdateval result
+ * Birth & death of cached people are parsed only once
+ *  (see indifacts.c)
+ *===========================================*/
+static GDATEVAL
+event_to_gdateval (NODE evnt, BOOLEAN * pfree)
+{
+	GDATEVAL gdv = indifacts_date(evnt);
+	*pfree = !gdv;
+	if (!gdv)
+		gdv = extract_date(event_to_date(evnt, FALSE));
+	return gdv;
+}
 /*======================================
  * Julian day calculation
  * Creation: Patrick Texier 2006/05/22
@@ -2834,6 +2860,7 @@ llrpt_extractdate (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	PNODE mvar = inext(dvar);
 	PNODE yvar = inext(mvar);
 	GDATEVAL gdv = 0;
+	BOOLEAN freegdv = TRUE;
 	if (*eflg) {
 		prog_var_error(node, stab, argvar, val, nonnodx, "extractdate", "1");
 		return NULL;
@@ -2856,15 +2883,18 @@ llrpt_extractdate (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		prog_error(node, nonvarx, "extractdate", "4");
 		return NULL;
 	}
-	if (nestr("DATE", ntag(line)))
-		str = event_to_date(line, FALSE);
-	else
+	if (nestr("DATE", ntag(line))) {
+		/* parse before deleting val, which may delete line node */
+		gdv = event_to_gdateval(line, &freegdv);
+		delete_pvalue(val);
+	} else {
 		str = nval(line);
-	if (str)
-	    str = strsave(str); /* save in case we delete line node */
-	delete_pvalue(val);
-	gdv = extract_date(str);
-	strfree(&str);
+		if (str)
+		    str = strsave(str); /* save in case we delete line node */
+		delete_pvalue(val);
+		gdv = extract_date(str);
+		strfree(&str);
+	}
 	/* TODO: deal with date information */
 	da = date_get_day(gdv);
 	mo = date_get_month(gdv);
@@ -2873,7 +2903,8 @@ llrpt_extractdate (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	assign_iden(stab, iident_name(dvar), create_pvalue_from_int(da));
 	assign_iden(stab, iident_name(mvar), create_pvalue_from_int(mo));
 	assign_iden(stab, iident_name(yvar), create_pvalue_from_int(yr));
-	free_gdateval(gdv);
+	if (freegdv)
+		free_gdateval(gdv);
 	*eflg = FALSE;
 	return NULL;
 }
@@ -3151,6 +3182,8 @@ llrpt_datepic (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	}
 	str = pvalue_to_string(val);
 	set_date_pic(str);
+	/* list strings of people show dates in this picture */
+	drop_indifacts();
 	delete_pvalue(val);
 	return NULL;
 }
@@ -3184,6 +3217,7 @@ llrpt_complexpic (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	}
 	str = pvalue_to_string(val);
 	ok = set_cmplx_pic(ecmplx, str);
+	drop_indifacts();
 	delete_pvalue(val);
 	if (!ok) {
 		*eflg = TRUE;
@@ -3203,10 +3237,11 @@ llrpt_year (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	STRING str=0;
 	char buff[20];
 	GDATEVAL gdv;
+	BOOLEAN freegdv = TRUE;
 	PNODE argvar = builtin_args(node);
 	PVALUE val = eval_without_coerce(argvar, stab, eflg);
 	if (val && which_pvalue_type(val) == PSTRING) {
-		str = pvalue_to_string(val);
+		gdv = extract_date(pvalue_to_string(val));
 	} else {
 		NODE evnt;
 		coerce_pvalue(PGNODE, val, eflg);
@@ -3215,9 +3250,8 @@ llrpt_year (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 			return NULL;
 		}
 		evnt = pvalue_to_node(val);
-		str = event_to_date(evnt, FALSE);
+		gdv = event_to_gdateval(evnt, &freegdv);
 	}
-	gdv = extract_date(str);
 	/* prefer year's string if it has one */
 	str = date_get_year_string(gdv);
 	if (str && str[0]) {
@@ -3233,7 +3267,8 @@ llrpt_year (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		}
 	}
 	set_pvalue_string(val, str);
-	free_gdateval(gdv);
+	if (freegdv)
+		free_gdateval(gdv);
 	return val;
 }
 /*================================+
@@ -0,0 +1,564 @@
+/*=============================================================
+ * builtin_map.c -- Report language (interpreter) ordered map
+ *  and hash set functions
+ *  Both containers are keyed by any scalar value (number,
+ *  boolean, string or record), unlike table, which takes
+ *  only string keys
+ *===========================================================*/
+
+#include "sys_inc.h"
+#include "llstdlib.h"
+#include "gedcom.h"
+#include "interpi.h"
+#include "zstr.h"
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static PVALUE eval_bound(PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname, CNSTRING argnum);
+static PVALUE eval_hset(PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname);
+static PVALUE eval_key(PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname, CNSTRING argnum);
+static PVALUE eval_map(PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname);
+static BOOLEAN hset_add(TABLE tab, PVALUE key);
+static ZSTR hset_key(PVALUE key);
+static PVALUE map_range(PNODE node, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname, BOOLEAN keys);
+
+/*********************************************
+ * local function definitions
+ * body of module
+ *********************************************/
+
+/*============================+
+ * llrpt_map -- Create ordered map
+ * usage: map(IDENT) -> VOID
+ *===========================*/
+PVALUE
+llrpt_map (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	if (!iistype(argvar, IIDENT)) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, NULL, nonvar1, "map");
+		return NULL;
+	}
+	assign_iden(stab, iident_name(argvar), create_new_pvalue_map());
+	return NULL;
+}
+/*=========================================+
+ * llrpt_mapset -- Store value under key in map
+ * usage: mapset(MAP, KEY, ANY) -> VOID
+ *========================================*/
+PVALUE
+llrpt_mapset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valmap=0, key=0, val=0;
+
+	valmap = eval_map(node, argvar, stab, eflg, "mapset");
+	if (*eflg) return NULL;
+	key = eval_key(node, argvar=inext(argvar), stab, eflg, "mapset", "2");
+	if (*eflg) goto exit_mapset;
+	val = evaluate(argvar=inext(argvar), stab, eflg);
+	if (*eflg || !val) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, val, badargx, "mapset", "3");
+		delete_pvalue(key);
+		delete_pvalue(val);
+		goto exit_mapset;
+	}
+	/* map takes over key & val */
+	insert_omap(pvalue_to_map(valmap), key, val);
+
+exit_mapset:
+	delete_pvalue(valmap);
+	return NULL;
+}
+/*====================================+
+ * llrpt_mapget -- Look up value of key in map
+ * usage: mapget(MAP, KEY) -> ANY
+ *===================================*/
+PVALUE
+llrpt_mapget (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valmap=0, key=0, found=0, newv=0;
+
+	valmap = eval_map(node, argvar, stab, eflg, "mapget");
+	if (*eflg) return NULL;
+	key = eval_key(node, inext(argvar), stab, eflg, "mapget", "2");
+	if (*eflg) {
+		delete_pvalue(valmap);
+		return NULL;
+	}
+	found = (PVALUE)find_omap(pvalue_to_map(valmap), key, NULL);
+	newv = (found ? copy_pvalue(found) : create_pvalue_any());
+	delete_pvalue(key);
+	delete_pvalue(valmap);
+	return newv;
+}
+/*====================================+
+ * llrpt_inmap -- Is key present in map ?
+ * usage: inmap(MAP, KEY) -> BOOL
+ *===================================*/
+PVALUE
+llrpt_inmap (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valmap=0, key=0;
+	BOOLEAN present=FALSE;
+
+	valmap = eval_map(node, argvar, stab, eflg, "inmap");
+	if (*eflg) return NULL;
+	key = eval_key(node, inext(argvar), stab, eflg, "inmap", "2");
+	if (*eflg) {
+		delete_pvalue(valmap);
+		return NULL;
+	}
+	find_omap(pvalue_to_map(valmap), key, &present);
+	delete_pvalue(key);
+	set_pvalue_bool(valmap, present);
+	return valmap;
+}
+/*====================================+
+ * llrpt_mapdelete -- Remove key (and its value) from map
+ * usage: mapdelete(MAP, KEY) -> BOOL
+ *===================================*/
+PVALUE
+llrpt_mapdelete (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valmap=0, key=0;
+	BOOLEAN removed=FALSE;
+
+	valmap = eval_map(node, argvar, stab, eflg, "mapdelete");
+	if (*eflg) return NULL;
+	key = eval_key(node, inext(argvar), stab, eflg, "mapdelete", "2");
+	if (*eflg) {
+		delete_pvalue(valmap);
+		return NULL;
+	}
+	removed = remove_omap(pvalue_to_map(valmap), key);
+	delete_pvalue(key);
+	set_pvalue_bool(valmap, removed);
+	return valmap;
+}
+/*====================================+
+ * llrpt_mapkeys -- List keys of map in order
+ * usage: mapkeys(MAP [, LOW [, HIGH]]) -> LIST
+ *===================================*/
+PVALUE
+llrpt_mapkeys (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	return map_range(node, stab, eflg, "mapkeys", TRUE);
+}
+/*====================================+
+ * llrpt_mapvalues -- List values of map in key order
+ * usage: mapvalues(MAP [, LOW [, HIGH]]) -> LIST
+ *===================================*/
+PVALUE
+llrpt_mapvalues (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	return map_range(node, stab, eflg, "mapvalues", FALSE);
+}
+/*====================================+
+ * map_range -- Implement mapkeys & mapvalues
+ *  Optional bounds are inclusive; a bound which is not
+ *  a valid key (eg, an unset variable) leaves that end open
+ *  keys:  [IN]  list keys (else values)
+ *===================================*/
+static PVALUE
+map_range (PNODE node, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname, BOOLEAN keys)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valmap=0, low=0, high=0, newval=0;
+	OMAP_ITER omit=0;
+	LIST list=0;
+	const void * key=0;
+	VPTR ptr=0;
+
+	valmap = eval_map(node, argvar, stab, eflg, fname);
+	if (*eflg) return NULL;
+	if ((argvar = inext(argvar))) {
+		low = eval_bound(node, argvar, stab, eflg, fname, "2");
+		if (*eflg) goto exit_range;
+		if ((argvar = inext(argvar))) {
+			high = eval_bound(node, argvar, stab, eflg, fname, "3");
+			if (*eflg) goto exit_range;
+		}
+	}
+
+	newval = create_new_pvalue_list();
+	list = pvalue_to_list(newval);
+	omit = begin_omap(pvalue_to_map(valmap), low, high);
+	while (next_omap(omit, &key, &ptr)) {
+		enqueue_list(list, copy_pvalue(keys ? (PVALUE)key : (PVALUE)ptr));
+	}
+	end_omap(&omit);
+
+exit_range:
+	delete_pvalue(low);
+	delete_pvalue(high);
+	delete_pvalue(valmap);
+	return newval;
+}
+/*====================================+
+ * llrpt_mapload -- Bulk insert parallel lists of keys & values
+ * usage: mapload(MAP, LIST, LIST) -> INT
+ *  returns number of entries stored
+ *===================================*/
+PVALUE
+llrpt_mapload (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valmap=0, valkeys=0, valvals=0;
+	LIST keys=0, vals=0;
+	LIST_ITER keyit=0, valit=0;
+	OMAP omap=0;
+	VPTR kptr=0, vptr=0;
+	INT n=0;
+
+	valmap = eval_map(node, argvar, stab, eflg, "mapload");
+	if (*eflg) return NULL;
+	valkeys = eval_and_coerce(PLIST, argvar=inext(argvar), stab, eflg);
+	if (*eflg || !valkeys) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, valkeys, nonlstx, "mapload", "2");
+		goto exit_mapload;
+	}
+	valvals = eval_and_coerce(PLIST, argvar=inext(argvar), stab, eflg);
+	if (*eflg || !valvals) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, valvals, nonlstx, "mapload", "3");
+		goto exit_mapload;
+	}
+	keys = pvalue_to_list(valkeys);
+	vals = pvalue_to_list(valvals);
+	if (length_list(keys) != length_list(vals)) {
+		*eflg = TRUE;
+		prog_error(node, _("mapload: key and value lists differ in length"));
+		goto exit_mapload;
+	}
+	omap = pvalue_to_map(valmap);
+	keyit = begin_list(keys);
+	valit = begin_list(vals);
+	while (next_list_ptr(keyit, &kptr) && next_list_ptr(valit, &vptr)) {
+		PVALUE key = (PVALUE)kptr, val = (PVALUE)vptr;
+		if (!key || !is_scalar_key_pvalue(key)) {
+			*eflg = TRUE;
+			prog_error(node, _("mapload: list element %d is not a valid key"), n+1);
+			break;
+		}
+		insert_omap(omap, copy_pvalue(key)
+			, val ? copy_pvalue(val) : create_pvalue_any());
+		++n;
+	}
+	end_list_iter(&keyit);
+	end_list_iter(&valit);
+
+exit_mapload:
+	delete_pvalue(valkeys);
+	delete_pvalue(valvals);
+	if (*eflg) {
+		delete_pvalue(valmap);
+		return NULL;
+	}
+	set_pvalue_int(valmap, n);
+	return valmap;
+}
+/*============================+
+ * llrpt_hashset -- Create hash set
+ * usage: hashset(IDENT) -> VOID
+ *===========================*/
+PVALUE
+llrpt_hashset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	if (!iistype(argvar, IIDENT)) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, NULL, nonvar1, "hashset");
+		return NULL;
+	}
+	assign_iden(stab, iident_name(argvar), create_new_pvalue_hashset());
+	return NULL;
+}
+/*====================================+
+ * llrpt_hsadd -- Add member to hash set
+ * usage: hsadd(HASHSET, KEY) -> BOOL
+ *  returns TRUE if it was not already a member
+ *===================================*/
+PVALUE
+llrpt_hsadd (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valset=0, key=0;
+	BOOLEAN added=FALSE;
+
+	valset = eval_hset(node, argvar, stab, eflg, "hsadd");
+	if (*eflg) return NULL;
+	key = eval_key(node, inext(argvar), stab, eflg, "hsadd", "2");
+	if (*eflg) {
+		delete_pvalue(valset);
+		return NULL;
+	}
+	added = hset_add(pvalue_to_table(valset), key);
+	delete_pvalue(key);
+	set_pvalue_bool(valset, added);
+	return valset;
+}
+/*====================================+
+ * llrpt_hsin -- Is value a member of hash set ?
+ * usage: hsin(HASHSET, KEY) -> BOOL
+ *===================================*/
+PVALUE
+llrpt_hsin (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valset=0, key=0;
+	ZSTR zkey=0;
+	BOOLEAN present=FALSE;
+
+	valset = eval_hset(node, argvar, stab, eflg, "hsin");
+	if (*eflg) return NULL;
+	key = eval_key(node, inext(argvar), stab, eflg, "hsin", "2");
+	if (*eflg) {
+		delete_pvalue(valset);
+		return NULL;
+	}
+	zkey = hset_key(key);
+	present = in_table(pvalue_to_table(valset), zs_str(zkey));
+	zs_free(&zkey);
+	delete_pvalue(key);
+	set_pvalue_bool(valset, present);
+	return valset;
+}
+/*====================================+
+ * llrpt_hsdelete -- Remove member from hash set
+ * usage: hsdelete(HASHSET, KEY) -> BOOL
+ *  returns TRUE if it was a member
+ *===================================*/
+PVALUE
+llrpt_hsdelete (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valset=0, key=0;
+	TABLE tab=0;
+	ZSTR zkey=0;
+	BOOLEAN present=FALSE;
+
+	valset = eval_hset(node, argvar, stab, eflg, "hsdelete");
+	if (*eflg) return NULL;
+	key = eval_key(node, inext(argvar), stab, eflg, "hsdelete", "2");
+	if (*eflg) {
+		delete_pvalue(valset);
+		return NULL;
+	}
+	tab = pvalue_to_table(valset);
+	zkey = hset_key(key);
+	present = in_table(tab, zs_str(zkey));
+	if (present)
+		delete_table_element(tab, zs_str(zkey));
+	zs_free(&zkey);
+	delete_pvalue(key);
+	set_pvalue_bool(valset, present);
+	return valset;
+}
+/*====================================+
+ * llrpt_hsaddlist -- Bulk add list elements to hash set
+ * usage: hsaddlist(HASHSET, LIST) -> INT
+ *  returns number of new members
+ *===================================*/
+PVALUE
+llrpt_hsaddlist (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valset=0, vallist=0;
+	TABLE tab=0;
+	LIST_ITER listit=0;
+	VPTR ptr=0;
+	INT i=0, n=0;
+
+	valset = eval_hset(node, argvar, stab, eflg, "hsaddlist");
+	if (*eflg) return NULL;
+	vallist = eval_and_coerce(PLIST, argvar=inext(argvar), stab, eflg);
+	if (*eflg || !vallist) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, vallist, nonlstx, "hsaddlist", "2");
+		delete_pvalue(vallist);
+		delete_pvalue(valset);
+		return NULL;
+	}
+	tab = pvalue_to_table(valset);
+	listit = begin_list(pvalue_to_list(vallist));
+	while (next_list_ptr(listit, &ptr)) {
+		PVALUE key = (PVALUE)ptr;
+		++i;
+		if (!key || !is_scalar_key_pvalue(key)) {
+			*eflg = TRUE;
+			prog_error(node, _("hsaddlist: list element %d is not a valid key"), i);
+			break;
+		}
+		if (hset_add(tab, key))
+			++n;
+	}
+	end_list_iter(&listit);
+	delete_pvalue(vallist);
+	if (*eflg) {
+		delete_pvalue(valset);
+		return NULL;
+	}
+	set_pvalue_int(valset, n);
+	return valset;
+}
+/*====================================+
+ * llrpt_hslist -- List members of hash set
+ * usage: hslist(HASHSET) -> LIST
+ *  (in no particular order)
+ *===================================*/
+PVALUE
+llrpt_hslist (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE valset=0, newval=0;
+	TABLE_ITER tabit=0;
+	LIST list=0;
+	CNSTRING skey=0;
+	VPTR ptr=0;
+
+	valset = eval_hset(node, argvar, stab, eflg, "hslist");
+	if (*eflg) return NULL;
+	newval = create_new_pvalue_list();
+	list = pvalue_to_list(newval);
+	tabit = begin_table_iter(pvalue_to_table(valset));
+	while (next_table_ptr(tabit, &skey, &ptr)) {
+		enqueue_list(list, copy_pvalue((PVALUE)ptr));
+	}
+	end_table_iter(&tabit);
+	delete_pvalue(valset);
+	return newval;
+}
+/*====================================+
+ * hset_add -- Add copy of key to hash set table
+ *  returns FALSE if already present
+ *===================================*/
+static BOOLEAN
+hset_add (TABLE tab, PVALUE key)
+{
+	ZSTR zkey = hset_key(key);
+	BOOLEAN added = !in_table(tab, zs_str(zkey));
+	if (added)
+		insert_table_ptr(tab, zs_str(zkey), copy_pvalue(key));
+	zs_free(&zkey);
+	return added;
+}
+/*====================================+
+ * hset_key -- Encode scalar value as hash set table key
+ *  Keys equal under pvalue_keys_compare encode the same,
+ *  so 2 and 2.0 are the same member (as they are in a map).
+ *  Other floats are encoded by their bits (all NaNs alike).
+ *===================================*/
+static ZSTR
+hset_key (PVALUE key)
+{
+	switch (ptype(key)) {
+	case PINT:
+		return zs_newf("n%d", pvalue_to_int(key));
+	case PFLOAT:
+		{
+			float fval = pvalue_to_float(key);
+			unsigned int bits = 0;
+			if (fval != fval)
+				return zs_news("fnan");
+			if (fval == 0)
+				fval = 0; /* -0.0 is 0 */
+			/* only convert to INT when in range */
+			if (fval >= -2147483648.0 && fval < 2147483648.0
+				&& fval == (INT)fval)
+				return zs_newf("n%d", (INT)fval);
+			ASSERT(sizeof(fval) <= sizeof(bits));
+			memcpy(&bits, &fval, sizeof(fval));
+			return zs_newf("f%x", bits);
+		}
+	case PBOOL:
+		return zs_news(pvalue_to_bool(key) ? "b1" : "b0");
+	case PSTRING:
+		{
+			ZSTR zstr = zs_news("s");
+			zs_apps(zstr, pvalue_to_string(key));
+			return zstr;
+		}
+	}
+	{
+		RECORD rec = pvalue_to_record(key);
+		return zs_newf("r%d%s", ptype(key), rec ? nzkey(rec) : "");
+	}
+}
+/*====================================+
+ * eval_map -- Evaluate argument which must be a map
+ *  returns map pvalue, or NULL & sets *eflg
+ *===================================*/
+static PVALUE
+eval_map (PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname)
+{
+	PVALUE val = eval_and_coerce(PMAP, argvar, stab, eflg);
+	if (*eflg || !val || !pvalue_to_map(val)) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, val, nonmapx, fname, "1");
+		delete_pvalue(val);
+		return NULL;
+	}
+	return val;
+}
+/*====================================+
+ * eval_hset -- Evaluate argument which must be a hash set
+ *  returns hash set pvalue, or NULL & sets *eflg
+ *===================================*/
+static PVALUE
+eval_hset (PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname)
+{
+	PVALUE val = eval_and_coerce(PHSET, argvar, stab, eflg);
+	if (*eflg || !val || !pvalue_to_table(val)) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, val, nonhsetx, fname, "1");
+		delete_pvalue(val);
+		return NULL;
+	}
+	return val;
+}
+/*====================================+
+ * eval_key -- Evaluate argument which must be a scalar key
+ *  returns key pvalue, or NULL & sets *eflg
+ *===================================*/
+static PVALUE
+eval_key (PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname, CNSTRING argnum)
+{
+	PVALUE val = evaluate(argvar, stab, eflg);
+	if (*eflg || !val || !is_scalar_key_pvalue(val)) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, val, nonkeyx, fname, argnum);
+		delete_pvalue(val);
+		return NULL;
+	}
+	return val;
+}
+/*====================================+
+ * eval_bound -- Evaluate optional range bound
+ *  returns key pvalue, or NULL for open end
+ *===================================*/
+static PVALUE
+eval_bound (PNODE node, PNODE argvar, SYMTAB stab, BOOLEAN *eflg, CNSTRING fname, CNSTRING argnum)
+{
+	PVALUE val = evaluate(argvar, stab, eflg);
+	if (*eflg || !val) {
+		*eflg = TRUE;
+		prog_var_error(node, stab, argvar, val, badargx, fname, argnum);
+		delete_pvalue(val);
+		return NULL;
+	}
+	if (!is_scalar_key_pvalue(val)) {
+		delete_pvalue(val);
+		return NULL;
+	}
+	return val;
+}
@@ -217,6 +217,12 @@ evaluate_func (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	if (prog_trace)
 		trace_outl("evaluate_func called: %d: %s",
 		    iline(node)+1, iname(node));
+	if (prog_profile) {
+		prof_enter(IBCALL, iname(node));
+		val = (*(PFUNC)ifunc(node))(node, stab, eflg);
+		prof_leave();
+		return val;
+	}
 	val = (*(PFUNC)ifunc(node))(node, stab, eflg);
 	return val;
 }
@@ -266,7 +272,11 @@ evaluate_ufunc (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		prog_error(node, "``%s'': mismatched args and params\n", procname);
 		goto ufunc_leave;
 	}
+	if (prog_profile)
+		prof_enter(IFCALL, procname);
 	irc = interpret((PNODE) ibody(func), newstab, &val);
+	if (prog_profile)
+		prof_leave();
 	switch (irc) {
 	case INTRETURN:
 	case INTOKAY:
@@ -50,7 +50,7 @@ BUILTINS builtins[] = {
 	{"addnode",         3,    3,    llrpt_addnode},
 	{"addtoset",        3,    3,    llrpt_addtoset},
 	{"alpha",           1,    1,    llrpt_alpha},
-	{"ancestorset",     1,    1,    llrpt_ancestorset},
+	{"ancestorset",     1,    2,    llrpt_ancestorset},
 	{"and",             2,    32,   llrpt_and},
 	{"arccos",          1,    1,    llrpt_arccos},
 	{"arcsin",          1,    1,    llrpt_arcsin},
@@ -95,8 +95,8 @@ BUILTINS builtins[] = {
 	{"deletenode",      1,    1,    llrpt_detachnode},
 	{"dequeue",         1,    1,    llrpt_dequeue},
 	{"dereference",     1,    1,    llrpt_dereference},
-	{"descendantset",   1,    1,    llrpt_descendentset},
-	{"descendentset",   1,    1,    llrpt_descendentset},
+	{"descendantset",   1,    2,    llrpt_descendentset},
+	{"descendentset",   1,    2,    llrpt_descendentset},
 	{"detachnode",      1,    1,    llrpt_detachnode},
 	{"difference",      2,    2,    llrpt_difference},
 	{"div",             2,    2,    llrpt_div},
@@ -144,24 +144,33 @@ BUILTINS builtins[] = {
 	{"gettoday",        0,    0,    llrpt_gettoday},
 	{"givens",          1,    1,    llrpt_givens},
 	{"gt",              2,    2,    llrpt_gt},
+	{"hashset",         1,    1,    llrpt_hashset},
 	{"heapused",        0,    0,    llrpt_heapused},
+	{"hsadd",           2,    2,    llrpt_hsadd},
+	{"hsaddlist",       2,    2,    llrpt_hsaddlist},
+	{"hsdelete",        2,    2,    llrpt_hsdelete},
+	{"hsin",            2,    2,    llrpt_hsin},
+	{"hslist",          1,    1,    llrpt_hslist},
 	{"husband",         1,    1,    llrpt_husband},
 	{"incr",            1,    2,    llrpt_incr},
 	{"index",           3,    3,    llrpt_index},
 	{"indi",            1,    1,    llrpt_indi},
 	{"indiset",         1,    1,    llrpt_indiset},
 	{"inlist",          2,    2,    llrpt_inlist},
+	{"inmap",           2,    2,    llrpt_inmap},
 	{"inode",           1,    1,    llrpt_inode},
 	{"insert",          3,    3,    llrpt_insert},
 	{"inset",           2,    2,    llrpt_inset},
 	{"int",             1,    1,    llrpt_int},
 	{"intersect",       2,    2,    llrpt_intersect},
+	{"isancestor",      2,    2,    llrpt_isancestor},
 	{"jd2date",         1,    1,    llrpt_jd2date},
 	{"key",             1,    2,    llrpt_key},
 	{"keysort",         1,    1,    llrpt_keysort},
 	{"lastchild",       1,    1,    llrpt_lastchild},
 	{"lastfam",         0,    0,    llrpt_lastfam},
 	{"lastindi",        0,    0,    llrpt_lastindi},
+	{"lca",             2,    2,    llrpt_lca},
 	{"le",              2,    2,    llrpt_le},
 	{"length",          1,    1,    llrpt_length},
 	{"lengthset",       1,    1,    llrpt_lengthset},
@@ -174,6 +183,13 @@ BUILTINS builtins[] = {
 	{"lower",           1,    1,    llrpt_lower},
 	{"lt",              2,    2,    llrpt_lt},
 	{"male",            1,    1,    llrpt_male},
+	{"map",             1,    1,    llrpt_map},
+	{"mapdelete",       2,    2,    llrpt_mapdelete},
+	{"mapget",          2,    2,    llrpt_mapget},
+	{"mapkeys",         1,    3,    llrpt_mapkeys},
+	{"mapload",         3,    3,    llrpt_mapload},
+	{"mapset",          3,    3,    llrpt_mapset},
+	{"mapvalues",       1,    3,    llrpt_mapvalues},
 	{"marriage",        1,    1,    llrpt_marr},
 	{"menuchoose",      1,    2,    llrpt_menuchoose},
 	{"mod",             2,    2,    llrpt_mod},
@@ -252,6 +268,7 @@ BUILTINS builtins[] = {
 	{"tag",             1,    1,    llrpt_tag},
 	{"tan",             1,    1,    llrpt_tan},
 	{"test",            2,    2,    llrpt_test},
+	{"textsearch",      1,    2,    llrpt_textsearch},
 	{"title",           1,    1,    llrpt_titl},
 	{"titlecase",       1,    1,    llrpt_titlcase},
 	{"trim",            2,    2,    llrpt_trim},
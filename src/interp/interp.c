@@ -83,6 +83,21 @@ extern BOOLEAN progrunning, progparsing;
 extern STRING qSwhatrpt;
 extern STRING qSunsupuniv;
 
+/*********************************************
+ * local types
+ *********************************************/
+
+/* parsed program kept by interp_load_cached */
+typedef struct tag_cached_program {
+	STRING key;            /* program files asked for */
+	STRING rootfilepath;   /* full path of first program file */
+	LIST donelist;         /* pathinfos of files parsed */
+	TABLE proctab;         /* gproctab for program */
+	TABLE functab;         /* gfunctab for program */
+	SYMTAB globals;        /* globtab for program */
+	BOOLEAN explicitvars;
+} *CACHED_PROGRAM;
+
 /*********************************************
  * local function prototypes
  *********************************************/
@@ -92,13 +107,17 @@ static void clean_orphaned_rptlocks(void);
 static void delete_pathinfo(PATHINFO * pathinfo);
 static void enqueue_parse_error(const char * fmt, ...);
 static BOOLEAN find_program(CNSTRING fname, STRING localdir, STRING *pfull,BOOLEAN include);
+static BOOLEAN find_program_list(LIST lifiles, BOOLEAN picklist, LIST plist, STRING *prootpath);
 static void init_pactx(PACTX pactx);
+static BOOLEAN is_cached_stale(CACHED_PROGRAM prog);
 static BOOLEAN interpret_prog(PNODE begin, SYMTAB stab);
 static PATHINFO new_pathinfo(CNSTRING fname, STRING fullpath);
 static void parse_file(PACTX pactx, STRING fname, STRING fullpath);
+static BOOLEAN parse_program_list(PACTX pactx, LIST plist, LIST donelist);
 static void print_report_duration(INT duration, INT uiduration);
 static void progmessage(MSG_LEVEL level, STRING);
 static void remove_tables(PACTX pactx);
+static INT run_program(CNSTRING rootfilepath, STRING proc, INT nargs, VPTR *args, STRING ofile);
 static void wipe_pactx(PACTX pactx);
 
 /*********************************************
@@ -106,6 +125,8 @@ static void wipe_pactx(PACTX pactx);
  *********************************************/
 
 static LIST outstanding_parse_errors = 0;
+static LIST cached_programs = 0; /* see interp_load_cached */
+static CACHED_PROGRAM cur_cached = 0;
 
 /*********************************************
  * local function definitions
@@ -211,10 +232,6 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 	, STRING ofile, BOOLEAN picklist)
 {
 	LIST plist=0, donelist=0;
-	SYMTAB stab = NULL;
-	INT i;
-	INT nfiles = length_list(lifiles);
-	PNODE first, parm;
 	struct tag_pactx pact;
 	PACTX pactx = &pact;
 	STRING rootfilepath=0;
@@ -229,6 +246,51 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 	/* list of pathinfos finished */
 	donelist = create_list();
 
+	if (!find_program_list(lifiles, picklist, plist, &rootfilepath))
+		goto interp_program_notfound;
+
+	if (parse_program_list(pactx, plist, donelist))
+		ranit = run_program(rootfilepath, proc, nargs, args, ofile);
+
+	remove_tables(pactx);
+
+interp_program_notfound:
+
+	symbol_tables_end();
+	pvalues_end();
+	wipe_pactx(pactx);
+	xl_free_adhoc_xlats();
+
+	/* kill any orphaned pathinfos */
+	while (!is_empty_list(plist)) {
+		PATHINFO pathinfo = (PATHINFO)dequeue_list(plist);
+		delete_pathinfo(&pathinfo);
+	}
+	/* Assumption -- pactx->fullpath stays live longer than all pnodes */
+	while (!is_empty_list(donelist)) {
+		PATHINFO pathinfo = (PATHINFO)dequeue_list(donelist);
+		delete_pathinfo(&pathinfo);
+	}
+	strfree(&rootfilepath);
+	destroy_list(donelist);
+	destroy_list(plist);
+	return ranit;
+}
+/*=============================================+
+ * find_program_list -- Find program files to parse
+ *  lifiles:   [IN]  program files (if empty, ask user)
+ *  picklist:  [IN]  show user list of existing reports ?
+ *  plist:     [I/O] list to receive pathinfos of files found
+ *  prootpath: [OUT] full path of first program file
+ * Files not found are queued as parse errors.
+ * returns FALSE if user did not pick a program
+ *============================================*/
+static BOOLEAN
+find_program_list (LIST lifiles, BOOLEAN picklist, LIST plist, STRING *prootpath)
+{
+	INT i;
+	INT nfiles = length_list(lifiles);
+
 	if (nfiles > 0) {
 		for (i = 1; i < nfiles+1; i++) {
 			STRING fullpath = 0;
@@ -238,7 +300,7 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 				strfree(&fullpath);
 				enqueue_list(plist, pathinfo);
 				if (i==1)
-					strupdate(&rootfilepath, pathinfo->fullpath);
+					strupdate(prootpath, pathinfo->fullpath);
 			} else {
 				enqueue_parse_error(_("Report not found: %s "), progfile);
 			}
@@ -255,15 +317,29 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 			}
 			strfree(&fname);
 			strfree(&fullpath);
-			goto interp_program_notfound;
+			return FALSE;
 		}
 		pathinfo = new_pathinfo(fname, fullpath);
 		strfree(&fname);
 		strfree(&fullpath);
 
-		strupdate(&rootfilepath, pathinfo->fullpath);
+		strupdate(prootpath, pathinfo->fullpath);
 		enqueue_list(plist, pathinfo);
 	}
+	return TRUE;
+}
+/*=============================================+
+ * parse_program_list -- Parse program files
+ *  pactx:    [I/O] global parsing context
+ *  plist:    [I/O] files to parse (included files are added)
+ *  donelist: [I/O] list to receive pathinfos of files parsed
+ * Creates the interpreter's tables (see remove_tables).
+ * returns FALSE (after reporting) if program has errors
+ *============================================*/
+static BOOLEAN
+parse_program_list (PACTX pactx, LIST plist, LIST donelist)
+{
+	struct stat sbuf;
 
 	progparsing = TRUE;
 
@@ -281,10 +357,16 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 			STRING str;
 			insert_table_obj(pactx->filetab, cur_pathinfo->fullpath, 0);
 			Plist = plist;
+			/* note time before reading, so later changes are seen */
+			if (!stat(cur_pathinfo->fullpath, &sbuf))
+				cur_pathinfo->mtime = sbuf.st_mtime;
 			parse_file(pactx, cur_pathinfo->fname, cur_pathinfo->fullpath);
 			if ((str = check_rpt_requires(pactx, cur_pathinfo->fullpath)) != 0) {
 				progmessage(MSG_ERROR, str);
-				goto interp_program_exit;
+				/* kept in donelist, so caller frees it */
+				enqueue_list(donelist, cur_pathinfo);
+				cur_pathinfo = 0;
+				return FALSE;
 			}
 			enqueue_list(donelist, cur_pathinfo);
 		} else {
@@ -293,9 +375,6 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 		}
 		cur_pathinfo = 0;
 	}
-	destroy_list(plist);
-	plist=NULL;
-
 
 	if (outstanding_parse_errors) {
 		STRING str;
@@ -310,21 +389,39 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 
 	if (Perrors) {
 		progmessage(MSG_ERROR, _("Program contains errors.\n"));
-		goto interp_program_exit;
+		return FALSE;
 	}
+	return TRUE;
+}
+/*=============================================+
+ * run_program -- Run parsed program
+ *  rootfilepath: [IN]  full path of first program file
+ *  proc:         [IN]  proc to call
+ *  nargs:        [IN]  number of arguments
+ *  args:         [IN]  arguments
+ *  ofile:        [IN]  output file - can be NULL
+ * returns 0 if it didn't actually run
+ *============================================*/
+static INT
+run_program (CNSTRING rootfilepath, STRING proc, INT nargs, VPTR *args, STRING ofile)
+{
+	SYMTAB stab = NULL;
+	INT i;
+	PNODE first, parm;
+	INT ranit=0;
 
    /* Find top procedure */
 
 	if (!(first = (PNODE) valueof_ptr(get_rptinfo(rootfilepath)->proctab, proc))) {
 		progmessage(MSG_ERROR, _("Program needs a starting procedure.\n"));
-		goto interp_program_exit;
+		goto run_program_exit;
 	}
 
    /* Open output file if name is provided */
 
 	if (ofile) {
 		if (!start_output_file(ofile)) {
-			goto interp_program_exit;
+			goto run_program_exit;
 		}
 	}
 	if (Poutfp) setbuf(Poutfp, NULL);
@@ -335,7 +432,7 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 	if (nargs != num_params(parm)) {
 		msg_error(_("Proc %s must be called with %d (not %d) parameters."),
 			proc, num_params(parm), nargs);
-		goto interp_program_exit;
+		goto run_program_exit;
 	}
 	stab = create_symtab_proc(proc, NULL);
 	for (i = 0; i < nargs; i++) {
@@ -349,7 +446,11 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 	progrunning = TRUE;
 	progerror = 0;
 	progmessage(MSG_STATUS, _("Program is running..."));
+	prof_begin();
+	if (prog_profile)
+		prof_enter(IPCALL, proc);
 	ranit = interpret_prog((PNODE) ibody(first), stab);
+	prof_end();
 
    /* Clean up and return */
 
@@ -358,34 +459,12 @@ interp_program_list (STRING proc, INT nargs, VPTR *args, LIST lifiles
 	if (Poutfp) fclose(Poutfp);
 	Poutfp = NULL;
 
-interp_program_exit:
+run_program_exit:
 
-	remove_tables(pactx);
 	if (stab) {
 		remove_symtab(stab);
 		stab = NULL;
 	}
-
-interp_program_notfound:
-
-	symbol_tables_end();
-	pvalues_end();
-	wipe_pactx(pactx);
-	xl_free_adhoc_xlats();
-
-	/* kill any orphaned pathinfos */
-	while (!is_empty_list(plist)) {
-		PATHINFO pathinfo = (PATHINFO)dequeue_list(plist);
-		delete_pathinfo(&pathinfo);
-	}
-	/* Assumption -- pactx->fullpath stays live longer than all pnodes */
-	while (!is_empty_list(donelist)) {
-		PATHINFO pathinfo = (PATHINFO)dequeue_list(donelist);
-		delete_pathinfo(&pathinfo);
-	}
-	strfree(&rootfilepath);
-	destroy_list(donelist);
-	destroy_list(plist);
 	return ranit;
 }
 /*===============================================
@@ -571,6 +650,157 @@ interp_main (LIST lifiles, STRING ofile, BOOLEAN picklist, BOOLEAN timing)
 	in case any were left locked by report
 	*/
 }
+/*=============================================+
+ * interp_load_cached -- Parse program, unless already parsed
+ *  lifiles: [IN]  program files
+ * Parsed programs are kept, with their interpreter tables, for
+ * interp_run_cached to run. As pnodes & pvalues can only be freed
+ * all together, once any file of a kept program (including its
+ * included files) has changed, all are dropped & parsed afresh.
+ * For llexec --serve, which runs each job in a child process, so
+ * running a program never alters what is kept here.
+ * returns FALSE (after reporting) if program not found or has errors
+ *============================================*/
+BOOLEAN
+interp_load_cached (LIST lifiles)
+{
+	ZSTR zkey = zs_new();
+	CACHED_PROGRAM prog=0;
+	struct tag_pactx pact;
+	PACTX pactx = &pact;
+	LIST plist=0;
+	BOOLEAN ok=FALSE, stale=FALSE;
+
+	cur_cached = 0;
+	FORLIST(lifiles, el)
+		zs_apps(zkey, (STRING)el);
+		zs_apps(zkey, "\n");
+	ENDLIST
+	if (cached_programs) {
+		FORLIST(cached_programs, el)
+			CACHED_PROGRAM prog1 = (CACHED_PROGRAM)el;
+			if (is_cached_stale(prog1))
+				stale = TRUE;
+			if (eqstr(prog1->key, zs_str(zkey)))
+				prog = prog1;
+		ENDLIST
+		if (stale) {
+			interp_clear_cached();
+			prog = 0;
+		}
+	}
+	if (prog) {
+		cur_cached = prog;
+		zs_free(&zkey);
+		return TRUE;
+	}
+
+	if (!cached_programs) {
+		pvalues_begin();
+		cached_programs = create_list();
+	}
+	prog = (CACHED_PROGRAM)stdalloc(sizeof(*prog));
+	prog->key = strsave(zs_str(zkey));
+	zs_free(&zkey);
+	prog->donelist = create_list();
+	plist = create_list();
+	init_pactx(pactx);
+	if (find_program_list(lifiles, FALSE, plist, &prog->rootfilepath))
+		ok = parse_program_list(pactx, plist, prog->donelist);
+	progparsing = FALSE;
+	/* take interpreter's tables, to be restored when run */
+	prog->proctab = gproctab;
+	prog->functab = gfunctab;
+	prog->globals = globtab;
+	prog->explicitvars = explicitvars;
+	gproctab = gfunctab = NULL;
+	globtab = NULL;
+	wipe_pactx(pactx);
+	while (!is_empty_list(plist)) {
+		PATHINFO pathinfo = (PATHINFO)dequeue_list(plist);
+		delete_pathinfo(&pathinfo);
+	}
+	destroy_list(plist);
+
+	enqueue_list(cached_programs, prog);
+	if (ok)
+		cur_cached = prog;
+	else /* do not let failed parses pile up */
+		interp_clear_cached();
+	return ok;
+}
+/*=============================================+
+ * interp_run_cached -- Run main proc of program last loaded
+ *  by interp_load_cached
+ *  ofile: [IN]  output file - can be NULL
+ * returns 0 if it didn't actually run
+ *============================================*/
+INT
+interp_run_cached (STRING ofile)
+{
+	INT ranit=0;
+	ASSERT(cur_cached);
+	gproctab = cur_cached->proctab;
+	gfunctab = cur_cached->functab;
+	globtab = cur_cached->globals;
+	explicitvars = cur_cached->explicitvars;
+
+	interp_load_lang();
+	prog_trace = FALSE; /* clear report debug flag */
+	init_debugger();
+	rptui_init(); /* clear ui time counter */
+	rptlocale();
+	ranit = run_program(cur_cached->rootfilepath, "main", 0, NULL, ofile);
+	uilocale();
+	return ranit;
+}
+/*=============================================+
+ * interp_clear_cached -- Drop all programs kept by interp_load_cached
+ *============================================*/
+void
+interp_clear_cached (void)
+{
+	if (!cached_programs)
+		return;
+	while (!is_empty_list(cached_programs)) {
+		CACHED_PROGRAM prog = (CACHED_PROGRAM)dequeue_list(cached_programs);
+		destroy_table(prog->proctab);
+		if (prog->globals)
+			remove_symtab(prog->globals);
+		destroy_table(prog->functab);
+		while (!is_empty_list(prog->donelist)) {
+			PATHINFO pathinfo = (PATHINFO)dequeue_list(prog->donelist);
+			delete_pathinfo(&pathinfo);
+		}
+		destroy_list(prog->donelist);
+		strfree(&prog->key);
+		strfree(&prog->rootfilepath);
+		stdfree(prog);
+	}
+	destroy_list(cached_programs);
+	cached_programs = 0;
+	cur_cached = 0;
+	gproctab = gfunctab = NULL;
+	globtab = NULL;
+	symbol_tables_end();
+	pvalues_end();
+	xl_free_adhoc_xlats();
+}
+/*=============================================+
+ * is_cached_stale -- Has any file of kept program changed ?
+ *============================================*/
+static BOOLEAN
+is_cached_stale (CACHED_PROGRAM prog)
+{
+	struct stat sbuf;
+	BOOLEAN stale = FALSE;
+	FORLIST(prog->donelist, el)
+		PATHINFO pathinfo = (PATHINFO)el;
+		if (stat(pathinfo->fullpath, &sbuf) || sbuf.st_mtime != pathinfo->mtime)
+			stale = TRUE;
+	ENDLIST
+	return stale;
+}
 /*======================================
  * interpret -- Interpret statement list
  * PNODE node:   first node to interpret
@@ -594,6 +824,8 @@ interpret (PNODE node, SYMTAB stab, PVALUE *pval)
 			trace_pnode(node);
 			trace_endl();
 		}
+		if (prog_profile)
+			prof_line(node);
 		switch (itype(node)) {
 		case ISCONS:
 			poutput(pvalue_to_string(node->vars.iscons.value), &eflg);
@@ -749,6 +981,17 @@ interpret (PNODE node, SYMTAB stab, PVALUE *pval)
 				return irc;
 			}
 			break;
+		case IPARINDI:
+		case IPARFAM:
+			switch (irc = interp_parloop(node, stab, pval)) {
+			case INTOKAY:
+				break;
+			case INTERROR:
+				goto interp_fail;
+			default:
+				return irc;
+			}
+			break;
 		case IFAM:
 			switch (irc = interp_forfam(node, stab, pval)) {
 			case INTOKAY:
@@ -1802,7 +2045,11 @@ interp_call (PNODE node, SYMTAB stab, PVALUE *pval)
 		irc = INTERROR;
 		goto call_leave;
 	}
+	if (prog_profile)
+		prof_enter(IPCALL, procname);
 	irc = interpret((PNODE) ibody(proc), newstab, pval);
+	if (prog_profile)
+		prof_leave();
 	switch (irc) {
 	case INTRETURN:
 	case INTOKAY:
@@ -54,6 +54,7 @@ typedef struct tag_pactx *PACTX;
 typedef struct tag_pathinfo {
 	STRING fname;    /* filename as user specified */
 	STRING fullpath; /* fully qualified path */
+	time_t mtime;    /* modification time when parsed */
 } *PATHINFO;
 
 struct tag_rptinfo {
@@ -187,6 +188,8 @@ struct tag_pnode {
 #define IFAMCS      30   /* parents loop */
 #define INOTES      31   /* notes loop */
 #define IFAMILYSPOUSES 32   /* family spouses loop */
+#define IPARINDI    33   /* parallel person loop */
+#define IPARFAM     34   /* parallel family loop */
 #define IFREED      99   /* returned to free list */
 
 /* pnode flags */
@@ -228,6 +231,7 @@ PNODE ifcall_args(PNODE node);
 #define ielement(i)  ((i)->i_word2)     /* loop element */
 #define ibody(i)     ((i)->i_word5)     /* body of proc, func, loops */
 #define inum(i)      ((i)->i_word4)     /* counter used by many loops */
+#define ireduce(i)   ((i)->i_word1)     /* reduction vars of parallel loops */
 
 typedef PVALUE (*PFUNC)(PNODE, SYMTAB, BOOLEAN *);
 
@@ -252,6 +256,8 @@ void initinterp(void);
 void initrassa(void);
 void finishinterp(void);
 void finishrassa(void);
+void begin_deferred_output(void);
+ZSTR end_deferred_output(void);
 
 INTERPTYPE interpret(PNODE, SYMTAB, PVALUE*);
 INTERPTYPE interp_children(PNODE, SYMTAB, PVALUE*);
@@ -268,6 +274,7 @@ INTERPTYPE interp_forsour(PNODE, SYMTAB, PVALUE*);
 INTERPTYPE interp_foreven(PNODE, SYMTAB, PVALUE*);
 INTERPTYPE interp_forothr(PNODE, SYMTAB, PVALUE*);
 INTERPTYPE interp_forfam(PNODE, SYMTAB, PVALUE*);
+INTERPTYPE interp_parloop(PNODE, SYMTAB, PVALUE*);
 INTERPTYPE interp_indisetloop(PNODE, SYMTAB, PVALUE*);
 INTERPTYPE interp_forlist(PNODE, SYMTAB, PVALUE*);
 INTERPTYPE interp_if(PNODE, SYMTAB, PVALUE*);
@@ -371,7 +378,13 @@ PVALUE llrpt_gettext(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_gettoday(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_givens(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_gt(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_hashset(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_heapused(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_hsadd(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_hsaddlist(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_hsdelete(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_hsin(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_hslist(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_husband(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_incr(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_index(PNODE, SYMTAB, BOOLEAN *);
@@ -379,17 +392,20 @@ PVALUE llrpt_indi(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_indiset(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_inlist(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_inlist(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_inmap(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_inode(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_insert(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_inset(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_int(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_intersect(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_isancestor(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_jd2date(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_key(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_keysort(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_lastchild(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_lastfam(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_lastindi(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_lca(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_le(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_length(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_lengthset(PNODE, SYMTAB, BOOLEAN *);
@@ -402,6 +418,13 @@ PVALUE llrpt_lookup(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_lower(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_lt(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_male(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_map(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_mapdelete(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_mapget(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_mapkeys(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_mapload(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_mapset(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_mapvalues(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_marr(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_menuchoose(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_mod(PNODE, SYMTAB, BOOLEAN *);
@@ -479,6 +502,7 @@ PVALUE llrpt_table(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_tag(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_tan(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_test(PNODE, SYMTAB, BOOLEAN *);
+PVALUE llrpt_textsearch(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_titl(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_titlcase(PNODE, SYMTAB, BOOLEAN *);
 PVALUE llrpt_trim(PNODE, SYMTAB, BOOLEAN *);
@@ -502,6 +526,7 @@ PVALUE llrpt_yearformat(PNODE, SYMTAB, BOOLEAN *);
 extern BUILTINS builtins[];
 extern INT nobuiltins;
 extern BOOLEAN prog_trace;
+extern BOOLEAN prog_profile;
 
 extern TABLE gfunctab;
 extern SYMTAB globtab;
@@ -522,7 +547,7 @@ extern STRING nonind1, nonindx, nonfam1, nonfamx, nonif1, nonrecx;
 extern STRING nonnod1, nonnodx;
 extern STRING nonvar1, nonvarx;
 extern STRING nonlst1, nonlstx;
-extern STRING nontabx;
+extern STRING nontabx, nonmapx, nonhsetx, nonkeyx;
 extern STRING nonset1,nonsetx;
 extern STRING nonlstarrx;
 extern STRING badtrig;
@@ -603,6 +628,13 @@ void pa_handle_proc(PACTX pactx, CNSTRING procname, PNODE nd_args, PNODE nd_body
 void pa_handle_require(PACTX pactx, PNODE node);
 PNODE familyspouses_node(PACTX pactx, PNODE, STRING, STRING, PNODE);
 PNODE parents_node(PACTX pactx, PNODE, STRING, STRING, PNODE);
+PNODE parforfam_node(PACTX pactx, STRING, STRING, PNODE, PNODE);
+PNODE parforindi_node(PACTX pactx, STRING, STRING, PNODE, PNODE);
+void prof_begin(void);
+void prof_end(void);
+void prof_enter(INT kind, CNSTRING name);
+void prof_leave(void);
+void prof_line(PNODE node);
 void prog_error(PNODE, STRING, ...);
 void prog_var_error(PNODE node, SYMTAB stab, PNODE arg, PVALUE val, STRING fmt, ...);
 STRING prot(STRING str);
@@ -613,6 +645,7 @@ void show_pnode(PNODE);
 void show_pnodes(PNODE);
 PNODE spouses_node(PACTX pactx, PNODE, STRING, STRING, STRING, PNODE);
 BOOLEAN start_output_file (STRING outfname);
+PVALUE create_new_pvalue_set(void);
 PNODE create_string_node(PACTX pactx, STRING);
 void trace_endl(void);
 void trace_out(STRING fmt, ...);
@@ -70,7 +70,6 @@ static struct tag_indiseq_value_fnctable pvseq_fnctbl =
 PVALUE
 llrpt_indiset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 {
-	INDISEQ newseq=0;
 	PVALUE newval=0;
 	PNODE arg1 = builtin_args(node);
 	if (!iistype(arg1, IIDENT)) {
@@ -79,13 +78,22 @@ llrpt_indiset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		return NULL;
 	}
 	*eflg = FALSE;
-	newseq = create_indiseq_pval();
-	set_indiseq_value_funcs(newseq, &pvseq_fnctbl);
-	newval = create_pvalue_from_seq(newseq);
+	newval = create_new_pvalue_set();
 	assign_iden(stab, iident_name(arg1), newval);
 	/* gave val1 to stab, so don't clear it */
 	return NULL;
 }
+/*=============================================
+ * create_new_pvalue_set -- Create new empty set inside new pvalue
+ *  (set holds pvalues, like one made by indiset)
+ *============================================*/
+PVALUE
+create_new_pvalue_set (void)
+{
+	INDISEQ newseq = create_indiseq_pval();
+	set_indiseq_value_funcs(newseq, &pvseq_fnctbl);
+	return create_pvalue_from_seq(newseq);
+}
 /*==================================+
  * llrpt_addtoset -- Add person to INDISEQ
  * usage: addtoset(SET, INDI, ANY) -> VOID
@@ -499,42 +507,140 @@ llrpt_spouseset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 }
 /*================================================+
  * llrpt_ancestorset -- Create ancestor set of an INDISEQ
- * usage: ancestorset(SET) -> SET
+ *  optionally limited to given number of generations
+ * usage: ancestorset(SET [, INT]) -> SET
  *===============================================*/
 PVALUE
 llrpt_ancestorset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 {
 	INDISEQ seq=0;
-	PNODE arg1 = builtin_args(node);
+	INT maxgen=0;
+	PNODE arg1 = builtin_args(node), arg2 = inext(arg1);
 	PVALUE val1 = eval_and_coerce(PSET, arg1, stab, eflg);
 	if (*eflg) {
 		prog_var_error(node, stab, arg1, val1, nonset1, "ancestorset");
 		return NULL;
 	}
+	if (arg2) {
+		PVALUE val2 = eval_and_coerce(PINT, arg2, stab, eflg);
+		if (*eflg) {
+			prog_var_error(node, stab, arg2, val2, nonintx, "ancestorset", "2");
+			delete_pvalue(val1);
+			return NULL;
+		}
+		maxgen = pvalue_to_int(val2);
+		delete_pvalue(val2);
+	}
 	ASSERT(seq = pvalue_to_seq(val1));
-	seq = ancestor_indiseq(seq);
+	seq = ancestor_indiseq(seq, maxgen);
 	set_pvalue_seq(val1, seq);
 	return val1;
 }
 /*====================================================+
  * llrpt_descendentset -- Create descendent set of an INDISEQ
- * usage: descendantset(SET) -> SET
+ *  optionally limited to given number of generations
+ * usage: descendantset(SET [, INT]) -> SET
  *===================================================*/
 PVALUE
 llrpt_descendentset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 {
 	INDISEQ seq=0;
-	PNODE arg1 = builtin_args(node);
+	INT maxgen=0;
+	PNODE arg1 = builtin_args(node), arg2 = inext(arg1);
 	PVALUE val1 = eval_and_coerce(PSET, arg1, stab, eflg);
 	if (*eflg) {
 		prog_var_error(node, stab, arg1, val1, nonset1, "descendentset");
 		return NULL;
 	}
+	if (arg2) {
+		PVALUE val2 = eval_and_coerce(PINT, arg2, stab, eflg);
+		if (*eflg) {
+			prog_var_error(node, stab, arg2, val2, nonintx, "descendentset", "2");
+			delete_pvalue(val1);
+			return NULL;
+		}
+		maxgen = pvalue_to_int(val2);
+		delete_pvalue(val2);
+	}
 	ASSERT(seq = pvalue_to_seq(val1));
-	seq = descendent_indiseq(seq);
+	seq = descendent_indiseq(seq, maxgen);
 	set_pvalue_seq(val1, seq);
 	return val1;
 }
+/*===================================================+
+ * llrpt_isancestor -- How far back is one person in another's ancestry
+ * usage: isancestor(INDI, INDI) -> INT
+ *  returns generations from 2nd person up to 1st (1 for
+ *  parent, 2 for grandparent, ...), or 0 if not an ancestor
+ *==================================================*/
+PVALUE
+llrpt_isancestor (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	NODE indi1=0, indi2=0;
+	RELCLOSURE clos=0;
+	INT gen=0;
+	PNODE arg1 = builtin_args(node), arg2 = inext(arg1);
+	indi1 = eval_indi(arg1, stab, eflg, NULL);
+	if (*eflg) {
+		prog_var_error(node, stab, arg1, NULL, nonindx, "isancestor", "1");
+		return NULL;
+	}
+	indi2 = eval_indi(arg2, stab, eflg, NULL);
+	if (*eflg) {
+		prog_var_error(node, stab, arg2, NULL, nonindx, "isancestor", "2");
+		return NULL;
+	}
+	if (indi1 && indi2) {
+		clos = ancestor_closure(rmvat(nxref(indi2)), 0);
+		gen = closure_find(clos, atoi(rmvat(nxref(indi1))+1));
+		release_closure(clos);
+	}
+	return create_pvalue_from_int(gen);
+}
+/*===================================================+
+ * llrpt_lca -- Find closest common ancestors of two people
+ * usage: lca(INDI, INDI) -> SET
+ *  values in set are generations up from 1st person
+ *  (a person counts as own ancestor, at generation 0)
+ *==================================================*/
+PVALUE
+llrpt_lca (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	NODE indi1=0, indi2=0;
+	INT *keynums=0, *gens1=0, *gens2=0;
+	INT count=0, i;
+	PVALUE val=0;
+	INDISEQ seq=0;
+	PNODE arg1 = builtin_args(node), arg2 = inext(arg1);
+	indi1 = eval_indi(arg1, stab, eflg, NULL);
+	if (*eflg) {
+		prog_var_error(node, stab, arg1, NULL, nonindx, "lca", "1");
+		return NULL;
+	}
+	indi2 = eval_indi(arg2, stab, eflg, NULL);
+	if (*eflg) {
+		prog_var_error(node, stab, arg2, NULL, nonindx, "lca", "2");
+		return NULL;
+	}
+	val = create_new_pvalue_set();
+	seq = pvalue_to_seq(val);
+	if (indi1 && indi2) {
+		count = closest_common_ancestors(rmvat(nxref(indi1))
+			, rmvat(nxref(indi2)), &keynums, &gens1, &gens2);
+	}
+	for (i = 0; i < count; ++i) {
+		char key[MAXKEYWIDTH+1];
+		snprintf(key, sizeof(key), "I%d", keynums[i]);
+		append_indiseq_pval(seq, key, NULL
+			, create_pvalue_from_int(gens1[i]), FALSE);
+	}
+	if (count) {
+		stdfree(keynums);
+		stdfree(gens1);
+		stdfree(gens2);
+	}
+	return val;
+}
 /*===================================================+
  * llrpt_gengedcom -- Generate GEDCOM output from an INDISEQ
  * usage: gengedcom(SET) -> VOID
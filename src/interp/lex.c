@@ -279,6 +279,8 @@ static struct {
 	{ "if",          IF },
 	{ "mothers",     MOTHERS },
 	{ "Parents",     PARENTS },
+	{ "parforfam",   PARFORFAM },
+	{ "parforindi",  PARFORINDI },
 	{ "proc",        PROC },
 	{ "return",      RETURN },
 	{ "spouses",     SPOUSES },
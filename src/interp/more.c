@@ -40,6 +40,7 @@
 #include "feedback.h" /* call_system_cmd */
 #include "zstr.h"
 #include "version.h"
+#include "fpattern.h"
 
 /*********************************************
  * external/imported variables
@@ -53,10 +54,8 @@ extern STRING qSnotonei, qSifonei;
 
 /* alphabetical */
 static STRING allocsubstring(STRING s, INT i, INT j);
-static void compute_pi(STRING pi, STRING sub);
 static double deg2rad(double deg);
 static INT ll_index(STRING str, STRING sub, INT num);
-static INT kmp_search(STRING pi, STRING str, STRING sub, INT num);
 static void makestring(PVALUE val, STRING str, INT len, BOOLEAN *eflg);
 static double rad2deg(double rad);
 static STRING rightjustify(STRING str, INT len);
@@ -358,64 +357,32 @@ llrpt_substring (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	return val2;
 }
 /*======================================================
- * index -- Find nth occurrence of sub in str (uses KMP)
+ * index -- Find nth occurrence of sub in str
  * STRING str:  the text being searched
  * STRING sub:  the substring being sought
  * INT num:     which occurrence we want
  *  return value is 1-based index (or 0 if not found)
+ * Occurrences may overlap. Candidates are found by memchr for
+ * the first char of sub, and checked with memcmp.
  *====================================================*/
 static INT
 ll_index (STRING str, STRING sub, INT num)
 {
-	INT result=0;
-	STRING pi=0;
+	INT found = 0;
+	size_t m;
+	STRING p, end;
 	if (!str || !sub || *str == 0 || *sub == 0) return 0;
-	pi = stdalloc(strlen(sub)+1);
-	compute_pi(pi, sub);
-	result = kmp_search(pi, str, sub, num);
-	strfree(&pi);
-	return result;
-}
-/*===============================================
- * kmp_search -- Perform KMP search for substring
- * STRING pi:   the KMP index to avoid backtracking
- * STRING str:  the text being searched
- * STRING sub:  the substring being sought
- * INT num:     which occurrence we want
- *  return value is 1-based index (or 0 if not found)
- *=============================================*/
-static INT
-kmp_search (STRING pi, STRING str, STRING sub, INT num)
-{
-	INT i, q = 0, found = 0;
-	INT n = strlen(str);
-	INT m = strlen(sub);
-	for (i = 1; i <= n; i++) {
-		while (q > 0 && sub[q] != str[i-1])
-			q = pi[q];
-		if (sub[q] == str[i-1]) q++;
-		if (q == m) {
-			if (++found == num) return i - m + 1;
-			q = pi[q];
-		}
+	m = strlen(sub);
+	end = str + strlen(str);
+	for (p = str; (size_t)(end - p) >= m; ++p) {
+		p = memchr(p, sub[0], (end - p) - m + 1);
+		if (!p)
+			break;
+		if (!memcmp(p+1, sub+1, m-1) && ++found == num)
+			return p - str + 1;
 	}
 	return 0;
 }
-/*========================================
- * compute_pi -- Support routine for index
- *======================================*/
-static void
-compute_pi (STRING pi, STRING sub)
-{
-	INT m = strlen(sub), k = 0, q;
-	pi[1] = 0;
-	for (q = 2; q <= m; q++) {
-		while (k > 0 && sub[k] != sub[q-1])
-			k = pi[k];
-		if (sub[k] == sub[q-1]) k++;
-		pi[q] = k;
-	}
-}
 /*==============================
  * allocsubstring -- Return substring
  *  handles NULL input
@@ -673,6 +640,12 @@ makestring (PVALUE val, STRING str, INT len, BOOLEAN *eflg)
 		case PSET:
 			llstrapps(str, len, uu8, "<SET>");
 			break;
+		case PMAP:
+			llstrapps(str, len, uu8, "<MAP>");
+			break;
+		case PHSET:
+			llstrapps(str, len, uu8, "<HASHSET>");
+			break;
 		default:
 			*eflg = TRUE;
 	}
@@ -1163,6 +1136,55 @@ llrpt_genindiset (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	assign_iden(stab, iident_name(argvar), seqval);
 	return NULL;
 }
+/*===================================================+
+ * llrpt_textsearch -- Find records by text of their values
+ *  Pattern is matched, ignoring case, against each whole value
+ *  of the tag (default NAME, TITL, AUTH, PLAC, NOTE & REFN),
+ *  and each CONC or CONT line under it
+ * usage: textsearch(STRING [, STRING]) -> LIST
+ *  returns keys of matching records, in key order
+ *==================================================*/
+PVALUE
+llrpt_textsearch (PNODE node, SYMTAB stab, BOOLEAN *eflg)
+{
+	PNODE argvar = builtin_args(node);
+	PVALUE val1=0, val2=0, newval=0;
+	STRING pattern=0, tag=0;
+	INDISEQ seq=0;
+	LIST list=0;
+
+	val1 = eval_and_coerce(PSTRING, argvar, stab, eflg);
+	if (*eflg) {
+		prog_var_error(node, stab, argvar, val1, nonstrx, "textsearch", "1");
+		goto exit_textsearch;
+	}
+	if ((argvar = inext(argvar))) {
+		val2 = eval_and_coerce(PSTRING, argvar, stab, eflg);
+		if (*eflg) {
+			prog_var_error(node, stab, argvar, val2, nonstrx, "textsearch", "2");
+			goto exit_textsearch;
+		}
+		tag = pvalue_to_string(val2);
+	}
+	pattern = pvalue_to_string(val1);
+	if (!pattern || !fpattern_isvalid(pattern)) {
+		*eflg = TRUE;
+		prog_error(node, _("bad pattern in textsearch: %s"), pattern ? pattern : "");
+		goto exit_textsearch;
+	}
+	newval = create_new_pvalue_list();
+	list = pvalue_to_list(newval);
+	seq = textindex_search(pattern, (tag && tag[0]) ? tag : NULL);
+	FORINDISEQ(seq, el, num)
+		enqueue_list(list, create_pvalue_from_string(element_skey(el)));
+	ENDINDISEQ
+	remove_indiseq(seq);
+
+exit_textsearch:
+	delete_pvalue(val1);
+	delete_pvalue(val2);
+	return newval;
+}
 /*================================================+
  * llrpt_version -- Return the LifeLines version string
  * usage: version() -> STRING
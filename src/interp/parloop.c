@@ -0,0 +1,646 @@
+/*=============================================================
+ * parloop.c -- Parallel record loops (parforindi, parforfam)
+ *  The records are split into contiguous slices, and each slice
+ *  is run by a forked worker process with its own copy of the
+ *  symbol tables and record cache. Workers hand their output and
+ *  the values of the loop's reduction variables back over a pipe,
+ *  and the parent merges them in slice order, so results match
+ *  those of the plain loop (except that floating point sums,
+ *  added up a slice at a time, may round differently).
+ *  Reduction variables start each slice at zero, "" or empty,
+ *  and are merged into the caller's values afterwards: numbers
+ *  are added, strings concatenated, lists and sets appended, and
+ *  tables merged (numeric values for the same key added).
+ *  Any other variable changed by the loop body is only changed
+ *  in the worker.
+ *==============================================================*/
+
+#include "llstdlib.h"
+#include "table.h"
+#include "translat.h"
+#include "gedcom.h"
+#include "cache.h"
+#include "interpi.h"
+#include "indiseq.h"
+#include "liflines.h"
+#include "lloptions.h"
+#include "zstr.h"
+
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H)
+#include <sys/wait.h>
+#define PARLOOP_FORK
+#endif
+
+/* fewest records given each worker, unless user set worker count */
+#define MIN_SLICE 64
+#define MAX_WORKERS 64
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static INT *collect_keynums(INT type, INT *pnkeys);
+static BOOLEAN check_reductions(PNODE node, SYMTAB stab);
+static INT get_worker_count(INT nkeys);
+static void merge_reduction(PNODE node, SYMTAB stab, CNSTRING iden, PVALUE part, BOOLEAN *eflg);
+static INTERPTYPE run_inline(PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT from, INT to);
+static INTERPTYPE run_slice(PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT from, INT to);
+static void set_reductions_empty(PNODE node, SYMTAB stab);
+#ifdef PARLOOP_FORK
+static PVALUE get_pvalue(FILE * fp, BOOLEAN *eflg);
+static STRING get_string(FILE * fp, BOOLEAN *eflg);
+static BOOLEAN put_pvalue(FILE * fp, PVALUE val);
+static void put_string(FILE * fp, CNSTRING str);
+static BOOLEAN read_worker(FILE * fp, PNODE node, SYMTAB stab);
+static INTERPTYPE run_workers(PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT nkeys, INT nworkers);
+static void run_worker(PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT from, INT to, int fd);
+#endif
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*========================================+
+ * interp_parloop -- Interpret parallel record loop
+ *  usage: parforindi(INDI_V,INT_V[,VAR]...) {...}
+ *         parforfam(FAM_V,INT_V[,VAR]...) {...}
+ *=======================================*/
+INTERPTYPE
+interp_parloop (PNODE node, SYMTAB stab, PVALUE *pval)
+{
+	INTERPTYPE irc;
+	INT nkeys=0, nworkers;
+	INT *keys;
+
+	if (!check_reductions(node, stab))
+		return INTERROR;
+	keys = collect_keynums(itype(node), &nkeys);
+	nworkers = get_worker_count(nkeys);
+	insert_symtab(stab, inum(node), create_pvalue_from_int(0));
+#ifdef PARLOOP_FORK
+	if (nworkers > 1)
+		irc = run_workers(node, stab, pval, keys, nkeys, nworkers);
+	else
+#endif
+		irc = run_inline(node, stab, pval, keys, 0, nkeys);
+	delete_symtab_element(stab, ielement(node));
+	delete_symtab_element(stab, inum(node));
+	stdfree(keys);
+	return irc;
+}
+/*========================================+
+ * check_reductions -- Check reduction variables of loop
+ *  can only reduce types we know how to merge
+ *=======================================*/
+static BOOLEAN
+check_reductions (PNODE node, SYMTAB stab)
+{
+	PNODE red;
+	for (red = ireduce(node); red; red = inext(red)) {
+		BOOLEAN eflg = FALSE;
+		PVALUE val = valueof_iden(node, stab, iident_name(red), &eflg);
+		INT type = val ? ptype(val) : PNULL;
+		delete_pvalue(val);
+		if (eflg)
+			return FALSE;
+		switch (type) {
+		case PINT: case PFLOAT: case PSTRING:
+		case PLIST: case PTABLE: case PSET:
+			break;
+		default:
+			prog_error(node, "reduction variable %s must be a number, string, list, table or set"
+				, iident_name(red));
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+/*========================================+
+ * collect_keynums -- List keynums of all persons or families
+ *  type:   [IN]  IPARINDI or IPARFAM
+ *  pnkeys: [OUT] number of keynums returned
+ * returns heap array (caller must free)
+ *=======================================*/
+static INT *
+collect_keynums (INT type, INT *pnkeys)
+{
+	INT (*nextfnc)(INT) = (type == IPARFAM) ? xref_nextf : xref_nexti;
+	INT max = (type == IPARFAM) ? num_fams() : num_indis();
+	INT n=0, count=0;
+	INT *keys;
+	if (max < 16) max = 16;
+	keys = (INT *)stdalloc(max * sizeof(*keys));
+	while ((count = (*nextfnc)(count))) {
+		if (n == max) {
+			INT *newkeys = (INT *)stdalloc(2 * max * sizeof(*keys));
+			memcpy(newkeys, keys, n * sizeof(*keys));
+			stdfree(keys);
+			keys = newkeys;
+			max *= 2;
+		}
+		keys[n++] = count;
+	}
+	*pnkeys = n;
+	return keys;
+}
+/*========================================+
+ * get_worker_count -- How many workers to run loop with
+ *  ReportWorkers option, else one per processor
+ *=======================================*/
+static INT
+get_worker_count (INT nkeys)
+{
+	INT n = getlloptint("ReportWorkers", 0);
+	if (n <= 0) {
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+		n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+		if (n > nkeys / MIN_SLICE)
+			n = nkeys / MIN_SLICE;
+	}
+	if (n > nkeys)
+		n = nkeys;
+	if (n > MAX_WORKERS)
+		n = MAX_WORKERS;
+	return n < 1 ? 1 : n;
+}
+/*========================================+
+ * run_slice -- Run loop body over some of the records
+ *  keys:     [IN]  keynums of all records
+ *  from, to: [IN]  range of keys to do (to not included)
+ *=======================================*/
+static INTERPTYPE
+run_slice (PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT from, INT to)
+{
+	INTERPTYPE irc;
+	INT i;
+	for (i = from; i < to; i++) {
+		PVALUE val = (itype(node) == IPARFAM)
+			? create_pvalue_from_fam_keynum(keys[i])
+			: create_pvalue_from_indi_keynum(keys[i]);
+		CACHEEL cel = pvalue_to_cel(val);
+		if (!cel) { /* apparently missing record */
+			delete_pvalue(val);
+			continue;
+		}
+		lock_cache(cel); /* keep current record in cache during loop body */
+		insert_symtab(stab, ielement(node), val);
+		insert_symtab(stab, inum(node), create_pvalue_from_int(i+1));
+		irc = interpret((PNODE) ibody(node), stab, pval);
+		unlock_cache(cel);
+		switch (irc) {
+		case INTCONTINUE:
+		case INTOKAY:
+			continue;
+		case INTERROR:
+			return irc;
+		default:
+			/* a slice cannot stop the others */
+			prog_error(node, "break and return are not allowed in a parallel loop");
+			return INTERROR;
+		}
+	}
+	return INTOKAY;
+}
+/*========================================+
+ * set_reductions_empty -- Start reduction variables afresh
+ *  as every slice begins with nothing accumulated
+ *=======================================*/
+static void
+set_reductions_empty (PNODE node, SYMTAB stab)
+{
+	PNODE red;
+	for (red = ireduce(node); red; red = inext(red)) {
+		BOOLEAN eflg = FALSE;
+		PVALUE val = valueof_iden(node, stab, iident_name(red), &eflg);
+		PVALUE newval = 0;
+		switch (ptype(val)) {
+		case PINT: newval = create_pvalue_from_int(0); break;
+		case PFLOAT: newval = create_pvalue_from_float(0); break;
+		case PSTRING: newval = create_pvalue_from_string(""); break;
+		case PLIST: newval = create_new_pvalue_list(); break;
+		case PTABLE: newval = create_new_pvalue_table(); break;
+		case PSET: newval = create_new_pvalue_set(); break;
+		}
+		delete_pvalue(val);
+		ASSERT(newval); /* check_reductions let nothing else through */
+		assign_iden(stab, iident_name(red), newval);
+	}
+}
+/*========================================+
+ * run_inline -- Run slice in this process
+ *  with the same reduction semantics as a worker
+ *=======================================*/
+static INTERPTYPE
+run_inline (PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT from, INT to)
+{
+	INTERPTYPE irc;
+	PNODE red;
+	LIST saved = create_list3(delete_vptr_pvalue);
+	BOOLEAN eflg = FALSE;
+	/* set caller's values aside (FORLIST gives them back in this order) */
+	for (red = ireduce(node); red; red = inext(red))
+		enqueue_list(saved, valueof_iden(node, stab, iident_name(red), &eflg));
+	set_reductions_empty(node, stab);
+	irc = run_slice(node, stab, pval, keys, from, to);
+	red = ireduce(node);
+	FORLIST(saved, el)
+		PVALUE part = valueof_iden(node, stab, iident_name(red), &eflg);
+		assign_iden(stab, iident_name(red), copy_pvalue((PVALUE)el));
+		if (irc == INTOKAY)
+			merge_reduction(node, stab, iident_name(red), part, &eflg);
+		delete_pvalue(part);
+		red = inext(red);
+	ENDLIST
+	destroy_list(saved);
+	return eflg ? INTERROR : irc;
+}
+/*========================================+
+ * merge_reduction -- Add in value accumulated by a slice
+ *  iden: [IN]  reduction variable
+ *  part: [IN]  value slice left in it (caller still owns)
+ *=======================================*/
+static void
+merge_reduction (PNODE node, SYMTAB stab, CNSTRING iden, PVALUE part, BOOLEAN *eflg)
+{
+	PVALUE val = valueof_iden(node, stab, iden, eflg);
+	ZSTR zerr=0;
+	if (*eflg) return;
+	if (ptype(val) != ptype(part) && !(is_numeric_pvalue(val) && is_numeric_pvalue(part))) {
+		prog_error(node, "reduction variable %s changed type in parallel loop", iden);
+		*eflg = TRUE;
+		delete_pvalue(val);
+		return;
+	}
+	switch (ptype(val)) {
+	case PINT:
+	case PFLOAT:
+		add_pvalues(val, copy_pvalue(part), eflg, &zerr);
+		break;
+	case PSTRING:
+		if (1) {
+			ZSTR zstr = zs_news(pvalue_to_string(val));
+			zs_apps(zstr, pvalue_to_string(part));
+			set_pvalue_string(val, zs_str(zstr));
+			zs_free(&zstr);
+		}
+		break;
+	case PLIST:
+		if (1) {
+			LIST list = pvalue_to_list(val);
+			FORLIST(pvalue_to_list(part), el)
+				enqueue_list(list, copy_pvalue((PVALUE)el));
+			ENDLIST
+		}
+		break;
+	case PTABLE:
+		if (1) {
+			TABLE tab = pvalue_to_table(val);
+			TABLE_ITER tabit = begin_table_iter(pvalue_to_table(part));
+			CNSTRING key=0;
+			VPTR ptr=0;
+			while (next_table_ptr(tabit, &key, &ptr)) {
+				PVALUE old = (PVALUE)valueof_ptr(tab, key);
+				PVALUE add = (PVALUE)ptr;
+				if (old && is_numeric_pvalue(old) && is_numeric_pvalue(add))
+					add_pvalues(old, copy_pvalue(add), eflg, &zerr);
+				else
+					insert_table_ptr(tab, key, copy_pvalue(add));
+			}
+			end_table_iter(&tabit);
+		}
+		break;
+	case PSET:
+		if (1) {
+			INDISEQ seq = pvalue_to_seq(val);
+			FORINDISEQ(pvalue_to_seq(part), el, i)
+				PVALUE elval = (PVALUE)element_pval(el);
+				append_indiseq_pval(seq, (STRING)element_skey(el), NULL
+					, elval ? copy_pvalue(elval) : NULL, FALSE);
+			ENDINDISEQ
+		}
+		break;
+	}
+	if (*eflg) {
+		prog_error(node, "%s", zerr ? zs_str(zerr) : iden);
+	} else if (ptype(val) == PINT || ptype(val) == PFLOAT || ptype(val) == PSTRING) {
+		assign_iden(stab, iden, val);
+		val = 0;
+	}
+	zs_free(&zerr);
+	delete_pvalue(val);
+}
+#ifdef PARLOOP_FORK
+/*========================================+
+ * run_workers -- Run loop in worker processes
+ *  keys:     [IN]  keynums of all records
+ *  nworkers: [IN]  how many slices to make
+ *=======================================*/
+static INTERPTYPE
+run_workers (PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT nkeys, INT nworkers)
+{
+	INTERPTYPE irc = INTOKAY;
+	pid_t *pids = (pid_t *)stdalloc(nworkers * sizeof(*pids));
+	FILE **fps = (FILE **)stdalloc(nworkers * sizeof(*fps));
+	INT i, started;
+
+	/* do not let workers inherit unwritten output */
+	fflush(stdout);
+	fflush(stderr);
+	if (Poutfp) fflush(Poutfp);
+
+	for (started = 0; started < nworkers; started++) {
+		INT from = (INT)((INT64)nkeys * started / nworkers);
+		INT to = (INT)((INT64)nkeys * (started+1) / nworkers);
+		int fds[2];
+		pid_t pid;
+		if (pipe(fds) < 0)
+			break;
+		if ((pid = fork()) < 0) {
+			close(fds[0]);
+			close(fds[1]);
+			break;
+		}
+		if (pid == 0) {
+			close(fds[0]);
+			for (i = 0; i < started; i++)
+				close(fileno(fps[i]));
+			run_worker(node, stab, pval, keys, from, to, fds[1]);
+		}
+		close(fds[1]);
+		fps[started] = fdopen(fds[0], LLREADBINARY);
+		pids[started] = pid;
+	}
+
+	/* merge in slice order; after a failure just reap the rest */
+	for (i = 0; i < started; i++) {
+		int status = 0;
+		if (irc == INTOKAY && !read_worker(fps[i], node, stab))
+			irc = INTERROR;
+		fclose(fps[i]);
+		waitpid(pids[i], &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			irc = INTERROR;
+	}
+	/* any slices we could not start are done here */
+	if (irc == INTOKAY && started < nworkers) {
+		INT from = (INT)((INT64)nkeys * started / nworkers);
+		irc = run_inline(node, stab, pval, keys, from, nkeys);
+	}
+	stdfree(pids);
+	stdfree(fps);
+	return irc;
+}
+/*========================================+
+ * run_worker -- Body of worker process (does not return)
+ *  fd: [IN]  pipe to send results back to parent
+ * Sends a status character, the output made by
+ * the body, and the final value of each reduction
+ *=======================================*/
+static void
+run_worker (PNODE node, SYMTAB stab, PVALUE *pval, INT *keys, INT from, INT to, int fd)
+{
+	FILE * fp = fdopen(fd, LLWRITEBINARY);
+	INTERPTYPE irc;
+	ZSTR zout=0;
+	PNODE red;
+	BOOLEAN ok = TRUE;
+
+	begin_deferred_output();
+	set_reductions_empty(node, stab);
+	irc = run_slice(node, stab, pval, keys, from, to);
+	zout = end_deferred_output();
+	putc(irc == INTOKAY ? '+' : '-', fp);
+	put_string(fp, zs_str(zout));
+	zs_free(&zout);
+	for (red = ireduce(node); ok && irc == INTOKAY && red; red = inext(red)) {
+		BOOLEAN eflg = FALSE;
+		PVALUE val = valueof_iden(node, stab, iident_name(red), &eflg);
+		if (!put_pvalue(fp, val)) {
+			prog_error(node, "reduction variable %s holds a value that cannot be merged"
+				, iident_name(red));
+			ok = FALSE;
+		}
+		delete_pvalue(val);
+	}
+	fclose(fp);
+	fflush(stdout);
+	fflush(stderr);
+	/* skip atexit handlers, which belong to parent */
+	_exit(irc == INTOKAY && ok ? 0 : 1);
+}
+/*========================================+
+ * read_worker -- Take results of one worker
+ *  outputs its text & merges its reductions
+ *=======================================*/
+static BOOLEAN
+read_worker (FILE * fp, PNODE node, SYMTAB stab)
+{
+	BOOLEAN eflg = FALSE;
+	int status = getc(fp);
+	STRING str = get_string(fp, &eflg);
+	PNODE red;
+	if (eflg) return FALSE;
+	/* output made before any error is kept, as in plain loop */
+	if (str) {
+		poutput(str, &eflg);
+		strfree(&str);
+	}
+	if (status != '+' || eflg)
+		return FALSE;
+	for (red = ireduce(node); red; red = inext(red)) {
+		PVALUE part = get_pvalue(fp, &eflg);
+		if (eflg) return FALSE;
+		merge_reduction(node, stab, iident_name(red), part, &eflg);
+		delete_pvalue(part);
+		if (eflg) return FALSE;
+	}
+	return TRUE;
+}
+/*========================================+
+ * put_string -- Write string to worker pipe
+ *  as length line followed by bytes (-1 for NULL)
+ *=======================================*/
+static void
+put_string (FILE * fp, CNSTRING str)
+{
+	if (!str) {
+		fprintf(fp, "-1\n");
+		return;
+	}
+	fprintf(fp, "%ld\n", (long)strlen(str));
+	fwrite(str, strlen(str), 1, fp);
+}
+/*========================================+
+ * get_string -- Read string written by put_string
+ * returns heap string (or NULL)
+ *=======================================*/
+static STRING
+get_string (FILE * fp, BOOLEAN *eflg)
+{
+	long len=0;
+	STRING str;
+	if (fscanf(fp, "%ld", &len) != 1 || getc(fp) != '\n') {
+		*eflg = TRUE;
+		return NULL;
+	}
+	if (len < 0)
+		return NULL;
+	str = (STRING)stdalloc(len+1);
+	if (len && fread(str, len, 1, fp) != 1) {
+		stdfree(str);
+		*eflg = TRUE;
+		return NULL;
+	}
+	str[len] = 0;
+	return str;
+}
+/*========================================+
+ * put_pvalue -- Write value to worker pipe
+ *  type character, then data; containers end with 'e'
+ * returns FALSE if value (eg, a node) cannot be sent
+ *=======================================*/
+static BOOLEAN
+put_pvalue (FILE * fp, PVALUE val)
+{
+	BOOLEAN ok = TRUE;
+	RECORD rec;
+	switch (val ? ptype(val) : PNULL) {
+	case PNULL:
+		putc('n', fp);
+		return TRUE;
+	case PINT:
+		fprintf(fp, "i%ld\n", (long)pvalue_to_int(val));
+		return TRUE;
+	case PFLOAT:
+		fprintf(fp, "f%.17g\n", (double)pvalue_to_float(val));
+		return TRUE;
+	case PBOOL:
+		fprintf(fp, "b%d\n", pvalue_to_bool(val) ? 1 : 0);
+		return TRUE;
+	case PSTRING:
+		putc('s', fp);
+		put_string(fp, pvalue_to_string(val));
+		return TRUE;
+	case PINDI: case PFAM: case PSOUR: case PEVEN: case POTHR:
+		rec = pvalue_to_record(val);
+		fprintf(fp, "r%d %ld\n", ptype(val), (long)(rec ? nzkeynum(rec) : 0));
+		return TRUE;
+	case PLIST:
+		putc('L', fp);
+		FORLIST(pvalue_to_list(val), el)
+			if (ok) ok = put_pvalue(fp, (PVALUE)el);
+		ENDLIST
+		putc('e', fp);
+		return ok;
+	case PTABLE:
+		if (1) {
+			TABLE_ITER tabit = begin_table_iter(pvalue_to_table(val));
+			CNSTRING key=0;
+			VPTR ptr=0;
+			putc('T', fp);
+			while (ok && next_table_ptr(tabit, &key, &ptr)) {
+				putc('k', fp);
+				put_string(fp, key);
+				ok = put_pvalue(fp, (PVALUE)ptr);
+			}
+			end_table_iter(&tabit);
+			putc('e', fp);
+		}
+		return ok;
+	case PSET:
+		putc('Q', fp);
+		FORINDISEQ(pvalue_to_seq(val), el, i)
+			if (ok) {
+				putc('k', fp);
+				put_string(fp, element_skey(el));
+				ok = put_pvalue(fp, (PVALUE)element_pval(el));
+			}
+		ENDINDISEQ
+		putc('e', fp);
+		return ok;
+	}
+	return FALSE;
+}
+/*========================================+
+ * get_pvalue -- Read value written by put_pvalue
+ *=======================================*/
+static PVALUE
+get_pvalue (FILE * fp, BOOLEAN *eflg)
+{
+	PVALUE val=0, el=0;
+	PVALUE_DATA pvd;
+	STRING key=0;
+	long num=0;
+	double fnum=0;
+	int c, type=0;
+	switch (c = getc(fp)) {
+	case 'n':
+		return create_pvalue_any();
+	case 'i':
+		if (fscanf(fp, "%ld", &num) != 1) break;
+		getc(fp);
+		return create_pvalue_from_int((INT)num);
+	case 'f':
+		if (fscanf(fp, "%lf", &fnum) != 1) break;
+		getc(fp);
+		/* not create_pvalue_from_float, which takes a float */
+		pvd.fxd = fnum;
+		return create_pvalue(PFLOAT, pvd);
+	case 'b':
+		if (fscanf(fp, "%ld", &num) != 1) break;
+		getc(fp);
+		return create_pvalue_from_bool(num != 0);
+	case 's':
+		key = get_string(fp, eflg);
+		if (*eflg) return NULL;
+		val = create_pvalue_from_string(key);
+		strfree(&key);
+		return val;
+	case 'r':
+		if (fscanf(fp, "%d %ld", &type, &num) != 2) break;
+		getc(fp);
+		switch (type) {
+		case PINDI: return create_pvalue_from_indi_keynum((INT)num);
+		case PFAM: return create_pvalue_from_fam_keynum((INT)num);
+		case PSOUR: return create_pvalue_from_sour_keynum((INT)num);
+		case PEVEN: return create_pvalue_from_even_keynum((INT)num);
+		case POTHR: return create_pvalue_from_othr_keynum((INT)num);
+		}
+		break;
+	case 'L':
+	case 'T':
+	case 'Q':
+		val = (c == 'L') ? create_new_pvalue_list()
+			: (c == 'T') ? create_new_pvalue_table()
+			: create_new_pvalue_set();
+		while ((type = getc(fp)) != 'e') {
+			if (c != 'L') {
+				/* tables & sets have key before each value */
+				if (type != 'k' || !(key = get_string(fp, eflg)))
+					break;
+			} else {
+				ungetc(type, fp);
+			}
+			if (!(el = get_pvalue(fp, eflg)))
+				break;
+			if (c == 'L') {
+				enqueue_list(pvalue_to_list(val), el);
+			} else if (c == 'T') {
+				insert_table_ptr(pvalue_to_table(val), key, el);
+			} else {
+				append_indiseq_pval(pvalue_to_seq(val), key, NULL, el, FALSE);
+			}
+			strfree(&key);
+		}
+		strfree(&key);
+		if (type == 'e') return val;
+		break;
+	}
+	*eflg = TRUE;
+	delete_pvalue(val);
+	return NULL;
+}
+#endif /* PARLOOP_FORK */
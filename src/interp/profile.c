@@ -0,0 +1,287 @@
+/*=============================================================
+ * profile.c -- Instrumenting profiler for report programs
+ *  Counts calls and accumulates inclusive & exclusive time (and
+ *  record cache misses) per proc, func, builtin and source line.
+ *  When the report finishes, writes the call stacks in folded
+ *  format (one "a;b;c usecs" line per stack, as consumed by
+ *  flamegraph.pl) and a plain text summary next to it.
+ *==============================================================*/
+
+#include "llstdlib.h"
+#include "table.h"
+#include "gedcom.h"
+#include "interpi.h"
+#include "feedback.h"
+#include "zstr.h"
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* accumulated statistics for one proc/func/builtin or line */
+typedef struct tag_profstat {
+	INT calls;     /* times entered (or executed, for lines) */
+	INT active;    /* current recursion depth (procs & funcs) */
+	INT64 incl;    /* usecs including callees */
+	INT64 excl;    /* usecs excluding callees */
+	INT misses;    /* cache misses while this was innermost */
+} *PROFSTAT;
+
+/* one entry on the profiler's call stack */
+typedef struct tag_profframe {
+	PROFSTAT stat;      /* stats of routine running in this frame */
+	PROFSTAT line;      /* stats of line currently executing */
+	INT64 start;        /* clock when frame was entered */
+	unsigned int plen;  /* length of stack path before this frame */
+} PROFFRAME;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static void charge_elapsed(void);
+static PROFSTAT get_stat(TABLE tab, CNSTRING key);
+static void write_folded(FILE * fp);
+static void write_stats(FILE * fp, CNSTRING title, TABLE tab, BOOLEAN incl);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+static STRING prof_file = 0;    /* output requested by user */
+static TABLE routinetab = 0;    /* PROFSTAT by kind & name */
+static TABLE linetab = 0;       /* PROFSTAT by file & line */
+static TABLE foldtab = 0;       /* PROFSTAT by stack path */
+static PROFFRAME *frames = 0;   /* profiler call stack */
+static INT nframes = 0;
+static INT maxframes = 0;
+static ZSTR stackpath = 0;      /* eg, "main;dofam;[fullname]" */
+static INT64 lasttick = 0;      /* clock when time last charged */
+static INT lastmisses = 0;      /* cache misses when last charged */
+
+/*********************************************
+ * exported variables
+ *********************************************/
+
+BOOLEAN prog_profile = FALSE;   /* profiling active for running report */
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*=============================================
+ * set_report_profile -- Ask for profile of next report(s)
+ *  fname: [IN]  folded stack output file (NULL to turn off)
+ *===========================================*/
+void
+set_report_profile (CNSTRING fname)
+{
+	strfree(&prof_file);
+	if (fname && fname[0])
+		prof_file = strsave(fname);
+}
+/*=============================================
+ * prof_begin -- Start profiling a report run
+ *  (does nothing unless user requested a profile)
+ *===========================================*/
+void
+prof_begin (void)
+{
+	if (!prof_file) return;
+	routinetab = create_table_hptr();
+	linetab = create_table_hptr();
+	foldtab = create_table_hptr();
+	stackpath = zs_new();
+	nframes = 0;
+	lasttick = get_usec_clock();
+	lastmisses = get_cache_miss_count();
+	prog_profile = TRUE;
+}
+/*=============================================
+ * prof_end -- Finish profiling & write results
+ *===========================================*/
+void
+prof_end (void)
+{
+	FILE * fp;
+	ZSTR zname;
+	if (!prog_profile) return;
+	while (nframes)
+		prof_leave();
+	charge_elapsed();
+	prog_profile = FALSE;
+
+	fp = fopen(prof_file, LLWRITETEXT);
+	if (fp) {
+		write_folded(fp);
+		fclose(fp);
+	} else {
+		msg_error(_("Could not open file %s"), prof_file);
+	}
+	zname = zs_news(prof_file);
+	zs_apps(zname, ".summary");
+	fp = fopen(zs_str(zname), LLWRITETEXT);
+	if (fp) {
+		write_stats(fp, "routines", routinetab, TRUE);
+		write_stats(fp, "lines", linetab, FALSE);
+		fclose(fp);
+	}
+	zs_free(&zname);
+
+	destroy_table(routinetab);
+	routinetab = 0;
+	destroy_table(linetab);
+	linetab = 0;
+	destroy_table(foldtab);
+	foldtab = 0;
+	zs_free(&stackpath);
+	stdfree(frames);
+	frames = 0;
+	nframes = maxframes = 0;
+}
+/*=============================================
+ * get_stat -- Find or create statistics entry
+ *===========================================*/
+static PROFSTAT
+get_stat (TABLE tab, CNSTRING key)
+{
+	PROFSTAT stat = (PROFSTAT)valueof_ptr(tab, key);
+	if (!stat) {
+		stat = (PROFSTAT)stdalloc(sizeof(*stat));
+		insert_table_ptr(tab, key, stat);
+	}
+	return stat;
+}
+/*=============================================
+ * charge_elapsed -- Charge time & cache misses since last
+ *  event to whatever is innermost right now
+ *===========================================*/
+static void
+charge_elapsed (void)
+{
+	INT64 now = get_usec_clock();
+	INT64 delta = now - lasttick;
+	INT misses = get_cache_miss_count();
+	INT dmisses = misses - lastmisses;
+	lasttick = now;
+	lastmisses = misses;
+	if (!nframes) return;
+	frames[nframes-1].stat->excl += delta;
+	frames[nframes-1].stat->misses += dmisses;
+	if (frames[nframes-1].line) {
+		frames[nframes-1].line->excl += delta;
+		frames[nframes-1].line->misses += dmisses;
+	}
+	if (delta || dmisses) {
+		PROFSTAT fold = get_stat(foldtab, zs_str(stackpath));
+		fold->excl += delta;
+		fold->misses += dmisses;
+	}
+}
+/*=============================================
+ * prof_enter -- Note entry to proc, func or builtin
+ *  kind: [IN]  IPCALL, IFCALL or IBCALL
+ *  name: [IN]  name of routine called
+ *===========================================*/
+void
+prof_enter (INT kind, CNSTRING name)
+{
+	char key[256];
+	PROFFRAME * frame;
+	charge_elapsed();
+	if (nframes == maxframes) {
+		INT newmax = maxframes ? 2*maxframes : 64;
+		PROFFRAME * newframes = (PROFFRAME *)stdalloc(newmax * sizeof(*newframes));
+		if (nframes)
+			memcpy(newframes, frames, nframes * sizeof(*newframes));
+		stdfree(frames);
+		frames = newframes;
+		maxframes = newmax;
+	}
+	frame = &frames[nframes++];
+	frame->plen = zs_len(stackpath);
+	frame->start = lasttick;
+	frame->line = 0;
+	if (frame->plen)
+		zs_appc(stackpath, ';');
+	switch (kind) {
+	case IFCALL: snprintf(key, sizeof(key), "%s()", name); break;
+	case IBCALL: snprintf(key, sizeof(key), "[%s]", name); break;
+	default:     snprintf(key, sizeof(key), "%s", name); break;
+	}
+	zs_apps(stackpath, key);
+	frame->stat = get_stat(routinetab, key);
+	frame->stat->calls++;
+	frame->stat->active++;
+}
+/*=============================================
+ * prof_leave -- Note return from innermost routine
+ *===========================================*/
+void
+prof_leave (void)
+{
+	PROFFRAME * frame;
+	if (!nframes) return;
+	charge_elapsed();
+	frame = &frames[--nframes];
+	/* only outermost activation of recursive routine counts inclusive */
+	if (--frame->stat->active == 0)
+		frame->stat->incl += lasttick - frame->start;
+	zs_chop(stackpath, frame->plen);
+}
+/*=============================================
+ * prof_line -- Note start of statement
+ *  node: [IN]  statement about to be interpreted
+ *===========================================*/
+void
+prof_line (PNODE node)
+{
+	char key[MAXPATHLEN+20];
+	PROFSTAT line;
+	if (!nframes) return;
+	charge_elapsed();
+	snprintf(key, sizeof(key), "%s:%d"
+		, irptinfo(node) ? irptinfo(node)->fullpath : "?", iline(node)+1);
+	line = get_stat(linetab, key);
+	line->calls++;
+	frames[nframes-1].line = line;
+}
+/*=============================================
+ * write_folded -- Output one line per distinct call stack
+ *===========================================*/
+static void
+write_folded (FILE * fp)
+{
+	TABLE_ITER tabit = begin_table_iter(foldtab);
+	CNSTRING key=0;
+	VPTR ptr=0;
+	while (next_table_ptr(tabit, &key, &ptr)) {
+		PROFSTAT fold = (PROFSTAT)ptr;
+		fprintf(fp, "%s %lld\n", key, (long long)fold->excl);
+	}
+	end_table_iter(&tabit);
+}
+/*=============================================
+ * write_stats -- Output one line per routine or line
+ *  incl: [IN]  include inclusive time column ?
+ *===========================================*/
+static void
+write_stats (FILE * fp, CNSTRING title, TABLE tab, BOOLEAN incl)
+{
+	TABLE_ITER tabit = begin_table_iter(tab);
+	CNSTRING key=0;
+	VPTR ptr=0;
+	fprintf(fp, "# %s: calls%s excl_usec cache_misses name\n"
+		, title, incl ? " incl_usec" : "");
+	while (next_table_ptr(tabit, &key, &ptr)) {
+		PROFSTAT stat = (PROFSTAT)ptr;
+		fprintf(fp, "%d", stat->calls);
+		if (incl)
+			fprintf(fp, " %lld", (long long)stat->incl);
+		fprintf(fp, " %lld %d %s\n", (long long)stat->excl
+			, stat->misses, key);
+	}
+	end_table_iter(&tabit);
+}
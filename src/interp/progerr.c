@@ -58,6 +58,7 @@ struct dbgsymtab_s
 static INT count_symtab_ancestors(SYMTAB stab);
 static void disp_dbgsymtab(CNSTRING title, struct dbgsymtab_s * sdata);
 static void disp_list(LIST list);
+static void disp_map(OMAP omap);
 static void disp_pvalue(PVALUE val);
 static void disp_seq(INDISEQ seq);
 static void disp_symtab(STRING title, SYMTAB stab);
@@ -386,11 +387,18 @@ disp_pvalue (PVALUE val)
 			}
 			return;
 		case PTABLE:
+		case PHSET:
 			{
 				TABLE tab = pvalue_to_table(val);
 				disp_table(tab);
 			}
 			return;
+		case PMAP:
+			{
+				OMAP omap = pvalue_to_map(val);
+				disp_map(omap);
+			}
+			return;
 		case PSET:
 			{
 				INDISEQ seq = pvalue_to_seq(val);
@@ -432,6 +440,39 @@ disp_list (LIST list)
 
 	free_dbgsymtab_arrays(&sdata);
 }
+/*=============================================+
+ * disp_map -- Display ordered map contents
+ *  used for drilldown in variable debugger
+ *  omap:  map to display
+ *============================================*/
+static void
+disp_map (OMAP omap)
+{
+	struct dbgsymtab_s sdata;
+	INT nels = get_omap_count(omap);
+	if (!nels) {
+		msg_info(_("map is empty"));
+		return;
+	}
+	init_dbgsymtab_arrays(&sdata, nels);
+
+	/* loop thru map building display array */
+	{
+		OMAP_ITER omit = begin_omap(omap, 0, 0);
+		const void * key = 0;
+		VPTR ptr = 0;
+		while (next_omap(omit, &key, &ptr)) {
+			ZSTR zkey = describe_pvalue((PVALUE)key);
+			format_dbgsymtab_val(zs_str(zkey), (PVALUE)ptr, &sdata);
+			zs_free(&zkey);
+		}
+		end_omap(&omit);
+	}
+
+	disp_dbgsymtab(_("MAP contents"), &sdata);
+
+	free_dbgsymtab_arrays(&sdata);
+}
 /*=============================================+
  * disp_table -- Display table contents
  *  used for drilldown in variable debugger
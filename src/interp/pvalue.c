@@ -56,8 +56,10 @@ static PVALUE create_pvalue_from_record(RECORD rec, INT ptype);
 /* static BOOLEAN eq_pstrings(PVALUE val1, PVALUE val2); */
 static int float_to_int(float f);
 static BOOLEAN is_record_pvaltype(INT valtype);
+static INT key_class(PVALUE val);
 static OBJECT pvalue_copy(OBJECT obj, int deep);
 static void pvalue_destructor(VTABLE *obj);
+static INT record_keynum(PVALUE val);
 static void release_pvalue_contents(PVALUE val);
 static void set_pvalue(PVALUE val, INT type, PVALUE_DATA pvd);
 
@@ -70,7 +72,7 @@ static void set_pvalue(PVALUE val, INT type, PVALUE_DATA pvd);
 static char *ptypes[] = {
 	"?", "PNULL", "PINT", "PLONG", "PFLOAT", "PBOOL", "PSTRING",
 	"PGNODE", "PINDI", "PFAM", "PSOUR", "PEVEN", "POTHR", "PLIST",
-	"PTABLE", "PSET", "PARRAY"
+	"PTABLE", "PSET", "PARRAY", "PMAP", "PHSET"
 };
 static struct tag_vtable vtable_for_pvalue = {
 	VTABLE_MAGIC
@@ -165,12 +167,12 @@ set_pvalue (PVALUE val, INT type, PVALUE_DATA pvd)
 		if (list) {
 			addref_list(list);
 		}
-	} else if (type == PTABLE) {
+	} else if (type == PTABLE || type == PHSET) {
 		TABLE table = pvd.txd;
-		if (val->type == PTABLE && val->value.txd == table)
+		if (val->type == type && val->value.txd == table)
 			return; /* self-assignment */
 		clear_pvalue(val);
-		val->type = PTABLE;
+		val->type = type;
 		val->value.txd = table;
 		if (table) {
 			addref_table(table);
@@ -195,6 +197,16 @@ set_pvalue (PVALUE val, INT type, PVALUE_DATA pvd)
 		if (arr) {
 			addref_array(arr);
 		}
+	} else if (type == PMAP) {
+		OMAP omap = pvd.mxd;
+		if (val->type == PMAP && val->value.mxd == omap)
+			return; /* self-assignment */
+		clear_pvalue(val);
+		val->type = PMAP;
+		val->value.mxd = omap;
+		if (omap) {
+			addref_omap(omap);
+		}
 	}
 }
 /*========================================
@@ -282,11 +294,18 @@ release_pvalue_contents (PVALUE val)
 		}
 		return;
 	case PTABLE:
+	case PHSET:
 		{
 			TABLE table = pvalue_to_table(val);
 			release_table(table);
 		}
 		return;
+	case PMAP:
+		{
+			OMAP omap = pvalue_to_map(val);
+			release_omap(omap);
+		}
+		return;
 	case PSET:
 		{
 			INDISEQ seq = pvalue_to_seq(val);
@@ -644,6 +663,8 @@ get_pvalue_as_bool (PVALUE val)
 	case PTABLE: return pvalue_to_table(val) != 0;
 	case PSET: return pvalue_to_seq(val) != 0;
 	case PARRAY: return val->value.axd != 0;
+	case PMAP: return pvalue_to_map(val) != 0;
+	case PHSET: return pvalue_to_table(val) != 0;
 	}
 	return FALSE;
 }
@@ -677,7 +698,8 @@ coerce_pvalue (INT type, PVALUE val, BOOLEAN *eflg)
 
 	/* PNULL or PINT with NULL (0) value is convertible to any scalar (1995.07.31) */
 	if (ptype(val) == PNULL || (ptype(val) == PINT && pvalue_to_int(val) == 0)) {
-		if (type == PSET || type == PTABLE || type == PLIST) goto bad;
+		if (type == PSET || type == PTABLE || type == PLIST
+			|| type == PMAP || type == PHSET) goto bad;
 		/*
 		  INTs convert to FLOATs numerically further down, no special 
 		  conversion when INT value 0
@@ -844,7 +866,10 @@ eqv_pvalues (VPTR ptr1, VPTR ptr2)
 		case PLIST:
 			return pvalue_to_list(val1) == pvalue_to_list(val2);
 		case PTABLE:
+		case PHSET:
 			return pvalue_to_table(val1) == pvalue_to_table(val2);
+		case PMAP:
+			return pvalue_to_map(val1) == pvalue_to_map(val2);
 		case PSET:
 			return pvalue_to_seq(val1) == pvalue_to_seq(val2);
 		case PARRAY:
@@ -1025,12 +1050,20 @@ describe_pvalue (PVALUE val)
 		}
 		break;
 	case PTABLE:
+	case PHSET:
 		{
 			TABLE table = pvalue_to_table(val);
 			INT n = get_table_count(table);
 			zs_appf(zstr, _pl("%d entry", "%d entries", n), n);
 		}
 		break;
+	case PMAP:
+		{
+			OMAP omap = pvalue_to_map(val);
+			INT n = get_omap_count(omap);
+			zs_appf(zstr, _pl("%d entry", "%d entries", n), n);
+		}
+		break;
 	case PSET:
 		{
 			INDISEQ seq = pvalue_to_seq(val);
@@ -1229,6 +1262,14 @@ pvalue_to_table (PVALUE val)
 {
 	return pvalvv(val).txd;
 }
+/*==================================
+ * PMAP: pvalue containing an ordered map
+ *================================*/
+OMAP
+pvalue_to_map (PVALUE val)
+{
+	return pvalvv(val).mxd;
+}
 /*==================================
  * PSET: pvalue containing a set (INDISEQ)
  *================================*/
@@ -1326,6 +1367,119 @@ create_new_pvalue_table (void)
 	release_table(tab);
 	return val;
 }
+/*=============================================
+ * is_scalar_key_pvalue -- Can this value key a map or hash set ?
+ *  (numbers, booleans, strings & records)
+ *============================================*/
+BOOLEAN
+is_scalar_key_pvalue (PVALUE val)
+{
+	switch (ptype(val)) {
+	case PINT: case PFLOAT: case PBOOL:
+	case PINDI: case PFAM: case PSOUR: case PEVEN: case POTHR:
+		return TRUE;
+	case PSTRING:
+		return pvalue_to_string(val) != 0;
+	}
+	return FALSE;
+}
+/*=============================================
+ * key_class -- Rank of scalar key type in map order
+ *  numbers sort first, then booleans, strings & records
+ *============================================*/
+static INT
+key_class (PVALUE val)
+{
+	switch (ptype(val)) {
+	case PINT: case PFLOAT: return 0;
+	case PBOOL: return 1;
+	case PSTRING: return 2;
+	}
+	return 3;
+}
+/*=============================================
+ * record_keynum -- Numeric part of key of record pvalue
+ *============================================*/
+static INT
+record_keynum (PVALUE val)
+{
+	RECORD rec = pvalue_to_record(val);
+	return rec ? atoi(nzkey(rec)+1) : 0;
+}
+/*=============================================
+ * pvalue_keys_compare -- Order scalar pvalues as map keys
+ *  (compare function for ordered maps)
+ *  Integers & floats compare numerically with each other
+ *  (NaNs after all other numbers), strings bytewise (so the
+ *  order does not depend on locale), and records by type &
+ *  then key number
+ *============================================*/
+int
+pvalue_keys_compare (const void * key1, const void * key2)
+{
+	PVALUE val1 = (PVALUE)key1, val2 = (PVALUE)key2;
+	INT cls1 = key_class(val1), cls2 = key_class(val2);
+	if (cls1 != cls2)
+		return cls1 < cls2 ? -1 : 1;
+	switch (cls1) {
+	case 0:
+		if (ptype(val1) == PINT && ptype(val2) == PINT) {
+			INT i1 = pvalue_to_int(val1), i2 = pvalue_to_int(val2);
+			return i1 < i2 ? -1 : (i1 > i2 ? 1 : 0);
+		} else {
+			double d1 = (ptype(val1) == PINT) ? pvalue_to_int(val1) : pvalue_to_float(val1);
+			double d2 = (ptype(val2) == PINT) ? pvalue_to_int(val2) : pvalue_to_float(val2);
+			/* NaN compares unequal to everything, so place it ourselves */
+			if (d1 != d1 || d2 != d2)
+				return (d1 != d1) - (d2 != d2);
+			return d1 < d2 ? -1 : (d1 > d2 ? 1 : 0);
+		}
+	case 1:
+		return (INT)pvalue_to_bool(val1) - (INT)pvalue_to_bool(val2);
+	case 2:
+		{
+			INT rel = strcmp(pvalue_to_string(val1), pvalue_to_string(val2));
+			return rel < 0 ? -1 : (rel > 0 ? 1 : 0);
+		}
+	}
+	if (ptype(val1) != ptype(val2))
+		return ptype(val1) < ptype(val2) ? -1 : 1;
+	else {
+		INT k1 = record_keynum(val1), k2 = record_keynum(val2);
+		return k1 < k2 ? -1 : (k1 > k2 ? 1 : 0);
+	}
+}
+/*=============================================
+ * create_new_pvalue_map -- Create new ordered map inside new pvalue
+ *  keys & values are pvalues owned by the map
+ *============================================*/
+PVALUE
+create_new_pvalue_map (void)
+{
+	OMAP omap = create_omap(pvalue_keys_compare
+		, delete_vptr_pvalue, delete_vptr_pvalue);
+	PVALUE_DATA pvd;
+	PVALUE val;
+	pvd.mxd = omap;
+	val = create_pvalue(PMAP, pvd);
+	release_omap(omap); /* release our ref to map */
+	return val;
+}
+/*=============================================
+ * create_new_pvalue_hashset -- Create new hash set inside new pvalue
+ *  table maps encoded key to pvalue of the member itself
+ *============================================*/
+PVALUE
+create_new_pvalue_hashset (void)
+{
+	TABLE tab = create_table_custom_vptr(delete_vptr_pvalue);
+	PVALUE_DATA pvd;
+	PVALUE val;
+	pvd.txd = tab;
+	val = create_pvalue(PHSET, pvd);
+	release_table(tab);
+	return val;
+}
 /*=============================================
  * create_new_pvalue_list -- Create new list inside new pvalue
  *============================================*/
@@ -42,6 +42,7 @@
 #include "feedback.h"
 #include "lloptions.h"
 #include "zstr.h"
+#include "lltrace.h"
 
 #include "interpi.h"
 
@@ -84,6 +85,7 @@ static INT linebuflen = 0;
 static STRING bufptr = (STRING)linebuffer;
 
 static STRING outfilename;
+static ZSTR deferred = 0;   /* output held back by parallel loop worker */
 
 /*********************************************
  * local function definitions
@@ -114,6 +116,28 @@ finishrassa (void)
 		curcol = 1;
 	}
 }
+/*======================================+
+ * begin_deferred_output -- Hold back program output
+ *  Used by parallel loop workers, whose output is
+ *  handed to the parent to be written in order
+ *=====================================*/
+void
+begin_deferred_output (void)
+{
+	zs_free(&deferred);
+	deferred = zs_new();
+}
+/*======================================+
+ * end_deferred_output -- Stop holding back output
+ *  returns output held back (caller must free)
+ *=====================================*/
+ZSTR
+end_deferred_output (void)
+{
+	ZSTR zstr = deferred;
+	deferred = 0;
+	return zstr ? zstr : zs_new();
+}
 /*========================================+
  * llrpt_pagemode -- Switch output to page mode
  * usage: pagemode(INT, INT) -> VOID
@@ -472,7 +496,16 @@ poutput (STRING str, BOOLEAN *eflg)
 	ZSTR zstr = 0;
 	INT c, len;
 	XLAT ttmr = transl_get_predefined_xlat(MINRP);
+	TRACE_TIME tt;
 	if (!str || (len = strlen(str)) <= 0) return;
+	TRACE_BEGIN(tt);
+	if (deferred) {
+		/* untranslated, as parent will pass it back through here */
+		zs_apps(deferred, str);
+		adjust_cols(str);
+		TRACE_END(tt, "report", "poutput", NULL);
+		return;
+	}
 	zstr = translate_string_to_zstring(ttmr, str);
 	str = zs_str(zstr);
 	if ((len = strlen(str)) <= 0)
@@ -529,6 +562,7 @@ poutput (STRING str, BOOLEAN *eflg)
 	}
 exit_poutput:
 	zs_free(&zstr);
+	TRACE_END(tt, "report", "poutput", NULL);
 }
 /*==================================================+
  * adjust_cols -- Adjust column after printing string
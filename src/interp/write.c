@@ -132,6 +132,8 @@ llrpt_addnode (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 	newchild->n_cel = prnt->n_cel;
 	set_temp_node(newchild, is_temp_node(prnt));
 	dolock_node_in_cache(newchild, TRUE);
+	if (prnt->n_cel)
+		drop_indifacts(); /* cached record changed */
 	if (prev == NULL) {
 		next = nchild(prnt);
 		nchild(prnt) = newchild;
@@ -159,6 +161,8 @@ llrpt_detachnode (PNODE node, SYMTAB stab, BOOLEAN *eflg)
 		return NULL;
 	}
 	dead = pvalue_to_node(val);
+	if (dead->n_cel)
+		drop_indifacts(); /* cached record changed */
 	if ((prnt = nparent(dead))) {
 		NODE prev = NULL, next;
 		NODE curs = nchild(prnt);
@@ -106,6 +106,7 @@ int yylex(YYSTYPE * lvalp, PACTX pactx);
 %token  FAMILIES ICONS WHILE CALL FORINDISET FORINDI FORNOTES
 %token  TRAVERSE FORNODES FORLIST_TOK FORFAM FORSOUR FOREVEN FOROTHR
 %token  BREAK CONTINUE RETURN FATHERS MOTHERS PARENTS FCONS
+%token  PARFORINDI PARFORFAM
 
 /*===========================================================*/
 /* Grammar Rules                                             */
@@ -166,6 +167,13 @@ idens	:	IDEN {
 			inext(((PNODE)$$)) = (PNODE) $3;
 		}
 	;
+reduceso:	/* empty */ {
+			$$ = 0;
+		}
+	|	',' idens {
+			$$ = $2;
+		}
+	;
 tmplts	:	tmplt {
 			$$ = $1;
 		}
@@ -234,6 +242,12 @@ tmplt	:	CHILDREN m '(' expr ',' IDEN ',' IDEN ')' '{' tmplts '}'
 			$$ = forindi_node(pactx, (STRING)$4, (STRING)$6, (PNODE)$9);
 			((PNODE)$$)->i_line = (INTPTR)$2;
 		}
+	|	PARFORINDI m '(' IDEN ',' IDEN reduceso ')' '{' tmplts '}'
+		{
+			/* consumes $4 and $6 */
+			$$ = parforindi_node(pactx, (STRING)$4, (STRING)$6, (PNODE)$7, (PNODE)$10);
+			((PNODE)$$)->i_line = (INTPTR)$2;
+		}
 	|	FORNOTES m '(' expr ',' IDEN ')' '{' tmplts '}'
 		{
 			/* consumes $6 */
@@ -246,6 +260,12 @@ tmplt	:	CHILDREN m '(' expr ',' IDEN ',' IDEN ')' '{' tmplts '}'
 			$$ = forfam_node(pactx, (STRING)$4, (STRING)$6, (PNODE)$9);
 			((PNODE)$$)->i_line = (INTPTR)$2;
 		}
+	|	PARFORFAM m '(' IDEN ',' IDEN reduceso ')' '{' tmplts '}'
+		{
+			/* consumes $4 and $6 */
+			$$ = parforfam_node(pactx, (STRING)$4, (STRING)$6, (PNODE)$7, (PNODE)$10);
+			((PNODE)$$)->i_line = (INTPTR)$2;
+		}
 	|	FORSOUR m '(' IDEN ',' IDEN ')' '{' tmplts '}'
 		{
 			/* consumes $4 and $6 */
@@ -64,7 +64,7 @@ struct tag_trav_parm {
 
 /* alphabetical */
 static BOOLEAN archive(BTREE btree, BLOCK block, void * param);
-static void copy_and_translate(FILE *fo, INT len, struct tag_trav_parm * travparm, char ctype, XLAT xlat);
+static void copy_and_translate(STRING rec, INT len, struct tag_trav_parm * travparm, char ctype, XLAT xlat);
 
 /*********************************************
  * local variables
@@ -135,59 +135,58 @@ archive_in_file (struct tag_export_feedback * efeed, FILE *fp)
 }
 /*========================================================
  * archive -- Traverse function called on each btree block
+ *  Reads the records of the block with one read, then writes
+ *  each exportable record from memory
  *======================================================*/
 static BOOLEAN
 archive (BTREE btree, BLOCK block, void * param)
 {
-	INT i, n, l;
+	INT i, n, l, end=0;
 	char scratch[100];
 	FILE *fo=0;
+	STRING buf=0;
 	struct tag_trav_parm * travparm = (struct tag_trav_parm *)param;
 
+	n = nkeys(block);
+	for (i = 0; i < n; i++) {
+		if (offs(block, i) + lens(block, i) > end)
+			end = offs(block, i) + lens(block, i);
+	}
+	if (!end)
+		return TRUE;
 	sprintf(scratch, "%s/%s", bbasedir(btree), fkey2path(ixself(block)));
 	fo = fopen(scratch, LLREADBINARY);
 	ASSERT(fo);
-	n = nkeys(block);
+	if (fseek(fo, (long)BUFLEN, 0))
+		FATAL();
+	buf = (STRING)stdalloc(end);
+	ASSERT(fread(buf, end, 1, fo) == 1);
+	fclose(fo);
 	for (i = 0; i < n; i++) {
 		STRING key = rkey2str(rkeys(block, i));
 		if (*key != 'I' && *key != 'F' && *key != 'E' &&
 		    *key != 'S' && *key != 'X')
 			continue;
-		if (fseek(fo, (long)(offs(block, i) + BUFLEN), 0))
-			FATAL();
 		if ((l = lens(block, i)) > 6)	/* filter deleted records */
-			copy_and_translate(fo, l, travparm, *key, xlat_gedout);
+			copy_and_translate(buf + offs(block, i), l, travparm, *key, xlat_gedout);
 	}
-	fclose(fo);
+	stdfree(buf);
 	return TRUE;
 }
 /*===================================================
  * copy_and_translate -- Copy record with translation
+ *  rec:  [IN]  record text (not zero-terminated)
+ *  len:  [IN]  length of record
  *=================================================*/
 static void
-copy_and_translate (FILE *fo, INT len, struct tag_trav_parm * travparm, char ctype, XLAT xlat)
+copy_and_translate (STRING rec, INT len, struct tag_trav_parm * travparm, char ctype, XLAT xlat)
 {
-	char in[BUFLEN]="";
-	char *inp=0;
-	int remlen=0, num=0;
-	FILE * fn = travparm->fp;
+	INT num=0;
+	BOOLEAN ok=FALSE;
 	struct tag_export_feedback * efeed = travparm->efeed;
-	
-	inp = in;		/* location for next read */
-	remlen = BUFLEN;	/* max for next read */
-	while (len > 0) {
-		BOOLEAN last=FALSE, ok=FALSE;
-		if(len < remlen) remlen = len;
-		ASSERT(fread(inp, remlen, 1, fo) == 1);
-		len -= remlen;
-		remlen = (inp + remlen) - in;	/* amount in current buffer */
-		last = (len <= 0);
-		ok = translate_write(xlat, in, &remlen, fn, last);
-		ASSERT(ok);
-		inp = in + remlen;		/* position for next read */
-		remlen = BUFLEN - remlen;	/* max for next read */
-	}
-	num = 0;
+
+	ok = translate_write(xlat, rec, &len, travparm->fp, TRUE);
+	ASSERT(ok);
 	switch (ctype) {
 	case 'I': num = ++nindi; break;
 	case 'F': num = ++nfam;  break;
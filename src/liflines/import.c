@@ -31,6 +31,7 @@
  *========================================================*/
 
 #include "llstdlib.h"
+#include "btree.h"
 #include "table.h"
 #include "translat.h"
 #include "gedcom.h"
@@ -63,6 +64,7 @@ extern INT gd_smax;	/* maximum source key number */
 extern INT gd_emax;	/* maximum event key number */
 extern INT gd_xmax;	/* maximum other key number */
 
+extern BTREE BTR;
 extern STRING qSgdnadd, qSdboldk, qSdbnewk;
 extern STRING qScfoldk, qSunsupuniv, qSproceed;
 
@@ -131,7 +133,9 @@ static BOOLEAN
 do_import (IMPORT_FEEDBACK ifeed, FILE *fp)
 {
 	NODE node, conv;
-	XLAT ttm = 0;
+	XLAT ttm = 0, srcxlat = 0;
+	FILE *fstage = 0;
+	GEDBUF gb = 0, src = 0;
 	STRING msg;
 	BOOLEAN emp;
 	INT nindi = 0, nfam = 0, neven = 0;
@@ -151,7 +155,11 @@ do_import (IMPORT_FEEDBACK ifeed, FILE *fp)
 /*	rptui_init(); *//* clear ui time counter */
 
 /* Open and validate GEDCOM file */
-	if ((unistr=check_file_for_unicode(fp)) && !eqstr(unistr, "UTF-8")) {
+	if (!(gb = open_gedbuf(fp))) {
+		msg_error(_("Cannot read GEDCOM file"));
+		goto end_import;
+	}
+	if ((unistr=gedbuf_check_unicode(gb)) && !eqstr(unistr, "UTF-8")) {
 		msg_error(_(qSunsupuniv), unistr);
 		goto end_import;
 	}
@@ -159,7 +167,7 @@ do_import (IMPORT_FEEDBACK ifeed, FILE *fp)
 		strupdate(&gdcodeset, "UTF-8");
 	}
 
-	if (!scan_header(fp, metadatatab, &zerr)) {
+	if (!scan_header(gb, metadatatab, &zerr)) {
 		msg_error(zs_str(zerr));
 		goto end_import;
 	}
@@ -204,25 +212,6 @@ do_import (IMPORT_FEEDBACK ifeed, FILE *fp)
 		}
 	}
 
-	/* validate */
-	if (ifeed && ifeed->validating_fnc)
-		(*ifeed->validating_fnc)();
-
-	if (!validate_gedcom(ifeed, fp)) {
-		if (ifeed && ifeed->error_invalid_fnc)
-			(*ifeed->error_invalid_fnc)(_(qSgdnadd));
-		goto end_import;
-	}
-	warnings = validate_get_warning_count();
-	if (warnings) {
-		ZSTR zstr=zs_new();
-		zs_setf(zstr, _pl("%d warning during import",
-			"%d warnings during import", warnings), warnings);
-		if (!ask_yes_or_no_msg(zs_str(zstr), _(qSproceed))) {
-			goto end_import;
-		}
-	}
-
 	if (gdcodeset[0] && int_codeset[0]) {
 retry_input_codeset:
 		ttm = transl_get_xlat(gdcodeset, int_codeset);
@@ -246,7 +235,41 @@ retry_input_codeset:
 			}
 		}
 	}
-	
+
+	/* test for read-only database here, before any parsing is done */
+
+	if(readonly) {
+		if (ifeed && ifeed->error_readonly_fnc)
+			(*ifeed->error_readonly_fnc)();
+		goto end_import;
+	}
+
+	/*
+	validation parses and translates every line; it also copies them
+	to a staging file, so the records are loaded from there afterwards
+	rather than parsing and translating the GEDCOM file a second time
+	*/
+	fstage = tmpfile();
+
+	/* validate */
+	if (ifeed && ifeed->validating_fnc)
+		(*ifeed->validating_fnc)();
+
+	if (!validate_gedcom(ifeed, gb, ttm, fstage)) {
+		if (ifeed && ifeed->error_invalid_fnc)
+			(*ifeed->error_invalid_fnc)(_(qSgdnadd));
+		goto end_import;
+	}
+	warnings = validate_get_warning_count();
+	if (warnings) {
+		ZSTR zstr=zs_new();
+		zs_setf(zstr, _pl("%d warning during import",
+			"%d warnings during import", warnings), warnings);
+		if (!ask_yes_or_no_msg(zs_str(zstr), _(qSproceed))) {
+			goto end_import;
+		}
+	}
+
 	if((num_indis() > 0)
 		|| (num_fams() > 0)
 		|| (num_sours() > 0)
@@ -273,15 +296,21 @@ TODO: why were these here ?
 */
 	}
 
-	/* start loading the file */
-	rewind(fp);
-
-	/* test for read-only database here */
-
-	if(readonly) {
-		if (ifeed && ifeed->error_readonly_fnc)
-			(*ifeed->error_readonly_fnc)();
-		goto end_import;
+	/* load from the staged copy, or failing that reread the file */
+	if (fstage) {
+		if (fflush(fstage) || ferror(fstage)) {
+			msg_error(_("Error writing import staging file"));
+			goto end_import;
+		}
+		rewind(fstage);
+		if (!(src = open_gedbuf(fstage))) {
+			msg_error(_("Error reading import staging file"));
+			goto end_import;
+		}
+	} else {
+		gedbuf_seek(gb, 0);
+		src = gb;
+		srcxlat = ttm;
 	}
 
 	/* tell user we are beginning real part of import */
@@ -294,11 +323,14 @@ TODO: why were these here ?
 
 
 /* Add records to database */
-	node = convert_first_fp_to_node(fp, FALSE, ttm, &msg, &emp);
+	/* queue btree writes, so each data block is rewritten once per batch
+	rather than once per record (includes name & refn index records) */
+	bt_begin_batch(BTR);
+	node = first_gedbuf_to_node(src, FALSE, srcxlat, &msg, &emp);
 	while (node) {
 		if (!(conv = node_to_node(node, &type))) {
 			free_nodes(node);
-			node = next_fp_to_node(fp, FALSE, ttm, &msg, &emp);
+			node = next_gedbuf_to_node(src, FALSE, srcxlat, &msg, &emp);
 			continue;
 		}
 		switch (type) {
@@ -313,7 +345,7 @@ TODO: why were these here ?
 		if (ifeed && ifeed->added_rec_fnc)
 			ifeed->added_rec_fnc(nxref(conv)[1], ntag(conv), num);
 		free_nodes(node);
-		node = next_fp_to_node(fp, FALSE, ttm, &msg, &emp);
+		node = next_gedbuf_to_node(src, FALSE, srcxlat, &msg, &emp);
 	}
 	if (msg) {
 		msg_error(msg);
@@ -327,9 +359,15 @@ TODO: why were these here ?
 		addmissingkeys(SOUR_REC);
 		addmissingkeys(OTHR_REC);
 	}
+	bt_end_batch(BTR);
 	succeeded = TRUE;
 
 end_import:
+	if (src && src != gb)
+		close_gedbuf(src);
+	close_gedbuf(gb);
+	if (fstage)
+		fclose(fstage);
 	validate_end_import();
 	zs_free(&zerr);
 	destroy_table(metadatatab);
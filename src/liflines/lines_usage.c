@@ -69,6 +69,20 @@ print_lines_usage (CNSTRING exename)
 	printf(_("do not use traditional family rules"));
 	printf("\n\t-o[FILE]\n\t\t");
 	printf(_("Specify program output filename (eg, -o/tmp/mytests)"));
+	if (0 == strcmp(exename, "llexec")) {
+		printf("\n\t");
+		printf(_("--profile FILE"));
+		printf("\n\t\t");
+		printf(_("profile report: write call stacks with time spent in folded\n"
+			"\t\tformat (for flamegraph) to FILE, and statistics per proc,\n"
+			"\t\tfunc, builtin and line to FILE.summary"));
+		printf("\n\t");
+		printf(_("--serve SOCKET"));
+		printf("\n\t\t");
+		printf(_("keep database open read-only and run report jobs sent\n"
+			"\t\tto local socket SOCKET (one -x, -I or -o option per line,\n"
+			"\t\tended by a blank line)"));
+	}
 	printf("\n\t-r\n\t\t");
 	printf(_("open database with read-only access (prohibiting other\n"
 		"\t\twrite access)"));
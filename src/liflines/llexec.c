@@ -26,6 +26,7 @@
 #include "ui.h"
 #include "llinesi.h"
 #include "version.h"
+#include "llexec.h"
 
 #ifdef HAVE_GETOPT
 #ifdef HAVE_GETOPT_H
@@ -84,7 +85,6 @@ INT screen_width = 20; /* TODO */
 static void print_usage(void);
 static void load_usage(void);
 static void main_db_notify(STRING db, BOOLEAN opening);
-static void parse_arg(const char * optarg, char ** optname, char **optval);
 static void platform_init(void);
 
 /*********************************************
@@ -113,7 +113,8 @@ main (int argc, char **argv)
 	STRING progout=NULL;
 	STRING configfile=0;
 	STRING crashlog=NULL;
-	int i=0;
+	STRING servesock=NULL; /* socket for llexec --serve */
+	int i=0, j=0;
 
 	/* initialize all the low-level library code */
 	init_stdlib();
@@ -152,6 +153,32 @@ main (int argc, char **argv)
 		}
 	}
 
+	/* handle --profile FILE & --serve SOCKET (getopt only knows
+	short options, so remove them from argv first) */
+	for (i=1; i<argc; ++i) {
+		int nused = 0;
+		if (!strcmp(argv[i], "--profile") && i+1 < argc) {
+			set_report_profile(argv[i+1]);
+			nused = 2;
+		} else if (!strncmp(argv[i], "--profile=", 10)) {
+			set_report_profile(argv[i]+10);
+			nused = 1;
+		} else if (!strcmp(argv[i], "--serve") && i+1 < argc) {
+			servesock = argv[i+1];
+			nused = 2;
+		} else if (!strncmp(argv[i], "--serve=", 8)) {
+			servesock = argv[i]+8;
+			nused = 1;
+		}
+		if (nused) {
+			for (j=i; j+nused<argc; ++j)
+				argv[j] = argv[j+nused];
+			argc -= nused;
+			argv[argc] = NULL;
+			--i;
+		}
+	}
+
 	/* Parse Command-Line Arguments */
 	opterr = 0;	/* turn off getopt's error message */
 	while ((c = getopt(argc, argv, "adkrwil:fntc:Fu:x:o:zC:I:vh?")) != -1) {
@@ -273,6 +300,10 @@ main (int argc, char **argv)
 		}
 	}
 
+	/* server never changes database */
+	if (servesock)
+		readonly = TRUE;
+
 prompt_for_db:
 
 	/* catch any fault, so we can close database */
@@ -351,7 +382,11 @@ prompt_for_db:
 		release_table(exargs);
 		exargs = 0;
 	}
-	if (exprogs) {
+	if (servesock) {
+		/* reports are given by jobs sent to server */
+		if (!serve_reports(servesock))
+			goto finish;
+	} else if (exprogs) {
 		BOOLEAN picklist = FALSE;
 		BOOLEAN timing = FALSE;
 		interp_main(exprogs, progout, picklist, timing);
@@ -377,6 +412,7 @@ finish:
 		goto prompt_for_db; /* changing databases */
 	termlocale();
 	strfree(&ext_codeset);
+	set_report_profile(NULL);
 
 usage:
 	/* Display Version and/or Command-Line Usage Help */
@@ -392,7 +428,7 @@ usage:
  *   yields a="main_indi" and b="I3"
  *  (a & b are newly allocated from heap)
  *================================*/
-static void
+void
 parse_arg (const char * optarg, char ** optname, char **optval)
 {
 	const char * ptr;
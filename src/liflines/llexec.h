@@ -4,5 +4,11 @@
 INT ask_for_char(CNSTRING ttl, CNSTRING prmpt, CNSTRING ptrn);
 BOOLEAN ask_for_db_filename(CNSTRING ttl, CNSTRING prmpt, CNSTRING basedir, STRING buffer, INT buflen);
 
+/* llexec.c */
+void parse_arg(const char * optarg, char ** optname, char **optval);
+
+/* llserve.c */
+BOOLEAN serve_reports(CNSTRING sockpath);
+
 #endif /* _LLEXEC_PRIV_H */
 
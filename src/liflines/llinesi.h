@@ -151,8 +151,8 @@ INT browse_2fam(RECORD *prec1, RECORD *prec2, INDISEQ *pseq);
 /* valgdcom.c */
 void addmissingkeys (INT);
 int check_stdkeys (void);
-BOOLEAN scan_header(FILE * fp, TABLE metadatatab, ZSTR * zerr);
-BOOLEAN validate_gedcom(IMPORT_FEEDBACK ifeed, FILE*);
+BOOLEAN scan_header(GEDBUF gb, TABLE metadatatab, ZSTR * zerr);
+BOOLEAN validate_gedcom(IMPORT_FEEDBACK ifeed, GEDBUF gb, XLAT ttm, FILE *fstage);
 void validate_end_import(void);
 INT validate_get_warning_count(void);
 INT xref_to_index (STRING);
@@ -0,0 +1,451 @@
+/*=============================================================
+ * llserve.c -- Report server mode of llexec (llexec --serve)
+ *  Keeps the database open (read-only) and takes report jobs
+ *  over a local (UNIX domain) socket. A job is a few lines in
+ *  llexec's own option syntax, ended by a blank line:
+ *     -x report        report program (may be repeated)
+ *     -I name=value    report option (may be repeated)
+ *     -o file          output file
+ *  Programs are parsed once and kept (see interp_load_cached),
+ *  and each job is run by a forked child, which inherits the
+ *  open database and warm caches, so nothing a report does
+ *  outlasts its job. Messages of the job go back over the
+ *  connection, followed by a last line "exit N", where N is
+ *  0 if the report ran.
+ *  Jobs are run one at a time. SIGTERM or SIGINT stops the
+ *  server after the current job. A client that does not send
+ *  its whole job within JOB_TIMEOUT seconds is dropped, so it
+ *  cannot hold up the jobs queued behind it.
+ *===========================================================*/
+
+#include "llstdlib.h"
+#include "table.h"
+#include "translat.h"
+#include "gedcom.h"
+#include "btree.h"
+#include "interp.h"
+#include "lloptions.h"
+#include "feedback.h"
+#include "llexec.h"
+
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H) \
+	&& defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H) \
+	&& defined(HAVE_POLL_H)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#define LLSERVE_SOCKET
+#endif
+
+/*********************************************
+ * external variables (no header)
+ *********************************************/
+
+extern BTREE BTR;
+
+#ifdef LLSERVE_SOCKET
+
+/* seconds allowed to client to send whole job */
+#define JOB_TIMEOUT 30
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* one report job, as sent by client */
+typedef struct tag_serve_job {
+	LIST progs;     /* report programs (-x) */
+	TABLE args;     /* report options (-I) */
+	STRING ofile;   /* output file (-o) */
+} *SERVE_JOB;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static void free_job(SERVE_JOB * pjob);
+static void on_stop_signal(int sig);
+static int open_socket(CNSTRING sockpath);
+static SERVE_JOB read_job(int fd, STRING * perr);
+static BOOLEAN read_line(int fd, time_t deadline, STRING line, INT size, STRING * perr);
+static void reply(int fd, CNSTRING str);
+static void run_child(SERVE_JOB job, int fd);
+static int run_job(SERVE_JOB job, int fd);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+static volatile sig_atomic_t stop_serving = 0;
+
+#endif /* LLSERVE_SOCKET */
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*==================================
+ * serve_reports -- Run report jobs sent to socket
+ *  until told to stop
+ *  sockpath: [IN]  path of socket to create
+ * Database must already be open.
+ * returns FALSE if server could not be started
+ *================================*/
+BOOLEAN
+serve_reports (CNSTRING sockpath)
+{
+#ifdef LLSERVE_SOCKET
+	struct sigaction sa;
+	int lfd;
+	char buffer[64];
+
+	if ((lfd = open_socket(sockpath)) < 0)
+		return FALSE;
+
+	/* no SA_RESTART, so that accept returns when told to stop */
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_stop_signal;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGINT, &sa, NULL);
+	/* a client hanging up must not kill the server */
+	signal(SIGPIPE, SIG_IGN);
+
+	llwprintf(_("Serving reports on %s\n"), sockpath);
+	fflush(stdout);
+
+	while (!stop_serving) {
+		STRING err=0;
+		SERVE_JOB job;
+		int status;
+		int cfd = accept(lfd, NULL, NULL);
+		if (cfd < 0) {
+			if (errno == EINTR)
+				continue;
+			llwprintf(_("Failed (errno=%d) to accept job on %s\n"), errno, sockpath);
+			break;
+		}
+		if ((job = read_job(cfd, &err)) != NULL) {
+			status = run_job(job, cfd);
+			free_job(&job);
+		} else {
+			reply(cfd, err);
+			reply(cfd, "\n");
+			status = 2;
+		}
+		snprintf(buffer, sizeof(buffer), "exit %d\n", status);
+		reply(cfd, buffer);
+		close(cfd);
+	}
+
+	close(lfd);
+	unlink(sockpath);
+	signal(SIGPIPE, SIG_DFL);
+	interp_clear_cached();
+	return TRUE;
+#else
+	sockpath=sockpath; /* unused */
+	llwprintf(_("llexec --serve is not supported on this platform\n"));
+	return FALSE;
+#endif
+}
+
+#ifdef LLSERVE_SOCKET
+
+/*==================================
+ * open_socket -- Create socket for jobs & listen on it
+ *  sockpath: [IN]  path of socket
+ * A socket left by a server that has gone is replaced, but
+ * not one a live server is listening on, nor any other file.
+ * returns listening descriptor, or -1 (after reporting)
+ *================================*/
+static int
+open_socket (CNSTRING sockpath)
+{
+	struct sockaddr_un addr;
+	struct stat sbuf;
+	mode_t oldmask;
+	int fd, rtn;
+
+	if (strlen(sockpath) >= sizeof(addr.sun_path)) {
+		llwprintf(_("Socket path too long: %s\n"), sockpath);
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	llstrncpy(addr.sun_path, sockpath, sizeof(addr.sun_path), 0);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		llwprintf(_("Failed (errno=%d) to create socket\n"), errno);
+		return -1;
+	}
+	if (!stat(sockpath, &sbuf)) {
+		if (!S_ISSOCK(sbuf.st_mode)
+			|| !connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+			llwprintf(_("Socket path already in use: %s\n"), sockpath);
+			close(fd);
+			return -1;
+		}
+		unlink(sockpath);
+	}
+	/* only our user may send jobs */
+	oldmask = umask(077);
+	rtn = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+	umask(oldmask);
+	if (rtn < 0 || listen(fd, 8) < 0) {
+		llwprintf(_("Failed (errno=%d) to listen on socket %s\n"), errno, sockpath);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+/*==================================
+ * read_job -- Read job sent by client
+ *  fd:   [IN]  connection to client
+ *  perr: [OUT] what is wrong with job (if it returns NULL)
+ * returns new job, or NULL if it is not valid
+ *================================*/
+static SERVE_JOB
+read_job (int fd, STRING * perr)
+{
+	SERVE_JOB job = (SERVE_JOB)stdalloc(sizeof(*job));
+	char line[MAXLINELEN+2];
+	/* the whole job must be in by then, however it is sent */
+	time_t deadline = time(NULL) + JOB_TIMEOUT;
+
+	job->progs = create_list2(LISTDOFREE);
+	*perr = 0;
+	while (read_line(fd, deadline, line, sizeof(line), perr)) {
+		INT len = strlen(line);
+		STRING val;
+		if (len && line[len-1] == '\r')
+			line[--len] = 0;
+		if (!len)
+			break;
+		if (line[0] != '-' || !line[1]) {
+			*perr = _("Job lines must be -x, -I or -o options");
+			goto read_job_exit;
+		}
+		for (val = line+2; iswhite((uchar)*val); ++val)
+			;
+		switch (line[1]) {
+		case 'x': /* program */
+			push_list(job->progs, strsave(val));
+			break;
+		case 'I': /* program argument */
+			{
+				STRING optname=0, optval=0;
+				parse_arg(val, &optname, &optval);
+				if (optname && optval) {
+					if (!job->args)
+						job->args = create_table_str();
+					insert_table_str(job->args, optname, optval);
+				}
+				strfree(&optname);
+				strfree(&optval);
+			}
+			break;
+		case 'o': /* output file */
+			if (val[0])
+				strupdate(&job->ofile, val);
+			break;
+		default:
+			*perr = _("Job lines must be -x, -I or -o options");
+			goto read_job_exit;
+		}
+	}
+	if (*perr)
+		goto read_job_exit;
+	if (is_empty_list(job->progs))
+		*perr = _("Job gives no report program (-x)");
+
+read_job_exit:
+	if (*perr)
+		free_job(&job);
+	return job;
+}
+/*==================================
+ * read_line -- Read one line of job from client
+ *  fd:       [IN]  connection to client
+ *  deadline: [IN]  time by which whole job must be read
+ *  line:     [OUT] line read, without its newline
+ *  size:     [IN]  size of line buffer
+ *  perr:     [OUT] what went wrong (if it returns FALSE)
+ * Reads straight from fd, a byte at a time, so that nothing
+ * past the job is consumed, and waits for each byte only as
+ * long as is left before deadline (a timeout on the socket
+ * would start afresh for every read).
+ * returns FALSE at end of input (*perr unset) or on failure
+ *================================*/
+static BOOLEAN
+read_line (int fd, time_t deadline, STRING line, INT size, STRING * perr)
+{
+	struct pollfd pfd;
+	INT len = 0;
+	int rtn;
+	char c;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	while (1) {
+		time_t left = deadline - time(NULL);
+		if (left <= 0) {
+			*perr = _("Timed out waiting for job");
+			return FALSE;
+		}
+		if ((rtn = poll(&pfd, 1, (int)left * 1000)) < 0) {
+			if (errno == EINTR)
+				continue;
+			*perr = _("Failed to read job");
+			return FALSE;
+		}
+		if (!rtn)
+			continue; /* left is checked again at top */
+		if ((rtn = read(fd, &c, 1)) < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			*perr = _("Failed to read job");
+			return FALSE;
+		}
+		if (!rtn || c == '\n')
+			break;
+		if (len >= size-1) {
+			*perr = _("Job line too long");
+			return FALSE;
+		}
+		line[len++] = c;
+	}
+	line[len] = 0;
+	/* last line need not end in newline */
+	return len > 0 || rtn > 0;
+}
+/*==================================
+ * run_job -- Run one report job
+ *  job: [IN]  job to run
+ *  fd:  [IN]  connection to client
+ * The program is parsed here (unless it already was) so the
+ * server keeps it, and run by a child process.
+ * returns exit status to give client
+ *================================*/
+static int
+run_job (SERVE_JOB job, int fd)
+{
+	BOOLEAN loaded;
+	int saved[2];
+	int status=0;
+	pid_t pid;
+
+	/* send any parse errors to client */
+	fflush(stdout);
+	fflush(stderr);
+	saved[0] = dup(1);
+	saved[1] = dup(2);
+	dup2(fd, 1);
+	dup2(fd, 2);
+	loaded = interp_load_cached(job->progs);
+	fflush(stdout);
+	fflush(stderr);
+	dup2(saved[0], 1);
+	dup2(saved[1], 2);
+	close(saved[0]);
+	close(saved[1]);
+	if (!loaded)
+		return 1;
+
+	if ((pid = fork()) < 0) {
+		reply(fd, _("Failed to start job"));
+		reply(fd, "\n");
+		return 1;
+	}
+	if (pid == 0)
+		run_child(job, fd);
+	/* finish job even if told to stop meanwhile */
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+		;
+	if (WIFEXITED(status))
+		return WEXITSTATUS(status);
+	return 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+}
+/*==================================
+ * run_child -- Body of job process (does not return)
+ *  job: [IN]  job to run
+ *  fd:  [IN]  connection to client
+ *================================*/
+static void
+run_child (SERVE_JOB job, int fd)
+{
+	INT ranit;
+	int nullfd;
+
+	signal(SIGTERM, SIG_DFL);
+	signal(SIGINT, SIG_DFL);
+	/* nobody to answer questions */
+	if ((nullfd = open("/dev/null", O_RDONLY)) >= 0) {
+		dup2(nullfd, 0);
+		close(nullfd);
+	}
+	dup2(fd, 1);
+	dup2(fd, 2);
+	close(fd);
+	/* if job dies by FATAL (which closes database), leave
+	the server's reader lock alone */
+	bimmut(BTR) = TRUE;
+	if (job->args)
+		set_cmd_options(job->args);
+	ranit = interp_run_cached(job->ofile);
+	fflush(stdout);
+	fflush(stderr);
+	/* skip atexit handlers, which belong to server */
+	_exit(ranit ? 0 : 1);
+}
+/*==================================
+ * reply -- Send text to client
+ *  (client may have gone, which is ignored)
+ *================================*/
+static void
+reply (int fd, CNSTRING str)
+{
+	size_t len = strlen(str);
+	while (len > 0) {
+		ssize_t n = write(fd, str, len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return;
+		str += n;
+		len -= n;
+	}
+}
+/*==================================
+ * free_job -- Free job & null pointer
+ *================================*/
+static void
+free_job (SERVE_JOB * pjob)
+{
+	SERVE_JOB job = *pjob;
+	if (!job) return;
+	destroy_list(job->progs);
+	if (job->args)
+		release_table(job->args);
+	strfree(&job->ofile);
+	stdfree(job);
+	*pjob = 0;
+}
+/*==================================
+ * on_stop_signal -- Ask server to stop after current job
+ *================================*/
+static void
+on_stop_signal (int sig)
+{
+	sig=sig; /* unused */
+	stop_serving = 1;
+}
+
+#endif /* LLSERVE_SOCKET */
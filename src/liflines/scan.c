@@ -53,6 +53,7 @@ typedef struct
 	INT scantype;
 	CNSTRING statusmsg;
 	char pattern[64];
+	fpattern_comp *compiled; /* pattern compiled for matching */
 	INDISEQ seq;
 	STRING field; /* field to scan, eg "AUTH" for sources by author */
 	BOOLEAN conts; /* include CONC & CONT children tags? */
@@ -77,6 +78,7 @@ static void do_name_scan(SCANNER * scanner, STRING prompt);
 static void do_sources_scan(SCANNER * scanner, CNSTRING prompt);
 static BOOLEAN ns_callback(CNSTRING key, CNSTRING name, BOOLEAN newset, void *param);
 static BOOLEAN rs_callback(CNSTRING key, CNSTRING refn, BOOLEAN newset, void *param);
+static BOOLEAN scan_indexed(SCANNER * scanner, char ntype, CNSTRING tag, TRAV_NAMES_FUNC func);
 static void scanner_add_result(SCANNER * scanner, CNSTRING key);
 static BOOLEAN scanner_does_pattern_match(SCANNER *scanner, CNSTRING text);
 static INDISEQ scanner_free_and_return_seq(SCANNER * scanner);
@@ -135,7 +137,8 @@ refn_scan (STRING sts)
 			break;
 	}
 	msg_status(sts);
-	traverse_refns(rs_callback, &scanner);
+	if (!scan_indexed(&scanner, 0, "REFN", rs_callback))
+		traverse_refns(rs_callback, &scanner);
 	msg_status("");
 
 	return scanner_free_and_return_seq(&scanner);
@@ -185,7 +188,8 @@ do_name_scan (SCANNER * scanner, STRING prompt)
 			break;
 	}
 	msg_status((STRING)scanner->statusmsg);
-	traverse_names(ns_callback, scanner);
+	if (!scan_indexed(scanner, 'I', "NAME", ns_callback))
+		traverse_names(ns_callback, scanner);
 	msg_status("");
 }
 /*==============================
@@ -197,6 +201,7 @@ static void
 do_sources_scan (SCANNER * scanner, CNSTRING prompt)
 {
 	INT keynum = 0;
+	INDISEQ cands = 0;
 
 	while (1) {
 		char request[MAXPATHLEN];
@@ -210,6 +215,15 @@ do_sources_scan (SCANNER * scanner, CNSTRING prompt)
 	/* msg_status takes STRING arg, should take CNSTRING - const declaration error */
 	msg_status((STRING)scanner->statusmsg);
 
+	/* only sources holding a word of the pattern, if index knows */
+	if ((cands = textindex_candidates(scanner->pattern, 'S'))) {
+		FORINDISEQ(cands, el, num)
+			do_fields_scan(scanner, keynum_to_srecord(atoi(element_skey(el)+1)));
+		ENDINDISEQ
+		remove_indiseq(cands);
+		msg_status("");
+		return;
+	}
 	while (1) {
 		RECORD rec = 0;
 		keynum = xref_nexts(keynum);
@@ -220,6 +234,33 @@ do_sources_scan (SCANNER * scanner, CNSTRING prompt)
 	}
 	msg_status("");
 }
+/*==============================
+ * scan_indexed -- Scan only records which the text index
+ *  says may match, passing each value of tag (at level 1)
+ *  scanner:   [I/O] all necessary scan info, including sequence of results
+ *  ntype:     [IN]  type of record to scan, or 0 for all
+ *  func:      [IN]  callback, as for traverse_names
+ * returns FALSE if the index cannot be used (caller scans all)
+ *============================*/
+static BOOLEAN
+scan_indexed (SCANNER * scanner, char ntype, CNSTRING tag, TRAV_NAMES_FUNC func)
+{
+	INDISEQ cands = textindex_candidates(scanner->pattern, ntype);
+	if (!cands)
+		return FALSE;
+	FORINDISEQ(cands, el, num)
+		CNSTRING key = element_skey(el);
+		RECORD rec = qkey_to_record(key);
+		NODE node = rec ? nztop(rec) : 0;
+		for (node = node ? nchild(node) : 0; node; node = nsibling(node)) {
+			if (eqstr(ntag(node), tag) && nval(node))
+				(*func)(key, nval(node), FALSE, scanner);
+		}
+		release_record(rec);
+	ENDINDISEQ
+	remove_indiseq(cands);
+	return TRUE;
+}
 /*==============================
  * do_fields_scan -- traverse top nodes looking for desired field value
  *  scanner:   [I/O] all necessary scan info, including sequence of results
@@ -267,6 +308,7 @@ scanner_init (SCANNER * scanner, INT scantype, CNSTRING statusmsg)
 	scanner->scantype = scantype;
 	scanner->seq = create_indiseq_null();
 	strcpy(scanner->pattern, "");
+	scanner->compiled = NULL;
 	scanner->statusmsg = statusmsg;
 	scanner->field = NULL;
 	scanner->conts = FALSE;
@@ -278,6 +320,8 @@ static INDISEQ
 scanner_free_and_return_seq (SCANNER * scanner)
 {
 	strfree(&scanner->field);
+	fpattern_free(scanner->compiled);
+	scanner->compiled = NULL;
 	return scanner->seq;
 }
 /*=================================================
@@ -301,6 +345,8 @@ scanner_set_pattern (SCANNER * scanner, STRING str)
 		return FALSE;
 
 	strcpy(scanner->pattern, str);
+	fpattern_free(scanner->compiled);
+	scanner->compiled = fpattern_compile(str);
 
 	return TRUE;
 }
@@ -328,7 +374,7 @@ scanner_scan_titles (SCANNER * scanner)
 static BOOLEAN
 scanner_does_pattern_match (SCANNER *scanner, CNSTRING text)
 {
-	return (fpattern_matchn(scanner->pattern, text));
+	return (fpattern_matchc(scanner->compiled, text));
 }
 /*=============================================
  * scanner_add_result -- Add a hit to the result list
@@ -71,6 +71,19 @@ INT gd_smax = 0;        /* maximum source key number */
 INT gd_emax = 0;        /* maximum event key number */
 INT gd_xmax = 0;        /* maximum other key number */
 
+/* xref -> index_data slot map. Keys of the usual "I123" form (a
+letter and a decimal number) are looked up in a dense vector per
+letter; all others, and numbers too sparse for the vector, go into
+convtab. */
+struct tag_xrefvec {
+	INT *slots;  /* index_data slot + 1, or 0 if unused */
+	INT max;     /* allocated length of slots */
+	INT count;   /* number of slots in use */
+};
+#define XREFVEC_DIGITS 9        /* longest number kept in a vector */
+#define XREFVEC_MINMAX 1024     /* first allocation of a vector */
+#define XREFVEC_SPARSE 1048576  /* vectors may always grow to this */
+static struct tag_xrefvec xrefvecs[128];
 static TABLE convtab = NULL;
 static INT rec_type;
 static BOOLEAN named = FALSE; /* found a NAME in current INDI ? */
@@ -107,6 +120,7 @@ static INT add_indi_defn(IMPORT_FEEDBACK ifeed, STRING, INT, ELMNT*);
 static INT add_othr_defn(IMPORT_FEEDBACK ifeed, STRING, INT);
 static INT add_sour_defn(IMPORT_FEEDBACK ifeed, STRING, INT);
 static INT add_to_structures(STRING, ELMNT);
+static BOOLEAN add_to_xrefvec(CNSTRING xref, INT dex);
 static void append_path(ZSTR zstr, char delim, CNSTRING str);
 static int check_akey (int firstchar, STRING keyp, INT *maxp);
 static void check_even_links(IMPORT_FEEDBACK ifeed, ELMNT);
@@ -124,22 +138,29 @@ static void handle_indi_lev1(IMPORT_FEEDBACK ifeed, STRING tag, STRING val, INT
 static void handle_head_lev1(IMPORT_FEEDBACK ifeed, STRING, STRING, INT);
 static void handle_trlr_lev1(IMPORT_FEEDBACK ifeed, STRING, STRING, INT);
 static void handle_value(STRING, INT);
+static BOOLEAN parse_xref_num(CNSTRING xref, INT *pletter, INT *pnum);
 static BOOLEAN openlog(void);
 static void handle_warn(IMPORT_FEEDBACK ifeed, STRING, ...);
 static void handle_err(IMPORT_FEEDBACK ifeed, STRING, ...);
 static void set_import_log(STRING logpath);
+static void stage_line(FILE *fstage, INT lev, CNSTRING xref, CNSTRING tag, CNSTRING val);
 static void report_missing_value(IMPORT_FEEDBACK ifeed, STRING tag, INT line, CNSTRING tag0, CNSTRING xref0);
 
 /*===================================================
  * validate_gedcom -- Validate GEDCOM records in file
+ *  ifeed:  [IN]  output methods
+ *  gb:     [IN]  GEDCOM file (positioned after header)
+ *  ttm:    [IN]  translation from file codeset to internal
+ *  fstage: [IN]  if not NULL, every line read is copied here in internal
+ *                form, so the import can load records without rereading gb
  *=================================================*/
 BOOLEAN
-validate_gedcom (IMPORT_FEEDBACK ifeed, FILE *fp)
+validate_gedcom (IMPORT_FEEDBACK ifeed, GEDBUF gb, XLAT ttm, FILE *fstage)
 {
 	INT lev, rc, curlev = 0;
 	INT nhead, ntrlr, nindi, nfam, nsour, neven, nothr;
 	ELMNT el;
-	XLAT xlat = transl_get_predefined_xlat(MGDIN);
+	XLAT xlat = ttm;
 	STRING xref, tag, val, msg;
 	STRING tag0=0;
 	STRING xref0=0;
@@ -155,7 +176,8 @@ validate_gedcom (IMPORT_FEEDBACK ifeed, FILE *fp)
 	convtab = create_table_int();
 
 
-	rc = file_to_line(fp, xlat, &lev, &xref, &tag, &val, &msg);
+	rc = gedbuf_to_line(gb, xlat, &lev, &xref, &tag, &val, &msg);
+	if (rc == OKAY) stage_line(fstage, lev, xref, tag, val);
 	xref = xref ? rmvat(xref) : NULL;
 	rec_type = OTHR_REC;
 	while (rc != DONE)  {
@@ -166,16 +188,18 @@ validate_gedcom (IMPORT_FEEDBACK ifeed, FILE *fp)
 				handle_err(ifeed, qSbadlev, flineno);
 			handle_value(val, flineno);
 			curlev = lev;
-			rc = file_to_line(fp, xlat, &lev, &xref, &tag, &val,
+			rc = gedbuf_to_line(gb, xlat, &lev, &xref, &tag, &val,
 			    &msg);
+			if (rc == OKAY) stage_line(fstage, lev, xref, tag, val);
 			xref = xref ? rmvat(xref) : NULL;
 			continue;
 		}
 		if (lev > 1) {
 			handle_value(val, flineno);
 			curlev = lev;
-			rc = file_to_line(fp, xlat, &lev, &xref, &tag, &val,
+			rc = gedbuf_to_line(gb, xlat, &lev, &xref, &tag, &val,
 			    &msg);
+			if (rc == OKAY) stage_line(fstage, lev, xref, tag, val);
 			xref = xref ? rmvat(xref) : NULL;
 			continue;
 		}
@@ -246,7 +270,8 @@ validate_gedcom (IMPORT_FEEDBACK ifeed, FILE *fp)
 			check_level1_tag(ifeed, tag, val, flineno, tag0, xref0);
 		}
 		curlev = lev;
-		rc = file_to_line(fp, xlat, &lev, &xref, &tag, &val, &msg);
+		rc = gedbuf_to_line(gb, xlat, &lev, &xref, &tag, &val, &msg);
+		if (rc == OKAY) stage_line(fstage, lev, xref, tag, val);
 		xref = xref ? rmvat(xref) : NULL;
 	}
 	if (rec_type == INDI_REC && !named)
@@ -260,6 +285,28 @@ validate_gedcom (IMPORT_FEEDBACK ifeed, FILE *fp)
 	strfree(&tag0);
 	return num_errors == 0;
 }
+/*===================================================
+ * stage_line -- Copy one parsed line to the import staging file
+ *  The line is written back in canonical GEDCOM form (already
+ *  translated), so it can be read again with no translation table.
+ *=================================================*/
+static void
+stage_line (FILE *fstage, INT lev, CNSTRING xref, CNSTRING tag, CNSTRING val)
+{
+	if (!fstage) return;
+	fprintf(fstage, "%d", lev);
+	if (xref) {
+		putc(' ', fstage);
+		fputs(xref, fstage);
+	}
+	putc(' ', fstage);
+	fputs(tag, fstage);
+	if (val && val[0]) {
+		putc(' ', fstage);
+		fputs(val, fstage);
+	}
+	putc('\n', fstage);
+}
 /*=======================================
  * create_elmnt -- Return newly alloc'd ELMNT
  *=====================================*/
@@ -986,30 +1033,90 @@ INT
 xref_to_index (STRING xref)
 {
 	BOOLEAN there;
-	INT dex = valueofbool_int(convtab, xref, &there);
+	INT letter, num, dex;
+
+	if (parse_xref_num(xref, &letter, &num)) {
+		struct tag_xrefvec * vec = &xrefvecs[letter];
+		if (num < vec->max && vec->slots[num])
+			return vec->slots[num] - 1;
+	}
+	if (!convtab || !get_table_count(convtab))
+		return -1;
+	dex = valueofbool_int(convtab, xref, &there);
 	return there ? dex : -1;
 }
+/*=========================================================
+ * parse_xref_num -- Split "I123" style xref into letter & number
+ *  returns FALSE for any other form (including leading zeros, so
+ *  that "I012" and "I12" remain distinct records)
+ *=======================================================*/
+static BOOLEAN
+parse_xref_num (CNSTRING xref, INT *pletter, INT *pnum)
+{
+	INT num = 0, len = 0;
+	CNSTRING p;
+
+	if (!xref || !isasciiletter((uchar)xref[0]))
+		return FALSE;
+	p = xref + 1;
+	if (p[0] == '0' && p[1])
+		return FALSE;
+	for ( ; *p; ++p) {
+		if (*p < '0' || *p > '9' || ++len > XREFVEC_DIGITS)
+			return FALSE;
+		num = num*10 + (*p - '0');
+	}
+	if (!len)
+		return FALSE;
+	*pletter = (uchar)xref[0];
+	*pnum = num;
+	return TRUE;
+}
+/*=========================================================
+ * add_to_xrefvec -- Record slot of "I123" style xref in its vector
+ *  Vectors grow geometrically, but only while they stay reasonably
+ *  dense; returns FALSE if xref must go into convtab instead
+ *=======================================================*/
+static BOOLEAN
+add_to_xrefvec (CNSTRING xref, INT dex)
+{
+	INT letter, num;
+	struct tag_xrefvec * vec;
+
+	if (!parse_xref_num(xref, &letter, &num))
+		return FALSE;
+	vec = &xrefvecs[letter];
+	if (num >= vec->max) {
+		INT newmax = vec->max ? 2*vec->max : XREFVEC_MINMAX;
+		if (num >= XREFVEC_SPARSE && num >= 8*(vec->count + 1))
+			return FALSE;
+		while (newmax <= num)
+			newmax *= 2;
+		vec->slots = (INT *)stdrealloc(vec->slots, newmax*sizeof(INT));
+		memset(vec->slots + vec->max, 0, (newmax - vec->max)*sizeof(INT));
+		vec->max = newmax;
+	}
+	vec->slots[num] = dex + 1;
+	++vec->count;
+	return TRUE;
+}
 /*=========================================================
  * add_to_structures -- Add new elements to data structures
+ *  index_data grows geometrically, so that loading N records
+ *  costs O(N) copying in all
  *=======================================================*/
 static INT
 add_to_structures (STRING xref, ELMNT el)
 {
-	INT i, n;
-
-	if ((n = struct_len) >= struct_max)  {
-		ELMNT *newi = (ELMNT *) stdalloc(sizeof(ELMNT)*
-		    (n + 10000));
-		for (i = 0; i < n; i++)
-			newi[i] = index_data[i];
-		if (n) stdfree(index_data);
-		index_data = newi;
-		struct_max += 10000;
+	if (struct_len >= struct_max)  {
+		struct_max = struct_max ? 2*struct_max : 10000;
+		index_data = (ELMNT *)stdrealloc(index_data
+			, sizeof(ELMNT)*struct_max);
 	}
-	i = struct_len;
-	index_data[i] = el;
-	insert_table_int(convtab, xref, struct_len++);
-	return struct_len - 1;
+	index_data[struct_len] = el;
+	if (!add_to_xrefvec(xref, struct_len))
+		insert_table_int(convtab, xref, struct_len);
+	return struct_len++;
 }
 /*========================================================
  * clear_structures -- Clear GEDCOM import data structures
@@ -1025,6 +1132,14 @@ clear_structures (void)
 		destroy_table(convtab);
 		convtab = NULL;
 	}
+	for (i = 0; i < ARRSIZE(xrefvecs); i++) {
+		struct tag_xrefvec * vec = &xrefvecs[i];
+		if (vec->slots) {
+			stdfree(vec->slots);
+			vec->slots = NULL;
+		}
+		vec->max = vec->count = 0;
+	}
 	for (i = 0; i < struct_len; i++) {
 		ELMNT el = index_data[i];
 		index_data[i] = 0;
@@ -1048,11 +1163,11 @@ set_import_log (STRING logpath)
  * Created: 2003-02-03 (Perry Rapp)
  *==========================================================*/
 BOOLEAN
-scan_header (FILE * fp, TABLE metadatatab, ZSTR * zerr)
+scan_header (GEDBUF gb, TABLE metadatatab, ZSTR * zerr)
 {
 	STRING parents[2] = { 0, 0 };
 	INT linno, head=0, lev=-1, curlev,i;
-	INT lastoff=0;
+	size_t lastoff=0;
 	ZSTR zpath = zs_new();
 	*zerr = 0;
 	for (linno=1; 1; ++linno) {
@@ -1061,13 +1176,13 @@ scan_header (FILE * fp, TABLE metadatatab, ZSTR * zerr)
 		encoding declaration yet */
 		INT rc;
 		STRING xref, tag, val, msg;
-		lastoff = ftell(fp);
+		lastoff = gedbuf_tell(gb);
 		curlev = lev;
 		if (linno==500) {
 			*zerr = zs_newf(_("Processed %d lines without finding end of HEAD"), linno);
 			break;
 		}
-		rc = file_to_line(fp, xlat, &lev, &xref, &tag, &val, &msg);
+		rc = gedbuf_to_line(gb, xlat, &lev, &xref, &tag, &val, &msg);
 		if (rc==DONE) {
 			*zerr = zs_newf(_("End of file at line %d"), linno);
 			break;
@@ -1092,7 +1207,7 @@ scan_header (FILE * fp, TABLE metadatatab, ZSTR * zerr)
 				*zerr = zs_newf(_("Missing HEAD line at line %d"), linno);
 				break;
 			} else {
-				fseek(fp, lastoff, SEEK_SET);
+				gedbuf_seek(gb, lastoff);
 				flineno--;
 				/* finished head */
 				break;
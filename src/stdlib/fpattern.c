@@ -66,7 +66,10 @@ static const char	copyright[] =
 /* System includes */
 
 #include <ctype.h>
+#include <limits.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if TEST
 #include <locale.h>
@@ -507,6 +510,392 @@ int fpattern_matchn(const char *pat, const char *fname)
 }
 
 
+/*-----------------------------------------------------------------------------
+* Compiled patterns
+*	A pattern matched against many strings (eg, every name in a database)
+*	can be compiled once by fpattern_compile(). Each pattern element
+*	(char, '?', set, '*' or '^Z') becomes one state of a nondeterministic
+*	automaton, held as bits of an unsigned long, with a table per input
+*	char of the states it advances. All states are followed at once, so
+*	there is no backtracking, and case folding and set lookup are done at
+*	compile time. If the pattern has a longest run of plain chars after
+*	its start, strings are first searched (by memchr) for one char of that
+*	run, and those without the whole run are rejected at once.
+*	Patterns with too many elements, an exclusion ('!') other than at
+*	the start, or an unfinished set or quote (which fpattern_isvalid()
+*	lets through after a '!') are interpreted by fpattern_submatch() as
+*	before.
+*/
+
+#define FPAT_BITS	((int)(sizeof(unsigned long) * CHAR_BIT))
+#define FPAT_BIT(n)	(1UL << (n))
+
+struct fpattern_comp
+{
+    char *		pat;		/* Copy of pattern		*/
+    int			interp;		/* Interpret pat instead	*/
+    int			negate;		/* Leading exclusion		*/
+    unsigned long	one[256];	/* States passed by char	*/
+    unsigned long	loop[256];	/* Closure states kept by char	*/
+    unsigned long	clos;		/* Closure states		*/
+    unsigned long	accept;		/* Final state			*/
+    int			litpos;		/* First state of literal run	*/
+    int			litlen;		/* Length of run (0 if none)	*/
+    int			litkey;		/* Offset of char sought in run	*/
+    int			nkeych;		/* Chars matching that one	*/
+    unsigned char	keych[2];
+};
+
+
+/*-----------------------------------------------------------------------------
+* fpattern_compchar()
+*	Sets state 'n' to pass the chars matching pattern char 'pch'.
+*/
+
+static void fpattern_compchar(fpattern_comp *fp, int n, int pch)
+{
+    int		b;
+    int		fch;
+
+    for (b = 1;  b < 256;  b++)
+    {
+        fch = (char) b;
+        if (lowercase(fch) == lowercase(pch))
+            fp->one[b] |= FPAT_BIT(n);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+* fpattern_compset()
+*	Sets state 'n' to pass the chars matching the set starting at 'pat'
+*	(just past the '['), by testing each char as fpattern_submatch() does.
+*
+* Returns
+*	Pointer past the closing bracket, or null if there is none.
+*/
+
+static const char *fpattern_compset(fpattern_comp *fp, int n, const char *pat)
+{
+    const char *	p = pat;
+    int			b;
+    int			fch;
+    int			yes, match;
+    int			lo, hi;
+
+    for (b = 1;  b < 256;  b++)
+    {
+        fch = (char) b;
+        p = pat;
+        yes = TRUE;
+        if (*p == FPAT_SET_NOT)
+        {
+            p++;
+            yes = FALSE;	/* Set negation */
+        }
+
+        match = !yes;
+        while (*p != FPAT_SET_R  &&  *p != '\0')
+        {
+            if (*p == QUOTE)
+                p++;		/* Quoted char */
+
+            if (*p == '\0')
+                break;
+            lo = *p++;
+            hi = lo;
+
+            if (*p == FPAT_SET_THRU)
+            {
+                /* Range */
+                p++;
+
+                if (*p == QUOTE)
+                    p++;	/* Quoted char */
+
+                if (*p == '\0')
+                    break;
+                hi = *p++;
+            }
+
+            if (*p == '\0')
+                break;
+
+            if (lowercase(fch) >= lowercase(lo)  &&
+                lowercase(fch) <= lowercase(hi))
+                match = yes;
+        }
+
+        if (match)
+            fp->one[b] |= FPAT_BIT(n);
+    }
+
+    return (*p == '\0' ? NULL : p+1);
+}
+
+
+/*-----------------------------------------------------------------------------
+* fpattern_compkey()
+*	Chooses which char of the literal run to search for: the one matching
+*	fewest chars (at most 2, eg 's' and 'S'), and of those the rarest in
+*	English text.
+*/
+
+static void fpattern_compkey(fpattern_comp *fp)
+{
+    static const char	freq[] = "etaoinshrdlcumwfgypbvkjxqz";
+    int			i, b, n, rank;
+    int			best = -1, bestn = 3, bestrank = -1;
+    unsigned char	ch[2];
+    const char *	f;
+
+    for (i = 0;  i < fp->litlen;  i++)
+    {
+        n = 0;
+        ch[0] = ch[1] = '\0';
+        for (b = 1;  b < 256;  b++)
+        {
+            if (fp->one[b] & FPAT_BIT(fp->litpos + i))
+            {
+                if (n < 2)
+                    ch[n] = (unsigned char) b;
+                n++;
+            }
+        }
+        f = (ch[0] < 0x80 ? strchr(freq, tolower(ch[0])) : NULL);
+        rank = (f == NULL ? (int) sizeof(freq) : (int) (f - freq));
+        if (n > 0  &&  (n < bestn  ||  (n == bestn  &&  rank > bestrank)))
+        {
+            best = i;
+            bestn = n;
+            bestrank = rank;
+            fp->keych[0] = ch[0];
+            fp->keych[1] = ch[1];
+        }
+    }
+
+    if (best < 0)
+    {
+        fp->litlen = 0;		/* No prefilter */
+        return;
+    }
+    fp->litkey = best;
+    fp->nkeych = bestn;
+}
+
+
+/*-----------------------------------------------------------------------------
+* fpattern_compile()
+*	Compiles pattern 'pat' for repeated matching by fpattern_matchc().
+*
+* Returns
+*	Compiled pattern, to be freed by fpattern_free(), or null if 'pat' is
+*	null or not a well-formed pattern.
+*/
+
+fpattern_comp *fpattern_compile(const char *pat)
+{
+    fpattern_comp *	fp;
+    const char *	p;
+    int			n, b;
+    int			lit;
+    int			runpos = 0, runlen = 0;
+
+    if (!fpattern_isvalid(pat))
+        return (NULL);
+
+    fp = (fpattern_comp *) calloc(1, sizeof(*fp));
+    fp->pat = (char *) malloc(strlen(pat)+1);
+    strcpy(fp->pat, pat);
+
+    /* Leading exclusions just invert the result */
+    p = pat;
+    while (p[0] == FPAT_NOT  &&  p[1] != '\0')
+    {
+        fp->negate = !fp->negate;
+        p++;
+    }
+
+    for (n = 0;  *p != '\0';  n++)
+    {
+        if (n+1 >= FPAT_BITS  ||  *p == FPAT_NOT  ||
+            (*p == QUOTE  &&  p[1] == '\0'))
+            break;
+
+        lit = FALSE;
+        switch (*p)
+        {
+        case FPAT_ANY:
+            for (b = 1;  b < 256;  b++)
+                fp->one[b] |= FPAT_BIT(n);
+            p++;
+            break;
+
+        case FPAT_CLOS:
+        case SUB:
+            for (b = 1;  b < 256;  b++)
+            {
+                if (*p == FPAT_CLOS  ||  b != '.')
+                    fp->loop[b] |= FPAT_BIT(n);
+            }
+            fp->clos |= FPAT_BIT(n);
+            p++;
+            break;
+
+        case QUOTE:
+            p++;
+            fpattern_compchar(fp, n, *p++);
+            lit = TRUE;
+            break;
+
+        case FPAT_SET_L:
+            p = fpattern_compset(fp, n, p+1);
+            break;
+
+        default:
+            fpattern_compchar(fp, n, *p++);
+            lit = TRUE;
+            break;
+        }
+
+        if (p == NULL)
+            break;
+
+        /* Track longest literal run not at start */
+        if (!lit  ||  n == 0)
+            runlen = 0;
+        else
+        {
+            if (runlen == 0)
+                runpos = n;
+            runlen++;
+            if (runlen > fp->litlen)
+            {
+                fp->litpos = runpos;
+                fp->litlen = runlen;
+            }
+        }
+    }
+
+    if (p == NULL  ||  *p != '\0')
+    {
+        /* Cannot compile, so interpret */
+        fp->interp = TRUE;
+        fp->litlen = 0;
+        return (fp);
+    }
+
+    fp->accept = FPAT_BIT(n);
+    if (fp->litlen > 0)
+        fpattern_compkey(fp);
+    return (fp);
+}
+
+
+/*-----------------------------------------------------------------------------
+* fpattern_free()
+*	Frees pattern compiled by fpattern_compile().
+*/
+
+void fpattern_free(fpattern_comp *fp)
+{
+    if (fp == NULL)
+        return;
+    free(fp->pat);
+    free(fp);
+}
+
+
+/*-----------------------------------------------------------------------------
+* fpattern_findlit()
+*	Checks that string 'fname' holds the literal run of a compiled pattern.
+*/
+
+static int fpattern_findlit(const fpattern_comp *fp, const char *fname)
+{
+    size_t			len = strlen(fname);
+    const char *		end = fname + len;
+    const char *		pa;
+    const char *		pb;
+    const char *		p;
+    const unsigned char *	q;
+    int				i;
+
+    pa = memchr(fname, fp->keych[0], len);
+    pb = (fp->nkeych > 1 ? memchr(fname, fp->keych[1], len) : NULL);
+    while (pa != NULL  ||  pb != NULL)
+    {
+        p = (pb == NULL  ||  (pa != NULL  &&  pa < pb)) ? pa : pb;
+        if (p - fname >= fp->litkey  &&
+            end - p >= fp->litlen - fp->litkey)
+        {
+            q = (const unsigned char *) p - fp->litkey;
+            for (i = 0;  i < fp->litlen;  i++)
+            {
+                if (!(fp->one[q[i]] & FPAT_BIT(fp->litpos + i)))
+                    break;
+            }
+            if (i == fp->litlen)
+                return (TRUE);
+        }
+        if (p == pa)
+            pa = memchr(pa+1, fp->keych[0], end - (pa+1));
+        else
+            pb = memchr(pb+1, fp->keych[1], end - (pb+1));
+    }
+    return (FALSE);
+}
+
+
+/*-----------------------------------------------------------------------------
+* fpattern_matchc()
+*	Attempts to match compiled pattern 'fp' to filename 'fname'.
+*	This gives the same result as fpattern_matchn() with the pattern,
+*	except that a negated set never matches the end of the filename
+*	(fpattern_submatch() would go on to read past it).
+*
+* Returns
+*	1 (true) if the filename matches, otherwise 0 (false).
+*
+* Caveats
+*	If 'fname' or 'fp' is null, zero (false) is returned.
+*
+*	Upper and lower case are folded according to the locale setting at the
+*	time the pattern was compiled.
+*/
+
+int fpattern_matchc(const fpattern_comp *fp, const char *fname)
+{
+    const unsigned char *	s;
+    unsigned long		d, x;
+
+    /* Check args */
+    if (fname == NULL  ||  fp == NULL)
+        return (FALSE);
+
+    if (fp->interp)
+        return (fpattern_submatch(fp->pat, fname));
+
+    if (fp->litlen > 0  &&  !fpattern_findlit(fp, fname))
+        return (fp->negate);
+
+    /* Follow all states at once; closures also pass to next state */
+    d = FPAT_BIT(0);
+    while ((x = ((d & fp->clos) << 1) & ~d) != 0)
+        d |= x;
+    for (s = (const unsigned char *) fname;  *s != '\0';  s++)
+    {
+        d = ((d & fp->one[*s]) << 1) | (d & fp->loop[*s]);
+        if (d == 0)
+            return (fp->negate);
+        while ((x = ((d & fp->clos) << 1) & ~d) != 0)
+            d |= x;
+    }
+
+    return (((d & fp->accept) != 0) != fp->negate);
+}
+
+
 /*---------------------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -36,6 +36,8 @@
  *********************************************/
 
 #define MAXHASH_DEF 512
+/* chains are doubled when average chain length would exceed this */
+#define MAXLOAD 2
 
 /*********************************************
  * local types
@@ -56,6 +58,7 @@ struct tag_hashtab {
 	HASHENT *entries;
 	INT count; /* #entries */
 	INT maxhash;
+	INT niters; /* #live iterators (table may not grow while iterated) */
 };
 /* typedef struct tag_hashtab *HASHTAB */ /* in hashtab.h */
 
@@ -73,6 +76,7 @@ struct tag_hashtab_iter {
 
 static HASHENT create_entry(CNSTRING key, HVALUE val);
 static HASHENT fndentry(HASHTAB tab, CNSTRING key);
+static void grow_hashtab(HASHTAB tab);
 static INT hash(HASHTAB tab, CNSTRING key);
 
 /*********************************************
@@ -152,6 +156,9 @@ insert_hashtab (HASHTAB tab, CNSTRING key, HVALUE val)
 	ASSERT(tab);
 	ASSERT(tab->magic == hashtab_magic);
 
+	if (tab->count >= MAXLOAD * tab->maxhash && !tab->niters)
+		grow_hashtab(tab);
+
 	/* find appropriate has chain */
 	hval = hash(tab, key);
 	if (!tab->entries[hval]) {
@@ -262,20 +269,47 @@ fndentry (HASHTAB tab, CNSTRING key)
 	}
 	return NULL;
 }
+/*================================
+ * grow_hashtab -- Double number of hash chains
+ *  and rehash all entries into new chains
+ *==============================*/
+static void
+grow_hashtab (HASHTAB tab)
+{
+	HASHENT *oldentries = tab->entries;
+	INT oldmax = tab->maxhash;
+	INT i=0;
+	tab->maxhash = 2 * oldmax;
+	tab->entries = (HASHENT *)stdalloc(tab->maxhash * sizeof(HASHENT));
+	for (i=0; i<oldmax; ++i) {
+		HASHENT entry = oldentries[i];
+		while (entry) {
+			HASHENT next = entry->enext;
+			INT hval = hash(tab, entry->ekey);
+			entry->enext = tab->entries[hval];
+			tab->entries[hval] = entry;
+			entry = next;
+		}
+	}
+	stdfree(oldentries);
+}
 /*======================
  * hash -- Hash function
+ *  (multiplicative, so keys differing only in the order
+ *  of their characters land on different chains)
  *====================*/
 static INT
 hash (HASHTAB tab, CNSTRING key)
 {
 	const unsigned char *ckey = (const unsigned char *)key;
-	INT hval = 0;
+	unsigned int hval = 0;
+	INT rtn;
 	while (*ckey)
-		hval += *ckey++;
-	hval %= tab->maxhash;
-	ASSERT(hval>=0);
-	ASSERT(hval < tab->maxhash);
-	return hval;
+		hval = hval * 31 + *ckey++;
+	rtn = (INT)(hval % (unsigned int)tab->maxhash);
+	ASSERT(rtn>=0);
+	ASSERT(rtn < tab->maxhash);
+	return rtn;
 }
 /*================================
  * create_entry -- Create and return new hash entry
@@ -302,6 +336,7 @@ begin_hashtab (HASHTAB tab)
 	tabit = (HASHTAB_ITER)stdalloc(sizeof(*tabit));
 	tabit->magic = hashtab_iter_magic;
 	tabit->hashtab = tab;
+	++tab->niters;
 	/* table iterator starts at index=0, enext=0 */
 	/* stdalloc gave us all zero memory */
 	return tabit;
@@ -359,6 +394,8 @@ end_hashtab (HASHTAB_ITER * ptabit)
 	ASSERT(tabit);
 	ASSERT(tabit->magic == hashtab_iter_magic);
 
+	if (tabit->hashtab)
+		--tabit->hashtab->niters;
 	memset(tabit, 0, sizeof(*tabit));
 	stdfree(tabit);
 	*ptabit = 0;
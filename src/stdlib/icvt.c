@@ -26,6 +26,30 @@
 #include "zstr.h"
 #include "icvt.h"
 
+/*********************************************
+ * local types
+ *********************************************/
+
+/* reusable iconv conversion */
+struct tag_icvt {
+#ifdef HAVE_ICONV
+	iconv_t ict;
+#endif
+	STRING src;
+	STRING dest;
+	int chwidth;   /* width of output characters */
+	double expand; /* expected growth of output over input */
+	int asciiok;   /* leaves ASCII unchanged ? (-1 until checked) */
+};
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+#ifdef HAVE_ICONV
+static BOOLEAN out_of_room(int err, size_t outleft);
+#endif
+
 
 /*===================================================
  * iconv_can_trans -- Can iconv do this translation ?
@@ -54,33 +78,133 @@ iconv_can_trans (CNSTRING src, CNSTRING dest)
  *  sin:     [IN]  source string to be converted
  *  zout:    [I/O] converted result
  *  illegal: [IN]  character to use as placeholder for unconvertible input
+ * Opens a conversion just for this string; callers converting many
+ * strings should hold an ICVT from icvt_open instead
  *=================================================*/
 BOOLEAN
 iconv_trans (CNSTRING src, CNSTRING dest, CNSTRING sin, ZSTR zout, char illegal)
+{
+	ICVT icvt = icvt_open(src, dest);
+	BOOLEAN rtn;
+
+	if (!icvt)
+		return FALSE;
+	rtn = icvt_trans(icvt, sin, zout, illegal);
+	icvt_close(&icvt);
+	return rtn;
+}
+/*===================================================
+ * icvt_open -- Open a reusable iconv conversion
+ *  src:     [IN]  source codeset
+ *  dest:    [IN]  destination codeset
+ *  returns NULL if iconv cannot do this conversion
+ *=================================================*/
+ICVT
+icvt_open (CNSTRING src, CNSTRING dest)
 {
 #ifdef HAVE_ICONV
+	ICVT icvt;
 	iconv_t ict;
-	const char * inptr;
-	char * outptr;
-	size_t inleft;
-	size_t outleft;
-	size_t cvted;
 #ifdef ICONV_SET_TRANSLITERATE
 	int transliterate=2; 
 #endif
-	double expand=1.3;
-	int chwidth=1;
-	int badchars=0; /* count # illegal placeholders inserted */
-	int inlen = sin ? strlen(sin) : 0;
 
 	ASSERT(src);
 	ASSERT(dest);
 
 	ict = iconv_open(dest, src);
-
 	if (ict == (iconv_t)-1) {
-		return FALSE;
+		return NULL;
+	}
+	/* testing recursive transliteration in my private iconv, Perry, 2002.07.11 */
+#ifdef ICONV_SET_TRANSLITERATE
+	iconvctl(ict, ICONV_SET_TRANSLITERATE, &transliterate);
+#endif
+	icvt = (ICVT)stdalloc(sizeof(*icvt));
+	memset(icvt, 0, sizeof(*icvt));
+	icvt->ict = ict;
+	icvt->src = strsave(src);
+	icvt->dest = strsave(dest);
+	icvt->expand = 1.3;
+	icvt->chwidth = 1;
+	icvt->asciiok = -1;
+	if (!strncmp(dest, "UCS-2", strlen("UCS-2"))) {
+		icvt->chwidth = 2;
+	}
+	if (!strncmp(dest, "UCS-4", strlen("UCS-4"))) {
+		icvt->chwidth = 4;
 	}
+	if (eqstr(dest, "wchar_t")) {
+		icvt->chwidth = sizeof(wchar_t);
+	}
+	/* TODO: What about UTF-16 or UTF-32 ? */
+	if (icvt->chwidth > 1)
+		icvt->expand = icvt->chwidth;
+	return icvt;
+#else
+	src=src; /* unused */
+	dest=dest; /* unused */
+	return NULL;
+#endif
+}
+/*===================================================
+ * icvt_close -- Release conversion from icvt_open
+ *=================================================*/
+void
+icvt_close (ICVT * picvt)
+{
+	ICVT icvt = *picvt;
+	if (!icvt) return;
+#ifdef HAVE_ICONV
+	iconv_close(icvt->ict);
+#endif
+	strfree(&icvt->src);
+	strfree(&icvt->dest);
+	stdfree(icvt);
+	*picvt = 0;
+}
+/*===================================================
+ * icvt_is_ascii_transparent -- Does this conversion leave
+ *  7-bit ASCII text unchanged ?
+ * Checked (once) by converting all ASCII characters
+ *=================================================*/
+BOOLEAN
+icvt_is_ascii_transparent (ICVT icvt)
+{
+	char probe[128], out[256];
+	INT i;
+
+	if (icvt->asciiok < 0) {
+		for (i = 1; i < 128; ++i)
+			probe[i-1] = (char)i;
+		icvt->asciiok = (icvt_trans_buffer(icvt, probe, 127, out, sizeof(out), '?') == 127
+			&& !memcmp(probe, out, 127));
+	}
+	return icvt->asciiok > 0;
+}
+/*===================================================
+ * icvt_trans -- Translate string via open iconv conversion
+ *  icvt:    [IN]  conversion from icvt_open
+ *  sin:     [IN]  source string to be converted
+ *  zout:    [I/O] converted result
+ *  illegal: [IN]  character to use as placeholder for unconvertible input
+ *=================================================*/
+BOOLEAN
+icvt_trans (ICVT icvt, CNSTRING sin, ZSTR zout, char illegal)
+{
+#ifdef HAVE_ICONV
+	const char * inptr;
+	char * outptr;
+	size_t inleft;
+	size_t outleft;
+	size_t cvted;
+	int err;
+	CNSTRING src = icvt->src;
+	double expand = icvt->expand;
+	int chwidth = icvt->chwidth;
+	int badchars=0; /* count # illegal placeholders inserted */
+	int inlen = sin ? strlen(sin) : 0;
+
 	if (!strncmp(src, "UCS-2", strlen("UCS-2"))) {
 		/* assume MS-Windows makenarrow call */
 		inlen = 2 * wcslen((const wchar_t *)sin);
@@ -89,17 +213,6 @@ iconv_trans (CNSTRING src, CNSTRING dest, CNSTRING sin, ZSTR zout, char illegal)
 		/* assume UNIX makenarrow call */
 		inlen = 4 * wcslen((const wchar_t *)sin);
 	}
-	if (!strncmp(dest, "UCS-2", strlen("UCS-2"))) {
-		chwidth = expand = 2;
-	}
-	if (!strncmp(dest, "UCS-4", strlen("UCS-4"))) {
-		chwidth = expand = 4;
-	}
-	if (eqstr(dest, "wchar_t")) {
-		chwidth = expand = sizeof(wchar_t);
-
-	}
-	/* TODO: What about UTF-16 or UTF-32 ? */
 
 	zs_reserve(zout, (unsigned int)(inlen*expand+6));
 
@@ -108,11 +221,8 @@ iconv_trans (CNSTRING src, CNSTRING dest, CNSTRING sin, ZSTR zout, char illegal)
 		goto icvt_terminate_and_exit;
 	}
 
-	/* testing recursive transliteration in my private iconv, Perry, 2002.07.11 */
-#ifdef ICONV_SET_TRANSLITERATE
-	iconvctl(ict, ICONV_SET_TRANSLITERATE, &transliterate);
-#endif
-
+	/* return to initial shift state, in case a previous use left it */
+	iconv(icvt->ict, NULL, NULL, NULL, NULL);
 
 	inptr = sin;
 	outptr = zs_str(zout);
@@ -123,8 +233,8 @@ iconv_trans (CNSTRING src, CNSTRING dest, CNSTRING sin, ZSTR zout, char illegal)
 
 cvting:
 	/* main convert */
-	cvted = iconv (ict, &inptr, &inleft, &outptr, &outleft);
-
+	cvted = iconv (icvt->ict, &inptr, &inleft, &outptr, &outleft);
+	err = errno;
 	/* zero terminate & fix output zstring */
 	/* there may be embedded nulls, if UCS-2/4 is target! */
 	*outptr=0;
@@ -132,10 +242,8 @@ cvting:
 
 	/* handle error cases */
 	if (cvted == (size_t)-1) {
-		/* errno is not reliable, because on MS-Windows we called
-		iconv in a dll & didn't get errno */
-		if (outleft<3) {
-			/* may be out of space, so grow & retry */
+		if (out_of_room(err, outleft)) {
+			/* grow & retry, until iconv has room for all of it */
 			zs_reserve(zout, (unsigned int)(inleft * expand + 6 + zs_allocsize(zout)));
 		} else {
 			/* unconvertible input character */
@@ -188,17 +296,93 @@ icvt_terminate_and_exit:
 	*outptr=0;
 	zs_set_len(zout, outptr-zs_str(zout));
 
-	iconv_close(ict);
 	return TRUE;
 #else
-	src=src; /* unused */
-	dest=dest; /* unused */
+	icvt=icvt; /* unused */
 	sin=sin; /* unused */
 	zout=zout; /* unused */
 	illegal=illegal; /* unused */
 	return FALSE;
 #endif /* HAVE_ICONV */
 }
+/*===================================================
+ * icvt_trans_buffer -- Translate buffer via open iconv conversion
+ *  into caller's buffer, without allocating
+ *  icvt:    [IN]  conversion from icvt_open
+ *  in:      [IN]  source text
+ *  inlen:   [IN]  length of source text
+ *  out:     [OUT] converted result (zero-terminated)
+ *  outcap:  [IN]  size of out
+ *  illegal: [IN]  character to use as placeholder for unconvertible input
+ *  returns length of result, or -1 if it does not fit in out
+ *   (always -1 for wide character destinations)
+ *=================================================*/
+INT
+icvt_trans_buffer (ICVT icvt, CNSTRING in, INT inlen, STRING out, INT outcap, char illegal)
+{
+#ifdef HAVE_ICONV
+	const char * inptr = in;
+	char * outptr = out;
+	size_t inleft = inlen;
+	size_t outleft;
+	BOOLEAN utf8src = eqstr(icvt->src, "UTF-8");
+
+	if (icvt->chwidth > 1 || outcap < 1)
+		return -1;
+	outleft = outcap - 1;
+	iconv(icvt->ict, NULL, NULL, NULL, NULL);
+	while (inleft) {
+		if (iconv(icvt->ict, &inptr, &inleft, &outptr, &outleft) != (size_t)-1)
+			break;
+		if (out_of_room(errno, outleft)) {
+			/* caller must use a bigger buffer */
+			return -1;
+		} else {
+			/* unconvertible input character */
+			/* append placeholder & skip over */
+			size_t wid = utf8src ? utf8len(*inptr) : 1;
+			if (wid > inleft)
+				wid = inleft;
+			inptr += wid;
+			inleft -= wid;
+			*outptr++ = illegal;
+			--outleft;
+		}
+	}
+	*outptr = 0;
+	return outptr - out;
+#else
+	icvt=icvt; /* unused */
+	in=in; /* unused */
+	inlen=inlen; /* unused */
+	out=out; /* unused */
+	outcap=outcap; /* unused */
+	illegal=illegal; /* unused */
+	return -1;
+#endif /* HAVE_ICONV */
+}
+#ifdef HAVE_ICONV
+/*===================================================
+ * out_of_room -- Did iconv stop for lack of output space
+ *  (rather than at an unconvertible input character) ?
+ *  err:     [IN]  errno after the failed iconv call
+ *  outleft: [IN]  output space iconv left unused
+ *=================================================*/
+static BOOLEAN
+out_of_room (int err, size_t outleft)
+{
+#ifdef WIN32_ICONV_SHIM
+	/* errno is not reliable, because we called iconv in a dll &
+	didn't get errno, so guess from the space left; no character
+	takes 8 bytes, and a wrong guess only costs a retry */
+	err=err; /* unused */
+	return outleft < 8;
+#else
+	outleft=outleft; /* unused */
+	return err == E2BIG;
+#endif
+}
+#endif /* HAVE_ICONV */
 /*===================================================
  * init_win32_iconv_shim -- Helper for loading iconv.dll on win32
  *=================================================*/
@@ -10,6 +10,9 @@
 
 #include <time.h>
 #include "llstdlib.h"
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
 
 /*===============================
  * get_current_lldate -- fill in ISO style string for current time
@@ -25,3 +28,19 @@ get_current_lldate (LLDATE * creation)
 		pt->tm_year+1900, pt->tm_mon+1, pt->tm_mday,
 		pt->tm_hour, pt->tm_min, pt->tm_sec);
 }
+/*===============================
+ * get_usec_clock -- return a microsecond clock reading
+ *  only differences between readings are meaningful
+ *  (falls back to processor time where gettimeofday is missing)
+ *=============================*/
+INT64
+get_usec_clock (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (INT64)tv.tv_sec * 1000000 + tv.tv_usec;
+#else
+	return (INT64)clock() * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
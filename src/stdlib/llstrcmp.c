@@ -34,7 +34,9 @@ extern int opt_finnish;
 static usersortfnc usersort = 0;
 
 
+static void append_unit(ZSTR zkey, unsigned long unit, INT width);
 static BOOLEAN widecmp(CNSTRING str1, CNSTRING str2, INT *rtn);
+static BOOLEAN widexfrm(CNSTRING str, ZSTR zkey);
 
 /*===================================================
  * ll_strcmp -- Compare two strings
@@ -88,6 +90,57 @@ ll_strcmploc (const char *str1, const char *str2)
 	return(strcmp(str1, str2));
 #endif
 }
+/*===================================================
+ * ll_strxfrmloc -- Append collation key of string to zkey
+ *  str:  [IN]  string to transform
+ *  zkey: [I/O] binary key to append to
+ * Keys compare by memcmp in the order that ll_strcmploc gives
+ * their strings. Each key ends in a zero unit that sorts below
+ * anything else, so keys appended one after another compare
+ * field by field.
+ * returns FALSE if the collation in use has no such transform
+ * (Finnish build, or user-defined collation)
+ *=================================================*/
+BOOLEAN
+ll_strxfrmloc (CNSTRING str, ZSTR zkey)
+{
+	INT rtn;
+
+	if (opt_finnish) return FALSE;
+	if (usersort && (*usersort)("a", "b", &rtn)) return FALSE;
+
+	if (widexfrm(str, zkey))
+		return TRUE;
+
+#ifdef HAVE_STRCOLL
+	{
+		size_t len = strxfrm(NULL, str, 0);
+		unsigned int start = zs_len(zkey);
+		zs_reserve(zkey, start + len + 2);
+		strxfrm(zs_str(zkey) + start, str, len + 1);
+		zs_set_len(zkey, start + len);
+	}
+#else
+	zs_appsn(zkey, str, strlen(str));
+#endif
+	append_unit(zkey, 0, 1);
+	return TRUE;
+}
+/*===================================================
+ * append_unit -- Append number to key as width bytes,
+ *  most significant first (so keys compare by memcmp)
+ *=================================================*/
+static void
+append_unit (ZSTR zkey, unsigned long unit, INT width)
+{
+	char buf[8];
+	INT i;
+	for (i = width-1; i >= 0; --i) {
+		buf[i] = (char)(unit & 0xFF);
+		unit >>= 8;
+	}
+	zs_appsn(zkey, buf, width);
+}
 /*===================================================
  * ll_what_collation -- get string describing collation in use
  *=================================================*/
@@ -168,3 +221,31 @@ widecmp (CNSTRING str1, CNSTRING str2, INT *rtn)
 	zs_free(&zws2);
 	return success;
 }
+/*===================================================
+ * widexfrm -- Append wide collation key of string, if available
+ *  (the key version of widecmp)
+ *=================================================*/
+static BOOLEAN
+widexfrm (CNSTRING str, ZSTR zkey)
+{
+	BOOLEAN success = FALSE;
+#ifdef HAVE_WCSCOLL
+	ZSTR zws = makewide(str);
+	if (zws) {
+		const wchar_t * wfs = (const wchar_t *)zs_str(zws);
+		size_t i, len = wcsxfrm(NULL, wfs, 0);
+		wchar_t * wxf = (wchar_t *)stdalloc((len+1)*sizeof(wchar_t));
+		wcsxfrm(wxf, wfs, len+1);
+		for (i = 0; i < len; ++i)
+			append_unit(zkey, (unsigned long)wxf[i], sizeof(wchar_t));
+		append_unit(zkey, 0, sizeof(wchar_t));
+		stdfree(wxf);
+		zs_free(&zws);
+		success = TRUE;
+	}
+#else
+	str=str; /* unused */
+	zkey=zkey; /* unused */
+#endif /* HAVE_WCSCOLL */
+	return success;
+}
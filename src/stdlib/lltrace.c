@@ -0,0 +1,288 @@
+/*=============================================================
+ * lltrace.c -- Ring buffer of trace events (see lltrace.h)
+ *  Events are stored in a fixed array that wraps around, so a
+ *  long run keeps its most recent TraceEvents events, and
+ *  recording one is a clock read and a few stores.
+ *  The interpreter, caches and btree are single threaded (the
+ *  parallel report loops fork processes), so each process has
+ *  one buffer, written only by itself, and needs no locking.
+ *  Events of forked children are not written out.
+ *===========================================================*/
+
+#include <time.h>
+#include <signal.h>
+#include "llstdlib.h"
+#include "lltrace.h"
+
+/*********************************************
+ * local types
+ *********************************************/
+
+#define TRACE_ARGLEN 24
+#define TRACE_DEFEVENTS 131072
+
+typedef struct tag_trace_event {
+	TRACE_TIME start;  /* clock reading at start */
+	TRACE_TIME dur;    /* nanoseconds, or -1 if instant */
+	CNSTRING cat;      /* category (eg, "btree") */
+	CNSTRING name;     /* function traced */
+	char arg[TRACE_ARGLEN]; /* eg, key of record (truncated) */
+} TRACE_EVENT;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static TRACE_EVENT * next_event(void);
+#ifdef SIGUSR1
+static void on_dump_signal(int sig);
+#endif
+static void stop_tracing(void);
+static void trace_atexit(void);
+static void write_json_str(FILE * fp, CNSTRING str);
+
+/*********************************************
+ * global/exported variables
+ *********************************************/
+
+BOOLEAN lltrace_on = FALSE;
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+static TRACE_EVENT * ring = 0;
+static INT ringsize = 0;
+static INT ringpos = 0;      /* where next event goes */
+static INT64 nrecorded = 0;  /* events since buffer was (re)made */
+static STRING tracefile = 0;
+static TRACE_TIME basetime = 0; /* timestamps are relative to this */
+static BOOLEAN atexit_set = FALSE;
+static volatile sig_atomic_t dump_requested = 0;
+#ifdef SIGUSR1
+static void (*oldhandler)(int) = SIG_DFL;
+#endif
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*==================================
+ * lltrace_configure -- Start, retarget or stop tracing
+ *  file:    [IN]  file to write trace to (NULL or empty stops)
+ *  nevents: [IN]  size of buffer (0 for default)
+ * Stopping writes out what was traced. Called whenever
+ * options change, so setting the same file again is no change.
+ *================================*/
+void
+lltrace_configure (CNSTRING file, INT nevents)
+{
+#ifdef LLTRACE
+	if (!file || !file[0]) {
+		if (lltrace_on) {
+			lltrace_dump(tracefile);
+			stop_tracing();
+		}
+		return;
+	}
+	if (nevents <= 0)
+		nevents = TRACE_DEFEVENTS;
+	if (nevents != ringsize) {
+		stdfree(ring);
+		ring = (TRACE_EVENT *)stdalloc(nevents * sizeof(ring[0]));
+		ringsize = nevents;
+		ringpos = 0;
+		nrecorded = 0;
+	}
+	strupdate(&tracefile, file);
+	if (lltrace_on)
+		return;
+	if (!basetime)
+		basetime = lltrace_now();
+	if (!atexit_set) {
+		atexit(trace_atexit);
+		atexit_set = TRUE;
+	}
+#ifdef SIGUSR1
+	oldhandler = signal(SIGUSR1, on_dump_signal);
+#endif
+	lltrace_on = TRUE;
+#else
+	file=file; /* unused */
+	nevents=nevents; /* unused */
+#endif
+}
+/*==================================
+ * stop_tracing -- Stop recording (buffer is kept)
+ *================================*/
+static void
+stop_tracing (void)
+{
+	lltrace_on = FALSE;
+#ifdef SIGUSR1
+	signal(SIGUSR1, oldhandler);
+#endif
+}
+/*==================================
+ * lltrace_now -- Clock reading for trace, in nanoseconds
+ *================================*/
+TRACE_TIME
+lltrace_now (void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (TRACE_TIME)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+	return get_usec_clock() * 1000;
+#endif
+}
+/*==================================
+ * next_event -- Take next slot of ring buffer
+ *  (overwriting oldest event once buffer is full)
+ *================================*/
+static TRACE_EVENT *
+next_event (void)
+{
+	TRACE_EVENT * ev;
+	if (dump_requested) {
+		dump_requested = 0;
+		lltrace_dump(tracefile);
+	}
+	ev = &ring[ringpos];
+	if (++ringpos == ringsize)
+		ringpos = 0;
+	++nrecorded;
+	return ev;
+}
+/*==================================
+ * lltrace_complete -- Record call that has just finished
+ *  start: [IN]  clock reading when call began (from TRACE_BEGIN)
+ *  cat:   [IN]  category (constant string)
+ *  name:  [IN]  name of call (constant string)
+ *  arg:   [IN]  detail to show with event (may be NULL)
+ *================================*/
+void
+lltrace_complete (TRACE_TIME start, CNSTRING cat, CNSTRING name, CNSTRING arg)
+{
+	TRACE_TIME now = lltrace_now();
+	TRACE_EVENT * ev;
+	if (!lltrace_on)
+		return;
+	ev = next_event();
+	ev->start = start;
+	ev->dur = now - start;
+	ev->cat = cat;
+	ev->name = name;
+	llstrncpy(ev->arg, arg ? arg : "", sizeof(ev->arg), 0);
+}
+/*==================================
+ * lltrace_instant -- Record event without duration
+ *  (eg, record evicted from cache)
+ *================================*/
+void
+lltrace_instant (CNSTRING cat, CNSTRING name, CNSTRING arg)
+{
+	TRACE_EVENT * ev;
+	if (!lltrace_on)
+		return;
+	ev = next_event();
+	ev->start = lltrace_now();
+	ev->dur = -1;
+	ev->cat = cat;
+	ev->name = name;
+	llstrncpy(ev->arg, arg ? arg : "", sizeof(ev->arg), 0);
+}
+/*==================================
+ * lltrace_dump -- Write buffered events as Chrome trace JSON
+ *  file: [IN]  file to (over)write
+ * Events are written oldest first; tracing continues.
+ * returns FALSE if file could not be written
+ *================================*/
+BOOLEAN
+lltrace_dump (CNSTRING file)
+{
+	FILE * fp;
+	INT i, n, pos;
+	long pid = 1;
+
+	if (!file || !file[0] || !ring)
+		return FALSE;
+	if (!(fp = fopen(file, LLWRITETEXT)))
+		return FALSE;
+#ifndef WIN32
+	pid = (long)getpid();
+#endif
+	n = (nrecorded < ringsize) ? (INT)nrecorded : ringsize;
+	pos = (nrecorded < ringsize) ? 0 : ringpos;
+	fprintf(fp, "{\"displayTimeUnit\":\"ns\",\n");
+	fprintf(fp, "\"otherData\":{\"events\":%.0f,\"dropped\":%.0f},\n"
+		, (double)nrecorded, (double)(nrecorded - n));
+	fprintf(fp, "\"traceEvents\":[\n");
+	for (i = 0; i < n; ++i) {
+		TRACE_EVENT * ev = &ring[pos];
+		if (++pos == ringsize)
+			pos = 0;
+		fprintf(fp, "{\"name\":\"%s\",\"cat\":\"%s\"", ev->name, ev->cat);
+		if (ev->dur < 0) {
+			fprintf(fp, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f"
+				, (ev->start - basetime) / 1000.0);
+		} else {
+			fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f"
+				, (ev->start - basetime) / 1000.0, ev->dur / 1000.0);
+		}
+		fprintf(fp, ",\"pid\":%ld,\"tid\":%ld", pid, pid);
+		if (ev->arg[0]) {
+			fprintf(fp, ",\"args\":{\"arg\":");
+			write_json_str(fp, ev->arg);
+			fprintf(fp, "}");
+		}
+		fprintf(fp, "}%s\n", (i+1 < n) ? "," : "");
+	}
+	fprintf(fp, "]}\n");
+	return fclose(fp) == 0;
+}
+/*==================================
+ * write_json_str -- Write string as JSON string literal
+ *================================*/
+static void
+write_json_str (FILE * fp, CNSTRING str)
+{
+	fputc('"', fp);
+	for ( ; *str; ++str) {
+		uchar c = (uchar)*str;
+		if (c == '"' || c == '\\')
+			fprintf(fp, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(fp, "\\u%04x", c);
+		else
+			fputc(c, fp);
+	}
+	fputc('"', fp);
+}
+/*==================================
+ * trace_atexit -- Write out trace when program ends
+ *================================*/
+static void
+trace_atexit (void)
+{
+	if (!lltrace_on)
+		return;
+	stop_tracing();
+	if (!lltrace_dump(tracefile))
+		fprintf(stderr, _("Failed to write trace file %s\n"), tracefile);
+}
+#ifdef SIGUSR1
+/*==================================
+ * on_dump_signal -- Ask for trace to be written out
+ *  (done at next traced call, not in handler)
+ *================================*/
+static void
+on_dump_signal (int sig)
+{
+	sig=sig; /* unused */
+	dump_requested = 1;
+}
+#endif
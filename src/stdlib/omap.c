@@ -0,0 +1,237 @@
+/*=============================================================
+ * omap.c -- Ordered map container object
+ *  Maps arbitrary keys (ordered by a client compare function)
+ *  to arbitrary values; the map owns both & frees them with
+ *  client supplied destructors
+ *  These maps are reference counted objects
+ *  This uses rbtree for storage
+ *==============================================================*/
+
+#include "llstdlib.h"
+#include "vtable.h"
+#include "omap.h"
+#include "rbtree.h"
+
+/*********************************************
+ * local types
+ *********************************************/
+
+/* ordered map object itself */
+struct tag_omap {
+	struct tag_vtable *vtable; /* generic object */
+	INT refcnt; /* ref-countable object */
+	OMAPDEL delkey;
+	OMAPDEL delval;
+	RBTREE rbtree;
+};
+/* typedef struct tag_omap *OMAP */ /* in omap.h */
+
+/* ordered map iterator */
+struct tag_omap_iter {
+	OMAP omap;
+	RBITER rbit;
+};
+/* typedef struct tag_omap_iter *OMAP_ITER */ /* in omap.h */
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static void destroy_omap(OMAP omap);
+static void omap_destructor(VTABLE *obj);
+static void rbdestroy(void * param, RBKEY key, RBVALUE info);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+static struct tag_vtable vtable_for_omap = {
+	VTABLE_MAGIC
+	, "omap"
+	, &omap_destructor
+	, &refcountable_isref
+	, &refcountable_addref
+	, &refcountable_release
+	, 0 /* copy_fnc */
+	, &generic_get_type_name
+};
+
+/*********************************************
+ * local & exported function definitions
+ * body of module
+ *********************************************/
+
+/*=============================
+ * create_omap -- Create ordered map
+ *  cmp:    [IN]  key comparison function
+ *  delkey: [IN]  key destructor (may be NULL)
+ *  delval: [IN]  value destructor (may be NULL)
+ * returns addref'd map
+ *===========================*/
+OMAP
+create_omap (OMAPCMP cmp, OMAPDEL delkey, OMAPDEL delval)
+{
+	OMAP omap = (OMAP)stdalloc(sizeof(*omap));
+	omap->vtable = &vtable_for_omap;
+	omap->refcnt = 1;
+	omap->delkey = delkey;
+	omap->delval = delval;
+	omap->rbtree = RbTreeCreate(omap, cmp, rbdestroy);
+	return omap;
+}
+/*=================================================
+ * destroy_omap -- Free map, and all its keys & values
+ *===============================================*/
+static void
+destroy_omap (OMAP omap)
+{
+	if (!omap) return;
+	ASSERT(omap->vtable == &vtable_for_omap);
+	RbTreeDestroy(omap->rbtree);
+	memset(omap, 0, sizeof(*omap));
+	stdfree(omap);
+}
+/*=================================================
+ * omap_destructor -- destructor for map
+ *  (destructor entry in vtable)
+ *===============================================*/
+static void
+omap_destructor (VTABLE *obj)
+{
+	destroy_omap((OMAP)obj);
+}
+/*=================================================
+ * addref_omap -- increment reference count of map
+ *===============================================*/
+void
+addref_omap (OMAP omap)
+{
+	ASSERT(omap->vtable == &vtable_for_omap);
+	++omap->refcnt;
+}
+/*=================================================
+ * release_omap -- decrement reference count of map
+ *  and free if appropriate (ref count hits zero)
+ *===============================================*/
+void
+release_omap (OMAP omap)
+{
+	if (!omap) return;
+	ASSERT(omap->vtable == &vtable_for_omap);
+	--omap->refcnt;
+	if (!omap->refcnt) {
+		destroy_omap(omap);
+	}
+}
+/*=================================================
+ * get_omap_count -- Return #elements
+ *===============================================*/
+INT
+get_omap_count (OMAP omap)
+{
+	if (!omap) return 0;
+	ASSERT(omap->vtable == &vtable_for_omap);
+	return RbGetCount(omap->rbtree);
+}
+/*=================================================
+ * find_omap -- Return value stored under key
+ *  set optional present arg to indicate whether key was found
+ *===============================================*/
+void *
+find_omap (OMAP omap, const void * key, BOOLEAN * present)
+{
+	RBNODE node;
+	ASSERT(omap->vtable == &vtable_for_omap);
+	node = RbExactQuery(omap->rbtree, key);
+	if (present)
+		*present = !!node;
+	return node ? RbGetInfo(node) : 0;
+}
+/*=================================================
+ * insert_omap -- Store value under key
+ *  map takes ownership of key & val; if key is already
+ *  present, the new key and the old value are freed
+ *===============================================*/
+void
+insert_omap (OMAP omap, void * key, void * val)
+{
+	RBNODE node;
+	ASSERT(omap->vtable == &vtable_for_omap);
+	node = RbExactQuery(omap->rbtree, key);
+	if (node) {
+		void * old = RbSetInfo(node, val);
+		if (omap->delkey)
+			(*omap->delkey)(key);
+		if (omap->delval)
+			(*omap->delval)(old);
+		return;
+	}
+	RbTreeInsert(omap->rbtree, key, val);
+}
+/*=================================================
+ * remove_omap -- Remove (and free) entry for key
+ *  returns FALSE if key was not present
+ *===============================================*/
+BOOLEAN
+remove_omap (OMAP omap, const void * key)
+{
+	RBNODE node;
+	ASSERT(omap->vtable == &vtable_for_omap);
+	node = RbExactQuery(omap->rbtree, key);
+	if (!node)
+		return FALSE;
+	RbDeleteNode(omap->rbtree, node);
+	return TRUE;
+}
+/*=================================================
+ * rbdestroy -- Destructor for key & value of rbtree
+ *  (for rbtree module, which does not manage key or value memory)
+ *===============================================*/
+static void
+rbdestroy (void * param, RBKEY key, RBVALUE info)
+{
+	OMAP omap = (OMAP)param;
+	if (omap->delkey)
+		(*omap->delkey)((void *)key);
+	if (omap->delval)
+		(*omap->delval)(info);
+}
+/*=================================================
+ * begin_omap -- Begin iteration of map in key order
+ *  low:  [IN]  lowest key wanted (NULL for first)
+ *  high: [IN]  highest key wanted (NULL for last)
+ *  map must not be altered until end_omap is called
+ *===============================================*/
+OMAP_ITER
+begin_omap (OMAP omap, const void * low, const void * high)
+{
+	OMAP_ITER omit = (OMAP_ITER)stdalloc(sizeof(*omit));
+	ASSERT(omap->vtable == &vtable_for_omap);
+	addref_omap(omap);
+	omit->omap = omap;
+	omit->rbit = RbBeginIter(omap->rbtree, low, high);
+	return omit;
+}
+/*=================================================
+ * next_omap -- Advance to next entry of map
+ *  returns FALSE when iteration is finished
+ *===============================================*/
+BOOLEAN
+next_omap (OMAP_ITER omit, const void ** pkey, void ** pval)
+{
+	return RbNext(omit->rbit, pkey, pval) ? TRUE : FALSE;
+}
+/*=================================================
+ * end_omap -- Finish iteration of map
+ *===============================================*/
+void
+end_omap (OMAP_ITER * pomit)
+{
+	OMAP_ITER omit = *pomit;
+	ASSERT(omit);
+	RbEndIter(omit->rbit);
+	release_omap(omit->omap);
+	stdfree(omit);
+	*pomit = 0;
+}
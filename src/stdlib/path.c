@@ -439,6 +439,30 @@ compress_path (CNSTRING path, INT len)
 	}
 	return buf;
 }
+/*========================================================================
+ * check_buffer_for_unicode -- Check for BOM (byte order mark) bytes
+ *  buf:     [IN]  start of file contents
+ *  len:     [IN]  bytes available
+ *  pbomlen: [OUT] length of BOM to skip (only set for UTF-8)
+ *  return values as check_file_for_unicode
+ *======================================================================*/
+STRING
+check_buffer_for_unicode (CNSTRING buf, INT len, INT * pbomlen)
+{
+	const uchar * p = (const uchar *)buf;
+	*pbomlen = 0;
+	if (len >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+		*pbomlen = 3;
+		return "UTF-8";
+	}
+	if (len >= 2 && p[0] == 0xFF && p[1] == 0xFE)
+		return "UTF-16LE or UTF-32LE";
+	if (len >= 2 && p[0] == 0xFE && p[1] == 0xFF)
+		return "UTF-16BE";
+	if (len >= 1 && p[0] == 0)
+		return "Possibly UTF-32BE?";
+	return 0;
+}
 /*========================================================================
  * check_file_for_unicode -- Check for BOM (byte order mark) bytes
  *  return descriptive string if found, or 0 if not
@@ -146,6 +146,21 @@ isasciiletter (INT c)
 {
 	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
+/*=============================
+ * isasciibuf -- Is buffer entirely 7-bit ASCII ?
+ *  buf: [IN]  text to check
+ *  len: [IN]  length of buf
+ *===========================*/
+BOOLEAN
+isasciibuf (CNSTRING buf, INT len)
+{
+	const uchar * p = (const uchar *)buf;
+	const uchar * end = p + len;
+	uchar any = 0;
+	for ( ; p < end; ++p)
+		any |= *p;
+	return !(any & 0x80);
+}
 /*==========================================
  * ll_toupper -- Convert letter to uppercase
  *========================================*/
@@ -39,6 +39,8 @@
 static const char * get_wchar_codeset_name(void);
 static ZSTR (*upperfunc)(CNSTRING) = 0;
 static ZSTR (*lowerfunc)(CNSTRING) = 0;
+static ICVT wideicvt = 0; /* int_codeset to wchar_t, kept for makewide */
+static STRING wideicvt_src = 0; /* int_codeset that wideicvt converts */
 
 /*===================================================
  * get_wchar_codeset_name -- name of wchar_t codeset
@@ -67,11 +69,18 @@ makewide (const char *str)
 {
 	ZSTR zstr=0;
 	if (int_codeset && int_codeset[0]) {
-		CNSTRING dest = get_wchar_codeset_name();
-		zstr = zs_new();
-		/* dest = "wchar_t" doesn't work--Perry, 2002-11-20 */
-		if (!iconv_trans(int_codeset, dest, str, zstr, '?')) {
-			zs_free(&zstr);
+		if (!wideicvt || !eqstr(wideicvt_src, int_codeset)) {
+			CNSTRING dest = get_wchar_codeset_name();
+			/* dest = "wchar_t" doesn't work--Perry, 2002-11-20 */
+			icvt_close(&wideicvt);
+			strupdate(&wideicvt_src, int_codeset);
+			wideicvt = icvt_open(int_codeset, dest);
+		}
+		if (wideicvt) {
+			zstr = zs_new();
+			if (!icvt_trans(wideicvt, str, zstr, '?')) {
+				zs_free(&zstr);
+			}
 		}
 	}
 	return zstr;
@@ -311,6 +311,17 @@ zs_apps (ZSTR zstr, const char * txt)
 	}
 	return zstr->str;
 }
+/* append len bytes of input to zstring */
+char *
+zs_appsn (ZSTR zstr, const char * txt, unsigned int len)
+{
+	DBGCHK(zstr);
+	zs_reserve(zstr, zs_len(zstr)+len+1);
+	memcpy(zstr->end, txt, len);
+	zstr->end += len;
+	*zstr->end = 0;
+	return zstr->str;
+}
 /* append input zstring to zstring */
 char *
 zs_appz(ZSTR zstr, ZCSTR zsrc)
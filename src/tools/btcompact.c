@@ -0,0 +1,469 @@
+/*=================================================================
+ * btcompact.c -- Command that rewrites a BTREE with full blocks,
+ *   dropping deleted records and rebuilding the index levels.
+ *   The copy is made from a read-only opening, so readers may
+ *   continue meanwhile; it is then either left beside the
+ *   original, or swapped into its place.
+ *===============================================================*/
+
+#define _GNU_SOURCE /* for renameat2 */
+#include "llstdlib.h"
+/* llstdlib.h pulls in standard.h, config.h, sys_inc.h */
+#include "btree.h"
+#include "arch.h"
+#include "version.h"
+#ifdef HAVE_RENAMEAT2
+#include <fcntl.h>
+#endif
+
+/*********************************************
+ * required global variables
+ *********************************************/
+/* defined in liflines/main.c */
+STRING readpath_file = NULL;
+STRING readpath = NULL;
+int opt_finnish = 0;
+int opt_mychar = 0;
+/* defined in gedlib/codesets.c */
+BOOLEAN uu8=0;            /* flag if internal codeset is UTF-8 */
+STRING int_codeset=0;     /* internal codeset */
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static BOOLEAN copy_file(CNSTRING from, CNSTRING to);
+static BOOLEAN copy_other_files(CNSTRING olddir, CNSTRING newdir);
+static BOOLEAN exchange_dirs(CNSTRING dir1, CNSTRING dir2);
+static BOOLEAN lock_for_swap(BTREE btree);
+static void print_counts(CNSTRING title, INT records, INT blocks, INT indexes);
+static void print_usage(void);
+static BOOLEAN recover_swap(CNSTRING dbname, CNSTRING olddir);
+static BOOLEAN remove_tree(CNSTRING dir);
+static BOOLEAN set_ostat(CNSTRING dir, INT ostat);
+
+/*********************************************
+ * local function definitions
+ * body of module
+ *********************************************/
+
+/*=========================================
+ * main -- Main procedure of btcompact command
+ *=======================================*/
+int
+main (int argc,
+      char **argv)
+{
+	BTREE btree;
+	BTCOMPACT stats;
+	char newdir[MAXPATHLEN];
+	char olddir[MAXPATHLEN];
+	char *dbname=NULL, *newname=NULL;
+	INT fill=100;
+	BOOLEAN keep=FALSE; /* keep original after swap */
+	INT lldberrnum=0;
+	int i=0;
+
+	/* TODO: needs locale & gettext initialization */
+
+#ifdef WIN32
+	/* TO DO - research if this is necessary */
+	_fmode = O_BINARY;	/* default to binary rather than TEXT mode */
+#endif
+
+	/* handle conventional arguments --version and --help */
+	/* needed for help2man to synthesize manual pages */
+	for (i=1; i<argc; ++i) {
+		if (!strcmp(argv[i], "--version")
+			|| !strcmp(argv[i], "-v")) {
+			print_version("btcompact");
+			return 0;
+		}
+		if (!strcmp(argv[i], "--help")
+			|| !strcmp(argv[i], "-h")
+			|| !strcmp(argv[i], "-?")) {
+			print_usage();
+			return 0;
+		}
+	}
+
+	/* Parse Command-Line Arguments */
+	for (i=1; i<argc; ++i) {
+		if (!strcmp(argv[i], "-f") && i+1<argc) {
+			fill = atoi(argv[++i]);
+			if (fill < 1 || fill > 100) {
+				printf(_("Fill factor must be between 1 and 100."));
+				puts("");
+				return 10;
+			}
+		} else if (!strcmp(argv[i], "-k")) {
+			keep = TRUE;
+		} else if (argv[i][0] == '-') {
+			printf(_("Unknown option: %s"), argv[i]);
+			puts("");
+			return 10;
+		} else if (!dbname) {
+			dbname = argv[i];
+		} else if (!newname) {
+			newname = argv[i];
+		} else {
+			dbname = NULL;
+			break;
+		}
+	}
+	if (!dbname) {
+		printf(_("btcompact requires a btree, and optionally a new btree."));
+		puts("");
+		printf(_("See `btcompact --help' for more information."));
+		puts("");
+		return 10;
+	}
+	if (newname)
+		llstrncpy(newdir, newname, sizeof(newdir), 0);
+	else
+		snprintf(newdir, sizeof(newdir), "%s.compact", dbname);
+	snprintf(olddir, sizeof(olddir), "%s.old", dbname);
+	if (!newname && !recover_swap(dbname, olddir))
+		return 10;
+
+	/* a reader opening keeps writers out while we copy */
+	if (!(btree = bt_openbtree(dbname, FALSE, 0, FALSE, &lldberrnum))) {
+		printf(_("Failed to open btree: %s."), dbname);
+		puts("");
+		return 20;
+	}
+	if (!bt_compact(btree, newdir, fill, &stats, &lldberrnum)) {
+		if (lldberrnum == BTERR_EXISTS)
+			printf(_("There is already a btree in %s."), newdir);
+		else
+			printf(_("Failed to create btree: %s."), newdir);
+		puts("");
+		closebtree(btree);
+		return 30;
+	}
+	if (!copy_other_files(dbname, newdir)) {
+		closebtree(btree);
+		remove_tree(newdir);
+		return 40;
+	}
+	print_counts(_("Before"), stats.c_records + stats.c_deleted
+		, stats.c_oldblocks, stats.c_oldindexes);
+	print_counts(_("After"), stats.c_records
+		, stats.c_newblocks, stats.c_newindexes);
+
+	if (newname) {
+		/* snapshot copy, original left as it was */
+		closebtree(btree);
+		return 0;
+	}
+
+	/* swap copy into place, which needs all other users gone */
+	if (!lock_for_swap(btree)) {
+		printf(_("Database is in use, so it was not replaced."));
+		puts("");
+		printf(_("Compacted copy is in %s"), newdir);
+		puts("");
+		closebtree(btree);
+		return 50;
+	}
+	closebtree(btree);
+	btree = 0;
+	if (exchange_dirs(newdir, dbname)) {
+		/* original is now in newdir, still locked */
+		if (rename(newdir, olddir) != 0) {
+			printf(_("Failed to rename %s to %s"), newdir, olddir);
+			puts("");
+			return 60;
+		}
+	} else {
+		/* not atomic: nothing is at dbname between the renames,
+		so if we stop there, recover_swap restores it next run */
+		if (rename(dbname, olddir) != 0) {
+			printf(_("Failed to rename %s to %s"), dbname, olddir);
+			puts("");
+			set_ostat(dbname, 0);
+			return 60;
+		}
+		if (rename(newdir, dbname) != 0) {
+			printf(_("Failed to rename %s to %s"), newdir, dbname);
+			puts("");
+			rename(olddir, dbname);
+			set_ostat(dbname, 0);
+			return 60;
+		}
+	}
+	if (keep) {
+		set_ostat(olddir, 0);
+		printf(_("Original btree kept in %s"), olddir);
+		puts("");
+	} else if (!remove_tree(olddir)) {
+		printf(_("Failed to remove %s"), olddir);
+		puts("");
+		return 70;
+	}
+	return 0;
+}
+/*=========================================
+ * exchange_dirs -- Swap two directories in one step
+ *  returns FALSE if the system or file system cannot do it,
+ *  in which case neither has been touched
+ *=======================================*/
+static BOOLEAN
+exchange_dirs (CNSTRING dir1, CNSTRING dir2)
+{
+#if defined(HAVE_RENAMEAT2) && defined(RENAME_EXCHANGE)
+	return renameat2(AT_FDCWD, dir1, AT_FDCWD, dir2, RENAME_EXCHANGE) == 0;
+#else
+	dir1=dir1; /* unused */
+	dir2=dir2; /* unused */
+	return FALSE;
+#endif
+}
+/*=========================================
+ * recover_swap -- Check for what an interrupted swap left
+ *  If we stopped between the two renames of a swap without
+ *  exchange_dirs, there is no database, only database.old,
+ *  which is put back. If both are there, database.old would
+ *  be in the way of this swap, so we stop.
+ *  returns FALSE if the database should not be compacted now
+ *=======================================*/
+static BOOLEAN
+recover_swap (CNSTRING dbname, CNSTRING olddir)
+{
+	struct stat sbuf;
+	if (stat(olddir, &sbuf) != 0)
+		return TRUE;
+	if (stat(dbname, &sbuf) == 0) {
+		printf(_("%s is in the way; remove it, or move it elsewhere."), olddir);
+		puts("");
+		return FALSE;
+	}
+	if (rename(olddir, dbname) != 0 || !set_ostat(dbname, 0)) {
+		printf(_("Failed to restore %s from %s"), dbname, olddir);
+		puts("");
+		return FALSE;
+	}
+	printf(_("Restored %s from %s, left by an interrupted swap."), dbname, olddir);
+	puts("");
+	return TRUE;
+}
+/*=========================================
+ * lock_for_swap -- Turn our reader lock into a writer lock
+ *  This only succeeds if we are the only user of the btree.
+ *  The key file is left writer-locked when the btree is closed,
+ *  so nobody can open it until it has been replaced.
+ *=======================================*/
+static BOOLEAN
+lock_for_swap (BTREE btree)
+{
+	FILE *fk = bkfp(btree);
+	KEYFILE1 kfile1;
+	if (bimmut(btree) || !fk)
+		return FALSE;
+	rewind(fk);
+	if (fread(&kfile1, sizeof(kfile1), 1, fk) != 1
+		|| kfile1.k_ostat != 1)
+		return FALSE;
+	kfile1.k_ostat = -1;
+	rewind(fk);
+	if (fwrite(&kfile1, sizeof(kfile1), 1, fk) != 1)
+		return FALSE;
+	/* close key file here, so closebtree leaves it locked */
+	fclose(fk);
+	bkfp(btree) = NULL;
+	return TRUE;
+}
+/*=========================================
+ * set_ostat -- Set open status in key file of unopened btree
+ *=======================================*/
+static BOOLEAN
+set_ostat (CNSTRING dir, INT ostat)
+{
+	char path[MAXPATHLEN];
+	FILE *fk=NULL;
+	KEYFILE1 kfile1;
+	BOOLEAN ok=FALSE;
+
+	snprintf(path, sizeof(path), "%s%ckey", dir, LLCHRDIRSEPARATOR);
+	if (!(fk = fopen(path, LLREADBINARYUPDATE)))
+		return FALSE;
+	if (fread(&kfile1, sizeof(kfile1), 1, fk) == 1) {
+		kfile1.k_ostat = ostat;
+		rewind(fk);
+		ok = (fwrite(&kfile1, sizeof(kfile1), 1, fk) == 1);
+	}
+	if (fclose(fk) != 0)
+		ok = FALSE;
+	return ok;
+}
+/*=========================================
+ * copy_other_files -- Copy files besides the btree (eg, xrefs)
+ *  These are the regular files at the top of the database
+ *  directory, other than the key file & btree temporaries.
+ *=======================================*/
+static BOOLEAN
+copy_other_files (CNSTRING olddir, CNSTRING newdir)
+{
+	struct dirent **entries=0;
+	char from[MAXPATHLEN], to[MAXPATHLEN];
+	struct stat sbuf;
+	BOOLEAN ok=TRUE;
+	int n;
+
+	n = scandir(olddir, &entries, 0, 0);
+	if (n < 0) return FALSE;
+	while (n--) {
+		CNSTRING name = entries[n]->d_name;
+		if (snprintf(from, sizeof(from), "%s%c%s", olddir, LLCHRDIRSEPARATOR
+				, name) >= (int)sizeof(from)
+			|| snprintf(to, sizeof(to), "%s%c%s", newdir, LLCHRDIRSEPARATOR
+				, name) >= (int)sizeof(to)) {
+			printf(_("Path too long: %s"), name);
+			puts("");
+			ok = FALSE;
+		}
+		if (ok && !eqstr(name, "key") && !eqstr(name, "tmp1")
+			&& !eqstr(name, "tmp2")
+			&& !stat(from, &sbuf) && S_ISREG(sbuf.st_mode)
+			&& !copy_file(from, to)) {
+			printf(_("Failed to copy %s to %s"), from, to);
+			puts("");
+			ok = FALSE;
+		}
+		stdfree(entries[n]);
+	}
+	stdfree(entries);
+	return ok;
+}
+/*=========================================
+ * copy_file -- Copy one file
+ *=======================================*/
+static BOOLEAN
+copy_file (CNSTRING from, CNSTRING to)
+{
+	FILE *fpsrc=NULL, *fpdest=NULL;
+	char buffer[BUFSIZ];
+	size_t len;
+	BOOLEAN ok=TRUE;
+
+	if (!(fpsrc = fopen(from, LLREADBINARY)))
+		return FALSE;
+	if (!(fpdest = fopen(to, LLWRITEBINARY))) {
+		fclose(fpsrc);
+		return FALSE;
+	}
+	while (ok && (len = fread(buffer, 1, sizeof(buffer), fpsrc)) > 0) {
+		if (fwrite(buffer, 1, len, fpdest) != len)
+			ok = FALSE;
+	}
+	if (ferror(fpsrc))
+		ok = FALSE;
+	fclose(fpsrc);
+	if (fclose(fpdest) != 0)
+		ok = FALSE;
+	return ok;
+}
+/*=========================================
+ * remove_tree -- Delete btree directory
+ *  (files, and the subdirectories holding btree files)
+ *=======================================*/
+static BOOLEAN
+remove_tree (CNSTRING dir)
+{
+	struct dirent **entries=0;
+	char path[MAXPATHLEN];
+	struct stat sbuf;
+	BOOLEAN ok=TRUE;
+	int n;
+
+	n = scandir(dir, &entries, 0, 0);
+	if (n < 0) return FALSE;
+	while (n--) {
+		CNSTRING name = entries[n]->d_name;
+		if (!eqstr(name, ".") && !eqstr(name, "..")) {
+			snprintf(path, sizeof(path), "%s%c%s", dir, LLCHRDIRSEPARATOR, name);
+			if (!stat(path, &sbuf) && S_ISDIR(sbuf.st_mode)) {
+				if (!remove_tree(path))
+					ok = FALSE;
+			} else if (unlink(path) != 0) {
+				ok = FALSE;
+			}
+		}
+		stdfree(entries[n]);
+	}
+	stdfree(entries);
+	if (rmdir(dir) != 0)
+		ok = FALSE;
+	return ok;
+}
+/*=========================================
+ * print_counts -- Describe size of btree
+ *=======================================*/
+static void
+print_counts (CNSTRING title, INT records, INT blocks, INT indexes)
+{
+	printf(_("%s: %ld records, %ld blocks, %ld indexes"), title
+		, (long)records, (long)blocks, (long)indexes);
+	puts("");
+}
+/*=============================
+ * __fatal -- Fatal error routine
+ *  handles null or empty details input
+ *===========================*/
+void
+__fatal (STRING file, int line, CNSTRING details)
+{
+	printf("FATAL ERROR: ");
+	if (details && details[0]) {
+		printf("%s", details);
+		printf("\nAT: ");
+	}
+	printf("%s: line %d\n", file, line);
+	exit(1);
+}
+/*===============================================
+ * print_usage -- display program help/usage
+ *  displays to stdout
+ *=============================================*/
+static void
+print_usage (void)
+{
+#ifdef WIN32
+	char * fname = _("\"\\My Documents\\LifeLines\\Databases\\MyFamily\"");
+#else
+	char * fname = _("/home/users/myname/lifelines/databases/myfamily");
+#endif
+
+	printf(_("lifelines `btcompact' rewrites a lifelines database btree\n"
+		"with full blocks, dropping deleted records and rebuilding\n"
+		"the index. Back up your database before using this."));
+	printf("\n\n");
+	printf(_("Usage btcompact [-f fill] [-k] [database] [newdatabase]"));
+	printf("\n\n");
+	printf(_("Options:"));
+	printf("\n");
+	printf(_("\t-f fill\tpercentage to fill blocks (default 100)"));
+	printf("\n");
+	printf(_("\t-k\tkeep original database (as database.old)"));
+	printf("\n");
+	printf(_("\t--help\tdisplay this help and exit"));
+	printf("\n");
+	printf(_("\t--version\toutput version information and exit"));
+	printf("\n\n");
+	printf(_("Without newdatabase, the compacted copy replaces database,\n"
+		"which must not be in use by anyone else at the end."));
+	printf("\n\n");
+	printf(_("Examples:"));
+	printf("\n");
+	printf(_("\tbtcompact %s"), fname);
+	printf("\n\t\t");
+	printf(_("compact database in place"));
+	printf("\n");
+	printf(_("\tbtcompact -f 80 %s copy"), fname);
+	printf("\n\t\t");
+	printf(_("write copy with blocks 80%% full, leaving database as is"));
+	printf("\n\n");
+	printf(_("Report bugs to https://github.com/MarcNo/lifelines/issues"));
+	printf("\n");
+}
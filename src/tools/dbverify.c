@@ -99,7 +99,6 @@ struct work {
 	INT fix_alter_pointers;
 	INT check_missing_data_records; /* record in index, but no data */
 	INT fix_missing_data_records;
-	INT pass; /* =1 is checking, =2 is fixing */
 };
 /*=======================================
  * NAMEREFN_REC -- holds one name or refn
@@ -110,40 +109,79 @@ typedef struct
 	STRING namerefn; 
 	STRING key;
 	INT err;
+	BOOLEAN newset; /* first of its index record (verify pass) */
 } NAMEREFN_REC;
+/*==============================================
+ * VLINKS -- one kind of lineage link (eg, FAMC)
+ *  seen by verify pass, as pairs of key numbers,
+ *  in order of the record holding the link
+ *============================================*/
+typedef struct
+{
+	INT count;
+	INT max;
+	INT *from;
+	INT *to;
+} VLINKS;
+/*================================================
+ * VCHECK -- one check noted by verify pass, to be
+ *  resolved once the pass has seen every record
+ *  (kept in the order the checks are reported)
+ *  ttype,to: target, if it is a record key
+ *  text:     other target, or bad name
+ *==============================================*/
+typedef struct
+{
+	char op;
+	char ftype;
+	char ttype;
+	INT from;
+	INT to;
+	STRING text;
+} VCHECK;
+/*==========================================
+ * VNAME -- one NAME of a person seen by verify pass
+ *========================================*/
+typedef struct
+{
+	INT keynum;
+	STRING name;
+} VNAME;
 
 /*********************************************
  * local function prototypes
  *********************************************/
 
 /* alphabetical */
+static void add_check(char op, char ftype, INT from, CNSTRING target, CNSTRING text);
 static NAMEREFN_REC * alloc_namerefn(CNSTRING namerefn, CNSTRING key, INT err);
 static BOOLEAN cgn_callback(TRAV_NAMES_FUNC_ARGS(key, name, newset, param));
 static BOOLEAN cgr_callback(TRAV_REFNS_FUNC_ARGS(key, refn, newset, param));
 static void check_and_fix_records(void);
 static BOOLEAN check_block(BLOCK block, RKEY * lo, RKEY * hi);
 static BOOLEAN check_btree(BTREE btr);
-static BOOLEAN check_even(CNSTRING key, RECORD rec);
-static BOOLEAN check_fam(CNSTRING key, RECORD rec);
 static void check_ghosts(void);
 static BOOLEAN check_keys(BLOCK block, RKEY * lo, RKEY * hi);
 static BOOLEAN check_index(BTREE btr, INDEX index, TABLE fkeytab, RKEY * lo, RKEY * hi);
-static BOOLEAN check_indi(CNSTRING key, RECORD rec);
-static void check_node(CNSTRING key, NODE node, INT level);
-static void check_nodes(void);
 static void check_missing_data_records(void);
-static void check_pointers(CNSTRING key, RECORD rec);
-static void check_set(INDISEQ seq, char ctype);
-static BOOLEAN check_sour(CNSTRING key, RECORD rec);
+static void check_set(char ctype);
 static void check_typed_missing_data_records(char ntype);
-static BOOLEAN check_othe(CNSTRING key, RECORD rec);
 static BOOLEAN find_xref(CNSTRING key, NODE node, CNSTRING tag1, CNSTRING tag2);
 static void finish_and_delete_nameset(void);
 static void finish_and_delete_refnset(void);
 static void fix_nodes(void);
 static void free_namerefn(NAMEREFN_REC * rec);
+static void free_verify_pass(void);
 static BOOLEAN fix_bad_pointer(CNSTRING key, RECORD rec, NODE node);
-static BOOLEAN nodes_callback(TRAV_RECORDS_FUNC_ARGS(key, rec, param));
+static char * get_state(char ntype, INT keynum, BOOLEAN grow);
+static BOOLEAN has_link(INT kind, INT from, INT to);
+static BOOLEAN indi_has_name(INT keynum, CNSTRING name);
+static BOOLEAN is_checked(char ntype);
+static BOOLEAN is_live(char ntype, INT keynum);
+static BOOLEAN is_live_key(CNSTRING key, char ntype);
+static INT note_links(NODE root, INT from, CNSTRING tag, INT kind, INT op);
+static void note_pointers(char ftype, INT from, NODE node, INT level);
+static BOOLEAN parse_key(CNSTRING key, char * ptype, INT * pnum);
 static void printblock(BLOCK block);
 static CNSTRING printkey(CNSTRING key);
 static void print_usage(void);
@@ -154,8 +192,13 @@ static void report_error(INT err, STRING fmt, ...);
 static void report_fix(INT err, STRING fmt, ...);
 static void report_progress(STRING fmt, ...);
 static void report_results(void);
+static void resolve_checks(void);
 static void validate_errs(void);
 static void vcrashlog(int newline, const char * fmt, va_list args);
+static BOOLEAN verify_callback(TRAV_RECORD_FUNC_BYKEY_ARGS(rkey, data, len, param));
+static BOOLEAN vindex_callback(TRAV_NAMES_FUNC_ARGS(key, namerefn, newset, param));
+static void verify_pass(void);
+static void verify_record(char ntype, INT keynum, STRING data);
 
 /*********************************************
  * local variables
@@ -206,7 +249,27 @@ static LIST tofix=0;
 /* sequence of NAMEs or REFNs in the same block */
 static INDISEQ soundexseq=0;
 static BOOLEAN noisy=FALSE;
-static INDISEQ seq_indis, seq_fams, seq_sours, seq_evens, seq_othes;
+/*
+The verify pass reads every block of the btree once, in order,
+and keeps what the checks need: the state of each record key,
+the lineage links and names of persons, and the name & refn
+index entries.
+*/
+enum { VK_NONE, VK_EMPTY, VK_LIVE }; /* state of a record key */
+enum { VL_FAMC, VL_FAMS, VL_HUSB, VL_WIFE, VL_CHIL, VL_COUNT };
+enum {
+	VOP_NODE, VOP_DUP, VOP_BADNAME, VOP_FAMC, VOP_FAMS
+	, VOP_HUSB, VOP_WIFE, VOP_CHIL, VOP_EMPTYFAM, VOP_SOLOFAM, VOP_POINTER
+};
+static char vtypes[] = "IFSEX";
+static char * vstates[5];     /* VK_ state by key number, for each type */
+static INT vnstates[5];
+static VLINKS vlinks[VL_COUNT];
+static VCHECK * vchecks=0;
+static INT vnchecks=0, vmaxchecks=0;
+static VNAME * vnames=0;      /* NAMEs of persons, in key order */
+static INT vnnames=0, vmaxnames=0;
+static LIST vnameidx=0, vrefnidx=0; /* NAMEREFN_RECs of index entries */
 static STRING lineage_tags[] = {
 	"FAMC"
 	, "FAMS"
@@ -328,19 +391,24 @@ free_namerefn (NAMEREFN_REC * rec)
 /*==========================================
  * check_ghosts -- Process all names & refns
  *  checking (& optionally fixing) ghosts
+ *  (index entries & records from verify pass)
  * Created: 2001/01/01, Perry Rapp
  *=========================================*/
 static void
 check_ghosts (void)
 {
+	NAMEREFN_REC * rec;
 	tofix = create_list();
 	soundexseq = create_indiseq_sval();
 	/* soundexseq is used inside cgn_callback, across calls */
-	traverse_names(cgn_callback, NULL);
+	while (!is_empty_list(vnameidx)) {
+		rec = (NAMEREFN_REC *) dequeue_list(vnameidx);
+		cgn_callback(rec->key, rec->namerefn, rec->newset, NULL);
+		free_namerefn(rec);
+	}
 	finish_and_delete_nameset();
 
 	if (todo.fix_ghosts) {
-		NAMEREFN_REC * rec;
 		while (!is_empty_list(tofix)) {
 			rec = (NAMEREFN_REC *) dequeue_list(tofix);
 			remove_name(rec->namerefn, rec->key);
@@ -354,11 +422,14 @@ check_ghosts (void)
 
 	soundexseq = create_indiseq_sval();
 	/* soundexseq is used inside cgr_callback, across calls */
-	traverse_refns(cgr_callback, NULL);
+	while (!is_empty_list(vrefnidx)) {
+		rec = (NAMEREFN_REC *) dequeue_list(vrefnidx);
+		cgr_callback(rec->key, rec->namerefn, rec->newset, NULL);
+		free_namerefn(rec);
+	}
 	finish_and_delete_refnset();
 
 	if (todo.fix_ghosts) {
-		NAMEREFN_REC * rec;
 		while (!is_empty_list(tofix)) {
 			rec = (NAMEREFN_REC *) dequeue_list(tofix);
 			remove_refn(rec->namerefn, rec->key);
@@ -370,7 +441,7 @@ check_ghosts (void)
 	tofix=0;
 }
 /*============================================
- * cgn_callback -- callback for name traversal
+ * cgn_callback -- callback for each name entry
  *  for checking for ghost names
  * Created: 2001/01/01, Perry Rapp
  *==========================================*/
@@ -378,8 +449,8 @@ static BOOLEAN
 cgn_callback (TRAV_NAMES_FUNC_ARGS(key, name, newset, param))
 {
 	/* a name record which points at indi=key */
-	RECORD indi0 = NULL;
-	NODE indi = NULL;
+	char ntype=0;
+	INT keynum=0;
 	param=param; /* unused */
 
 	/* bail out immediately if not INDI */
@@ -389,9 +460,6 @@ cgn_callback (TRAV_NAMES_FUNC_ARGS(key, name, newset, param))
 			, key, name);
 		return 1; /* continue traversal */
 	}
-	
-	indi0 = qkey_to_irecord(key);
-	indi = nztop(indi0);
 
 	if (newset) {
 		finish_and_delete_nameset();
@@ -401,25 +469,14 @@ cgn_callback (TRAV_NAMES_FUNC_ARGS(key, name, newset, param))
 	append_indiseq_sval(soundexseq, strsave(key), (STRING)name, strsave(name)
 		, TRUE, TRUE); /* sure, alloc */
 
-	if (!indi) {
+	if (!parse_key(key, &ntype, &keynum) || !is_live(ntype, keynum)) {
 		report_error(ERR_ORPHANNAME, _("Orphaned name: %s"), name);
 		if (todo.fix_ghosts)
 			enqueue_list(tofix, (VPTR)alloc_namerefn(name, key, ERR_ORPHANNAME));
-	} else {
-		NODE node;
-		BOOLEAN found=FALSE;
-		NODE nam, refn, sex, body, famc, fams;
-		split_indi_old(indi, &nam, &refn, &sex, &body, &famc, &fams);
-		for (node = nam; node; node = nsibling(node)) {
-			if (!strcmp(nval(node), name))
-				found=TRUE;
-		}
-		join_indi(indi, nam, refn, sex, body, famc, fams);
-		if (!found) {
-			report_error(ERR_GHOSTNAME, _("Ghost name: %s -> %s"), name, key);
-			if (todo.fix_ghosts)
-				enqueue_list(tofix, (VPTR)alloc_namerefn(name, key, ERR_GHOSTNAME));
-		}
+	} else if (!indi_has_name(keynum, name)) {
+		report_error(ERR_GHOSTNAME, _("Ghost name: %s -> %s"), name, key);
+		if (todo.fix_ghosts)
+			enqueue_list(tofix, (VPTR)alloc_namerefn(name, key, ERR_GHOSTNAME));
 	}
 
 	if (noisy)
@@ -428,7 +485,7 @@ cgn_callback (TRAV_NAMES_FUNC_ARGS(key, name, newset, param))
 	return 1; /* continue traversal */
 }
 /*============================================
- * cgr_callback -- callback for refn traversal
+ * cgr_callback -- callback for each refn entry
  *  for checking for ghost refns
  * Created: 2001/01/13, Perry Rapp
  *==========================================*/
@@ -436,8 +493,6 @@ static BOOLEAN
 cgr_callback (TRAV_REFNS_FUNC_ARGS(key, refn, newset, param))
 {
 	/* a refn record which points at record=key */
-	RECORD rec = key_to_record(key);
-	NODE node = nztop(rec);
 	param = param; /* unused */
 
 	if (newset) {
@@ -447,11 +502,10 @@ cgr_callback (TRAV_REFNS_FUNC_ARGS(key, refn, newset, param))
 	append_indiseq_sval(soundexseq, strsave(key), NULL, strsave(refn)
 		, TRUE, TRUE); /* sure, alloc */
 	
-	if (!node) {
+	if (!is_live_key(key, key[0])) {
 		report_error(ERR_ORPHANNAME, _("Orphaned refn: %s"), refn);
 		if (todo.fix_ghosts)
 			enqueue_list(tofix, (VPTR)alloc_namerefn(refn, key, ERR_ORPHANNAME));
-	} else {
 	}
 	if (noisy)
 		report_progress("Refn: %s", refn);
@@ -535,46 +589,544 @@ finish_and_delete_refnset (void)
 	destroy_table(table);
 }
 /*=================================
- * check_nodes -- Check all nodes in database
- * (as selected in struct work)
+ * verify_pass -- Read whole database once, noting
+ *  everything the checks need (see verify_record)
+ *  Reads btree block by block, so no record goes thru
+ *  the cache, and each block file is read only once.
  *================================*/
 static void
-check_nodes (void)
+verify_pass (void)
 {
-	seq_indis = create_indiseq_null();
-	seq_fams = create_indiseq_null();
-	seq_sours = create_indiseq_null();
-	seq_evens = create_indiseq_null();
-	seq_othes = create_indiseq_null();
-	traverse_db_key_recs(nodes_callback, NULL);
-	/* check what we saw against delete sets */
-	check_set(seq_indis, 'I');
-	check_set(seq_fams, 'F');
-	check_set(seq_sours, 'S');
-	check_set(seq_evens, 'E');
-	check_set(seq_othes, 'X');
-	remove_indiseq(seq_indis);
-	remove_indiseq(seq_fams);
-	remove_indiseq(seq_sours);
-	remove_indiseq(seq_evens);
-	remove_indiseq(seq_othes);
+	BOOLEAN ghosts = todo.find_ghosts || todo.fix_ghosts;
+	if (ghosts) {
+		vnameidx = create_list();
+		vrefnidx = create_list();
+	}
+	traverse_db_blocks(BTR, verify_callback, &ghosts);
+}
+/*=================================
+ * free_verify_pass -- Free all verify pass noted
+ *================================*/
+static void
+free_verify_pass (void)
+{
+	INT i;
+	for (i=0; i<ARRSIZE(vstates); i++) {
+		stdfree(vstates[i]);
+		vstates[i] = 0;
+		vnstates[i] = 0;
+	}
+	for (i=0; i<VL_COUNT; i++) {
+		stdfree(vlinks[i].from);
+		stdfree(vlinks[i].to);
+		memset(&vlinks[i], 0, sizeof(vlinks[i]));
+	}
+	for (i=0; i<vnchecks; i++)
+		stdfree(vchecks[i].text);
+	stdfree(vchecks);
+	vchecks = 0;
+	vnchecks = vmaxchecks = 0;
+	for (i=0; i<vnnames; i++)
+		stdfree(vnames[i].name);
+	stdfree(vnames);
+	vnames = 0;
+	vnnames = vmaxnames = 0;
+	if (vnameidx) {
+		while (!is_empty_list(vnameidx))
+			free_namerefn((NAMEREFN_REC *)dequeue_list(vnameidx));
+		destroy_list(vnameidx);
+		vnameidx = 0;
+	}
+	if (vrefnidx) {
+		while (!is_empty_list(vrefnidx))
+			free_namerefn((NAMEREFN_REC *)dequeue_list(vrefnidx));
+		destroy_list(vrefnidx);
+		vrefnidx = 0;
+	}
+}
+/*=================================
+ * verify_callback -- callback for each btree record
+ *  during verify pass
+ *  param: [IN]  whether to keep name & refn entries
+ *================================*/
+static BOOLEAN
+verify_callback (TRAV_RECORD_FUNC_BYKEY_ARGS(rkey, data, len, param))
+{
+	BOOLEAN ghosts = *(BOOLEAN *)param;
+	char ntype=0;
+	INT keynum=0;
+	len=len; /* unused */
+
+	if (ghosts) {
+		if (traverse_name_rec(rkey.r_rkey, data, vindex_callback, vnameidx)
+			|| traverse_refn_rec(rkey.r_rkey, data, vindex_callback, vrefnidx))
+			return TRUE;
+	}
+	if (parse_key(rkey2str(rkey), &ntype, &keynum))
+		verify_record(ntype, keynum, data);
+	return TRUE;
+}
+/*=================================
+ * vindex_callback -- callback for each name or refn
+ *  entry during verify pass (kept for check_ghosts)
+ *  param: [IN]  list to keep it on
+ *================================*/
+static BOOLEAN
+vindex_callback (TRAV_NAMES_FUNC_ARGS(key, namerefn, newset, param))
+{
+	NAMEREFN_REC * rec = alloc_namerefn(namerefn, key, 0);
+	rec->newset = newset;
+	enqueue_list((LIST)param, (VPTR)rec);
+	return TRUE;
+}
+/*=================================
+ * verify_record -- Note one record during verify pass
+ *  ntype:  [IN]  type of record (I, F, S, E, X)
+ *  keynum: [IN]  number of record key
+ *  data:   [IN]  record (NULL if empty; is modified)
+ * Lineage links & names of persons are always kept, to
+ * check other records against; checks are noted only for
+ * the types of record selected.
+ *================================*/
+static void
+verify_record (char ntype, INT keynum, STRING data)
+{
+	BOOLEAN check = is_checked(ntype);
+	char * state = get_state(ntype, keynum, TRUE);
+	NODE root, node;
+	INT members=0;
+
+	if (!data || *data != '0') {
+		/* deleted (DELE), empty, or corrupt */
+		if (*state == VK_NONE)
+			*state = VK_EMPTY;
+		return;
+	}
+	if (check && noisy)
+		add_check(VOP_NODE, ntype, keynum, NULL, NULL);
+	if (check && *state != VK_NONE)
+		add_check(VOP_DUP, ntype, keynum, NULL, NULL);
+	*state = VK_LIVE;
+	if (!check && ntype != 'I' && ntype != 'F')
+		return;
+	if (!(root = string_to_node(data))) {
+		*state = VK_EMPTY;
+		return;
+	}
+
+	if (ntype == 'I') {
+		/* names first, then parents, then spouses, as always reported */
+		for (node = nchild(root); node; node = nsibling(node)) {
+			if (!eqstr(ntag(node), "NAME"))
+				continue;
+			if (nval(node) && vnameidx) {
+				if (vnnames == vmaxnames) {
+					vmaxnames = vmaxnames ? 2*vmaxnames : 1024;
+					vnames = (VNAME *)(vnames
+						? stdrealloc(vnames, vmaxnames*sizeof(VNAME))
+						: stdalloc(vmaxnames*sizeof(VNAME)));
+				}
+				vnames[vnnames].keynum = keynum;
+				vnames[vnnames++].name = strsave(nval(node));
+			}
+			if (check && !valid_name(nval(node)))
+				add_check(VOP_BADNAME, ntype, keynum, NULL, nval(node));
+		}
+		note_links(root, keynum, "FAMC", VL_FAMC, check ? VOP_FAMC : -1);
+		note_links(root, keynum, "FAMS", VL_FAMS, check ? VOP_FAMS : -1);
+	} else if (ntype == 'F') {
+		members += note_links(root, keynum, "HUSB", VL_HUSB, check ? VOP_HUSB : -1);
+		members += note_links(root, keynum, "WIFE", VL_WIFE, check ? VOP_WIFE : -1);
+		members += note_links(root, keynum, "CHIL", VL_CHIL, check ? VOP_CHIL : -1);
+		/* check for undersized family */
+		if (check && members < 2)
+			add_check(members ? VOP_SOLOFAM : VOP_EMPTYFAM, ntype, keynum, NULL, NULL);
+	}
+	if (check)
+		note_pointers(ntype, keynum, root, 0);
+	free_nodes(root);
+}
+/*=================================
+ * note_links -- Note lineage links of one tag
+ *  of a person or family during verify pass
+ *  root:  [IN]  record
+ *  from:  [IN]  its key number
+ *  tag:   [IN]  lineage tag (FAMC, HUSB, ...)
+ *  kind:  [IN]  VL_ kind of link
+ *  op:    [IN]  VOP_ check to note for each (-1 if none)
+ * returns number of links of tag
+ *================================*/
+static INT
+note_links (NODE root, INT from, CNSTRING tag, INT kind, INT op)
+{
+	VLINKS * links = &vlinks[kind];
+	char ftype = (kind == VL_FAMC || kind == VL_FAMS) ? 'I' : 'F';
+	char ttype = (ftype == 'I') ? 'F' : 'I';
+	NODE node;
+	INT count=0;
+	for (node = nchild(root); node; node = nsibling(node)) {
+		STRING target;
+		char ntype=0;
+		INT keynum=0;
+		if (!eqstr(ntag(node), tag))
+			continue;
+		++count;
+		target = rmvat(nval(node));
+		if (op >= 0)
+			add_check((char)op, ftype, from, target, NULL);
+		if (!parse_key(target, &ntype, &keynum) || ntype != ttype)
+			continue;
+		if (links->count == links->max) {
+			links->max = links->max ? 2*links->max : 1024;
+			if (links->count) {
+				links->from = (INT *)stdrealloc(links->from, links->max*sizeof(INT));
+				links->to = (INT *)stdrealloc(links->to, links->max*sizeof(INT));
+			} else {
+				links->from = (INT *)stdalloc(links->max*sizeof(INT));
+				links->to = (INT *)stdalloc(links->max*sizeof(INT));
+			}
+		}
+		links->from[links->count] = from;
+		links->to[links->count++] = keynum;
+	}
+	return count;
+}
+/*=====================================
+ * note_pointers -- note check of each pointer
+ *  of node & its subtree during verify pass
+ *  (lineage links are checked elsewhere)
+ * 2001/02/18, Perry Rapp
+ *===================================*/
+static void
+note_pointers (char ftype, INT from, NODE node, INT level)
+{
+	for ( ; node; node = nsibling(node)) {
+		BOOLEAN lineage=FALSE;
+		STRING skey;
+		/* ignore lineage links - they are checked elsewhere */
+		if (level==1) {
+			INT i;
+			for (i=0; i<ARRSIZE(lineage_tags); i++) {
+				if (eqstr(ntag(node), lineage_tags[i])) {
+					lineage=TRUE;
+					break;
+				}
+			}
+		}
+		/*
+		TO DO: How do we tell non-pointers that *ought* to
+		be pointers, eg "1 SOUR <FamilyHistory>" ?
+		*/
+		if (!lineage && (skey = rmvat(nval(node))))
+			add_check(VOP_POINTER, ftype, from, skey, nval(node));
+		if (nchild(node))
+			note_pointers(ftype, from, nchild(node), level+1);
+	}
+}
+/*=================================
+ * add_check -- Note a check for resolve_checks
+ *  op:     [IN]  VOP_ check
+ *  ftype:  [IN]  type of record checked
+ *  from:   [IN]  its key number
+ *  target: [IN]  key the check is about (may be NULL)
+ *  text:   [IN]  text to report (if not target)
+ *================================*/
+static void
+add_check (char op, char ftype, INT from, CNSTRING target, CNSTRING text)
+{
+	VCHECK * chk;
+	if (vnchecks == vmaxchecks) {
+		vmaxchecks = vmaxchecks ? 2*vmaxchecks : 1024;
+		vchecks = (VCHECK *)(vchecks
+			? stdrealloc(vchecks, vmaxchecks*sizeof(VCHECK))
+			: stdalloc(vmaxchecks*sizeof(VCHECK)));
+	}
+	chk = &vchecks[vnchecks++];
+	chk->op = op;
+	chk->ftype = ftype;
+	chk->from = from;
+	chk->ttype = 0;
+	chk->to = 0;
+	chk->text = NULL;
+	if (!parse_key(target, &chk->ttype, &chk->to)) {
+		chk->ttype = 0;
+		chk->text = target ? strsave(target) : NULL;
+	}
+	if (text) {
+		stdfree(chk->text);
+		chk->text = strsave(text);
+	}
+}
+/*=================================
+ * resolve_checks -- Report problems found by checks
+ *  verify pass noted, now that all records are known,
+ *  and put records needing fixes on tofix list
+ *================================*/
+static void
+resolve_checks (void)
+{
+	INT i;
+	BOOLEAN needfix=FALSE;
+	char key[MAXKEYWIDTH+1], tkey[MAXKEYWIDTH+1];
+	key[0] = 0;
+	for (i=0; i<=vnchecks; i++) {
+		VCHECK * chk = (i<vnchecks) ? &vchecks[i] : NULL;
+		CNSTRING target;
+		BOOLEAN found;
+		if (!chk || chk->ftype != key[0] || chk->from != atoi(&key[1])) {
+			/* done with a record */
+			if (needfix)
+				enqueue_list(tofix, strsave(key));
+			needfix = FALSE;
+			if (!chk)
+				break;
+			sprintf(key, "%c%d", chk->ftype, chk->from);
+		}
+		if (chk->ttype) {
+			sprintf(tkey, "%c%d", chk->ttype, chk->to);
+			target = tkey;
+		} else {
+			target = printkey(chk->text);
+		}
+		switch (chk->op) {
+		case VOP_NODE:
+			report_progress("Node: %s", key);
+			break;
+		case VOP_DUP:
+			switch (chk->ftype) {
+			case 'I': report_error(ERR_DUPINDI, _("Duplicate individual for %s"), key); break;
+			case 'F': report_error(ERR_DUPFAM, _("Duplicate family for %s"), key); break;
+			case 'S': report_error(ERR_DUPSOUR, _("Duplicate source for %s"), key); break;
+			case 'E': report_error(ERR_DUPEVEN, _("Duplicate event for %s"), key); break;
+			default: report_error(ERR_DUPOTHE, _("Duplicate record for %s"), key); break;
+			}
+			break;
+		case VOP_BADNAME:
+			report_error(ERR_BADNAME, _("Bad name for individual %s: %s"), key, target);
+			break;
+		case VOP_FAMC:
+			if (!(chk->ttype == 'F' && is_live('F', chk->to))) {
+				report_error(ERR_BADFAMREF, _("Bad family reference (%s) individual %s"), target, key);
+			} else if (!has_link(VL_CHIL, chk->to, chk->from)) {
+				/* person not in family's children */
+				report_error(ERR_MISSINGCHILD, _("Missing child (%s) in family (%s)"), key, target);
+				needfix=TRUE;
+			}
+			break;
+		case VOP_FAMS:
+			if (!(chk->ttype == 'F' && is_live('F', chk->to))) {
+				report_error(ERR_BADFAMREF, _("Bad family reference (%s) individual %s"), target, key);
+			} else if (!has_link(VL_HUSB, chk->to, chk->from)
+				&& !has_link(VL_WIFE, chk->to, chk->from)) {
+				/* person not in family's spouses */
+				report_error(ERR_MISSINGSPOUSE, _("Missing spouse (%s) in family (%s)"), key, target);
+				needfix=TRUE;
+			}
+			break;
+		case VOP_HUSB:
+		case VOP_WIFE:
+		case VOP_CHIL:
+			found = (chk->ttype == 'I' && is_live('I', chk->to));
+			if (!found) {
+				needfix=TRUE;
+				if (chk->op == VOP_HUSB)
+					report_error(ERR_BADHUSBREF
+						, _("Bad HUSB reference (%s) in family %s")
+						, target, key);
+				else if (chk->op == VOP_WIFE)
+					report_error(ERR_BADWIFEREF
+						, _("Bad wife reference (%s) in family %s")
+						, target, key);
+				else
+					report_error(ERR_BADCHILDREF
+						, _("Bad child reference (%s) in family %s")
+						, target, key);
+			} else if (chk->op == VOP_CHIL) {
+				if (!has_link(VL_FAMC, chk->to, chk->from))
+					report_error(ERR_EXTRACHILD
+						, _("Improper child: Child (%s) without FAMC reference to family (%s)")
+						, target, key);
+			} else if (!has_link(VL_FAMS, chk->to, chk->from)) {
+				if (chk->op == VOP_HUSB)
+					report_error(ERR_EXTRAHUSB
+						, _("Improper HUSB (%s) in family (%s)")
+						, target, key);
+				else
+					report_error(ERR_EXTRAWIFE
+						, _("Improper wife (%s) in family (%s)")
+						, target, key);
+			}
+			break;
+		case VOP_EMPTYFAM:
+			report_error(ERR_EMPTYFAM, _("Empty family (%s)"), key);
+			break;
+		case VOP_SOLOFAM:
+			report_error(ERR_SOLOFAM, _("Single person family (%s)"), key);
+			break;
+		case VOP_POINTER:
+			if (!chk->ttype || !is_live(chk->ttype, chk->to)) {
+				report_error(ERR_BADPOINTER
+					, _("Bad pointer (in %s): %s")
+					, key, chk->text);
+			}
+			break;
+		}
+	}
+}
+/*=================================
+ * has_link -- Did verify pass see this lineage link ?
+ *  kind: [IN]  VL_ kind of link
+ *  from: [IN]  key number of record holding link
+ *  to:   [IN]  key number link points to
+ *================================*/
+static BOOLEAN
+has_link (INT kind, INT from, INT to)
+{
+	VLINKS * links = &vlinks[kind];
+	INT lo=0, hi=links->count;
+	/* links are in order of from (records are read in key order) */
+	while (lo < hi) {
+		INT mid = lo + (hi-lo)/2;
+		if (links->from[mid] < from)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	for ( ; lo < links->count && links->from[lo] == from; ++lo) {
+		if (links->to[lo] == to)
+			return TRUE;
+	}
+	return FALSE;
+}
+/*=================================
+ * indi_has_name -- Did verify pass see this NAME
+ *  in this person ?
+ *================================*/
+static BOOLEAN
+indi_has_name (INT keynum, CNSTRING name)
+{
+	INT lo=0, hi=vnnames;
+	/* names are in order of person (records are read in key order) */
+	while (lo < hi) {
+		INT mid = lo + (hi-lo)/2;
+		if (vnames[mid].keynum < keynum)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	for ( ; lo < vnnames && vnames[lo].keynum == keynum; ++lo) {
+		if (eqstr(vnames[lo].name, name))
+			return TRUE;
+	}
+	return FALSE;
+}
+/*=================================
+ * parse_key -- Parse a record key (eg, I12)
+ *  key:   [IN]  key to parse (may be NULL)
+ *  ptype: [OUT] type of record (I, F, S, E, X)
+ *  pnum:  [OUT] key number
+ * returns FALSE if not a record key in canonical form
+ *================================*/
+static BOOLEAN
+parse_key (CNSTRING key, char * ptype, INT * pnum)
+{
+	CNSTRING p;
+	INT num=0;
+	if (!key || !key[0] || !strchr(vtypes, key[0]))
+		return FALSE;
+	if (key[1] < '1' || key[1] > '9')
+		return FALSE;
+	for (p = key+1; *p; ++p) {
+		if (*p < '0' || *p > '9' || p-key >= MAXKEYWIDTH)
+			return FALSE;
+		num = num*10 + (*p - '0');
+	}
+	*ptype = key[0];
+	*pnum = num;
+	return TRUE;
+}
+/*=================================
+ * get_state -- Get VK_ state of a record key
+ *  grow: [IN]  whether to make room for key (else NULL)
+ *================================*/
+static char *
+get_state (char ntype, INT keynum, BOOLEAN grow)
+{
+	INT t = strchr(vtypes, ntype) - vtypes;
+	if (keynum >= vnstates[t]) {
+		INT newnum = vnstates[t] ? vnstates[t] : 1024;
+		char * newstates;
+		if (!grow) return NULL;
+		while (newnum <= keynum)
+			newnum *= 2;
+		newstates = (char *)stdalloc(newnum); /* zeroed, VK_NONE */
+		if (vnstates[t])
+			memcpy(newstates, vstates[t], vnstates[t]);
+		stdfree(vstates[t]);
+		vstates[t] = newstates;
+		vnstates[t] = newnum;
+	}
+	return &vstates[t][keynum];
+}
+/*=================================
+ * is_live -- Did verify pass see this record ?
+ *================================*/
+static BOOLEAN
+is_live (char ntype, INT keynum)
+{
+	char * state = get_state(ntype, keynum, FALSE);
+	return state && *state == VK_LIVE;
+}
+/*=================================
+ * is_live_key -- Did verify pass see this record,
+ *  of this type ?
+ *  key:   [IN]  key to check (may be NULL)
+ *  ntype: [IN]  type record must have
+ *================================*/
+static BOOLEAN
+is_live_key (CNSTRING key, char ntype)
+{
+	char ktype=0;
+	INT keynum=0;
+	return parse_key(key, &ktype, &keynum) && ktype == ntype
+		&& is_live(ktype, keynum);
+}
+/*=================================
+ * is_checked -- Is user checking this type of record ?
+ *================================*/
+static BOOLEAN
+is_checked (char ntype)
+{
+	switch (ntype) {
+	case 'I': return todo.check_indis;
+	case 'F': return todo.check_fams;
+	case 'S': return todo.check_sours;
+	case 'E': return todo.check_evens;
+	case 'X': return todo.check_othes;
+	}
+	return FALSE;
 }
 /*=================================
  * check_and_fix_records -- 
+ *  (using what verify pass saw)
  *================================*/
 static void
 check_and_fix_records (void)
 {
+	INT i;
 	tofix = create_list();
-	todo.pass = 1;
-	check_nodes();
-	todo.pass = 2;
+	resolve_checks();
+	/* check what we saw against delete sets */
+	for (i=0; vtypes[i]; i++) {
+		if (is_checked(vtypes[i]))
+			check_set(vtypes[i]);
+	}
 	fix_nodes();
 	destroy_empty_list(tofix);
 }
 /*=================================
  * fix_nodes -- Fix all nodes on fix list
- *  (uses list from check_nodes)
+ *  (uses list from resolve_checks)
  *================================*/
 static void
 fix_nodes (void)
@@ -589,30 +1141,9 @@ fix_nodes (void)
 		unlock_record_from_cache(rec);
 	}
 }
-/*=============================================
- * nodes_callback -- callback for node traversal
- *  for checking indis, fams, sours, evens, othes
- * Created: 2001/01/14, Perry Rapp
- *===========================================*/
-static BOOLEAN
-nodes_callback(TRAV_RECORDS_FUNC_ARGS(key, rec, param))
-{
-	param=param;	/* NOTUSED */
-	if (noisy)
-		report_progress("Node: %s", key);
-	switch (key[0]) {
-	case 'I': return todo.check_indis ? check_indi((CNSTRING)key, (RECORD)rec) : TRUE;
-	case 'F': return todo.check_fams ? check_fam((CNSTRING)key, (RECORD)rec) : TRUE;
-	case 'S': return todo.check_sours ? check_sour((CNSTRING)key, (RECORD)rec) : TRUE;
-	case 'E': return todo.check_evens ? check_even((CNSTRING)key, (RECORD)rec) : TRUE;
-	case 'X': return todo.check_othes ? check_othe((CNSTRING)key, (RECORD)rec) : TRUE;
-	}
-	ASSERT(0); /* traverse_db_key_recs is broken */
-	return TRUE;
-}
 /*=====================================
  * process_record -- process record
- *  Called during pass2 (fix)
+ *  Called to fix records found by checks
  *===================================*/
 static void
 process_record (RECORD rec)
@@ -624,36 +1155,8 @@ process_record (RECORD rec)
 	}
 }
 /*=====================================
- * check_indi -- check indi record
- *  and record any records needing fixing
- *  in tofix list
- *===================================*/
-static BOOLEAN
-check_indi (CNSTRING key, RECORD rec)
-{
-	static char prevkey[MAXKEYWIDTH+1];
-	CACHEEL icel1=0;
-	RECORD recx=0;
-
-	if (eqstr(key, prevkey)) {
-		report_error(ERR_DUPINDI, _("Duplicate individual for %s"), key);
-	}
-	icel1 = indi_to_cacheel(rec);
-	lock_cache(icel1);
-
-	recx = get_record_for_cel(icel1);
-	ASSERT(todo.pass == 1);
-	process_indi(recx);
-
-	unlock_cache(icel1);
-	check_pointers(key, rec);
-	append_indiseq_null(seq_indis, strsave(key), NULL, TRUE, TRUE);
-	release_record(recx);
-	return TRUE;
-}
-/*=====================================
- * process_indi -- process indi record
- *  checking in pass 1, fixing in pass 2
+ * process_indi -- fix indi record
+ *  (lineage links resolve_checks found bad)
  *===================================*/
 static void
 process_indi (RECORD rec)
@@ -662,54 +1165,21 @@ process_indi (RECORD rec)
 	NODE name1, refn1, sex1, body1, famc1, fams1;
 	NODE node1;
 	BOOLEAN altered=FALSE;
-	BOOLEAN needfix=FALSE;
 	CNSTRING key = nzkey(rec);
 
 	indi0 = nztop(rec);
-	if (todo.pass==1) {
-		indi1 = indi0;
-	} else {
-		indi1 = copy_node_subtree(indi0);
-	}
+	indi1 = copy_node_subtree(indi0);
 	split_indi_old(indi1, &name1, &refn1, &sex1, &body1, &famc1, &fams1);
 
-	if (todo.pass == 1) {
-		/* check names */
-		for (node1 = name1; node1; node1 = nsibling(node1)) {
-			STRING name=nval(node1);
-			if (!valid_name(name)) {
-				report_error(ERR_BADNAME, _("Bad name for individual %s: %s"), key, name);
-			} else {
-			/* TO DO: verify that name is in db */
-			}
-		}
-		/* check refns */
-		for (node1 = refn1; node1; node1 = nsibling(node1)) {
-			/* STRING refn=nval(node1); */
-			/* TO DO: verify that refn is in db */
-		}
-	}
-
 	/* check parents */
 	for (node1 = famc1; node1; node1 = nsibling(node1)) {
 		STRING famkey=rmvat(nval(node1));
-		NODE fam2 = qkey_to_fam(famkey);
-		if (!fam2) {
-			if (todo.pass == 1) {
-				report_error(ERR_BADFAMREF, _("Bad family reference (%s) individual %s"), famkey, key);
-			}
-		} else {
-			/* look for indi1 (key) in fam2's children */
-			if (!find_xref(key, fam2, "CHIL", NULL)) {
-				if (todo.pass == 1) {
-					report_error(ERR_MISSINGCHILD, _("Missing child (%s) in family (%s)"), key, famkey);
-					needfix=TRUE;
-				} else {
-					if (fix_bad_pointer(key, rec, node1)) {
-						report_fix(ERR_MISSINGCHILD, _("Fixed missing child (%s) in family (%s)"), key, famkey);
-						altered=TRUE;
-					}
-				}
+		NODE fam2 = is_live_key(famkey, 'F') ? qkey_to_fam(famkey) : NULL;
+		/* look for indi1 (key) in fam2's children */
+		if (fam2 && !find_xref(key, fam2, "CHIL", NULL)) {
+			if (fix_bad_pointer(key, rec, node1)) {
+				report_fix(ERR_MISSINGCHILD, _("Fixed missing child (%s) in family (%s)"), key, famkey);
+				altered=TRUE;
 			}
 		}
 	}
@@ -717,23 +1187,12 @@ process_indi (RECORD rec)
 	/* check spouses */
 	for (node1 = fams1; node1; node1 = nsibling(node1)) {
 		STRING famkey=rmvat(nval(node1));
-		NODE fam2 = qkey_to_fam(famkey);
-		if (!fam2) {
-			if (todo.pass == 1) {
-				report_error(ERR_BADFAMREF, _("Bad family reference (%s) individual %s"), famkey, key);
-			}
-		} else {
-			/* look for indi1 (key) in fam2's spouses */
-			if (!find_xref(key, fam2, "HUSB", "WIFE")) {
-				if (todo.pass == 1) {
-					report_error(ERR_MISSINGSPOUSE, _("Missing spouse (%s) in family (%s)"), key, famkey);
-					needfix=TRUE;
-				} else {
-					if (fix_bad_pointer(key, rec, node1)) {
-						report_fix(ERR_MISSINGSPOUSE, _("Fixed missing spouse (%s) in family (%s)"), key, famkey);
-						altered=TRUE;
-					}
-				}
+		NODE fam2 = is_live_key(famkey, 'F') ? qkey_to_fam(famkey) : NULL;
+		/* look for indi1 (key) in fam2's spouses */
+		if (fam2 && !find_xref(key, fam2, "HUSB", "WIFE")) {
+			if (fix_bad_pointer(key, rec, node1)) {
+				report_fix(ERR_MISSINGSPOUSE, _("Fixed missing spouse (%s) in family (%s)"), key, famkey);
+				altered=TRUE;
 			}
 		}
 	}
@@ -746,42 +1205,13 @@ process_indi (RECORD rec)
 
 		/* write to database */
 		replace_indi(indi0, indi1);
-
-	} else if (needfix) {
-		enqueue_list(tofix, strsave(key));
-	}
-}
-/*=====================================
- * check_fam -- check family record
- *  and record any records needing fixing
- *  in tofix list
- *===================================*/
-static BOOLEAN
-check_fam (CNSTRING key, RECORD rec)
-{
-	static char prevkey[MAXKEYWIDTH+1]="";
-	CACHEEL fcel1=0;
-	RECORD recx=0;
-
-	if (eqstr(key, prevkey)) {
-		report_error(ERR_DUPFAM, _("Duplicate family for %s"), key);
+	} else {
+		free_nodes(indi1);
 	}
-	
-	fcel1 = fam_to_cacheel(rec);
-	lock_cache(fcel1);
-
-	recx = get_record_for_cel(fcel1);
-	ASSERT(todo.pass == 1);
-	process_fam(recx);
-
-	unlock_cache(fcel1);
-	check_pointers(key, rec);
-	append_indiseq_null(seq_fams, strsave(key), NULL, TRUE, TRUE);
-	return TRUE;
 }
 /*=====================================
- * process_fam -- process indi record
- *  checking in pass 1, fixing in pass 2
+ * process_fam -- fix family record
+ *  (lineage links resolve_checks found bad)
  *===================================*/
 static void
 process_fam (RECORD rec)
@@ -789,116 +1219,44 @@ process_fam (RECORD rec)
 	NODE fam0, fam1;
 	NODE fref1, husb1, wife1, chil1, rest1;
 	NODE node1;
-	INT members = 0;
 	BOOLEAN altered=FALSE;
-	BOOLEAN needfix=FALSE;
 	CNSTRING key = nzkey(rec);
 
 	fam0 = nztop(rec);
-	if (todo.pass==1) {
-		fam1 = fam0;
-	} else {
-		fam1 = copy_node_subtree(fam0);
-	}
+	fam1 = copy_node_subtree(fam0);
 	split_fam(fam1, &fref1, &husb1, &wife1, &chil1, &rest1);
 
-	/* check refns */
-	for (node1 = fref1; node1; node1 = nsibling(node1)) {
-		/* STRING refn=nval(node1); */
-		/* TO DO: verify that refn is in db */
-	}
 	/* check husbs */
 	for (node1 = husb1; node1; node1 = nsibling(node1)) {
 		STRING husbkey=rmvat(nval(node1));
-		NODE husb = qkey_to_indi(husbkey);
-		members++;
-		if (!husb) {
-			if (todo.pass == 1) {
-				report_error(ERR_BADHUSBREF
-					, _("Bad HUSB reference (%s) in family %s")
-					, husbkey, key);
-				needfix=TRUE;
-			} else {
-				if (fix_bad_pointer(key, rec, node1)) {
-					report_fix(ERR_BADHUSBREF
-						, _("Fixed Bad HUSB reference (%s) in family %s")
-						, husbkey, key);
-					altered=TRUE;
-				}
-			}
-		} else {
-			/* look for family (key) in husb */
-			if (!find_xref(key, husb, "FAMS", NULL)) {
-				report_error(ERR_EXTRAHUSB
-					, _("Improper HUSB (%s) in family (%s)")
-					, husbkey, key);
-			}
+		if (!is_live_key(husbkey, 'I') && fix_bad_pointer(key, rec, node1)) {
+			report_fix(ERR_BADHUSBREF
+				, _("Fixed Bad HUSB reference (%s) in family %s")
+				, printkey(husbkey), key);
+			altered=TRUE;
 		}
 	}
 	/* check wives */
 	for (node1 = wife1; node1; node1 = nsibling(node1)) {
 		STRING wifekey=rmvat(nval(node1));
-		NODE wife = qkey_to_indi(wifekey);
-		members++;
-		if (!wife) {
-			if (todo.pass == 1) {
-				report_error(ERR_BADWIFEREF
-					, _("Bad wife reference (%s) in family %s")
-					, wifekey, key);
-				needfix=TRUE;
-			} else {
-				if (fix_bad_pointer(key, rec, node1)) {
-					report_fix(ERR_BADWIFEREF
-						, _("Fixed Bad wife reference (%s) in family %s")
-						, printkey(wifekey), key);
-					altered=TRUE;
-				}
-			}
-		} else {
-			/* look for family (key) in wife */
-			if (!find_xref(key, wife, "FAMS", NULL)) {
-				report_error(ERR_EXTRAWIFE
-					, _("Improper wife (%s) in family (%s)")
-					, printkey(wifekey), key);
-			}
+		if (!is_live_key(wifekey, 'I') && fix_bad_pointer(key, rec, node1)) {
+			report_fix(ERR_BADWIFEREF
+				, _("Fixed Bad wife reference (%s) in family %s")
+				, printkey(wifekey), key);
+			altered=TRUE;
 		}
 	}
 	/* check children */
 	for (node1 = chil1; node1; node1 = nsibling(node1)) {
 		STRING chilkey=rmvat(nval(node1));
-		NODE child = qkey_to_indi(chilkey);
-		members++;
-		if (!child) {
-			if (todo.pass == 1) {
-				report_error(ERR_BADCHILDREF
-					, _("Bad child reference (%s) in family %s")
-					, printkey(chilkey), key);
-				needfix=TRUE;
-			} else {
-				if (fix_bad_pointer(key, rec, node1)) {
-					report_fix(ERR_BADCHILDREF
-						, _("Fixed bad child reference (%s) in family %s")
-						, printkey(chilkey), key);
-					altered=TRUE;
-				}
-			}
-		} else {
-			/* look for family (key) in child */
-			if (!find_xref(key, child, "FAMC", NULL)) {
-				report_error(ERR_EXTRACHILD
-					, _("Improper child: Child (%s) without FAMC reference to family (%s)")
-					, printkey(chilkey), key);
-			}
+		if (!is_live_key(chilkey, 'I') && fix_bad_pointer(key, rec, node1)) {
+			report_fix(ERR_BADCHILDREF
+				, _("Fixed bad child reference (%s) in family %s")
+				, printkey(chilkey), key);
+			altered=TRUE;
 		}
 	}
 	join_fam(fam1, fref1, husb1, wife1, chil1, rest1);
-	/* check for undersized family */
-	if (!members) {
-		report_error(ERR_EMPTYFAM, _("Empty family (%s)"), key);
-	} else if (members == 1) {
-		report_error(ERR_SOLOFAM, _("Single person family (%s)"), key);
-	}
-
 
 	if (altered) {
 		/* must normalize, as some lineage references may have been 
@@ -907,58 +1265,9 @@ process_fam (RECORD rec)
 
 		/* write to database */
 		replace_fam(fam0, fam1);
-
-	} else if (needfix) {
-		enqueue_list(tofix, strsave(key));
-	}
-}
-/*=====================================
- * check_sour -- process sour record
- *  checking and/or fixing as requested
- * Created: 2001/01/14, Perry Rapp
- *===================================*/
-static BOOLEAN
-check_sour (CNSTRING key, RECORD rec)
-{
-	static char prevkey[MAXKEYWIDTH+1];
-	if (!strcmp(key, prevkey)) {
-		report_error(ERR_DUPSOUR, _("Duplicate source for %s"), key);
-	}
-	check_pointers(key, rec);
-	append_indiseq_null(seq_sours, strsave(key), NULL, TRUE, TRUE);
-	return TRUE;
-}
-/*=====================================
- * check_even -- process even record
- *  checking and/or fixing as requested
- * Created: 2001/01/14, Perry Rapp
- *===================================*/
-static BOOLEAN
-check_even (CNSTRING key, RECORD rec)
-{
-	static char prevkey[MAXKEYWIDTH+1];
-	if (!strcmp(key, prevkey)) {
-		report_error(ERR_DUPEVEN, _("Duplicate event for %s"), key);
+	} else {
+		free_nodes(fam1);
 	}
-	check_pointers(key, rec);
-	append_indiseq_null(seq_evens, strsave(key), NULL, TRUE, TRUE);
-	return TRUE;
-}
-/*=====================================
- * check_othe -- process othe record
- *  checking and/or fixing as requested
- * Created: 2001/01/14, Perry Rapp
- *===================================*/
-static BOOLEAN
-check_othe (CNSTRING key, RECORD rec)
-{
-	static char prevkey[MAXKEYWIDTH+1];
-	if (!strcmp(key, prevkey)) {
-		report_error(ERR_DUPOTHE, _("Duplicate record for %s"), key);
-	}
-	check_pointers(key, rec);
-	append_indiseq_null(seq_othes, strsave(key), NULL, TRUE, TRUE);
-	return TRUE;
 }
 /*===================================
  * find_xref -- Search node for a cross-reference key
@@ -986,55 +1295,6 @@ exit_find:
 	unlock_cache(ncel2);
 	return found;
 }
-/*=====================================
- * check_pointers -- check record for bad pointers
- *  and bad levels
- * 2001/01/21, Perry Rapp
- *===================================*/
-static void
-check_pointers (CNSTRING key, RECORD rec)
-{
-	check_node(key, nztop(rec), 0);
-}
-/*=====================================
- * check_node -- check node for bad pointers
- *  and bad levels, and continue traverse
- * 2001/02/18, Perry Rapp
- *===================================*/
-static void
-check_node (CNSTRING n0key, NODE node, INT level)
-{
-	BOOLEAN lineage=FALSE;
-	/* ignore lineage links - they are checked elsewhere */
-	if (level==1) {
-		INT i;
-		for (i=0; i<ARRSIZE(lineage_tags); i++) {
-			if (eqstr(ntag(node), lineage_tags[i])) {
-				lineage=TRUE;
-				break;
-			}
-		}
-	}
-	/*
-	TO DO: How do we tell non-pointers that *ought* to
-	be pointers, eg "1 SOUR <FamilyHistory>" ?
-	*/
-	if (!lineage) {
-		STRING skey = rmvat(nval(node));
-		if (skey) {
-			NODE xnode = qkey_to_type(skey);
-			if (!xnode) {
-				report_error(ERR_BADPOINTER
-					, _("Bad pointer (in %s): %s")
-					, n0key, nval(node));
-			}
-		}
-	}
-	if (nchild(node))
-		check_node(n0key, nchild(node), level+1);
-	if (nsibling(node))
-		check_node(n0key, nsibling(node), level);
-}
 /*===================================
  * fix_bad_pointer -- Fix bad pointer if requested
  *=================================*/
@@ -1051,17 +1311,20 @@ fix_bad_pointer (CNSTRING key, RECORD rec, NODE node)
 	return FALSE;
 }
 /*===================================
- * check_set -- Validate set of nodes
+ * check_set -- Validate records of one type
+ *  (that verify pass saw) against delete set
  * Created: 2001/01/14, Perry Rapp
  *=================================*/
 static void
-check_set (INDISEQ seq, char ctype)
+check_set (char ctype)
 {
-	INT i=0;
-	keysort_indiseq(seq); /* spri now valid */
+	INT i=0, keynum;
+	INT t = strchr(vtypes, ctype) - vtypes;
 	i = xref_next(ctype, i);
-	FORINDISEQ(seq, el, num)
-		while (i<element_ikey(el)) {
+	for (keynum=1; keynum<vnstates[t]; keynum++) {
+		if (vstates[t][keynum] != VK_LIVE)
+			continue;
+		while (i && i<keynum) {
 			report_error(ERR_UNDELETED
 				, _("Missing undeleted record %c%d")
 				, ctype, i);
@@ -1080,11 +1343,12 @@ check_set (INDISEQ seq, char ctype)
 			}
 			i = xref_next(ctype, i);
 		}
-		if (i == element_ikey(el)) {
+		if (i == keynum) {
 			/* in synch */
 			i = xref_next(ctype, i);
-		} else { /* spri(el) < i */
-			CNSTRING key = element_skey(el);
+		} else { /* keynum < i, or past last xref */
+			char key[33];
+			sprintf(key, "%c%d", ctype, keynum);
 			report_error(ERR_DELETED
 				, _("Delete set contains valid record %s")
 				, key);
@@ -1099,9 +1363,9 @@ check_set (INDISEQ seq, char ctype)
 						, key);
 				}
 			}
-			/* fall thru and only advance seq */
+			/* fall thru and only advance keynum */
 		}
-	ENDINDISEQ
+	}
 }
 /*=========================================
  * check_btree -- Validate btree itself
@@ -1197,7 +1461,7 @@ check_keys (BLOCK block, RKEY * lo, RKEY * hi)
 	for (i=start ; i <= n; i++) {
 		if (i==start && lo) {
 			INT rel = cmpkeys(lo, &rkeys(block, i));
-			if (rel < 0) {
+			if (rel > 0) {
 				printf(_("First key in block below parent's limit\n"));
 				printblock(block);
 				ok = FALSE;
@@ -1270,6 +1534,7 @@ check_missing_data_records (void)
 /*=========================================
  * check_typed_missing_data_records -- Check all records 
  *  of specified type for orphans
+ *  (keys verify pass saw, but without live data)
  *=======================================*/
 static void
 check_typed_missing_data_records (char ntype)
@@ -1277,19 +1542,18 @@ check_typed_missing_data_records (char ntype)
 	int keynum=0;
 	while (TRUE) {
 		char key[33];
+		char * state;
 		keynum = xref_next(ntype, keynum);
 		if (!keynum) return;
 		sprintf(key, "%c%d", ntype, keynum);
 		if (noisy)
 			report_progress("Check data record presence: %s", key);
-		if (is_record_missing_data_entry(key)) {
-			if (todo.pass == 1) {
-				report_error(ERR_MISSINGREC, _("Missing data record (%s)"), key);
-			} else {
-				if (todo.fix_missing_data_records) {
-					delete_record_missing_data_entry(key);
-					report_fix(ERR_MISSINGREC, _("Fixed missing data record (%s)"), key);
-				}
+		state = get_state(ntype, keynum, FALSE);
+		if (state && *state == VK_EMPTY) {
+			report_error(ERR_MISSINGREC, _("Missing data record (%s)"), key);
+			if (todo.fix_missing_data_records) {
+				delete_record_missing_data_entry(key);
+				report_fix(ERR_MISSINGREC, _("Fixed missing data record (%s)"), key);
 			}
 		}
 	}
@@ -1429,10 +1693,19 @@ main (int argc, char **argv)
 		todo.find_ghosts=TRUE;
 	}
 
+	if (todo.find_ghosts || todo.fix_ghosts
+		|| todo.check_indis
+		|| todo.check_fams
+		|| todo.check_sours
+		|| todo.check_evens
+		|| todo.check_othes
+		|| todo.check_missing_data_records) {
+		verify_pass();
+	}
+
 	if (todo.find_ghosts || todo.fix_ghosts)
 		check_ghosts();
 
-
 	if (!(bwrite(BTR))) {
 		todo.fix_alter_pointers = FALSE;
 		todo.fix_ghosts = FALSE;
@@ -1450,6 +1723,7 @@ main (int argc, char **argv)
 		check_missing_data_records();
 	}
 
+	free_verify_pass();
 	report_results();
 
 	closebtree(BTR);
@@ -41,7 +41,7 @@ BOOLEAN writeable = FALSE;      /* normally defined in liflines/main.c */
 BOOLEAN immutable = FALSE;  /* normally defined in liflines/main.c */
 int opt_finnish = 0;
 int opt_mychar = 0;
-BTREE BTR;
+extern BTREE BTR; /* defined in gedlib/lldatabase.c */
 
 /*==================================
  * work -- what the user wants to do
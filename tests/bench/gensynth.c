@@ -0,0 +1,430 @@
+/*=============================================================
+ * gensynth.c -- Write a synthetic GEDCOM file for benchmarks
+ *  usage: gensynth [-n individuals] [-s seed] [-o file]
+ *  Families are grown generation by generation from a set of
+ *  founders: most people marry (some twice) someone from
+ *  outside the tree and have a few children, so the file has
+ *  lines of descent some ten generations deep, as a real
+ *  database does.
+ *  Surnames, given names and places follow a skewed (Zipf
+ *  like) distribution, with a long tail of rare surnames;
+ *  about a third of people have a note, mostly short but a
+ *  few several kilobytes long.
+ *  The same seed always gives the same file, on any platform.
+ *  This is standalone, so it does not use the lifelines libraries.
+ *===========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*********************************************
+ * local types
+ *********************************************/
+
+typedef struct {
+	long famc;     /* family as child (-1 if none) */
+	long fams[2];  /* families as spouse (-1 if none) */
+	int surname;   /* surname rank */
+	short given;   /* given name rank */
+	short middle;  /* middle name rank (-1 if none) */
+	short year;    /* birth year */
+	short place;   /* birth place rank */
+	char sex;      /* 'M' or 'F' */
+} PERSON;
+
+typedef struct {
+	long husb;
+	long wife;
+	short year;    /* marriage year */
+	short place;   /* marriage place rank */
+} FAMILY;
+
+/*********************************************
+ * local function prototypes
+ *********************************************/
+
+/* alphabetical */
+static long add_family(long husb, long wife, int year);
+static long add_person(char sex, int surname, int year, long famc);
+static unsigned long next_random(void);
+static int random_below(int n);
+static int random_zipf(int n);
+static void usage(void);
+static void write_family(FILE *fp, long f);
+static void write_note(FILE *fp, int level, int len);
+static void write_person(FILE *fp, long i);
+static void write_surname(FILE *fp, int rank);
+
+/*********************************************
+ * local variables
+ *********************************************/
+
+/* common names; ranks past these get made up surnames */
+static const char *surnames[] = {
+	"Smith", "Johnson", "Williams", "Brown", "Jones", "Miller", "Davis",
+	"Garcia", "Wilson", "Anderson", "Taylor", "Thomas", "Moore", "Martin",
+	"Jackson", "Thompson", "White", "Harris", "Clark", "Lewis", "Robinson",
+	"Walker", "Young", "Allen", "King", "Wright", "Scott", "Hill", "Green",
+	"Adams", "Baker", "Nelson", "Carter", "Mitchell", "Roberts", "Turner",
+	"Phillips", "Campbell", "Parker", "Evans", "Edwards", "Collins",
+	"Stewart", "Morris", "Murphy", "Cook", "Rogers", "Morgan", "Cooper",
+	"Peterson", "Reed", "Bailey", "Bell", "Kelly", "Howard", "Ward", "Cox",
+	"Richardson", "Wood", "Watson", "Brooks", "Bennett", "Gray", "Hughes",
+	"Price", "Sanders", "Myers", "Long", "Ross", "Foster", "Nilsson",
+	"Virtanen", "Schmidt", "Muller", "Dubois", "Rossi", "Jansen", "Novak"
+};
+static const char *syllables[] = {
+	"al", "ber", "cor", "dan", "el", "fen", "gar", "hol", "in", "jor",
+	"kel", "lin", "mar", "nor", "os", "per", "quin", "ros", "sten", "tor",
+	"ul", "ver", "win", "york", "zan", "beck", "dorf", "ham", "ley", "ton"
+};
+static const char *male_names[] = {
+	"John", "William", "James", "George", "Charles", "Thomas", "Henry",
+	"Joseph", "Robert", "Edward", "Samuel", "David", "Richard", "Peter",
+	"Frederick", "Walter", "Arthur", "Albert", "Francis", "Harry", "Daniel",
+	"Benjamin", "Isaac", "Jacob", "Andrew", "Michael", "Matthew", "Hugh",
+	"Lars", "Johan", "Karl", "Olof", "Anders", "Erik", "Nils", "Pierre"
+};
+static const char *female_names[] = {
+	"Mary", "Elizabeth", "Sarah", "Margaret", "Anna", "Catherine", "Jane",
+	"Ann", "Emma", "Alice", "Martha", "Ellen", "Hannah", "Frances", "Susan",
+	"Eliza", "Clara", "Lucy", "Emily", "Rose", "Agnes", "Julia", "Louisa",
+	"Harriet", "Maria", "Caroline", "Charlotte", "Edith", "Florence",
+	"Kristina", "Ingrid", "Karin", "Greta", "Marie", "Sophie", "Helena"
+};
+static const char *places[] = {
+	"London, England", "York, England", "Bristol, England",
+	"Edinburgh, Scotland", "Glasgow, Scotland", "Dublin, Ireland",
+	"Cork, Ireland", "Boston, Massachusetts", "Salem, Massachusetts",
+	"Hartford, Connecticut", "Albany, New York", "Philadelphia, Pennsylvania",
+	"Lancaster, Pennsylvania", "Baltimore, Maryland", "Richmond, Virginia",
+	"Charleston, South Carolina", "Savannah, Georgia", "Cincinnati, Ohio",
+	"Chicago, Illinois", "Stockholm, Sweden", "Uppsala, Sweden",
+	"Turku, Finland", "Hamburg, Germany", "Lyon, France", "Quebec, Canada"
+};
+static const char *months[] = {
+	"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+	"JUL", "AUG", "SEP", "OCT", "NOV", "DEC"
+};
+static const char *words[] = {
+	"the", "family", "lived", "at", "farm", "near", "church", "was",
+	"baptized", "in", "parish", "register", "records", "show", "that",
+	"he", "she", "moved", "to", "town", "with", "her", "his", "children",
+	"after", "death", "of", "father", "mother", "land", "sold", "year",
+	"census", "lists", "occupation", "as", "weaver", "miller", "smith",
+	"and", "later", "emigrated", "from", "port", "on", "ship"
+};
+
+#define NSURNAMES 50000   /* surname ranks, most made up */
+#define ARRSIZE(a) ((int)(sizeof(a)/sizeof(a[0])))
+
+static PERSON *persons = 0;
+static long npersons = 0, maxpersons = 0;
+static FAMILY *families = 0;
+static long nfamilies = 0, maxfamilies = 0;
+static long nsources = 0;
+static unsigned long rstate = 1;
+
+/*********************************************
+ * local function definitions
+ * body of module
+ *********************************************/
+
+/*==================================
+ * main -- Grow tree, then write it out
+ *================================*/
+int
+main (int argc, char **argv)
+{
+	long target = 100000, i, next;
+	unsigned long seed = 1;
+	const char *outname = 0;
+	FILE *fp = stdout;
+
+	for (i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-n") && i+1 < argc)
+			target = atol(argv[++i]);
+		else if (!strcmp(argv[i], "-s") && i+1 < argc)
+			seed = strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "-o") && i+1 < argc)
+			outname = argv[++i];
+		else {
+			usage();
+			return 10;
+		}
+	}
+	if (target < 2) target = 2;
+	rstate = seed ? seed : 1;
+
+	maxpersons = target;
+	persons = (PERSON *)malloc(maxpersons * sizeof(PERSON));
+	maxfamilies = target/2 + 16;
+	families = (FAMILY *)malloc(maxfamilies * sizeof(FAMILY));
+	if (!persons || !families) {
+		fprintf(stderr, "gensynth: out of memory for %ld individuals\n", target);
+		return 20;
+	}
+	nsources = target/1000 + 1;
+
+	/* founders, born over half a century */
+	for (i = 0; i < target/200 + 1; ++i) {
+		add_person(random_below(2) ? 'M' : 'F', random_zipf(NSURNAMES)
+			, 1600 + random_below(50), -1);
+	}
+	/* each person in turn may marry & have children, until full */
+	next = 0;
+	while (npersons < target) {
+		PERSON *p;
+		long spouse, f;
+		int nmarr, m;
+		if (next == npersons) {
+			/* all lines died out, so add a founder */
+			add_person(random_below(2) ? 'M' : 'F', random_zipf(NSURNAMES)
+				, 1600 + random_below(50), -1);
+		}
+		p = &persons[next];
+		if (p->fams[0] >= 0) {
+			/* married in, so already has family */
+			++next;
+			continue;
+		}
+		nmarr = random_below(100) < 80 ? 1 : 0;
+		if (nmarr && random_below(100) < 8)
+			nmarr = 2;
+		for (m = 0; m < nmarr && npersons < target; ++m) {
+			int year = p->year + 18 + random_below(15) + 8*m;
+			int nkids;
+			spouse = add_person(p->sex == 'M' ? 'F' : 'M', random_zipf(NSURNAMES)
+				, p->year - 5 + random_below(10), -1);
+			p = &persons[next];
+			f = (p->sex == 'M') ? add_family(next, spouse, year)
+				: add_family(spouse, next, year);
+			/* mostly 0 to 4 children, occasionally up to 8 */
+			nkids = random_below(3) + random_below(3);
+			if (random_below(10) == 0)
+				nkids += random_below(5);
+			while (nkids-- > 0 && npersons < target) {
+				int surname = persons[families[f].husb].surname;
+				add_person(random_below(2) ? 'M' : 'F', surname
+					, year + 1 + random_below(20), f);
+			}
+		}
+		++next;
+	}
+
+	if (outname && !(fp = fopen(outname, "w"))) {
+		fprintf(stderr, "gensynth: cannot create %s\n", outname);
+		return 30;
+	}
+	fprintf(fp, "0 HEAD\n1 SOUR GENSYNTH\n1 DEST ANSTFILE\n"
+		"1 GEDC\n2 VERS 5.5\n2 FORM LINEAGE-LINKED\n1 CHAR ASCII\n"
+		"1 NOTE Synthetic benchmark data, %ld individuals, seed %lu\n"
+		, target, seed);
+	for (i = 0; i < npersons; ++i)
+		write_person(fp, i);
+	for (i = 0; i < nfamilies; ++i)
+		write_family(fp, i);
+	for (i = 0; i < nsources; ++i) {
+		fprintf(fp, "0 @S%ld@ SOUR\n1 TITL Parish register of %s, volume %ld\n"
+			, i+1, places[random_zipf(ARRSIZE(places))], i+1);
+		fprintf(fp, "1 AUTH Church of %s\n", places[random_zipf(ARRSIZE(places))]);
+	}
+	fprintf(fp, "0 TRLR\n");
+	if (fp != stdout && fclose(fp) != 0) {
+		fprintf(stderr, "gensynth: error writing %s\n", outname);
+		return 40;
+	}
+	free(persons);
+	free(families);
+	return 0;
+}
+/*==================================
+ * add_person -- Create person (not yet linked as spouse)
+ *  returns index of new person
+ *================================*/
+static long
+add_person (char sex, int surname, int year, long famc)
+{
+	PERSON *p = &persons[npersons];
+	p->sex = sex;
+	p->surname = surname;
+	p->given = (short)random_zipf(sex == 'M' ? ARRSIZE(male_names) : ARRSIZE(female_names));
+	p->middle = (short)(random_below(3) ? -1
+		: random_zipf(sex == 'M' ? ARRSIZE(male_names) : ARRSIZE(female_names)));
+	p->year = (short)year;
+	p->place = (short)random_zipf(ARRSIZE(places));
+	p->famc = famc;
+	p->fams[0] = p->fams[1] = -1;
+	return npersons++;
+}
+/*==================================
+ * add_family -- Create family & link spouses to it
+ *  returns index of new family
+ *================================*/
+static long
+add_family (long husb, long wife, int year)
+{
+	FAMILY *f = &families[nfamilies];
+	if (nfamilies == maxfamilies) {
+		maxfamilies *= 2;
+		families = (FAMILY *)realloc(families, maxfamilies * sizeof(FAMILY));
+		if (!families) {
+			fprintf(stderr, "gensynth: out of memory for families\n");
+			exit(20);
+		}
+		f = &families[nfamilies];
+	}
+	f->husb = husb;
+	f->wife = wife;
+	f->year = (short)year;
+	f->place = (short)random_zipf(ARRSIZE(places));
+	persons[husb].fams[persons[husb].fams[0] < 0 ? 0 : 1] = nfamilies;
+	persons[wife].fams[persons[wife].fams[0] < 0 ? 0 : 1] = nfamilies;
+	return nfamilies++;
+}
+/*==================================
+ * write_person -- Write INDI record
+ *================================*/
+static void
+write_person (FILE *fp, long i)
+{
+	PERSON *p = &persons[i];
+	const char **given = (p->sex == 'M') ? male_names : female_names;
+	int k;
+
+	fprintf(fp, "0 @I%ld@ INDI\n1 NAME %s", i+1, given[p->given]);
+	if (p->middle >= 0)
+		fprintf(fp, " %s", given[p->middle]);
+	fprintf(fp, " /");
+	write_surname(fp, p->surname);
+	fprintf(fp, "/\n1 SEX %c\n", p->sex);
+	fprintf(fp, "1 BIRT\n2 DATE %d %s %d\n2 PLAC %s\n"
+		, 1 + random_below(28), months[random_below(12)], p->year
+		, places[p->place]);
+	if (random_below(5) == 0)
+		fprintf(fp, "2 SOUR @S%ld@\n", 1 + (long)random_zipf((int)nsources));
+	if (p->year < 1930) {
+		fprintf(fp, "1 DEAT\n2 DATE %s%d\n"
+			, random_below(4) ? "" : "ABT ", p->year + 1 + random_below(85));
+	}
+	if (random_below(3) == 0) {
+		/* mostly short notes, a few long ones */
+		int len = 20 + random_zipf(4000);
+		write_note(fp, 1, len);
+	}
+	if (p->famc >= 0)
+		fprintf(fp, "1 FAMC @F%ld@\n", p->famc + 1);
+	for (k = 0; k < 2; ++k) {
+		if (p->fams[k] >= 0)
+			fprintf(fp, "1 FAMS @F%ld@\n", p->fams[k] + 1);
+	}
+}
+/*==================================
+ * write_family -- Write FAM record
+ *================================*/
+static void
+write_family (FILE *fp, long f)
+{
+	FAMILY *fam = &families[f];
+	long i;
+	fprintf(fp, "0 @F%ld@ FAM\n1 HUSB @I%ld@\n1 WIFE @I%ld@\n"
+		, f+1, fam->husb+1, fam->wife+1);
+	fprintf(fp, "1 MARR\n2 DATE %d %s %d\n2 PLAC %s\n"
+		, 1 + random_below(28), months[random_below(12)], fam->year
+		, places[fam->place]);
+	/* children directly follow the spouse added with the family */
+	for (i = (fam->husb > fam->wife ? fam->husb : fam->wife) + 1
+		; i < npersons && persons[i].famc == f; ++i) {
+		fprintf(fp, "1 CHIL @I%ld@\n", i+1);
+	}
+}
+/*==================================
+ * write_note -- Write NOTE of about len characters
+ *  as CONC/CONT lines of at most 72 characters
+ *================================*/
+static void
+write_note (FILE *fp, int level, int len)
+{
+	int linelen = 0, written = 0;
+	fprintf(fp, "%d NOTE", level);
+	linelen = 1;
+	while (written < len) {
+		const char *w = words[random_zipf(ARRSIZE(words))];
+		int wlen = (int)strlen(w);
+		if (linelen + wlen + 1 > 72) {
+			/* start new paragraph now and then */
+			fprintf(fp, "\n%d %s", level+1, random_below(8) ? "CONC" : "CONT");
+			linelen = 0;
+		}
+		fprintf(fp, " %s", w);
+		linelen += wlen + 1;
+		written += wlen + 1;
+	}
+	fprintf(fp, ".\n");
+}
+/*==================================
+ * write_surname -- Write surname of given rank
+ *  (made up from syllables past the common names)
+ *================================*/
+static void
+write_surname (FILE *fp, int rank)
+{
+	int n = ARRSIZE(syllables);
+	if (rank < ARRSIZE(surnames)) {
+		fputs(surnames[rank], fp);
+		return;
+	}
+	rank -= ARRSIZE(surnames);
+	fputc(syllables[rank % n][0] - 'a' + 'A', fp);
+	fputs(syllables[rank % n] + 1, fp);
+	fputs(syllables[(rank / n) % n], fp);
+	if (rank >= n*n)
+		fputs(syllables[(rank / (n*n)) % n], fp);
+}
+/*==================================
+ * next_random -- Next 32 bit pseudorandom number
+ *  (xorshift, so sequence is the same everywhere)
+ *================================*/
+static unsigned long
+next_random (void)
+{
+	unsigned long x = rstate;
+	x ^= (x << 13) & 0xffffffffUL;
+	x ^= x >> 17;
+	x ^= (x << 5) & 0xffffffffUL;
+	rstate = x & 0xffffffffUL;
+	return rstate;
+}
+/*==================================
+ * random_below -- Uniform random number in [0,n)
+ *================================*/
+static int
+random_below (int n)
+{
+	return (int)(next_random() % (unsigned long)n);
+}
+/*==================================
+ * random_zipf -- Random rank in [0,n), rank r being chosen
+ *  about 1/(r+1) as often as rank 0
+ *================================*/
+static int
+random_zipf (int n)
+{
+	/* log uniform: pick a power of two range, then within it */
+	int bits = 0, lo, hi;
+	while ((1 << bits) <= n)
+		++bits;
+	lo = (1 << random_below(bits)) - 1;
+	hi = 2*lo + 1;
+	if (hi > n) hi = n;
+	return lo + random_below(hi - lo);
+}
+/*==================================
+ * usage -- Show command line
+ *================================*/
+static void
+usage (void)
+{
+	fprintf(stderr, "usage: gensynth [-n individuals] [-s seed] [-o file]\n");
+}
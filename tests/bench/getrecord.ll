@@ -0,0 +1,27 @@
+/*
+ * getrecord.ll -- Benchmark: load persons by key
+ *  Loads "count" persons (default 20000), striding through the
+ *  keys so consecutive loads are far apart in the database, which
+ *  defeats the record cache; every load reads the btree.
+ */
+proc main()
+{
+	set(count, 20000)
+	if (s, getproperty("count")) {
+		set(count, atoi(s))
+	}
+	set(nkeys, atoi(substring(key(lastindi()), 2, 12)))
+	set(k, 0)
+	set(found, 0)
+	set(j, 0)
+	while (lt(j, count)) {
+		set(k, add(mod(add(k, 7919), nkeys), 1))
+		if (i, indi(concat("I", d(k)))) {
+			if (name(i)) {
+				incr(found)
+			}
+		}
+		incr(j)
+	}
+	"loaded " d(found) " of " d(count) "\n"
+}
@@ -0,0 +1,35 @@
+/*
+ * namelookup.ll -- Benchmark: look persons up by name
+ *  Each common given name with each common surname (most exist,
+ *  some do not), then all persons of each surname.
+ */
+proc main()
+{
+	list(givens)
+	enqueue(givens, "John") enqueue(givens, "William")
+	enqueue(givens, "James") enqueue(givens, "Mary")
+	enqueue(givens, "Elizabeth") enqueue(givens, "Sarah")
+	enqueue(givens, "Hugh") enqueue(givens, "Helena")
+	enqueue(givens, "Nobody")
+	list(surnames)
+	enqueue(surnames, "Smith") enqueue(surnames, "Johnson")
+	enqueue(surnames, "Williams") enqueue(surnames, "Brown")
+	enqueue(surnames, "Miller") enqueue(surnames, "Taylor")
+	enqueue(surnames, "Clark") enqueue(surnames, "Nilsson")
+	enqueue(surnames, "Novak") enqueue(surnames, "Nosuchname")
+	set(nfound, 0)
+	set(nlookups, 0)
+	forlist(surnames, sn, j) {
+		forlist(givens, gn, k) {
+			indiset(s)
+			genindiset(concat(gn, " /", sn, "/"), s)
+			set(nfound, add(nfound, length(s)))
+			incr(nlookups)
+		}
+		indiset(s)
+		genindiset(concat("*/", sn, "/"), s)
+		set(nfound, add(nfound, length(s)))
+		incr(nlookups)
+	}
+	"lookups " d(nlookups) " found " d(nfound) "\n"
+}
@@ -0,0 +1,35 @@
+/*
+ * sweep.ll -- Benchmark: visit every person and family
+ *  Touches the data most reports use (names, vital dates, family
+ *  links), so this times record loading and node access in
+ *  forindi & forfam loops.
+ */
+proc main()
+{
+	set(nindi, 0)
+	set(ndates, 0)
+	set(years, 0)
+	forindi(i, n) {
+		incr(nindi)
+		set(s, fullname(i, 1, 1, 40))
+		if (b, birth(i)) {
+			incr(ndates)
+			set(years, add(years, atoi(year(b))))
+		}
+		if (d, death(i)) {
+			incr(ndates)
+		}
+		set(p, father(i))
+	}
+	set(nfam, 0)
+	set(nchil, 0)
+	forfam(f, n) {
+		incr(nfam)
+		set(nchil, add(nchil, nchildren(f)))
+		if (m, marriage(f)) {
+			set(s, place(m))
+		}
+	}
+	"persons " d(nindi) " families " d(nfam) " children " d(nchil)
+	" dates " d(ndates) "\n"
+}
@@ -0,0 +1,58 @@
+/*
+@progname dateparse.ll
+@description Parse compound years, decades and dates met again
+*/
+
+proc main ()
+{
+  /* 1850s once picked up a character left by the longer 1953/54 */
+  call show("1953/54")
+  call show("1850s")
+  call show("ABT 1953/54")
+  call show("1850s")
+  call show("1 JAN 1953/54")
+  call show("FROM 1850s TO 1953/54")
+  call show("BET 1953/54 AND 1960")
+  call show("1850S")
+  call show("1855s")
+
+  /* both birth dates share the date kept for 12 MAR 1850, which is
+  pushed out of the memo by 23 NOV 1732 (same slot) and parsed again */
+  set(p1, indi("I1"))
+  set(p2, indi("I2"))
+  call born(p1)
+  call born(p2)
+  call show("23 NOV 1732")
+  call born(p1)
+  call show("12 MAR 1850")
+  call born(p2)
+  call show("23 NOV 1732")
+  call show("23 NOV 1732")
+  call born(p1)
+  call born(p2)
+
+  /* a changed birth date lets go of the old one */
+  fornodes(birth(p1), n) {
+    if (eqstr(tag(n), "DATE")) { set(old, n) }
+  }
+  addnode(createnode("DATE", "23 NOV 1732"), birth(p1), old)
+  deletenode(old)
+  writeindi(p1)
+  call born(p1)
+  call born(p2)
+  call show("12 MAR 1850")
+  call show("23 NOV 1732")
+}
+
+proc show (s)
+{
+  extractdatestr(mod, day, mon, yr, yrstr, s)
+  s ": mod " d(mod) " day " d(day) " month " d(mon)
+  " year " d(yr) " (" yrstr ") " stddate(s) nl()
+}
+
+proc born (p)
+{
+  key(p) " born " year(birth(p)) " " stddate(birth(p))
+  " " dayofweek(birth(p)) nl()
+}
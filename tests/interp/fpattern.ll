@@ -0,0 +1,66 @@
+/*
+@progname fpattern.ll
+@description Test fpattern matching (through textsearch) and index()
+*/
+
+proc main ()
+{
+  "Starting Test" nl()
+
+  /* NOTE values: I1 abc, I2 ABC, I3 a.c, I4 abbc, I5 ac, I6 azc,
+     I7 a0b, I8 a-b, I9 Smith, I10 a, I11 ab, I12 a]x */
+  call search("abc")
+  call search("a?c")
+  call search("a*c")
+  call search("A*")
+  call search("*b")
+  call search("*")
+  call search("a[b-z]c")
+  call search("[ab0-9]?")
+  call search("a[-.]?")
+  call search("a[!a-z]b")
+  call search("a[!b]")
+  call search("a[\\]]x")
+  call search("a\\]x")
+  call search("sm?TH")
+  call search("!a*")
+  call search("!a?c")
+
+  call index("aaaa", "aa")
+  call index("abababa", "aba")
+  call index("abcabc", "c")
+  call index("abc", "abcd")
+  call index("mississippi", "issi")
+  set(s, "")
+  set(i, 0)
+  while (lt(i, 4)) {
+    set(s, concat(s, "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"))
+    incr(i)
+  }
+  "200 of 256 x's at: " d(index(s, substring(s, 1, 200), 1)) " "
+  d(index(s, substring(s, 1, 200), 57)) " " d(index(s, substring(s, 1, 200), 58)) nl()
+
+  "Ending Test" nl()
+}
+
+proc search (pat)
+{
+  "textsearch(" pat "):"
+  forlist(textsearch(pat, "NOTE"), k, n) {
+    " " k
+  }
+  nl()
+}
+
+proc index (s, sub)
+{
+  "index(" s ", " sub "):"
+  set(n, 1)
+  set(at, index(s, sub, n))
+  while (at) {
+    " " d(at)
+    incr(n)
+    set(at, index(s, sub, n))
+  }
+  " (then " d(index(s, sub, n)) ")" nl()
+}
@@ -0,0 +1,57 @@
+/*
+@progname lazynode.ll
+@description Read and edit long subtrees, which are parsed on first use
+*/
+
+proc main ()
+{
+  /* each record is first reached in a different way */
+  "I1 fornodes:" nl()
+  fornodes(inode(indi("I1")), n) {
+    if (eqstr(tag(n), "NOTE")) {
+      fornodes(n, m) { call shownode(m) }
+    }
+  }
+  "I2 traverse:" nl()
+  traverse(inode(indi("I2")), n, l) { call shownode(n) }
+  "I3 child:" nl()
+  set(n, child(inode(indi("I3"))))
+  while (n) {
+    if (eqstr(tag(n), "NOTE")) {
+      set(m, child(n))
+      call shownode(m)
+      call shownode(sibling(m))
+      call shownode(parent(m))
+    }
+    set(n, sibling(n))
+  }
+
+  /* edit inside long subtrees and store the records again */
+  set(p, indi("I1"))
+  fornodes(inode(p), n) {
+    if (eqstr(tag(n), "NOTE")) {
+      set(last, 0)
+      fornodes(n, m) { set(last, m) }
+      addnode(createnode("CONT", "6. Added at the end."), n, last)
+    }
+  }
+  writeindi(p)
+  set(p, indi("I3"))
+  fornodes(inode(p), n) {
+    if (eqstr(tag(n), "NOTE")) {
+      deletenode(child(n))
+    }
+  }
+  writeindi(p)
+  "edited:" nl()
+  traverse(inode(indi("I1")), n, l) { call shownode(n) }
+  traverse(inode(indi("I3")), n, l) { call shownode(n) }
+}
+
+/* level is found from the parent links */
+proc shownode (n)
+{
+  d(level(n)) " " tag(n)
+  if (value(n)) { " " value(n) }
+  nl()
+}
@@ -0,0 +1,95 @@
+/*
+@progname map.ll
+@description Test map and hashset keys and ordering
+*/
+
+proc main ()
+{
+  "Starting Test" nl()
+
+  /* special floats */
+  set(big, mul(100000.0, 100000.0))
+  set(huge, mul(big, mul(big, big)))
+  set(inf, mul(huge, huge))
+  set(nan, sub(inf, inf))
+  set(negzero, mul(-1.0, 0.0))
+
+  /* map: keys of every kind, inserted out of order */
+  map(m)
+  mapset(m, "cherry", "cherry")
+  mapset(m, 30, "30")
+  mapset(m, indi("I2"), "I2")
+  mapset(m, "Zebra", "Zebra")
+  mapset(m, nan, "nan")
+  mapset(m, 2.5, "2.5")
+  mapset(m, "apple", "apple")
+  mapset(m, inf, "inf")
+  mapset(m, -7, "-7")
+  mapset(m, big, "big")
+  mapset(m, indi("I1"), "I1")
+  mapset(m, "Banana", "Banana")
+  mapset(m, 0, "0")
+  mapset(m, negzero, "-0.0")
+  mapset(m, nan, "nan again")
+  mapset(m, 10, "10")
+  mapset(m, 10.0, "10.0")
+  "map length: " d(length(m)) nl()
+  "map order:"
+  forlist(mapvalues(m), v, c) { " " v }
+  nl()
+  "map 10: " mapget(m, 10) nl()
+  "map nan: " mapget(m, nan) nl()
+  "map 0: " mapget(m, 0) nl()
+  "map range 0..30:"
+  forlist(mapvalues(m, 0, 30), v, c) { " " v }
+  nl()
+  "map range strings:"
+  forlist(mapvalues(m, "B", "b"), v, c) { " " v }
+  nl()
+  if (mapdelete(m, "apple")) { "deleted apple" nl() }
+  if (not(mapdelete(m, "apple"))) { "apple already gone" nl() }
+  if (inmap(m, 2.5)) { "2.5 in map" nl() }
+  if (not(inmap(m, 2.6))) { "2.6 not in map" nl() }
+  list(ks)
+  list(vs)
+  enqueue(ks, "b") enqueue(vs, "second")
+  enqueue(ks, "a") enqueue(vs, "first")
+  map(m2)
+  "mapload: " d(mapload(m2, ks, vs)) ":"
+  forlist(mapkeys(m2), k, c) { " " k "=" mapget(m2, k) }
+  nl()
+
+  /* hash set: members equal as map keys are the same member */
+  hashset(h)
+  call add(h, 7, "7")
+  call add(h, 7.0, "7.0")
+  call add(h, "7", "\"7\"")
+  call add(h, 0, "0")
+  call add(h, negzero, "-0.0")
+  call add(h, 0.0, "0.0")
+  call add(h, big, "big")
+  call add(h, huge, "huge")
+  call add(h, mul(100000.0, 100000.0), "big again")
+  call add(h, inf, "inf")
+  call add(h, nan, "nan")
+  call add(h, sub(inf, inf), "nan again")
+  call add(h, 2.5, "2.5")
+  call add(h, 2.25, "2.25")
+  call add(h, indi("I1"), "I1")
+  call add(h, indi("I1"), "I1 again")
+  "hashset length: " d(length(h)) nl()
+  if (hsin(h, 2.5)) { "2.5 in set" nl() }
+  if (not(hsin(h, 2.75))) { "2.75 not in set" nl() }
+  if (hsdelete(h, 7.0)) { "deleted 7" nl() }
+  if (not(hsin(h, 7))) { "7 not in set" nl() }
+  "hsaddlist: " d(hsaddlist(h, ks)) " " d(hsaddlist(h, ks)) nl()
+  "hslist length: " d(length(hslist(h))) nl()
+
+  "Ending Test" nl()
+}
+
+proc add (h, v, what)
+{
+  if (hsadd(h, v)) { "added " what nl() }
+  else { "already have " what nl() }
+}
@@ -0,0 +1,37 @@
+/*
+@progname nullset.ll
+@description Test sets made by genindiset, whose elements have no value
+*/
+
+proc main ()
+{
+  "Starting Test" nl()
+
+  /* each call frees the set made by the one before */
+  set(i, 0)
+  while (lt(i, 20)) {
+    genindiset("Anne /Smith/", s)
+    genindiset("Mary /Jones/", t)
+    incr(i)
+  }
+
+  "genindiset:" nl()
+  forindiset(s, p, v, n) {
+    d(n) " " key(p) " " name(p) " [" v "]" nl()
+  }
+
+  /* value added to set of null values */
+  addtoset(t, indi("I4"), "added")
+  "addtoset:" nl()
+  forindiset(t, p, v, n) {
+    d(n) " " key(p) " [" v "]" nl()
+  }
+
+  set(u, union(s, t))
+  "union:" nl()
+  forindiset(u, p, v, n) {
+    d(n) " " key(p) " [" v "]" nl()
+  }
+
+  "Ending Test" nl()
+}
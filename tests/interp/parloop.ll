@@ -0,0 +1,87 @@
+/*
+@progname parloop.ll
+@description Test parforindi and parforfam against forindi and forfam
+*/
+
+proc main ()
+{
+  "Starting Test" nl()
+
+  /* persons, plain loop */
+  set(n1, 0)
+  set(s1, "")
+  set(f1, 0.0)
+  list(l1)
+  table(t1)
+  indiset(q1)
+  forindi(i, c) {
+    "forindi " key(i) nl()
+    incr(n1)
+    set(s1, concat(s1, " ", key(i)))
+    set(f1, add(f1, 0.5))
+    enqueue(l1, c)
+    insert(t1, sex(i), add(lookup(t1, sex(i)), 1))
+    if (eq(mod(c, 2), 0)) { addtoset(q1, i, c) }
+  }
+
+  /* persons, parallel loop */
+  set(n2, 0)
+  set(s2, "")
+  set(f2, 0.0)
+  list(l2)
+  table(t2)
+  indiset(q2)
+  parforindi(i, c, n2, s2, f2, l2, t2, q2) {
+    "forindi " key(i) nl()
+    incr(n2)
+    set(s2, concat(s2, " ", key(i)))
+    set(f2, add(f2, 0.5))
+    enqueue(l2, c)
+    insert(t2, sex(i), add(lookup(t2, sex(i)), 1))
+    if (eq(mod(c, 2), 0)) { addtoset(q2, i, c) }
+  }
+
+  "count: " d(n1) " " d(n2) nl()
+  "keys:" s1 nl()
+  call same("keys", eqstr(s1, s2))
+  "sum: " f(f1, 2) " " f(f2, 2) nl()
+  set(x1, "")
+  forlist(l1, e, c) { set(x1, concat(x1, " ", d(e))) }
+  set(x2, "")
+  forlist(l2, e, c) { set(x2, concat(x2, " ", d(e))) }
+  "list:" x1 nl()
+  call same("list", eqstr(x1, x2))
+  "table: M " d(lookup(t1, "M")) " " d(lookup(t2, "M"))
+  " F " d(lookup(t1, "F")) " " d(lookup(t2, "F")) nl()
+  set(x1, "")
+  forindiset(q1, i, v, c) { set(x1, concat(x1, " ", key(i), "=", d(v))) }
+  set(x2, "")
+  forindiset(q2, i, v, c) { set(x2, concat(x2, " ", key(i), "=", d(v))) }
+  "set:" x1 nl()
+  call same("set", eqstr(x1, x2))
+
+  /* families */
+  set(n1, 0)
+  set(s1, "")
+  forfam(f, c) {
+    incr(n1)
+    set(s1, concat(s1, " ", key(f)))
+  }
+  set(n2, 0)
+  set(s2, "")
+  parforfam(f, c, n2, s2) {
+    incr(n2)
+    set(s2, concat(s2, " ", key(f)))
+  }
+  "families: " d(n1) " " d(n2) nl()
+  "family keys:" s1 nl()
+  call same("family keys", eqstr(s1, s2))
+
+  "Ending Test" nl()
+}
+
+proc same (what, eq)
+{
+  if (eq) { what " same" nl() }
+  else { what " differ" nl() }
+}
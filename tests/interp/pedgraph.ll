@@ -0,0 +1,66 @@
+/*
+@progname pedgraph.ll
+@description Compare parentset and childset with the links in the records
+*/
+
+proc main ()
+{
+  getstr(stage, "Stage")
+  if (eqstr(stage, "imported")) {
+    newfile("pedgraph.out", 0)
+  } else {
+    newfile("pedgraph.out", 1)
+  }
+  if (eqstr(stage, "rewritten")) {
+    /* enough writes that the graph is dropped and built again */
+    forindi(p, n) {
+      if (gt(n, 6)) {
+        addnode(createnode("NOTE", "touched"), inode(p), 0)
+        writeindi(p)
+      }
+    }
+  }
+  stage ":" nl()
+  set(i, 1)
+  while (le(i, 6)) {
+    set(p, indi(concat("I", d(i))))
+    indiset(s)
+    addtoset(s, p, 0)
+    key(p) " parents" call keys(parentset(s))
+    indiset(r)
+    fornodes(inode(p), n) {
+      if (eqstr(tag(n), "FAMC")) {
+        fornodes(fnode(fam(value(n))), m) {
+          if (or(eqstr(tag(m), "HUSB"), eqstr(tag(m), "WIFE"))) {
+            addtoset(r, indi(value(m)), 0)
+          }
+        }
+      }
+    }
+    " records" call keys(r)
+    " children" call keys(childset(s))
+    indiset(r)
+    fornodes(inode(p), n) {
+      if (eqstr(tag(n), "FAMS")) {
+        fornodes(fnode(fam(value(n))), m) {
+          if (eqstr(tag(m), "CHIL")) {
+            addtoset(r, indi(value(m)), 0)
+          }
+        }
+      }
+    }
+    " records" call keys(r) nl()
+    incr(i)
+  }
+}
+
+proc keys (s)
+{
+  keysort(s)
+  " ["
+  forindiset(s, p, v, n) {
+    if (gt(n, 1)) { " " }
+    key(p)
+  }
+  "]"
+}
@@ -0,0 +1,48 @@
+/*
+@progname textsearch.ll
+@description Test textsearch before and after records are changed
+*/
+
+proc main ()
+{
+  "Starting Test" nl()
+
+  call search("*smith*", "")
+  call search("*somerset*", "PLAC")
+  call search("*zebra*", "")
+
+  /* add a note to I2 */
+  set(i, indi("I2"))
+  set(n, createnode("NOTE", "Kept a zebra"))
+  addnode(n, inode(i), 0)
+  "writeindi I2: " d(writeindi(i)) nl()
+  call search("*zebra*", "")
+  call search("*zebra*", "NOTE")
+  call search("*zebra*", "NAME")
+  call search("*bees*", "")
+
+  /* rename I1 */
+  set(i, indi("I1"))
+  fornodes(inode(i), n) {
+    if (eqstr(tag(n), "NAME")) {
+      set(old, n)
+    }
+  }
+  deletenode(old)
+  addnode(createnode("NAME", "John /Zebrowski/"), inode(i), 0)
+  "writeindi I1: " d(writeindi(i)) nl()
+  call search("*smith*", "")
+  call search("*zebrowski*", "NAME")
+  call search("*zebra*", "")
+
+  "Ending Test" nl()
+}
+
+proc search (pattern, tag)
+{
+  pattern " " tag ":"
+  forlist(textsearch(pattern, tag), k, n) {
+    " " k
+  }
+  nl()
+}
@@ -0,0 +1,22 @@
+/* uniqueset leaves a set in key order, whatever order
+   its elements were added in */
+proc main()
+{
+  indiset(s)
+  addtoset(s, indi("I3"), 1)
+  addtoset(s, indi("I5"), 2)
+  addtoset(s, indi("I1"), 3)
+  addtoset(s, indi("I3"), 4)
+  addtoset(s, indi("I2"), 5)
+  addtoset(s, indi("I4"), 6)
+  "added:" call show(s)
+  uniqueset(s)
+  "unique:" call show(s)
+}
+proc show(s)
+{
+  forindiset(s, p, v, n) {
+    " " key(p) "=" d(v)
+  }
+  nl()
+}
@@ -0,0 +1,21 @@
+/* convertcode() where the output outgrows the first guess at its size:
+   each 2-byte BIG5-HKSCS character becomes a 4-byte UTF-8 character,
+   and the leading "x" makes iconv run out of room with 3 bytes left,
+   which must not be taken for an unconvertible character */
+proc main()
+{
+  set(s, "x")
+  set(x, "x")
+  set(bad, 0)
+  set(i, 1)
+  while (le(i, 60)) {
+    set(s, concat(s, bytecode("$87$45", "raw")))
+    set(x, concat(x, bytecode("$F0$A7$89$A7", "raw")))
+    if (nestr(convertcode(s, "BIG5-HKSCS", "UTF-8"), x)) {
+      incr(bad)
+      "mismatch at " d(i) " characters\n"
+    }
+    incr(i)
+  }
+  d(bad) " mismatches\n"
+}
@@ -0,0 +1,20 @@
+/* Translation tables (.tt) compiled for lookup: the longest match wins,
+   a partial match that dead-ends falls back to the last complete one,
+   and text where no byte starts a pattern comes through unchanged */
+proc main()
+{
+  call show("abc")
+  call show("abd")
+  call show("aab")
+  call show("bab")
+  call show("xyzxyxy")
+  call show("none of them")
+  call show("")
+  /* tables shipped in tt/ */
+  "ANSEL " d(eqstr(convertcode("Ł-Ø", "UTF-8", "ANSEL"), bytecode("$A1-$A2", "raw"))) "\n"
+  "html <" convertcode("a © b", "UTF-8", "UTF-8//html") ">\n"
+}
+proc show(s)
+{
+  "<" s "> -> <" convertcode(s, "UTF-8", "UTF-8//ttdfa") ">\n"
+}